@@ -39,4 +39,15 @@ template <typename IntRange>
 	return HashFinalize(result);
 }
 
+// Hashes values projected from the existing storage, so the call sites
+// don't have to materialize a temporary vector of ids first.
+template <typename Range, typename Projection>
+[[nodiscard]] inline int32 CountHash(Range &&range, Projection &&projection) {
+	auto result = HashInit();
+	for (const auto &value : range) {
+		HashUpdate(result, projection(value));
+	}
+	return HashFinalize(result);
+}
+
 } // namespace Api
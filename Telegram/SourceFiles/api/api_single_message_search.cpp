@@ -21,6 +21,9 @@ namespace {
 
 using Key = details::SingleMessageSearchKey;
 
+// Resolved (and failed) lookups stay cached for that long.
+constexpr auto kCacheResultsFor = 10 * 60 * crl::time(1000);
+
 Key ExtractKey(const QString &query) {
 	const auto trimmed = query.trimmed();
 	const auto local = Core::TryConvertUrlToLocal(trimmed);
@@ -59,10 +62,21 @@ SingleMessageSearch::~SingleMessageSearch() {
 
 void SingleMessageSearch::clear() {
 	_cache.clear();
+	_readyCallbacks.clear();
 	_requestKey = Key();
 	_session->api().request(base::take(_requestId)).cancel();
 }
 
+void SingleMessageSearch::cacheResult(FullMsgId itemId) {
+	_cache[_requestKey] = CacheEntry{ itemId, crl::now() };
+}
+
+void SingleMessageSearch::notifyReady() {
+	for (const auto &callback : base::take(_readyCallbacks)) {
+		callback();
+	}
+}
+
 std::optional<HistoryItem*> SingleMessageSearch::lookup(
 		const QString &query,
 		Fn<void()> ready) {
@@ -72,13 +86,32 @@ std::optional<HistoryItem*> SingleMessageSearch::lookup(
 	}
 	const auto i = _cache.find(key);
 	if (i != end(_cache)) {
-		return _session->data().message(i->second);
+		if (crl::now() - i->second.when < kCacheResultsFor) {
+			return _session->data().message(i->second.itemId);
+		}
+		_cache.erase(i);
+	}
+	if (_requestKey == key && _requestId) {
+		// The same lookup is already in flight, just wait for it.
+		if (ready) {
+			_readyCallbacks.push_back(std::move(ready));
+		}
+		return std::nullopt;
 	}
 	if (!(_requestKey == key)) {
 		_session->api().request(base::take(_requestId)).cancel();
 		_requestKey = key;
+		_readyCallbacks.clear();
+	}
+	if (!ready) {
+		return performLookup(nullptr);
+	}
+	_readyCallbacks.push_back(std::move(ready));
+	const auto result = performLookup([=] { notifyReady(); });
+	if (result.has_value()) {
+		_readyCallbacks.clear();
 	}
-	return performLookup(ready);
+	return result;
 }
 
 std::optional<HistoryItem*> SingleMessageSearch::performLookupByChannel(
@@ -88,20 +121,21 @@ std::optional<HistoryItem*> SingleMessageSearch::performLookupByChannel(
 
 	const auto postId = _requestKey.postId;
 	if (const auto item = _session->data().message(channel, postId)) {
-		_cache.emplace(_requestKey, item->fullId());
+		cacheResult(item->fullId());
 		return item;
 	} else if (!ready) {
 		return nullptr;
 	}
 
 	const auto fail = [=] {
-		_cache.emplace(_requestKey, FullMsgId());
+		cacheResult(FullMsgId());
 		ready();
 	};
 	_requestId = _session->api().request(MTPchannels_GetMessages(
 		channel->inputChannel,
 		MTP_vector<MTPInputMessage>(1, MTP_inputMessageID(MTP_int(postId)))
 	)).done([=](const MTPmessages_Messages &result) {
+		_requestId = 0;
 		const auto received = Api::ParseSearchResult(
 			channel,
 			Storage::SharedMediaType::kCount,
@@ -110,14 +144,13 @@ std::optional<HistoryItem*> SingleMessageSearch::performLookupByChannel(
 			result);
 		if (!received.messageIds.empty()
 			&& received.messageIds.front() == postId) {
-			_cache.emplace(
-				_requestKey,
-				FullMsgId(channel->bareId(), postId));
+			cacheResult(FullMsgId(channel->bareId(), postId));
 			ready();
 		} else {
 			fail();
 		}
 	}).fail([=](const RPCError &error) {
+		_requestId = 0;
 		fail();
 	}).send();
 
@@ -136,7 +169,7 @@ std::optional<HistoryItem*> SingleMessageSearch::performLookupById(
 	}
 
 	const auto fail = [=] {
-		_cache.emplace(_requestKey, FullMsgId());
+		cacheResult(FullMsgId());
 		ready();
 	};
 	_requestId = _session->api().request(MTPchannels_GetChannels(
@@ -144,6 +177,7 @@ std::optional<HistoryItem*> SingleMessageSearch::performLookupById(
 			1,
 			MTP_inputChannel(MTP_int(channelId), MTP_long(0)))
 	)).done([=](const MTPmessages_Chats &result) {
+		_requestId = 0;
 		result.match([&](const auto &data) {
 			const auto peer = _session->data().processChats(data.vchats());
 			if (peer && peer->id == peerFromChannel(channelId)) {
@@ -155,6 +189,7 @@ std::optional<HistoryItem*> SingleMessageSearch::performLookupById(
 			}
 		});
 	}).fail([=](const RPCError &error) {
+		_requestId = 0;
 		fail();
 	}).send();
 
@@ -170,19 +205,20 @@ std::optional<HistoryItem*> SingleMessageSearch::performLookupByUsername(
 		if (const auto channel = peer->asChannel()) {
 			return performLookupByChannel(channel, ready);
 		}
-		_cache.emplace(_requestKey, FullMsgId());
+		cacheResult(FullMsgId());
 		return nullptr;
 	} else if (!ready) {
 		return nullptr;
 	}
 
 	const auto fail = [=] {
-		_cache.emplace(_requestKey, FullMsgId());
+		cacheResult(FullMsgId());
 		ready();
 	};
 	_requestId = _session->api().request(MTPcontacts_ResolveUsername(
 		MTP_string(username)
 	)).done([=](const MTPcontacts_ResolvedPeer &result) {
+		_requestId = 0;
 		result.match([&](const MTPDcontacts_resolvedPeer &data) {
 			_session->data().processUsers(data.vusers());
 			_session->data().processChats(data.vchats());
@@ -199,6 +235,7 @@ std::optional<HistoryItem*> SingleMessageSearch::performLookupByUsername(
 			}
 		});
 	}).fail([=](const RPCError &error) {
+		_requestId = 0;
 		fail();
 	}).send();
 
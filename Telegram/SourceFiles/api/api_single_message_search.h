@@ -52,6 +52,14 @@ public:
 private:
 	using Key = details::SingleMessageSearchKey;
 
+	struct CacheEntry {
+		FullMsgId itemId;
+		crl::time when = 0;
+	};
+
+	void cacheResult(FullMsgId itemId);
+	void notifyReady();
+
 	[[nodiscard]] std::optional<HistoryItem*> performLookup(
 		Fn<void()> ready);
 	[[nodiscard]] std::optional<HistoryItem*> performLookupById(
@@ -65,7 +73,8 @@ private:
 		Fn<void()> ready);
 
 	const not_null<Main::Session*> _session;
-	std::map<Key, FullMsgId> _cache;
+	std::map<Key, CacheEntry> _cache;
+	std::vector<Fn<void()>> _readyCallbacks;
 	mtpRequestId _requestId = 0;
 	Key _requestKey;
 
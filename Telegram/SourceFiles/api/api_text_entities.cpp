@@ -21,6 +21,8 @@ using namespace TextUtilities;
 EntitiesInText EntitiesFromMTP(
 		Main::Session *session,
 		const QVector<MTPMessageEntity> &entities) {
+	// The common case of a plain-text message costs no allocation,
+	// the default-constructed list shares the empty vector data.
 	auto result = EntitiesInText();
 	if (!entities.isEmpty()) {
 		result.reserve(entities.size());
@@ -81,8 +83,30 @@ MTPVector<MTPMessageEntity> EntitiesToMTP(
 		not_null<Main::Session*> session,
 		const EntitiesInText &entities,
 		ConvertOption option) {
+	if (entities.isEmpty()) {
+		return MTP_vector<MTPMessageEntity>();
+	}
+	const auto convertible = [&](const EntityInText &entity) {
+		if (entity.length() <= 0) {
+			return false;
+		}
+		return (option != ConvertOption::SkipLocal)
+			|| (entity.type() == EntityType::Bold)
+			//|| (entity.type() == EntityType::Semibold) // Not in API.
+			|| (entity.type() == EntityType::Italic)
+			|| (entity.type() == EntityType::Underline)
+			|| (entity.type() == EntityType::StrikeOut)
+			|| (entity.type() == EntityType::Code) // #TODO entities
+			|| (entity.type() == EntityType::Pre)
+			|| (entity.type() == EntityType::MentionName)
+			|| (entity.type() == EntityType::CustomUrl);
+	};
+	const auto count = int(ranges::count_if(entities, convertible));
+	if (!count) {
+		return MTP_vector<MTPMessageEntity>();
+	}
 	auto v = QVector<MTPMessageEntity>();
-	v.reserve(entities.size());
+	v.reserve(count);
 	for (const auto &entity : entities) {
 		if (entity.length() <= 0) continue;
 		if (option == ConvertOption::SkipLocal
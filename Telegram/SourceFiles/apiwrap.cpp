@@ -91,6 +91,11 @@ constexpr auto kForwardMessagesOnAdd = 100;
 constexpr auto kTopPromotionInterval = TimeId(60 * 60);
 constexpr auto kTopPromotionMinDelay = TimeId(10);
 constexpr auto kSmallDelayMs = 5;
+
+// A response younger than that is reused instead of a new request when
+// navigating back and forth, the data is refreshed on relevant updates.
+constexpr auto kIdempotentRequestCacheTimeout = 10 * crl::time(1000);
+
 constexpr auto kUnreadMentionsPreloadIfLess = 5;
 constexpr auto kUnreadMentionsFirstRequestLimit = 10;
 constexpr auto kUnreadMentionsNextRequestLimit = 100;
@@ -231,6 +236,7 @@ ApiWrap::ApiWrap(not_null<Main::Session*> session)
 : MTP::Sender(session->account().mtp())
 , _session(session)
 , _messageDataResolveDelayed([=] { resolveMessageDatas(); })
+, _peerRequestsResolveDelayed([=] { resolvePeerRequests(); })
 , _webPagesTimer([=] { resolveWebPages(); })
 , _draftsSaveTimer([=] { saveDraftsToCloud(); })
 , _featuredSetsReadTimer([=] { readFeaturedSets(); })
@@ -239,6 +245,7 @@ ApiWrap::ApiWrap(not_null<Main::Session*> session)
 //, _feedReadTimer([=] { readFeeds(); }) // #feed
 , _topPromotionTimer([=] { refreshTopPromotion(); })
 , _updateNotifySettingsTimer([=] { sendNotifySettingsUpdates(); })
+, _fileReferencesResolveDelayed([=] { resolveMessageFileReferences(); })
 , _selfDestruct(std::make_unique<Api::SelfDestruct>(this))
 , _sensitiveContent(std::make_unique<Api::SensitiveContent>(this)) {
 	crl::on_main([=] {
@@ -1080,6 +1087,12 @@ void ApiWrap::requestFullPeer(not_null<PeerData*> peer) {
 	if (_fullPeerRequests.contains(peer)) {
 		return;
 	}
+	const auto received = _fullPeerReceived.find(peer);
+	if (received != end(_fullPeerReceived)
+		&& (crl::now() - received->second
+			< kIdempotentRequestCacheTimeout)) {
+		return;
+	}
 
 	const auto requestId = [&] {
 		const auto failHandler = [=](const RPCError &error) {
@@ -1118,6 +1131,11 @@ void ApiWrap::requestFullPeer(not_null<PeerData*> peer) {
 	_fullPeerRequests.insert(peer, requestId);
 }
 
+void ApiWrap::invalidateFullPeer(not_null<PeerData*> peer) {
+	_fullPeerReceived.remove(peer);
+	requestFullPeer(peer);
+}
+
 void ApiWrap::processFullPeer(
 		not_null<PeerData*> peer,
 		const MTPmessages_ChatFull &result) {
@@ -1162,6 +1180,7 @@ void ApiWrap::gotChatFull(
 			_fullPeerRequests.erase(i);
 		}
 	}
+	_fullPeerReceived[peer] = crl::now();
 	fullPeerUpdated().notify(peer);
 }
 
@@ -1185,6 +1204,7 @@ void ApiWrap::gotUserFull(
 			_fullPeerRequests.erase(i);
 		}
 	}
+	_fullPeerReceived[user] = crl::now();
 	fullPeerUpdated().notify(user);
 }
 
@@ -1192,41 +1212,98 @@ void ApiWrap::requestPeer(not_null<PeerData*> peer) {
 	if (_fullPeerRequests.contains(peer) || _peerRequests.contains(peer)) {
 		return;
 	}
+	// Peers demanded in one event loop cycle are fetched together, so
+	// that opening a folder with many unloaded channels produces one
+	// vector request instead of a request per peer.
+	_peerRequests.insert(peer, 0);
+	_peerRequestsResolveDelayed.call();
+}
 
-	const auto requestId = [&] {
-		const auto failHandler = [=](const RPCError &error) {
-			_peerRequests.remove(peer);
-		};
-		const auto chatHandler = [=](const MTPmessages_Chats &result) {
-			_peerRequests.remove(peer);
-			const auto &chats = result.match([](const auto &data) {
-				return data.vchats();
-			});
-			_session->data().applyMaximumChatVersions(chats);
-			_session->data().processChats(chats);
-		};
+void ApiWrap::resolvePeerRequests() {
+	auto users = QVector<MTPInputUser>();
+	auto chats = QVector<MTPint>();
+	auto channels = QVector<MTPInputChannel>();
+	for (auto i = _peerRequests.cbegin(); i != _peerRequests.cend(); ++i) {
+		if (i.value() > 0) {
+			continue;
+		}
+		const auto peer = i.key();
 		if (const auto user = peer->asUser()) {
-			return request(MTPusers_GetUsers(
-				MTP_vector<MTPInputUser>(1, user->inputUser)
-			)).done([=](const MTPVector<MTPUser> &result) {
-				_peerRequests.remove(user);
-				_session->data().processUsers(result);
-			}).fail(failHandler).send();
+			users.push_back(user->inputUser);
 		} else if (const auto chat = peer->asChat()) {
-			return request(MTPmessages_GetChats(
-				MTP_vector<MTPint>(1, chat->inputChat)
-			)).done(chatHandler).fail(failHandler).send();
+			chats.push_back(chat->inputChat);
 		} else if (const auto channel = peer->asChannel()) {
-			return request(MTPchannels_GetChannels(
-				MTP_vector<MTPInputChannel>(1, channel->inputChannel)
-			)).done(chatHandler).fail(failHandler).send();
+			channels.push_back(channel->inputChannel);
 		}
-		Unexpected("Peer type in requestPeer.");
-	}();
-	_peerRequests.insert(peer, requestId);
+	}
+	const auto chatsHandler = [=](
+			const MTPmessages_Chats &result,
+			mtpRequestId requestId) {
+		const auto &chats = result.match([](const auto &data) {
+			return data.vchats();
+		});
+		_session->data().applyMaximumChatVersions(chats);
+		_session->data().processChats(chats);
+		finalizePeerRequests(requestId);
+	};
+	const auto failHandler = [=](
+			const RPCError &error,
+			mtpRequestId requestId) {
+		finalizePeerRequests(requestId);
+	};
+	const auto markSent = [&](mtpRequestId requestId, auto kind) {
+		for (auto i = _peerRequests.begin(); i != _peerRequests.end(); ++i) {
+			if (!i.value() && kind(i.key())) {
+				i.value() = requestId;
+			}
+		}
+	};
+	if (!users.isEmpty()) {
+		const auto requestId = request(MTPusers_GetUsers(
+			MTP_vector<MTPInputUser>(users)
+		)).done([=](const MTPVector<MTPUser> &result, mtpRequestId requestId) {
+			_session->data().processUsers(result);
+			finalizePeerRequests(requestId);
+		}).fail(failHandler).afterDelay(kSmallDelayMs).send();
+		markSent(requestId, [](PeerData *peer) { return peer->isUser(); });
+	}
+	if (!chats.isEmpty()) {
+		const auto requestId = request(MTPmessages_GetChats(
+			MTP_vector<MTPint>(chats)
+		)).done(chatsHandler).fail(failHandler).afterDelay(
+			kSmallDelayMs
+		).send();
+		markSent(requestId, [](PeerData *peer) { return peer->isChat(); });
+	}
+	if (!channels.isEmpty()) {
+		const auto requestId = request(MTPchannels_GetChannels(
+			MTP_vector<MTPInputChannel>(channels)
+		)).done(chatsHandler).fail(failHandler).afterDelay(
+			kSmallDelayMs
+		).send();
+		markSent(requestId, [](PeerData *peer) {
+			return peer->isChannel();
+		});
+	}
+}
+
+void ApiWrap::finalizePeerRequests(mtpRequestId requestId) {
+	for (auto i = _peerRequests.begin(); i != _peerRequests.end();) {
+		if (i.value() == requestId) {
+			i = _peerRequests.erase(i);
+		} else {
+			++i;
+		}
+	}
 }
 
 void ApiWrap::requestPeerSettings(not_null<PeerData*> peer) {
+	const auto received = _peerSettingsReceived.find(peer);
+	if (received != end(_peerSettingsReceived)
+		&& (crl::now() - received->second
+			< kIdempotentRequestCacheTimeout)) {
+		return;
+	}
 	if (!_requestedPeerSettings.emplace(peer).second) {
 		return;
 	}
@@ -1236,6 +1313,7 @@ void ApiWrap::requestPeerSettings(not_null<PeerData*> peer) {
 		peer->setSettings(result.match([&](const MTPDpeerSettings &data) {
 			return data.vflags().v;
 		}));
+		_peerSettingsReceived[peer] = crl::now();
 		_requestedPeerSettings.erase(peer);
 	}).fail([=](const RPCError &error) {
 		_requestedPeerSettings.erase(peer);
@@ -1392,48 +1470,11 @@ void ApiWrap::markMediaRead(not_null<HistoryItem*> item) {
 }
 
 void ApiWrap::requestPeers(const QList<PeerData*> &peers) {
-	QVector<MTPint> chats;
-	QVector<MTPInputChannel> channels;
-	QVector<MTPInputUser> users;
-	chats.reserve(peers.size());
-	channels.reserve(peers.size());
-	users.reserve(peers.size());
 	for (const auto peer : peers) {
-		if (!peer
-			|| _fullPeerRequests.contains(peer)
-			|| _peerRequests.contains(peer)) {
-			continue;
-		}
-		if (const auto user = peer->asUser()) {
-			users.push_back(user->inputUser);
-		} else if (const auto chat = peer->asChat()) {
-			chats.push_back(chat->inputChat);
-		} else if (const auto channel = peer->asChannel()) {
-			channels.push_back(channel->inputChannel);
+		if (peer) {
+			requestPeer(peer);
 		}
 	}
-	const auto handleChats = [=](const MTPmessages_Chats &result) {
-		_session->data().processChats(result.match([](const auto &data) {
-			return data.vchats();
-		}));
-	};
-	if (!chats.isEmpty()) {
-		request(MTPmessages_GetChats(
-			MTP_vector<MTPint>(chats)
-		)).done(handleChats).send();
-	}
-	if (!channels.isEmpty()) {
-		request(MTPchannels_GetChannels(
-			MTP_vector<MTPInputChannel>(channels)
-		)).done(handleChats).send();
-	}
-	if (!users.isEmpty()) {
-		request(MTPusers_GetUsers(
-			MTP_vector<MTPInputUser>(users)
-		)).done([=](const MTPVector<MTPUser> &result) {
-			_session->data().processUsers(result);
-		}).send();
-	}
 }
 
 void ApiWrap::requestLastParticipants(not_null<ChannelData*> channel) {
@@ -1562,7 +1603,7 @@ void ApiWrap::applyLastParticipantsList(
 			const auto rank = qs(creator.vrank().value_or_empty());
 			channel->mgInfo->creator = user;
 			channel->mgInfo->creatorRank = rank;
-			if (!channel->mgInfo->admins.empty()) {
+			if (channel->mgInfo->adminsGeneration) {
 				Data::ChannelAdminChanges(channel).add(userId, rank);
 			}
 		}
@@ -2814,41 +2855,109 @@ void ApiWrap::requestFileReference(
 
 	request(std::move(data)).done([=](const auto &result) {
 		const auto parsed = Data::GetFileReferences(result);
-		for (const auto &p : parsed.data) {
-			// Unpack here the parsed pair by hand to workaround a GCC bug.
-			// See https://gcc.gnu.org/bugzilla/show_bug.cgi?id=87122
-			const auto &origin = p.first;
-			const auto &reference = p.second;
-			const auto documentId = base::get_if<DocumentFileLocationId>(
-				&origin);
-			if (documentId) {
-				_session->data().document(
-					documentId->id
-				)->refreshFileReference(reference);
-			}
-			const auto photoId = base::get_if<PhotoFileLocationId>(&origin);
-			if (photoId) {
-				_session->data().photo(
-					photoId->id
-				)->refreshFileReference(reference);
-			}
+		applyUpdatedFileReferences(parsed);
+		finalizeFileReference(origin, parsed);
+	}).fail([=](const RPCError &error) {
+		finalizeFileReference(origin, UpdatedFileReferences());
+	}).send();
+}
+
+void ApiWrap::applyUpdatedFileReferences(const UpdatedFileReferences &update) {
+	for (const auto &p : update.data) {
+		// Unpack here the parsed pair by hand to workaround a GCC bug.
+		// See https://gcc.gnu.org/bugzilla/show_bug.cgi?id=87122
+		const auto &origin = p.first;
+		const auto &reference = p.second;
+		const auto documentId = base::get_if<DocumentFileLocationId>(
+			&origin);
+		if (documentId) {
+			_session->data().document(
+				documentId->id
+			)->refreshFileReference(reference);
 		}
-		const auto i = _fileReferenceHandlers.find(origin);
-		Assert(i != end(_fileReferenceHandlers));
-		auto handlers = std::move(i->second);
-		_fileReferenceHandlers.erase(i);
-		for (auto &handler : handlers) {
-			handler(parsed);
+		const auto photoId = base::get_if<PhotoFileLocationId>(&origin);
+		if (photoId) {
+			_session->data().photo(
+				photoId->id
+			)->refreshFileReference(reference);
 		}
-	}).fail([=](const RPCError &error) {
-		const auto i = _fileReferenceHandlers.find(origin);
-		Assert(i != end(_fileReferenceHandlers));
-		auto handlers = std::move(i->second);
-		_fileReferenceHandlers.erase(i);
-		for (auto &handler : handlers) {
-			handler(UpdatedFileReferences());
+	}
+}
+
+void ApiWrap::finalizeFileReference(
+		const Data::FileOrigin &origin,
+		const UpdatedFileReferences &data) {
+	const auto i = _fileReferenceHandlers.find(origin);
+	if (i == end(_fileReferenceHandlers)) {
+		return;
+	}
+	auto handlers = std::move(i->second);
+	_fileReferenceHandlers.erase(i);
+	for (auto &handler : handlers) {
+		handler(data);
+	}
+}
+
+void ApiWrap::postponeMessageFileReference(
+		Data::FileOrigin origin,
+		FileReferencesHandler &&handler) {
+	const auto i = _fileReferenceHandlers.find(origin);
+	if (i != end(_fileReferenceHandlers)) {
+		i->second.push_back(std::move(handler));
+		return;
+	}
+	auto handlers = std::vector<FileReferencesHandler>();
+	handlers.push_back(std::move(handler));
+	_fileReferenceHandlers.emplace(origin, std::move(handlers));
+	_postponedMessageFileReferences.push_back(origin);
+	_fileReferencesResolveDelayed.call();
+}
+
+void ApiWrap::resolveMessageFileReferences() {
+	struct Batch {
+		QVector<MTPInputMessage> ids;
+		std::vector<Data::FileOrigin> origins;
+	};
+	auto batches = base::flat_map<ChannelData*, Batch>();
+	for (const auto &origin : base::take(_postponedMessageFileReferences)) {
+		const auto msgId = base::get_if<Data::FileOriginMessage>(
+			&origin.data);
+		Assert(msgId != nullptr);
+		const auto item = _session->data().message(*msgId);
+		if (!item) {
+			finalizeFileReference(origin, UpdatedFileReferences());
+			continue;
 		}
-	}).send();
+		auto &batch = batches[item->history()->peer->asChannel()];
+		batch.ids.push_back(MTP_inputMessageID(MTP_int(item->id)));
+		batch.origins.push_back(origin);
+	}
+	for (auto &[peerChannel, batch] : batches) {
+		const auto done = [=, origins = batch.origins](
+				const MTPmessages_Messages &result) {
+			const auto parsed = Data::GetFileReferences(result);
+			applyUpdatedFileReferences(parsed);
+			for (const auto &origin : origins) {
+				finalizeFileReference(origin, parsed);
+			}
+		};
+		const auto fail = [=, origins = batch.origins](
+				const RPCError &error) {
+			for (const auto &origin : origins) {
+				finalizeFileReference(origin, UpdatedFileReferences());
+			}
+		};
+		if (const auto channel = peerChannel) {
+			request(MTPchannels_GetMessages(
+				channel->inputChannel,
+				MTP_vector<MTPInputMessage>(batch.ids)
+			)).done(done).fail(fail).afterDelay(kSmallDelayMs).send();
+		} else {
+			request(MTPmessages_GetMessages(
+				MTP_vector<MTPInputMessage>(batch.ids)
+			)).done(done).fail(fail).afterDelay(kSmallDelayMs).send();
+		}
+	}
 }
 
 void ApiWrap::refreshFileReference(
@@ -2893,17 +3002,10 @@ void ApiWrap::refreshFileReference(
 				request(MTPmessages_GetScheduledMessages(
 					item->history()->peer->input,
 					MTP_vector<MTPint>(1, MTP_int(realId))));
-			} else if (const auto channel = item->history()->peer->asChannel()) {
-				request(MTPchannels_GetMessages(
-					channel->inputChannel,
-					MTP_vector<MTPInputMessage>(
-						1,
-						MTP_inputMessageID(MTP_int(item->id)))));
 			} else {
-				request(MTPmessages_GetMessages(
-					MTP_vector<MTPInputMessage>(
-						1,
-						MTP_inputMessageID(MTP_int(item->id)))));
+				// Message references expire in batches, so collect the
+				// refreshes into one getMessages call per channel.
+				postponeMessageFileReference(origin, std::move(handler));
 			}
 		} else {
 			fail();
@@ -3698,6 +3800,23 @@ void ApiWrap::jumpToHistoryDate(not_null<PeerData*> peer, const QDate &date) {
 		jumpToHistoryDate(channel, date);
 		return;
 	}
+	const auto findLocally = [&](not_null<PeerData*> in) {
+		if (const auto history = _session->data().historyLoaded(in)) {
+			if (const auto itemId = history->findDateIndexMessage(date)) {
+				Ui::showPeerHistory(in, itemId);
+				return true;
+			}
+		}
+		return false;
+	};
+	if (const auto chat = peer->migrateFrom()) {
+		if (findLocally(chat)) {
+			return;
+		}
+	}
+	if (findLocally(peer)) {
+		return;
+	}
 	const auto jumpToDateInPeer = [=] {
 		requestMessageAfterDate(peer, date, [=](MsgId resultId) {
 			Ui::showPeerHistory(peer, resultId);
@@ -4876,6 +4995,16 @@ void ApiWrap::sendMessage(MessageToSend &&message) {
 				MTPVector<MTPRestrictionReason>()),
 			clientFlags,
 			NewMessageType::Unread);
+		if (!action.options.scheduled) {
+			// Journal the send, so that a crash before the server
+			// confirms it replays the request on the next launch.
+			Local::addToSendOutbox({
+				randomId,
+				peer->id,
+				action.replyTo,
+				silentPost,
+				sending.text });
+		}
 		histories.sendRequest(history, requestType, [=](Fn<void()> finish) {
 			history->sendRequestId = request(MTPmessages_SendMessage(
 				MTP_flags(sendFlags),
@@ -4888,6 +5017,7 @@ void ApiWrap::sendMessage(MessageToSend &&message) {
 				MTP_int(action.options.scheduled)
 			)).done([=](const MTPUpdates &result) {
 				applyUpdates(result, randomId);
+				Local::removeFromSendOutbox(randomId);
 				history->clearSentDraftText(QString());
 				finish();
 			}).fail([=](const RPCError &error) {
@@ -4896,6 +5026,7 @@ void ApiWrap::sendMessage(MessageToSend &&message) {
 				} else {
 					sendMessageFail(error, peer, randomId, newId);
 				}
+				Local::removeFromSendOutbox(randomId);
 				history->clearSentDraftText(QString());
 				finish();
 			}).afterRequest(history->sendRequestId
@@ -4909,6 +5040,55 @@ void ApiWrap::sendMessage(MessageToSend &&message) {
 	}
 }
 
+void ApiWrap::replaySendOutbox() {
+	for (const auto &entry : Local::readSendOutbox()) {
+		const auto peer = _session->data().peerLoaded(entry.peerId);
+		if (!peer || !peer->canWrite()) {
+			Local::removeFromSendOutbox(entry.randomId);
+			continue;
+		}
+		const auto history = _session->data().history(peer);
+		const auto randomId = entry.randomId;
+		const auto replyTo = MsgId(entry.replyTo);
+		const auto text = entry.text;
+		auto sendFlags = MTPmessages_SendMessage::Flags(0)
+			| MTPmessages_SendMessage::Flag::f_no_webpage;
+		if (replyTo) {
+			sendFlags |= MTPmessages_SendMessage::Flag::f_reply_to_msg_id;
+		}
+		if (entry.silent) {
+			sendFlags |= MTPmessages_SendMessage::Flag::f_silent;
+		}
+		auto &histories = _session->data().histories();
+		const auto requestType = Data::Histories::RequestType::Send;
+
+		// The server dedups by the journaled random identifier, so if the
+		// original request got through before the crash this resend is a
+		// no-op and the message is not duplicated.
+		histories.sendRequest(history, requestType, [=](Fn<void()> finish) {
+			history->sendRequestId = request(MTPmessages_SendMessage(
+				MTP_flags(sendFlags),
+				peer->input,
+				MTP_int(replyTo),
+				MTP_string(text),
+				MTP_long(randomId),
+				MTPReplyMarkup(),
+				MTP_vector<MTPMessageEntity>(0),
+				MTP_int(0)
+			)).done([=](const MTPUpdates &result) {
+				Local::removeFromSendOutbox(randomId);
+				applyUpdates(result);
+				finish();
+			}).fail([=](const RPCError &error) {
+				Local::removeFromSendOutbox(randomId);
+				finish();
+			}).afterRequest(history->sendRequestId
+			).send();
+			return history->sendRequestId;
+		});
+	}
+}
+
 void ApiWrap::sendBotStart(not_null<UserData*> bot, PeerData *chat) {
 	Expects(bot->isBot());
 	Expects(chat == nullptr || !bot->botInfo->startGroupToken.isEmpty());
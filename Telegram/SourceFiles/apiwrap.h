@@ -185,6 +185,7 @@ public:
 		Fn<void(const RPCError &)> fail);
 
 	void requestFullPeer(not_null<PeerData*> peer);
+	void invalidateFullPeer(not_null<PeerData*> peer);
 	void requestPeer(not_null<PeerData*> peer);
 	void requestPeers(const QList<PeerData*> &peers);
 	void requestPeerSettings(not_null<PeerData*> peer);
@@ -430,6 +431,7 @@ public:
 	void cancelLocalItem(not_null<HistoryItem*> item);
 
 	void sendMessage(MessageToSend &&message);
+	void replaySendOutbox();
 	void sendBotStart(not_null<UserData*> bot, PeerData *chat = nullptr);
 	void sendInlineResult(
 		not_null<UserData*> bot,
@@ -526,6 +528,9 @@ private:
 		ChannelData *channel,
 		mtpRequestId requestId);
 
+	void resolvePeerRequests();
+	void finalizePeerRequests(mtpRequestId requestId);
+
 	QVector<MTPInputMessage> collectMessageIds(const MessageDataRequests &requests);
 	MessageDataRequests *messageDataRequests(ChannelData *channel, bool onlyExisting = false);
 
@@ -660,6 +665,14 @@ private:
 		Data::FileOrigin origin,
 		FileReferencesHandler &&handler,
 		Request &&data);
+	void applyUpdatedFileReferences(const UpdatedFileReferences &update);
+	void finalizeFileReference(
+		const Data::FileOrigin &origin,
+		const UpdatedFileReferences &data);
+	void postponeMessageFileReference(
+		Data::FileOrigin origin,
+		FileReferencesHandler &&handler);
+	void resolveMessageFileReferences();
 
 	void photoUploadReady(const FullMsgId &msgId, const MTPInputFile &file);
 
@@ -684,8 +697,11 @@ private:
 
 	using PeerRequests = QMap<PeerData*, mtpRequestId>;
 	PeerRequests _fullPeerRequests;
+	base::flat_map<not_null<PeerData*>, crl::time> _fullPeerReceived;
 	PeerRequests _peerRequests;
+	SingleQueuedInvokation _peerRequestsResolveDelayed;
 	base::flat_set<not_null<PeerData*>> _requestedPeerSettings;
+	base::flat_map<not_null<PeerData*>, crl::time> _peerSettingsReceived;
 
 	PeerRequests _participantsRequests;
 	PeerRequests _botsRequests;
@@ -802,6 +818,8 @@ private:
 	std::map<
 		Data::FileOrigin,
 		std::vector<FileReferencesHandler>> _fileReferenceHandlers;
+	std::vector<Data::FileOrigin> _postponedMessageFileReferences;
+	SingleQueuedInvokation _fileReferencesResolveDelayed;
 
 	mtpRequestId _deepLinkInfoRequestId = 0;
 
@@ -71,10 +71,14 @@ struct CornersPixmaps {
 	QPixmap p[4];
 };
 QVector<CornersPixmaps> corners;
-using CornersMap = QMap<uint32, CornersPixmaps>;
+using CornersMap = QMap<uint64, CornersPixmaps>;
 CornersMap cornersMap;
 QImage cornersMaskLarge[4], cornersMaskSmall[4];
 
+// Guards against an older background regeneration finishing after
+// a newer one was scheduled by a subsequent palette change.
+int paletteCornersGeneration = 0;
+
 int32 serviceImageCacheSize = 0;
 
 } // namespace
@@ -107,11 +111,14 @@ namespace App {
 		return result;
 	}
 
-	void prepareCorners(RoundCorners index, int32 radius, const QBrush &brush, const style::color *shadow = nullptr, QImage *cors = nullptr) {
-		Expects(::corners.size() > index);
-
+	// Pure QImage rendering, safe to run on a background thread as long
+	// as the brushes were copied out of the palette on the main thread.
+	std::array<QImage, 4> renderCornersImages(
+			int32 radius,
+			const QBrush &brush,
+			std::optional<QBrush> shadow = std::nullopt) {
 		int32 r = radius * cIntRetinaFactor(), s = st::msgShadow * cIntRetinaFactor();
-		QImage rect(r * 3, r * 3 + (shadow ? s : 0), QImage::Format_ARGB32_Premultiplied), localCors[4];
+		QImage rect(r * 3, r * 3 + (shadow ? s : 0), QImage::Format_ARGB32_Premultiplied);
 		{
 			Painter p(&rect);
 			PainterHighQualityEnabler hq(p);
@@ -121,22 +128,42 @@ namespace App {
 			p.setCompositionMode(QPainter::CompositionMode_SourceOver);
 			p.setPen(Qt::NoPen);
 			if (shadow) {
-				p.setBrush((*shadow)->b);
+				p.setBrush(*shadow);
 				p.drawRoundedRect(0, s, r * 3, r * 3, r, r);
 			}
 			p.setBrush(brush);
 			p.drawRoundedRect(0, 0, r * 3, r * 3, r, r);
 		}
-		if (!cors) cors = localCors;
-		cors[0] = rect.copy(0, 0, r, r);
-		cors[1] = rect.copy(r * 2, 0, r, r);
-		cors[2] = rect.copy(0, r * 2, r, r + (shadow ? s : 0));
-		cors[3] = rect.copy(r * 2, r * 2, r, r + (shadow ? s : 0));
-		if (index != SmallMaskCorners && index != LargeMaskCorners) {
+		auto result = std::array<QImage, 4>();
+		result[0] = rect.copy(0, 0, r, r);
+		result[1] = rect.copy(r * 2, 0, r, r);
+		result[2] = rect.copy(0, r * 2, r, r + (shadow ? s : 0));
+		result[3] = rect.copy(r * 2, r * 2, r, r + (shadow ? s : 0));
+		return result;
+	}
+
+	void setCornersImages(RoundCorners index, std::array<QImage, 4> &&images) {
+		Expects(::corners.size() > index);
+
+		for (int i = 0; i < 4; ++i) {
+			::corners[index].p[i] = pixmapFromImageInPlace(std::move(images[i]));
+			::corners[index].p[i].setDevicePixelRatio(cRetinaFactor());
+		}
+	}
+
+	void prepareCorners(RoundCorners index, int32 radius, const QBrush &brush, const style::color *shadow = nullptr, QImage *cors = nullptr) {
+		Expects(::corners.size() > index);
+
+		auto images = renderCornersImages(
+			radius,
+			brush,
+			shadow ? std::make_optional((*shadow)->b) : std::nullopt);
+		if (cors) {
 			for (int i = 0; i < 4; ++i) {
-				::corners[index].p[i] = pixmapFromImageInPlace(std::move(cors[i]));
-				::corners[index].p[i].setDevicePixelRatio(cRetinaFactor());
+				cors[i] = std::move(images[i]);
 			}
+		} else if (index != SmallMaskCorners && index != LargeMaskCorners) {
+			setCornersImages(index, std::move(images));
 		}
 	}
 
@@ -154,38 +181,91 @@ namespace App {
 		}
 	}
 
+	struct CornersJob {
+		RoundCorners index = SmallMaskCorners;
+		int32 radius = 0;
+		QBrush brush;
+		std::optional<QBrush> shadow;
+	};
+
+	// Snapshots the current palette brushes on the main thread so the
+	// rendering itself may happen anywhere.
+	std::vector<CornersJob> paletteCornersJobs() {
+		auto result = std::vector<CornersJob>();
+		result.reserve(29);
+		const auto add = [&](RoundCorners index, int32 radius, const QBrush &brush, const style::color *shadow = nullptr) {
+			result.push_back({ index, radius, brush, shadow ? std::make_optional((*shadow)->b) : std::nullopt });
+		};
+		add(MenuCorners, st::buttonRadius, st::menuBg);
+		add(BoxCorners, st::boxRadius, st::boxBg);
+		add(BotKbOverCorners, st::dateRadius, st::msgBotKbOverBgAdd);
+		add(StickerCorners, st::dateRadius, st::msgServiceBg);
+		add(StickerSelectedCorners, st::dateRadius, st::msgServiceBgSelected);
+		add(SelectedOverlaySmallCorners, st::buttonRadius, st::msgSelectOverlay);
+		add(SelectedOverlayLargeCorners, st::historyMessageRadius, st::msgSelectOverlay);
+		add(DateCorners, st::dateRadius, st::msgDateImgBg);
+		add(DateSelectedCorners, st::dateRadius, st::msgDateImgBgSelected);
+		add(OverviewVideoCorners, st::overviewVideoStatusRadius, st::msgDateImgBg);
+		add(OverviewVideoSelectedCorners, st::overviewVideoStatusRadius, st::msgDateImgBgSelected);
+		add(InShadowCorners, st::historyMessageRadius, st::msgInShadow);
+		add(InSelectedShadowCorners, st::historyMessageRadius, st::msgInShadowSelected);
+		add(ForwardCorners, st::historyMessageRadius, st::historyForwardChooseBg);
+		add(MediaviewSaveCorners, st::mediaviewControllerRadius, st::mediaviewSaveMsgBg);
+		add(EmojiHoverCorners, st::buttonRadius, st::emojiPanHover);
+		add(StickerHoverCorners, st::buttonRadius, st::emojiPanHover);
+		add(BotKeyboardCorners, st::buttonRadius, st::botKbBg);
+		add(PhotoSelectOverlayCorners, st::buttonRadius, st::overviewPhotoSelectOverlay);
+
+		add(Doc1Corners, st::buttonRadius, st::msgFile1Bg);
+		add(Doc2Corners, st::buttonRadius, st::msgFile2Bg);
+		add(Doc3Corners, st::buttonRadius, st::msgFile3Bg);
+		add(Doc4Corners, st::buttonRadius, st::msgFile4Bg);
+
+		add(MessageInCorners, st::historyMessageRadius, st::msgInBg, &st::msgInShadow);
+		add(MessageInSelectedCorners, st::historyMessageRadius, st::msgInBgSelected, &st::msgInShadowSelected);
+		add(MessageOutCorners, st::historyMessageRadius, st::msgOutBg, &st::msgOutShadow);
+		add(MessageOutSelectedCorners, st::historyMessageRadius, st::msgOutBgSelected, &st::msgOutShadowSelected);
+
+		add(SendFilesBoxAlbumGroupCorners, st::sendBoxAlbumGroupRadius, st::callFingerprintBg);
+		return result;
+	}
+
 	void createPaletteCorners() {
-		prepareCorners(MenuCorners, st::buttonRadius, st::menuBg);
-		prepareCorners(BoxCorners, st::boxRadius, st::boxBg);
-		prepareCorners(BotKbOverCorners, st::dateRadius, st::msgBotKbOverBgAdd);
-		prepareCorners(StickerCorners, st::dateRadius, st::msgServiceBg);
-		prepareCorners(StickerSelectedCorners, st::dateRadius, st::msgServiceBgSelected);
-		prepareCorners(SelectedOverlaySmallCorners, st::buttonRadius, st::msgSelectOverlay);
-		prepareCorners(SelectedOverlayLargeCorners, st::historyMessageRadius, st::msgSelectOverlay);
-		prepareCorners(DateCorners, st::dateRadius, st::msgDateImgBg);
-		prepareCorners(DateSelectedCorners, st::dateRadius, st::msgDateImgBgSelected);
-		prepareCorners(OverviewVideoCorners, st::overviewVideoStatusRadius, st::msgDateImgBg);
-		prepareCorners(OverviewVideoSelectedCorners, st::overviewVideoStatusRadius, st::msgDateImgBgSelected);
-		prepareCorners(InShadowCorners, st::historyMessageRadius, st::msgInShadow);
-		prepareCorners(InSelectedShadowCorners, st::historyMessageRadius, st::msgInShadowSelected);
-		prepareCorners(ForwardCorners, st::historyMessageRadius, st::historyForwardChooseBg);
-		prepareCorners(MediaviewSaveCorners, st::mediaviewControllerRadius, st::mediaviewSaveMsgBg);
-		prepareCorners(EmojiHoverCorners, st::buttonRadius, st::emojiPanHover);
-		prepareCorners(StickerHoverCorners, st::buttonRadius, st::emojiPanHover);
-		prepareCorners(BotKeyboardCorners, st::buttonRadius, st::botKbBg);
-		prepareCorners(PhotoSelectOverlayCorners, st::buttonRadius, st::overviewPhotoSelectOverlay);
-
-		prepareCorners(Doc1Corners, st::buttonRadius, st::msgFile1Bg);
-		prepareCorners(Doc2Corners, st::buttonRadius, st::msgFile2Bg);
-		prepareCorners(Doc3Corners, st::buttonRadius, st::msgFile3Bg);
-		prepareCorners(Doc4Corners, st::buttonRadius, st::msgFile4Bg);
-
-		prepareCorners(MessageInCorners, st::historyMessageRadius, st::msgInBg, &st::msgInShadow);
-		prepareCorners(MessageInSelectedCorners, st::historyMessageRadius, st::msgInBgSelected, &st::msgInShadowSelected);
-		prepareCorners(MessageOutCorners, st::historyMessageRadius, st::msgOutBg, &st::msgOutShadow);
-		prepareCorners(MessageOutSelectedCorners, st::historyMessageRadius, st::msgOutBgSelected, &st::msgOutShadowSelected);
-
-		prepareCorners(SendFilesBoxAlbumGroupCorners, st::sendBoxAlbumGroupRadius, st::callFingerprintBg);
+		for (auto &job : paletteCornersJobs()) {
+			setCornersImages(job.index, renderCornersImages(
+				job.radius,
+				job.brush,
+				job.shadow));
+		}
+	}
+
+	// Renders the palette-dependent corner sprites on a background thread
+	// and swaps them in when ready, so a theme change does not block the
+	// window for the whole regeneration. Until the swap the previous
+	// sprites keep painting, which is preferable to a visible freeze.
+	void createPaletteCornersAsync(Fn<void()> swapped) {
+		const auto generation = ++::paletteCornersGeneration;
+		crl::async([=, jobs = paletteCornersJobs()]() mutable {
+			auto rendered = std::vector<std::array<QImage, 4>>();
+			rendered.reserve(jobs.size());
+			for (const auto &job : jobs) {
+				rendered.push_back(renderCornersImages(
+					job.radius,
+					job.brush,
+					job.shadow));
+			}
+			crl::on_main([=, jobs = std::move(jobs), rendered = std::move(rendered)]() mutable {
+				if (generation != ::paletteCornersGeneration) {
+					return;
+				}
+				for (auto i = 0, count = int(jobs.size()); i != count; ++i) {
+					setCornersImages(jobs[i].index, std::move(rendered[i]));
+				}
+				if (swapped) {
+					swapped();
+				}
+			});
+		});
 	}
 
 	void createCorners() {
@@ -205,12 +285,15 @@ namespace App {
 		using Update = Window::Theme::BackgroundUpdate;
 		static auto subscription = Window::Theme::Background()->add_subscription([](const Update &update) {
 			if (update.paletteChanged()) {
-				createPaletteCorners();
-
-				if (App::main()) {
-					App::main()->updateScrollColors();
-				}
-				HistoryView::serviceColorsUpdated();
+				createPaletteCornersAsync([] {
+					if (App::main()) {
+						App::main()->updateScrollColors();
+					}
+					HistoryView::serviceColorsUpdated();
+					if (const auto window = App::wnd()) {
+						window->update();
+					}
+				});
 			} else if (update.type == Update::Type::New) {
 				prepareCorners(StickerCorners, st::dateRadius, st::msgServiceBg);
 				prepareCorners(StickerSelectedCorners, st::dateRadius, st::msgServiceBgSelected);
@@ -507,7 +590,13 @@ namespace App {
 	}
 
 	void roundRect(Painter &p, int32 x, int32 y, int32 w, int32 h, style::color bg, ImageRoundRadius radius, RectParts parts) {
-		auto colorKey = ((uint32(bg->c.alpha()) & 0xFF) << 24) | ((uint32(bg->c.red()) & 0xFF) << 16) | ((uint32(bg->c.green()) & 0xFF) << 8) | ((uint32(bg->c.blue()) & 0xFF) << 24);
+		// The radius is a part of the key, so that Small and Large
+		// corners of the same color don't collide in the cache.
+		auto colorKey = (uint64(radius) << 32)
+			| ((uint64(bg->c.alpha()) & 0xFF) << 24)
+			| ((uint64(bg->c.red()) & 0xFF) << 16)
+			| ((uint64(bg->c.green()) & 0xFF) << 8)
+			| (uint64(bg->c.blue()) & 0xFF);
 		auto i = cornersMap.find(colorKey);
 		if (i == cornersMap.cend()) {
 			QImage images[4];
@@ -30,6 +30,21 @@ namespace {
 
 constexpr auto kBackgroundsInRow = 3;
 
+// Decoded grid cells kept between box openings, it is cleared
+// when it grows past this count to bound the memory usage.
+constexpr auto kThumbnailsCacheLimit = 64;
+
+struct CachedThumbnail {
+	QImage image;
+	std::optional<QColor> backgroundColor;
+	int patternIntensity = 0;
+};
+
+base::flat_map<Data::WallPaperId, CachedThumbnail> &ThumbnailsCache() {
+	static auto result = base::flat_map<Data::WallPaperId, CachedThumbnail>();
+	return result;
+}
+
 QImage TakeMiddleSample(QImage original, QSize size) {
 	size *= cIntRetinaFactor();
 	const auto from = original.size();
@@ -53,6 +68,18 @@ QImage TakeMiddleSample(QImage original, QSize size) {
 	return result;
 }
 
+QImage PrepareThumbnail(QImage original, const Data::WallPaper &paper) {
+	if (paper.isPattern()) {
+		const auto color = *paper.backgroundColor();
+		original = Data::PreparePatternImage(
+			std::move(original),
+			color,
+			Data::PatternColor(color),
+			paper.patternIntensity());
+	}
+	return TakeMiddleSample(std::move(original), st::backgroundSize);
+}
+
 } // namespace
 
 class BackgroundBox::Inner final
@@ -83,6 +110,7 @@ private:
 		Data::WallPaper data;
 		mutable std::shared_ptr<Data::DocumentMedia> dataMedia;
 		mutable QPixmap thumbnail;
+		mutable bool preparing = false;
 	};
 	struct Selected {
 		int index = 0;
@@ -114,8 +142,9 @@ private:
 		Painter &p,
 		const Paper &paper,
 		int column,
-		int row) const;
-	void validatePaperThumbnail(const Paper &paper) const;
+		int row);
+	void validatePaperThumbnail(const Paper &paper);
+	void thumbnailPrepared(Data::WallPaperId id);
 
 	const not_null<Main::Session*> _session;
 	MTP::Sender _api;
@@ -305,11 +334,22 @@ void BackgroundBox::Inner::paintEvent(QPaintEvent *e) {
 	}
 }
 
-void BackgroundBox::Inner::validatePaperThumbnail(
-		const Paper &paper) const {
+void BackgroundBox::Inner::validatePaperThumbnail(const Paper &paper) {
 	if (!paper.thumbnail.isNull()) {
 		return;
 	}
+	const auto i = ThumbnailsCache().find(paper.data.id());
+	if (i != end(ThumbnailsCache())
+		&& i->second.backgroundColor == paper.data.backgroundColor()
+		&& i->second.patternIntensity == paper.data.patternIntensity()) {
+		paper.thumbnail = App::pixmapFromImageInPlace(
+			base::duplicate(i->second.image));
+		paper.thumbnail.setDevicePixelRatio(cRetinaFactor());
+		return;
+	}
+	if (paper.preparing) {
+		return;
+	}
 	const auto localThumbnail = paper.data.localThumbnail();
 	if (!localThumbnail) {
 		if (const auto document = paper.data.document()) {
@@ -325,26 +365,44 @@ void BackgroundBox::Inner::validatePaperThumbnail(
 	const auto thumbnail = localThumbnail
 		? localThumbnail
 		: paper.dataMedia->thumbnail();
-	auto original = thumbnail->original();
-	if (paper.data.isPattern()) {
-		const auto color = *paper.data.backgroundColor();
-		original = Data::PreparePatternImage(
-			std::move(original),
-			color,
-			Data::PatternColor(color),
-			paper.data.patternIntensity());
+	paper.preparing = true;
+	crl::async([
+		weak = Ui::MakeWeak(this),
+		original = thumbnail->original(),
+		data = paper.data
+	]() mutable {
+		auto image = PrepareThumbnail(std::move(original), data);
+		crl::on_main([weak, data, image = std::move(image)]() mutable {
+			auto &cache = ThumbnailsCache();
+			if (cache.size() >= kThumbnailsCacheLimit) {
+				cache.clear();
+			}
+			cache[data.id()] = CachedThumbnail{
+				std::move(image),
+				data.backgroundColor(),
+				data.patternIntensity() };
+			if (const auto strong = weak.data()) {
+				strong->thumbnailPrepared(data.id());
+			}
+		});
+	});
+}
+
+void BackgroundBox::Inner::thumbnailPrepared(Data::WallPaperId id) {
+	for (auto i = 0, count = int(_papers.size()); i != count; ++i) {
+		if (_papers[i].data.id() == id) {
+			_papers[i].preparing = false;
+			repaintPaper(i);
+			break;
+		}
 	}
-	paper.thumbnail = App::pixmapFromImageInPlace(TakeMiddleSample(
-		original,
-		st::backgroundSize));
-	paper.thumbnail.setDevicePixelRatio(cRetinaFactor());
 }
 
 void BackgroundBox::Inner::paintPaper(
 		Painter &p,
 		const Paper &paper,
 		int column,
-		int row) const {
+		int row) {
 	const auto x = st::backgroundPadding + column * (st::backgroundSize.width() + st::backgroundPadding);
 	const auto y = st::backgroundPadding + row * (st::backgroundSize.height() + st::backgroundPadding);
 	validatePaperThumbnail(paper);
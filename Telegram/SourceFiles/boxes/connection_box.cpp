@@ -39,6 +39,9 @@ namespace {
 
 constexpr auto kSaveSettingsDelayedTimeout = crl::time(1000);
 
+// While the box is open re-check the latency of all proxies this often.
+constexpr auto kReprobeEach = 60 * crl::time(1000);
+
 using ProxyData = MTP::ProxyData;
 
 class Base64UrlInput : public Ui::MaskedInputField {
@@ -159,6 +162,7 @@ private:
 
 	not_null<ProxiesBoxController*> _controller;
 	QPointer<Ui::Checkbox> _tryIPv6;
+	QPointer<Ui::Checkbox> _autoSelect;
 	std::shared_ptr<Ui::RadioenumGroup<ProxyData::Settings>> _proxySettings;
 	QPointer<Ui::SlideWrap<Ui::Checkbox>> _proxyForCalls;
 	QPointer<Ui::DividerLabel> _about;
@@ -548,6 +552,12 @@ void ProxiesBox::setupContent() {
 			tr::lng_connection_try_ipv6(tr::now),
 			Global::TryIPv6()),
 		st::proxyTryIPv6Padding);
+	_autoSelect = inner->add(
+		object_ptr<Ui::Checkbox>(
+			inner,
+			tr::lng_proxy_auto_select(tr::now),
+			Global::ProxyAutoSelect()),
+		st::proxyTryIPv6Padding);
 	_proxySettings
 		= std::make_shared<Ui::RadioenumGroup<ProxyData::Settings>>(
 			Global::ProxySettings());
@@ -616,6 +626,10 @@ void ProxiesBox::setupContent() {
 	) | rpl::start_with_next([=](bool checked) {
 		_controller->setTryIPv6(checked);
 	}, _tryIPv6->lifetime());
+	_autoSelect->checkedChanges(
+	) | rpl::start_with_next([=](bool checked) {
+		_controller->setAutoSelect(checked);
+	}, _autoSelect->lifetime());
 
 	_controller->proxySettingsValue(
 	) | rpl::start_with_next([=](ProxyData::Settings value) {
@@ -979,7 +993,8 @@ void ProxyBox::addLabel(
 } // namespace
 
 ProxiesBoxController::ProxiesBoxController()
-: _saveTimer([] { Local::writeSettings(); }) {
+: _saveTimer([] { Local::writeSettings(); })
+, _reprobeTimer([=] { reprobeCheckers(); }) {
 	_list = ranges::view::all(
 		Global::ProxiesList()
 	) | ranges::view::transform([&](const ProxyData &proxy) {
@@ -997,6 +1012,7 @@ ProxiesBoxController::ProxiesBoxController()
 	for (auto &item : _list) {
 		refreshChecker(item);
 	}
+	_reprobeTimer.callEach(kReprobeEach);
 }
 
 void ProxiesBoxController::ShowApplyConfirmation(
@@ -1122,6 +1138,7 @@ void ProxiesBoxController::setupChecker(int id, const Checker &checker) {
 			item->state = ItemState::Available;
 			item->ping = pingTime;
 			updateView(*item);
+			checkAutoSelect();
 		}
 	});
 	const auto failed = [=] {
@@ -1142,6 +1159,37 @@ void ProxiesBoxController::setupChecker(int id, const Checker &checker) {
 	pointer->connect(pointer, &Connection::error, failed);
 }
 
+void ProxiesBoxController::reprobeCheckers() {
+	for (auto &item : _list) {
+		if (!item.deleted && !item.checker && !item.checkerv6) {
+			refreshChecker(item);
+			updateView(item);
+		}
+	}
+}
+
+void ProxiesBoxController::checkAutoSelect() {
+	if (!Global::ProxyAutoSelect()
+		|| (Global::ProxySettings() != ProxyData::Settings::Enabled)) {
+		return;
+	}
+	auto best = end(_list);
+	for (auto i = begin(_list); i != end(_list); ++i) {
+		if (i->deleted) {
+			continue;
+		} else if (i->state == ItemState::Checking) {
+			// Decide only when the whole probe round has finished.
+			return;
+		} else if (i->state == ItemState::Available
+			&& (best == end(_list) || i->ping < best->ping)) {
+			best = i;
+		}
+	}
+	if (best != end(_list)) {
+		applyItem(best->id);
+	}
+}
+
 object_ptr<Ui::BoxContent> ProxiesBoxController::CreateOwningBox() {
 	auto controller = std::make_unique<ProxiesBoxController>();
 	auto box = controller->create();
@@ -1377,6 +1425,15 @@ void ProxiesBoxController::setTryIPv6(bool enabled) {
 	saveDelayed();
 }
 
+void ProxiesBoxController::setAutoSelect(bool enabled) {
+	if (Global::ProxyAutoSelect() == enabled) {
+		return;
+	}
+	Global::SetProxyAutoSelect(enabled);
+	saveDelayed();
+	checkAutoSelect();
+}
+
 void ProxiesBoxController::saveDelayed() {
 	_saveTimer.callOnce(kSaveSettingsDelayedTimeout);
 }
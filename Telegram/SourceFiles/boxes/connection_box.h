@@ -68,6 +68,7 @@ public:
 	bool setProxySettings(ProxyData::Settings value);
 	void setProxyForCalls(bool enabled);
 	void setTryIPv6(bool enabled);
+	void setAutoSelect(bool enabled);
 	rpl::producer<ProxyData::Settings> proxySettingsValue() const;
 
 	rpl::producer<ItemView> views() const;
@@ -95,6 +96,8 @@ private:
 	void saveDelayed();
 	void refreshChecker(Item &item);
 	void setupChecker(int id, const Checker &checker);
+	void reprobeCheckers();
+	void checkAutoSelect();
 
 	void replaceItemWith(
 		std::vector<Item>::iterator which,
@@ -108,6 +111,7 @@ private:
 	std::vector<Item> _list;
 	rpl::event_stream<ItemView> _views;
 	base::Timer _saveTimer;
+	base::Timer _reprobeTimer;
 	rpl::event_stream<ProxyData::Settings> _proxySettingsChanges;
 
 	ProxyData _lastSelectedProxy;
@@ -109,6 +109,7 @@ private:
 		void createWarning();
 		void toggleCorrectSpace(bool visible);
 		void updateFieldGeometry();
+		void refreshValidity();
 
 		base::unique_qptr<Ui::SlideWrap<Ui::RpWidget>> _wrap;
 		not_null<Ui::RpWidget*> _content;
@@ -119,6 +120,8 @@ private:
 		base::unique_qptr<Ui::PlainShadow> _shadow;
 		base::unique_qptr<Ui::CrossButton> _remove;
 		rpl::variable<bool> *_removeAlways = nullptr;
+		bool _empty = true;
+		bool _tooLong = false;
 
 	};
 
@@ -147,6 +150,7 @@ private:
 	bool _hasOptions = false;
 	bool _isValid = false;
 	bool _hasCorrect = false;
+	bool _validationScheduled = false;
 	rpl::event_stream<not_null<QWidget*>> _scrollToWidget;
 	rpl::event_stream<> _backspaceInFront;
 	rpl::event_stream<> _tabbed;
@@ -236,6 +240,7 @@ Options::Option::Option(
 	}, _field->lifetime());
 
 	QObject::connect(_field, &Ui::InputField::changed, [=] {
+		refreshValidity();
 		Ui::PostponeCall(crl::guard(_field, [=] {
 			if (_hasCorrect) {
 				_correct->toggle(isGood(), anim::type::normal);
@@ -342,16 +347,24 @@ void Options::Option::createWarning() {
 	}, warning->lifetime());
 }
 
+void Options::Option::refreshValidity() {
+	// Cached on each change of this field only, so that the aggregate
+	// validation doesn't reparse the text of every answer field.
+	const auto text = field()->getLastText();
+	_empty = text.trimmed().isEmpty();
+	_tooLong = (text.size() > kOptionLimit);
+}
+
 bool Options::Option::isEmpty() const {
-	return field()->getLastText().trimmed().isEmpty();
+	return _empty;
 }
 
 bool Options::Option::isGood() const {
-	return !field()->getLastText().trimmed().isEmpty() && !isTooLong();
+	return !_empty && !_tooLong;
 }
 
 bool Options::Option::isTooLong() const {
-	return (field()->getLastText().size() > kOptionLimit);
+	return _tooLong;
 }
 
 bool Options::Option::isCorrect() const {
@@ -649,6 +662,11 @@ void Options::addEmptyOption() {
 		}
 	});
 	QObject::connect(field, &Ui::InputField::changed, [=] {
+		if (_validationScheduled) {
+			return;
+		}
+		// Coalesce to one deferred validation per event loop cycle.
+		_validationScheduled = true;
 		Ui::PostponeCall(crl::guard(field, [=] {
 			validateState();
 		}));
@@ -719,6 +737,7 @@ void Options::removeDestroyed(not_null<Option*> option) {
 }
 
 void Options::validateState() {
+	_validationScheduled = false;
 	checkLastOption();
 	_hasOptions = (ranges::count_if(_list, &Option::isGood) > 1);
 	_isValid = _hasOptions
@@ -0,0 +1,117 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "boxes/debug_console_box.h"
+
+#include "core/alloc_stats.h"
+#include "core/dispatch_tracer.h"
+#include "core/layout_benchmark.h"
+#include "core/memory_stats.h"
+#include "core/trace_events.h"
+#include "mtproto/network_health.h"
+#include "storage/cache_statistics.h"
+#include "history/history_inner_widget.h"
+#include "data/data_session.h"
+#include "main/main_session.h"
+#include "window/window_session_controller.h"
+#include "ui/widgets/input_fields.h"
+#include "ui/widgets/labels.h"
+#include "ui/wrap/vertical_layout.h"
+#include "lang/lang_keys.h"
+#include "styles/style_layers.h"
+#include "styles/style_boxes.h"
+
+namespace {
+
+[[nodiscard]] QString HelpText() {
+	return qsl("Commands:\n"
+		"layout - run the text layout benchmark\n"
+		"mem - dump the memory accounting\n"
+		"net - dump per-DC latency and traffic stats\n"
+		"cache - dump media cache hit rates\n"
+		"alloc - dump tagged allocation counters\n"
+		"dispatch - dump recent main queue tasks\n"
+		"trim - unload heavy media from view caches\n"
+		"trace start / trace stop - capture a task trace");
+}
+
+} // namespace
+
+DebugConsoleBox::DebugConsoleBox(
+	QWidget*,
+	not_null<Window::SessionController*> controller)
+: _controller(controller) {
+}
+
+void DebugConsoleBox::prepare() {
+	setTitle(rpl::single(qsl("Debug console")));
+
+	addButton(rpl::single(qsl("Run")), [=] { run(); });
+	addButton(tr::lng_close(), [=] { closeBox(); });
+
+	const auto inner = setInnerWidget(object_ptr<Ui::VerticalLayout>(this));
+	_command = inner->add(
+		object_ptr<Ui::InputField>(
+			inner,
+			st::defaultInputField,
+			rpl::single(qsl("Command, 'help' for the list"))),
+		st::boxPadding);
+	_output = inner->add(
+		object_ptr<Ui::FlatLabel>(inner, HelpText(), st::boxLabel),
+		st::boxPadding);
+	_output->setSelectable(true);
+
+	connect(_command, &Ui::InputField::submitted, [=] { run(); });
+	connect(_command, &Ui::InputField::cancelled, [=] { closeBox(); });
+
+	setDimensionsToContent(st::boxWideWidth, inner);
+}
+
+void DebugConsoleBox::setInnerFocus() {
+	_command->setFocusFast();
+}
+
+void DebugConsoleBox::run() {
+	const auto command = _command->getLastText().trimmed().toLower();
+	if (command.isEmpty()) {
+		return;
+	}
+	const auto result = runCommand(command);
+	_output->setText(result);
+	LOG(("Console '%1':\n%2").arg(command).arg(result));
+}
+
+QString DebugConsoleBox::runCommand(const QString &command) {
+	if (command == qsl("layout")) {
+		return Core::LayoutBenchmark::Run();
+	} else if (command == qsl("mem")) {
+		return Core::MemoryStats::ReportString();
+	} else if (command == qsl("net")) {
+		return MTP::NetworkHealth::ReportString();
+	} else if (command == qsl("cache")) {
+		return Storage::CacheStats::ReportString();
+	} else if (command == qsl("alloc")) {
+		return Core::AllocStats::ReportString();
+	} else if (command == qsl("dispatch")) {
+		return Core::DispatchTracer::ReportString();
+	} else if (command == qsl("trim")) {
+		const auto before = Core::MemoryStats::AccountedTotalBytes();
+		_controller->session().data().unloadHeavyViewParts(
+			HistoryInner::ElementDelegate());
+		const auto after = Core::MemoryStats::AccountedTotalBytes();
+		return qsl("Heavy view parts unloaded.\n"
+			"Accounted: %1 KB -> %2 KB."
+		).arg(before / 1024
+		).arg(after / 1024);
+	} else if (command == qsl("trace start")) {
+		Core::TraceEvents::Start();
+		return qsl("Trace capture started.");
+	} else if (command == qsl("trace stop")) {
+		return Core::TraceEvents::Finish();
+	}
+	return HelpText();
+}
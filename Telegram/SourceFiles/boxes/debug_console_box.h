@@ -0,0 +1,43 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include "boxes/abstract_box.h"
+
+namespace Ui {
+class InputField;
+class FlatLabel;
+} // namespace Ui
+
+namespace Window {
+class SessionController;
+} // namespace Window
+
+// A hidden console behind the "console" settings code. Runs the
+// diagnostics that are also reachable through separate codes and keeps
+// the results selectable for copying, each result goes to the log too.
+class DebugConsoleBox : public Ui::BoxContent {
+public:
+	DebugConsoleBox(
+		QWidget*,
+		not_null<Window::SessionController*> controller);
+
+protected:
+	void prepare() override;
+	void setInnerFocus() override;
+
+private:
+	void run();
+	[[nodiscard]] QString runCommand(const QString &command);
+
+	const not_null<Window::SessionController*> _controller;
+
+	Ui::InputField *_command = nullptr;
+	Ui::FlatLabel *_output = nullptr;
+
+};
@@ -14,6 +14,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "ui/widgets/shadow.h"
 #include "ui/widgets/continuous_sliders.h"
 #include "ui/effects/radial_animation.h"
+#include "ui/toast/toast.h"
 #include "ui/emoji_config.h"
 #include "storage/localstorage.h"
 #include "storage/cache/storage_cache_database.h"
@@ -130,6 +131,7 @@ public:
 
 	void update(const Database::TaggedSummary &data);
 	void toggleProgress(bool shown);
+	void setProgressText(const QString &text);
 
 	rpl::producer<> clearRequests() const;
 
@@ -199,6 +201,14 @@ void LocalStorageBox::Row::toggleProgress(bool shown) {
 	}
 }
 
+void LocalStorageBox::Row::setProgressText(const QString &text) {
+	if (!_clearing) {
+		return;
+	}
+	_clearing->setText(text);
+	resizeToWidth(width());
+}
+
 void LocalStorageBox::Row::radialAnimationCallback() {
 	if (!anim::Disabled()) {
 		RpWidget::update();
@@ -319,9 +329,36 @@ void LocalStorageBox::update(
 		Database::Stats &&statsBig) {
 	_stats = std::move(stats);
 	_statsBig = std::move(statsBig);
+	const auto clearing = _stats.clearing || _statsBig.clearing;
 	if (const auto i = _rows.find(0); i != end(_rows)) {
-		i->second->entity()->toggleProgress(
-			_stats.clearing || _statsBig.clearing);
+		i->second->entity()->toggleProgress(clearing);
+	}
+	if (_clearingTracked) {
+		const auto freed = std::max(
+			_clearingSizeBefore - summary().totalSize,
+			int64(0));
+		if (clearing) {
+			const auto elapsed = std::max(
+				crl::now() - _clearingStarted,
+				crl::time(1));
+			if (const auto i = _rows.find(0); i != end(_rows)) {
+				i->second->entity()->setProgressText(
+					tr::lng_local_storage_clearing_progress(
+						tr::now,
+						lt_size,
+						formatSizeText(freed),
+						lt_speed,
+						formatSizeText(freed * 1000 / elapsed)));
+			}
+		} else {
+			_clearingTracked = false;
+			if (freed > 0) {
+				Ui::Toast::Show(tr::lng_local_storage_cleared(
+					tr::now,
+					lt_size,
+					formatSizeText(freed)));
+			}
+		}
 	}
 	for (const auto &entry : _rows) {
 		if (entry.first == kFakeMediaCacheTag) {
@@ -346,6 +383,12 @@ auto LocalStorageBox::summary() const -> Database::TaggedSummary {
 }
 
 void LocalStorageBox::clearByTag(uint16 tag) {
+	// The deletions run in batches on the cache database thread, track
+	// the starting point here to display progress and completion stats.
+	_clearingTracked = true;
+	_clearingStarted = crl::now();
+	_clearingSizeBefore = summary().totalSize;
+
 	if (tag == kFakeMediaCacheTag) {
 		_dbBig->clear();
 	} else if (tag) {
@@ -101,4 +101,8 @@ private:
 	size_type _timeLimit = 0;
 	bool _limitsChanged = false;
 
+	bool _clearingTracked = false;
+	crl::time _clearingStarted = 0;
+	int64 _clearingSizeBefore = 0;
+
 };
@@ -437,7 +437,7 @@ void PasscodeBox::handleSrpIdInvalid() {
 }
 
 void PasscodeBox::save(bool force) {
-	if (_setRequest) return;
+	if (_setRequest || _derivingKey) return;
 
 	QString old = _oldPasscode->text(), pwd = _newPasscode->text(), conf = _reenterPasscode->text();
 	const auto has = currentlyHave();
@@ -450,16 +450,34 @@ void PasscodeBox::save(bool force) {
 			return;
 		}
 
-		if (Local::checkPasscode(old.toUtf8())) {
+		setDerivationInProgress(true);
+		Local::checkPasscodeAsync(old.toUtf8(), crl::guard(this, [=](
+				bool correct) {
+			setDerivationInProgress(false);
+			if (!correct) {
+				cSetPasscodeBadTries(cPasscodeBadTries() + 1);
+				cSetPasscodeLastTry(crl::now());
+				badOldPasscode();
+				return;
+			}
 			cSetPasscodeBadTries(0);
-			if (_turningOff) pwd = conf = QString();
-		} else {
-			cSetPasscodeBadTries(cPasscodeBadTries() + 1);
-			cSetPasscodeLastTry(crl::now());
-			badOldPasscode();
-			return;
-		}
+			finishSave(
+				force,
+				old,
+				_turningOff ? QString() : pwd,
+				_turningOff ? QString() : conf);
+		}));
+		return;
 	}
+	finishSave(force, old, pwd, conf);
+}
+
+void PasscodeBox::finishSave(
+		bool force,
+		const QString &old,
+		const QString &pwd,
+		const QString &conf) {
+	const auto has = currentlyHave();
 	const auto onlyCheck = onlyCheckCurrent();
 	if (!onlyCheck && pwd.isEmpty()) {
 		_newPasscode->setFocus();
@@ -516,16 +534,29 @@ void PasscodeBox::save(bool force) {
 		}
 	} else {
 		closeReplacedBy();
-		const auto weak = Ui::MakeWeak(this);
 		cSetPasscodeBadTries(0);
-		Local::setPasscode(pwd.toUtf8());
-		_session->localPasscodeChanged();
-		if (weak) {
+		setDerivationInProgress(true);
+		Local::setPasscodeAsync(pwd.toUtf8(), crl::guard(this, [=] {
+			setDerivationInProgress(false);
+			_session->localPasscodeChanged();
 			closeBox();
-		}
+		}));
 	}
 }
 
+void PasscodeBox::setDerivationInProgress(bool in) {
+	if (_derivingKey == in) {
+		return;
+	}
+	_derivingKey = in;
+
+	// Grey out the fields while the key derivation worker runs.
+	_oldPasscode->setDisabled(in);
+	_newPasscode->setDisabled(in);
+	_reenterPasscode->setDisabled(in);
+	update();
+}
+
 void PasscodeBox::submitOnlyCheckCloudPassword(const QString &oldPassword) {
 	Expects(!_oldPasscode->isHidden());
 
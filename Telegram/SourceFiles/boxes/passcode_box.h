@@ -74,6 +74,12 @@ private:
 	void newChanged();
 	void emailChanged();
 	void save(bool force = false);
+	void finishSave(
+		bool force,
+		const QString &old,
+		const QString &pwd,
+		const QString &conf);
+	void setDerivationInProgress(bool in);
 	void badOldPasscode();
 	void recoverByEmail();
 	void recoverExpired();
@@ -139,6 +145,7 @@ private:
 	bool _cloudPwd = false;
 	CloudFields _cloudFields;
 	mtpRequestId _setRequest = 0;
+	bool _derivingKey = false;
 
 	crl::time _lastSrpIdInvalidTime = 0;
 	bool _skipEmailWarning = false;
@@ -33,6 +33,16 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 #include <rpl/range.h>
 
+namespace {
+
+// The heavy row state (rendered texts, userpic view) is dropped for
+// the oldest initialized rows when their count grows past this limit,
+// so a list of hundreds of thousands members keeps only the rows near
+// the screen resident.
+constexpr auto kInitializedRowsLimit = 1024;
+
+} // namespace
+
 PaintRoundImageCallback PaintUserpicCallback(
 		not_null<PeerData*> peer,
 		bool respectSavedMessagesChat) {
@@ -639,6 +649,17 @@ void PeerListRow::lazyInitialize(const style::PeerListItem &st) {
 	refreshStatus();
 }
 
+void PeerListRow::deinitialize() {
+	if (!_initialized) {
+		return;
+	}
+	_initialized = false;
+	_name = Ui::Text::String();
+	_status = Ui::Text::String();
+	_ripple = nullptr;
+	_userpic = nullptr;
+}
+
 void PeerListRow::createCheckbox(
 		const style::RoundImageCheckbox &st,
 		Fn<void()> updateCallback) {
@@ -858,6 +879,9 @@ void PeerListContent::removeRow(not_null<PeerListRow*> row) {
 	_filterResults.erase(
 		ranges::remove(_filterResults, row),
 		end(_filterResults));
+	_initializedRows.erase(
+		ranges::remove(_initializedRows, row),
+		end(_initializedRows));
 	removeRowAtIndex(eraseFrom, index);
 
 	restoreSelection();
@@ -874,6 +898,7 @@ void PeerListContent::clearAllContent() {
 	_rowsById.clear();
 	_rowsByPeer.clear();
 	_filterResults.clear();
+	_initializedRows.clear();
 	_searchIndex.clear();
 	_rows.clear();
 	_searchRows.clear();
@@ -1203,7 +1228,10 @@ crl::time PeerListContent::paintRow(
 	const auto row = getRow(index);
 	Assert(row != nullptr);
 
-	row->lazyInitialize(_st.item);
+	if (!row->isInitialized()) {
+		row->lazyInitialize(_st.item);
+		registerInitializedRow(row);
+	}
 
 	auto refreshStatusAt = row->refreshStatusTime();
 	if (refreshStatusAt >= 0 && ms >= refreshStatusAt) {
@@ -1406,6 +1434,24 @@ void PeerListContent::loadProfilePhotos() {
 	}
 }
 
+void PeerListContent::registerInitializedRow(not_null<PeerListRow*> row) {
+	_initializedRows.push_back(row);
+	if (_initializedRows.size() <= kInitializedRowsLimit) {
+		return;
+	}
+
+	// Drop the heavy state of the oldest half, the rows that are
+	// still on the screen just initialize themselves again on the
+	// next paint.
+	const auto half = _initializedRows.size() / 2;
+	for (auto i = _initializedRows.begin(), e = i + half; i != e; ++i) {
+		(*i)->deinitialize();
+	}
+	_initializedRows.erase(
+		_initializedRows.begin(),
+		_initializedRows.begin() + half);
+}
+
 void PeerListContent::checkScrollForPreload() {
 	if (_visibleBottom + PreloadHeightsCount * (_visibleBottom - _visibleTop) >= height()) {
 		_controller->loadMoreRows();
@@ -1416,10 +1462,27 @@ void PeerListContent::searchQueryChanged(QString query) {
 	const auto searchWordsList = TextUtilities::PrepareSearchWords(query);
 	const auto normalizedQuery = searchWordsList.join(' ');
 	if (_normalizedSearchQuery != normalizedQuery) {
+		// Typing on only narrows the result set down, so the previous
+		// results are refined instead of rescanning the index bucket.
+		// The search result rows are taken out - they're destroyed
+		// when the query changes.
+		const auto refining = !_normalizedSearchQuery.isEmpty()
+			&& normalizedQuery.startsWith(_normalizedSearchQuery);
+		auto refineFrom = std::vector<not_null<PeerListRow*>>();
+		if (refining) {
+			refineFrom.reserve(_filterResults.size());
+			for (const auto row : _filterResults) {
+				if (!row->isSearchResult()) {
+					refineFrom.push_back(row);
+				}
+			}
+		}
 		setSearchQuery(query, normalizedQuery);
 		if (_controller->searchInLocal() && !searchWordsList.isEmpty()) {
 			auto minimalList = (const std::vector<not_null<PeerListRow*>>*)nullptr;
-			for (const auto &searchWord : searchWordsList) {
+			if (refining) {
+				minimalList = &refineFrom;
+			} else for (const auto &searchWord : searchWordsList) {
 				auto searchWordStart = searchWord[0].toLower();
 				auto it = _searchIndex.find(searchWordStart);
 				if (it == _searchIndex.cend()) {
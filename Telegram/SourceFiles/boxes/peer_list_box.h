@@ -193,7 +193,15 @@ public:
 		return _nameFirstLetters;
 	}
 
+	bool isInitialized() const {
+		return _initialized;
+	}
 	virtual void lazyInitialize(const style::PeerListItem &st);
+
+	// Frees the rendered texts and the userpic view, the row
+	// initializes itself again when it gets back on the screen.
+	void deinitialize();
+
 	virtual void paintStatusText(
 		Painter &p,
 		const style::PeerListItem &st,
@@ -204,10 +212,6 @@ public:
 		bool selected);
 
 protected:
-	bool isInitialized() const {
-		return _initialized;
-	}
-
 	explicit PeerListRow(PeerListRowId id);
 
 private:
@@ -552,6 +556,7 @@ private:
 	void refreshIndices();
 	void removeRowAtIndex(std::vector<std::unique_ptr<PeerListRow>> &from, int index);
 	void handleNameChanged(const Notify::PeerUpdate &update);
+	void registerInitializedRow(not_null<PeerListRow*> row);
 
 	void invalidatePixmapsCache();
 
@@ -663,6 +668,7 @@ private:
 	QString _normalizedSearchQuery;
 	QString _mentionHighlight;
 	std::vector<not_null<PeerListRow*>> _filterResults;
+	std::vector<not_null<PeerListRow*>> _initializedRows;
 
 	int _aboveHeight = 0;
 	int _belowHeight = 0;
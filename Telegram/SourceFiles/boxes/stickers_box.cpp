@@ -329,6 +329,11 @@ void StickersBox::prepare() {
 		connect(_installed.widget(), &Inner::draggingScrollDelta, [=](int delta) {
 			scrollByDraggingDelta(delta);
 		});
+		connect(_installed.widget(), &Inner::draggingDone, [=] {
+			if (base::take(_updateAfterDrag)) {
+				handleStickersUpdated();
+			}
+		});
 		if (!_megagroupSet) {
 			boxClosing() | rpl::start_with_next([=] {
 				saveChanges();
@@ -591,6 +596,12 @@ void StickersBox::resizeEvent(QResizeEvent *e) {
 }
 
 void StickersBox::handleStickersUpdated() {
+	if (_installed.widget() && _installed.widget()->isDragging()) {
+		// Rebuilding the list would reset the row being dragged,
+		// reapply the update after the reordering is finished.
+		_updateAfterDrag = true;
+		return;
+	}
 	if (_section == Section::Installed || _section == Section::Featured) {
 		rebuildList();
 	} else {
@@ -1305,6 +1316,7 @@ void StickersBox::Inner::mouseReleaseEvent(QMouseEvent *e) {
 		}
 
 		_dragging = _started = -1;
+		emit draggingDone();
 	} else if (pressed == _selected && _actionSel < 0 && _actionDown < 0) {
 		const auto selectedIndex = [&] {
 			if (auto index = base::get_if<int>(&_selected)) {
@@ -1901,6 +1913,7 @@ void StickersBox::Inner::visibleTopBottomUpdated(
 	_visibleTop = visibleTop;
 	_visibleBottom = visibleBottom;
 	updateScrollbarWidth();
+	loadThumbnails();
 	if (_section == Section::Featured) {
 		readVisibleSets();
 	}
@@ -1917,6 +1930,33 @@ void StickersBox::Inner::checkLoadMore() {
 	}
 }
 
+void StickersBox::Inner::loadThumbnails() {
+	if (_visibleTop >= _visibleBottom) {
+		return;
+	}
+	// Request thumbnails a screen above and below the visible area,
+	// so that scrolling doesn't have to wait for the network.
+	const auto margin = (_visibleBottom - _visibleTop);
+	auto yFrom = _visibleTop - _itemsTop - margin;
+	auto yTo = _visibleBottom - _itemsTop + margin;
+	int rowFrom = floorclamp(yFrom, _rowHeight, 0, _rows.size());
+	int rowTo = ceilclamp(yTo, _rowHeight, 0, _rows.size());
+	for (int i = rowFrom; i < rowTo; ++i) {
+		const auto row = _rows[i].get();
+		if (row->set->hasThumbnail()) {
+			if (!row->thumbnailMedia) {
+				row->thumbnailMedia = row->set->createThumbnailView();
+				row->set->loadThumbnail();
+			}
+		} else if (row->sticker && !row->stickerMedia) {
+			row->stickerMedia = row->sticker->createMediaView();
+			row->stickerMedia->thumbnailWanted(Data::FileOriginStickerSet(
+				row->set->id,
+				row->set->access));
+		}
+	}
+}
+
 void StickersBox::Inner::readVisibleSets() {
 	auto itemsVisibleTop = _visibleTop - _itemsTop;
 	auto itemsVisibleBottom = _visibleBottom - _itemsTop;
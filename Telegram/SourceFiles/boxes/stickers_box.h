@@ -156,6 +156,7 @@ private:
 	bool _archivedLoaded = false;
 	bool _allArchivedLoaded = false;
 	bool _someArchivedLoaded = false;
+	bool _updateAfterDrag = false;
 
 	Stickers::Order _localOrder;
 	Stickers::Order _localRemoved;
@@ -187,6 +188,10 @@ public:
 	void updateRows(); // refresh only pack cover stickers
 	bool appendSet(not_null<Stickers::Set*> set);
 
+	bool isDragging() const {
+		return (_dragging >= 0);
+	}
+
 	Stickers::Order getOrder() const;
 	Stickers::Order getFullOrder() const;
 	Stickers::Order getRemovedSets() const;
@@ -224,6 +229,7 @@ protected:
 
 signals:
 	void draggingScrollDelta(int delta);
+	void draggingDone();
 
 public slots:
 	void onUpdateSelected();
@@ -314,6 +320,7 @@ private:
 	void updateRowThumbnail(not_null<Row*> row);
 
 	void readVisibleSets();
+	void loadThumbnails();
 
 	void updateControlsGeometry();
 	void rebuildAppendSet(not_null<Stickers::Set*> set, int maxNameWidth);
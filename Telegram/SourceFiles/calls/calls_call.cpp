@@ -30,6 +30,15 @@ constexpr auto kMinLayer = 65;
 constexpr auto kHangupTimeoutMs = 5000;
 constexpr auto kSha256Size = 32;
 
+// Poll the controller for traffic stats this often while established.
+constexpr auto kQualityPollEach = 2 * crl::time(1000);
+
+// Quality samples kept for the debug log, five minutes at one per poll.
+constexpr auto kQualitySamplesLimit = 150;
+
+// The debug info string is heavy, refresh it once in that many polls.
+constexpr auto kDebugInfoEverySamples = 5;
+
 void AppendEndpoint(
 		std::vector<TgVoipEndpoint> &list,
 		const MTPPhoneConnection &connection) {
@@ -99,6 +108,7 @@ Call::Call(
 , _api(_user->session().api().instance())
 , _type(type) {
 	_discardByTimeoutTimer.setCallback([this] { hangup(); });
+	_qualityTimer.setCallback([this] { collectQualitySample(); });
 
 	if (_type == Type::Outgoing) {
 		setState(State::Requesting);
@@ -733,6 +743,7 @@ void Call::setState(State state) {
 		switch (_state) {
 		case State::Established:
 			_startTime = crl::now();
+			_qualityTimer.callEach(kQualityPollEach);
 			break;
 		case State::ExchangingKeys:
 			_delegate->playSound(Delegate::Sound::Connecting);
@@ -861,8 +872,80 @@ void Call::handleControllerError(const QString &error) {
 	finish(FinishType::Failed);
 }
 
+void Call::collectQualitySample() {
+	if (!_controller) {
+		return;
+	}
+	const auto traffic = _controller->getTrafficStats();
+	auto sample = QualitySample();
+	sample.when = crl::now();
+	sample.bytesSent = int64(traffic.bytesSentWifi)
+		+ int64(traffic.bytesSentMobile);
+	sample.bytesReceived = int64(traffic.bytesReceivedWifi)
+		+ int64(traffic.bytesReceivedMobile);
+	sample.signalBars = _signalBarCount;
+	if ((_qualitySamples.size() % kDebugInfoEverySamples) == 0) {
+		_lastDebugInfo = getDebugLog();
+	}
+	if (_qualitySamples.size() >= kQualitySamplesLimit) {
+		_qualitySamples.erase(_qualitySamples.begin());
+	}
+	_qualitySamples.push_back(sample);
+}
+
+QString Call::qualityReport() const {
+	const auto count = int(_qualitySamples.size());
+	if (count < 2) {
+		return QString();
+	}
+	const auto &last = _qualitySamples[count - 1];
+	const auto &previous = _qualitySamples[count - 2];
+	const auto ms = int64(last.when - previous.when);
+	if (ms <= 0) {
+		return QString();
+	}
+	auto result = qsl("up %1 / down %2 kbps, bars %3"
+	).arg((last.bytesSent - previous.bytesSent) * 8 / ms
+	).arg((last.bytesReceived - previous.bytesReceived) * 8 / ms
+	).arg(last.signalBars);
+	if (!_lastDebugInfo.isEmpty()) {
+		result += '\n' + _lastDebugInfo;
+	}
+	return result;
+}
+
+void Call::logQualitySamples() {
+	if (_qualitySamples.size() < 2) {
+		return;
+	}
+	auto series = QString();
+	for (auto i = 1, count = int(_qualitySamples.size()); i != count; ++i) {
+		const auto &previous = _qualitySamples[i - 1];
+		const auto &next = _qualitySamples[i];
+		const auto ms = int64(next.when - previous.when);
+		if (ms <= 0) {
+			continue;
+		}
+		series += qsl("%1/%2/%3 "
+		).arg((next.bytesSent - previous.bytesSent) * 8 / ms
+		).arg((next.bytesReceived - previous.bytesReceived) * 8 / ms
+		).arg(next.signalBars);
+	}
+	DEBUG_LOG(("Call Quality: up kbps / down kbps / bars each %1s: %2"
+	).arg(kQualityPollEach / 1000
+	).arg(series.trimmed()));
+	if (!_lastDebugInfo.isEmpty()) {
+		DEBUG_LOG(("Call Quality: last controller debug info:\n%1"
+		).arg(_lastDebugInfo));
+	}
+	_qualitySamples.clear();
+}
+
 void Call::destroyController() {
+	_qualityTimer.cancel();
 	if (_controller) {
+		_lastDebugInfo = getDebugLog();
+		logQualitySamples();
 		DEBUG_LOG(("Call Info: Destroying call controller.."));
 		_controller.reset();
 		DEBUG_LOG(("Call Info: Call controller destroyed."));
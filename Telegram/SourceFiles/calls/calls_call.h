@@ -122,6 +122,10 @@ public:
 
 	QString getDebugLog() const;
 
+	// A short live quality summary for the panel overlay, empty until
+	// at least two traffic samples were collected.
+	[[nodiscard]] QString qualityReport() const;
+
 	void setCurrentAudioDevice(bool input, std::string deviceID);
 	void setAudioVolume(bool input, float level);
 	void setAudioDuckingEnabled(bool enabled);
@@ -160,6 +164,8 @@ private:
 	void setStateQueued(State state);
 	void setFailedQueued(const QString &error);
 	void setSignalBarCount(int count);
+	void collectQualitySample();
+	void logQualitySamples();
 	void destroyController();
 
 	not_null<Delegate*> _delegate;
@@ -176,6 +182,16 @@ private:
 	base::DelayedCallTimer _finishByTimeoutTimer;
 	base::Timer _discardByTimeoutTimer;
 
+	struct QualitySample {
+		crl::time when = 0;
+		int64 bytesSent = 0;
+		int64 bytesReceived = 0;
+		int signalBars = 0;
+	};
+	base::Timer _qualityTimer;
+	std::vector<QualitySample> _qualitySamples;
+	QString _lastDebugInfo;
+
 	bool _mute = false;
 	base::Observable<bool> _muteChanged;
 
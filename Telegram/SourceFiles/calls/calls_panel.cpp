@@ -44,6 +44,9 @@ namespace {
 
 constexpr auto kTooltipShowTimeoutMs = 1000;
 
+// Matches the poll interval of the quality samples in the call.
+constexpr auto kQualityUpdateEach = 2 * crl::time(1000);
+
 } // namespace
 
 class Panel::Button : public Ui::RippleButton {
@@ -381,6 +384,12 @@ void Panel::initControls() {
 			_updateOuterRippleTimer.cancel();
 		}
 	});
+	_updateQualityTimer.setCallback([this] {
+		updateQualityText();
+	});
+	if (Logs::DebugEnabled()) {
+		_updateQualityTimer.callEach(kQualityUpdateEach);
+	}
 	_answerHangupRedial->setClickedCallback([this] {
 		if (!_call || _hangupShownProgress.animating()) {
 			return;
@@ -753,6 +762,25 @@ void Panel::paintEvent(QPaintEvent *e) {
 			left += st::callFingerprintSkip + size;
 		}
 	}
+
+	if (!_qualityText.isEmpty()) {
+		const auto available = QRect(
+			_padding.left() + st::callSignalPadding,
+			_contentTop + st::callSignalPadding,
+			width() - _padding.left() - _padding.right()
+				- 2 * st::callSignalPadding,
+			height() - _contentTop - 2 * st::callSignalPadding);
+		p.setFont(st::normalFont);
+		const auto used = p.boundingRect(
+			available,
+			Qt::AlignLeft | Qt::AlignTop,
+			_qualityText);
+		p.fillRect(
+			used.marginsAdded(QMargins(4, 4, 4, 4)),
+			QColor(0, 0, 0, 160));
+		p.setPen(Qt::white);
+		p.drawText(used, Qt::AlignLeft | Qt::AlignTop, _qualityText);
+	}
 }
 
 QRect Panel::signalBarsRect() const {
@@ -932,6 +960,14 @@ void Panel::updateStatusText(State state) {
 	updateStatusGeometry();
 }
 
+void Panel::updateQualityText() {
+	const auto text = _call ? _call->qualityReport() : QString();
+	if (_qualityText != text) {
+		_qualityText = text;
+		update();
+	}
+}
+
 void Panel::startDurationUpdateTimer(crl::time currentDuration) {
 	auto msTillNextSecond = 1000 - (currentDuration % 1000);
 	_updateDurationTimer.callOnce(msTillNextSecond + 5);
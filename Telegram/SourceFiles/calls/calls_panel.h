@@ -112,6 +112,7 @@ private:
 	void showControls();
 	void updateStatusText(State state);
 	void startDurationUpdateTimer(crl::time currentDuration);
+	void updateQualityText();
 	void fillFingerprint();
 	void toggleOpacityAnimation(bool visible);
 	void finishAnimating();
@@ -147,6 +148,8 @@ private:
 
 	base::Timer _updateDurationTimer;
 	base::Timer _updateOuterRippleTimer;
+	base::Timer _updateQualityTimer;
+	QString _qualityText;
 
 	bool _visible = false;
 	QPixmap _userPhoto;
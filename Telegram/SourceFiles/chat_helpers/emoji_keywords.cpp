@@ -38,7 +38,10 @@ struct LangPackEmoji {
 struct LangPackData {
 	int version = 0;
 	int maxKeyLength = 0;
-	std::map<QString, std::vector<LangPackEmoji>> emoji;
+
+	// A sorted contiguous map, so the per-keystroke prefix query walks
+	// adjacent memory instead of chasing tree nodes.
+	base::flat_map<QString, std::vector<LangPackEmoji>> emoji;
 };
 
 [[nodiscard]] bool MustAddPostfix(const QString &text) {
@@ -107,6 +110,7 @@ void CreateCacheFilePath() {
 	if (version < 0 || count < 0 || stream.status() != QDataStream::Ok) {
 		return {};
 	}
+	result.emoji.reserve(count);
 	for (auto i = 0; i != count; ++i) {
 		auto key = QString();
 		auto size = qint32();
@@ -792,6 +792,27 @@ void EmojiListWidget::refreshRecent() {
 	resizeToWidth(width());
 }
 
+void EmojiListWidget::preloadImages() {
+	// Fill the section lists and render one emoji into a throwaway
+	// image, so the first paint finds the sprite already loaded.
+	for (auto i = 0; i != kEmojiSectionCount; ++i) {
+		ensureLoaded(i);
+	}
+	for (auto i = 1; i != kEmojiSectionCount; ++i) {
+		if (_emoji[i].isEmpty()) {
+			continue;
+		}
+		auto image = QImage(
+			_esize,
+			_esize,
+			QImage::Format_ARGB32_Premultiplied);
+		image.fill(Qt::transparent);
+		Painter p(&image);
+		Ui::Emoji::Draw(p, _emoji[i][0], _esize, 0, 0);
+		return;
+	}
+}
+
 bool EmojiListWidget::eventHook(QEvent *e) {
 	if (e->type() == QEvent::ParentChange) {
 		if (_picker->parentWidget() != parentWidget()) {
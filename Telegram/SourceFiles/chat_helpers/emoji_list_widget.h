@@ -43,6 +43,7 @@ public:
 	using Section = Ui::Emoji::Section;
 
 	void refreshRecent() override;
+	void preloadImages() override;
 	void clearSelection() override;
 	object_ptr<TabbedSelector::InnerFooter> createFooter() override;
 
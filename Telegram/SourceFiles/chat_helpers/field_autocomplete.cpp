@@ -87,6 +87,9 @@ void FieldAutocomplete::showFiltered(
 		not_null<PeerData*> peer,
 		QString query,
 		bool addInlineBots) {
+	const auto samePeer = (_chat == peer->asChat())
+		&& (_user == peer->asUser())
+		&& (_channel == peer->asChannel());
 	_chat = peer->asChat();
 	_user = peer->asUser();
 	_channel = peer->asChannel();
@@ -120,14 +123,25 @@ void FieldAutocomplete::showFiltered(
 		plainQuery = query.midRef(1);
 		break;
 	}
-	bool resetScroll = (_type != type || _filter != plainQuery);
+	const auto newFilter = TextUtilities::RemoveAccents(plainQuery.toString());
+
+	// Each next typed letter only narrows the match, so the rows filtered
+	// for the previous, shorter query can be refined instead of rescanning
+	// all the participants of the chat.
+	const auto refine = samePeer
+		&& (type == _type)
+		&& (addInlineBots == _addInlineBots)
+		&& (newFilter.size() > _filter.size())
+		&& newFilter.startsWith(_filter);
+
+	bool resetScroll = (_type != type || _filter != newFilter);
 	if (resetScroll) {
 		_type = type;
-		_filter = TextUtilities::RemoveAccents(plainQuery.toString());
+		_filter = newFilter;
 	}
 	_addInlineBots = addInlineBots;
 
-	updateFiltered(resetScroll);
+	updateFiltered(resetScroll, refine);
 }
 
 void FieldAutocomplete::showStickers(EmojiPtr emoji) {
@@ -200,7 +214,7 @@ internal::StickerRows FieldAutocomplete::getStickerSuggestions() {
 	return result;
 }
 
-void FieldAutocomplete::updateFiltered(bool resetScroll) {
+void FieldAutocomplete::updateFiltered(bool resetScroll, bool refine) {
 	int32 now = base::unixtime::now(), recentInlineBots = 0;
 	internal::MentionRows mrows;
 	internal::HashtagRows hrows;
@@ -239,156 +253,203 @@ void FieldAutocomplete::updateFiltered(bool resetScroll) {
 		};
 
 		bool listAllSuggestions = _filter.isEmpty();
-		if (_addInlineBots) {
-			for_const (auto user, cRecentInlineBots()) {
+		if (refine && !listAllSuggestions && !_mrows.empty()) {
+			// Narrow down the rows filtered for the previous, shorter query.
+			mrows.reserve(_mrows.size());
+			auto index = 0;
+			for (const auto &row : _mrows) {
+				const auto user = row.user;
+				const auto wasRecentBot = (index++ < _recentInlineBotsInRows);
 				if (user->isInaccessible()) continue;
-				if (!listAllSuggestions && filterNotPassedByUsername(user)) continue;
-				mrows.push_back({ user });
-				++recentInlineBots;
+				if (wasRecentBot
+					? filterNotPassedByUsername(user)
+					: filterNotPassedByName(user)) continue;
+				if (wasRecentBot) {
+					++recentInlineBots;
+				}
+				mrows.push_back(row);
 			}
-		}
-		if (_chat) {
-			auto sorted = base::flat_multi_map<TimeId, not_null<UserData*>>();
-			const auto byOnline = [&](not_null<UserData*> user) {
-				return Data::SortByOnlineValue(user, now);
-			};
-			mrows.reserve(mrows.size() + (_chat->participants.empty() ? _chat->lastAuthors.size() : _chat->participants.size()));
-			if (_chat->noParticipantInfo()) {
-				Auth().api().requestFullPeer(_chat);
-			} else if (!_chat->participants.empty()) {
-				for (const auto user : _chat->participants) {
+		} else {
+			if (_addInlineBots) {
+				for_const (auto user, cRecentInlineBots()) {
 					if (user->isInaccessible()) continue;
-					if (!listAllSuggestions && filterNotPassedByName(user)) continue;
-					if (indexOfInFirstN(mrows, user, recentInlineBots) >= 0) continue;
-					sorted.emplace(byOnline(user), user);
+					if (!listAllSuggestions && filterNotPassedByUsername(user)) continue;
+					mrows.push_back({ user });
+					++recentInlineBots;
 				}
 			}
-			for (const auto user : _chat->lastAuthors) {
-				if (user->isInaccessible()) continue;
-				if (!listAllSuggestions && filterNotPassedByName(user)) continue;
-				if (indexOfInFirstN(mrows, user, recentInlineBots) >= 0) continue;
-				mrows.push_back({ user });
-				sorted.remove(byOnline(user), user);
-			}
-			for (auto i = sorted.cend(), b = sorted.cbegin(); i != b;) {
-				--i;
-				mrows.push_back({ i->second });
-			}
-		} else if (_channel && _channel->isMegagroup()) {
-			QMultiMap<int32, UserData*> ordered;
-			if (_channel->lastParticipantsRequestNeeded()) {
-				Auth().api().requestLastParticipants(_channel);
-			} else {
-				mrows.reserve(mrows.size() + _channel->mgInfo->lastParticipants.size());
-				for (const auto user : _channel->mgInfo->lastParticipants) {
+			if (_chat) {
+				auto sorted = base::flat_multi_map<TimeId, not_null<UserData*>>();
+				const auto byOnline = [&](not_null<UserData*> user) {
+					return Data::SortByOnlineValue(user, now);
+				};
+				mrows.reserve(mrows.size() + (_chat->participants.empty() ? _chat->lastAuthors.size() : _chat->participants.size()));
+				if (_chat->noParticipantInfo()) {
+					Auth().api().requestFullPeer(_chat);
+				} else if (!_chat->participants.empty()) {
+					for (const auto user : _chat->participants) {
+						if (user->isInaccessible()) continue;
+						if (!listAllSuggestions && filterNotPassedByName(user)) continue;
+						if (indexOfInFirstN(mrows, user, recentInlineBots) >= 0) continue;
+						sorted.emplace(byOnline(user), user);
+					}
+				}
+				for (const auto user : _chat->lastAuthors) {
 					if (user->isInaccessible()) continue;
 					if (!listAllSuggestions && filterNotPassedByName(user)) continue;
 					if (indexOfInFirstN(mrows, user, recentInlineBots) >= 0) continue;
 					mrows.push_back({ user });
+					sorted.remove(byOnline(user), user);
+				}
+				for (auto i = sorted.cend(), b = sorted.cbegin(); i != b;) {
+					--i;
+					mrows.push_back({ i->second });
+				}
+			} else if (_channel && _channel->isMegagroup()) {
+				QMultiMap<int32, UserData*> ordered;
+				if (_channel->lastParticipantsRequestNeeded()) {
+					Auth().api().requestLastParticipants(_channel);
+				} else {
+					mrows.reserve(mrows.size() + _channel->mgInfo->lastParticipants.size());
+					for (const auto user : _channel->mgInfo->lastParticipants) {
+						if (user->isInaccessible()) continue;
+						if (!listAllSuggestions && filterNotPassedByName(user)) continue;
+						if (indexOfInFirstN(mrows, user, recentInlineBots) >= 0) continue;
+						mrows.push_back({ user });
+					}
 				}
 			}
 		}
 	} else if (_type == Type::Hashtags) {
 		bool listAllSuggestions = _filter.isEmpty();
-		auto &recent(cRecentWriteHashtags());
-		hrows.reserve(recent.size());
-		for (const auto &item : recent) {
-			const auto &tag = item.first;
-			if (!listAllSuggestions
+		const auto tagNotPassed = [&](const QString &tag) {
+			return !listAllSuggestions
 				&& (tag.size() == _filter.size()
 					|| !TextUtilities::RemoveAccents(tag).startsWith(
 						_filter,
-						Qt::CaseInsensitive))) {
-				continue;
+						Qt::CaseInsensitive));
+		};
+		if (refine && !listAllSuggestions && !_hrows.empty()) {
+			hrows.reserve(_hrows.size());
+			for (const auto &tag : _hrows) {
+				if (!tagNotPassed(tag)) {
+					hrows.push_back(tag);
+				}
+			}
+		} else {
+			auto &recent(cRecentWriteHashtags());
+			hrows.reserve(recent.size());
+			for (const auto &item : recent) {
+				const auto &tag = item.first;
+				if (!tagNotPassed(tag)) {
+					hrows.push_back(tag);
+				}
 			}
-			hrows.push_back(tag);
 		}
 	} else if (_type == Type::BotCommands) {
 		bool listAllSuggestions = _filter.isEmpty();
 		bool hasUsername = _filter.indexOf('@') > 0;
-		QMap<UserData*, bool> bots;
-		int32 cnt = 0;
-		if (_chat) {
-			if (_chat->noParticipantInfo()) {
-				_chat->session().api().requestFullPeer(_chat);
-			} else if (!_chat->participants.empty()) {
-				for (const auto user : _chat->participants) {
-					if (!user->isBot()) {
-						continue;
-					} else if (!user->botInfo->inited) {
-						user->session().api().requestFullPeer(user);
-					}
-					if (user->botInfo->commands.isEmpty()) {
-						continue;
-					}
-					bots.insert(user, true);
-					cnt += user->botInfo->commands.size();
+		if (refine && !listAllSuggestions && !_brows.empty()) {
+			const auto botStatus = _chat
+				? _chat->botStatus
+				: ((_channel && _channel->isMegagroup())
+					? _channel->mgInfo->botStatus
+					: -1);
+			brows.reserve(_brows.size());
+			for (const auto &row : _brows) {
+				const auto user = row.user;
+				const auto toFilter = (hasUsername || botStatus == 0 || botStatus == 2)
+					? row.command->command + '@' + user->username
+					: row.command->command;
+				if (toFilter.startsWith(_filter, Qt::CaseInsensitive)) {
+					brows.push_back(row);
 				}
 			}
-		} else if (_user && _user->isBot()) {
-			if (!_user->botInfo->inited) {
-				_user->session().api().requestFullPeer(_user);
-			}
-			cnt = _user->botInfo->commands.size();
-			bots.insert(_user, true);
-		} else if (_channel && _channel->isMegagroup()) {
-			if (_channel->mgInfo->bots.empty()) {
-				if (!_channel->mgInfo->botStatus) {
-					_channel->session().api().requestBots(_channel);
+		} else {
+			QMap<UserData*, bool> bots;
+			int32 cnt = 0;
+			if (_chat) {
+				if (_chat->noParticipantInfo()) {
+					_chat->session().api().requestFullPeer(_chat);
+				} else if (!_chat->participants.empty()) {
+					for (const auto user : _chat->participants) {
+						if (!user->isBot()) {
+							continue;
+						} else if (!user->botInfo->inited) {
+							user->session().api().requestFullPeer(user);
+						}
+						if (user->botInfo->commands.isEmpty()) {
+							continue;
+						}
+						bots.insert(user, true);
+						cnt += user->botInfo->commands.size();
+					}
 				}
-			} else {
-				for (const auto user : _channel->mgInfo->bots) {
-					if (!user->isBot()) {
-						continue;
-					} else if (!user->botInfo->inited) {
-						user->session().api().requestFullPeer(user);
+			} else if (_user && _user->isBot()) {
+				if (!_user->botInfo->inited) {
+					_user->session().api().requestFullPeer(_user);
+				}
+				cnt = _user->botInfo->commands.size();
+				bots.insert(_user, true);
+			} else if (_channel && _channel->isMegagroup()) {
+				if (_channel->mgInfo->bots.empty()) {
+					if (!_channel->mgInfo->botStatus) {
+						_channel->session().api().requestBots(_channel);
 					}
-					if (user->botInfo->commands.isEmpty()) {
-						continue;
+				} else {
+					for (const auto user : _channel->mgInfo->bots) {
+						if (!user->isBot()) {
+							continue;
+						} else if (!user->botInfo->inited) {
+							user->session().api().requestFullPeer(user);
+						}
+						if (user->botInfo->commands.isEmpty()) {
+							continue;
+						}
+						bots.insert(user, true);
+						cnt += user->botInfo->commands.size();
 					}
-					bots.insert(user, true);
-					cnt += user->botInfo->commands.size();
 				}
 			}
-		}
-		if (cnt) {
-			brows.reserve(cnt);
-			int32 botStatus = _chat ? _chat->botStatus : ((_channel && _channel->isMegagroup()) ? _channel->mgInfo->botStatus : -1);
-			if (_chat) {
-				for (const auto &user : _chat->lastAuthors) {
-					if (!user->isBot()) {
-						continue;
-					} else if (!bots.contains(user)) {
-						continue;
-					} else if (!user->botInfo->inited) {
-						user->session().api().requestFullPeer(user);
-					}
-					if (user->botInfo->commands.isEmpty()) {
-						continue;
-					}
-					bots.remove(user);
-					for (auto j = 0, l = user->botInfo->commands.size(); j != l; ++j) {
-						if (!listAllSuggestions) {
-							auto toFilter = (hasUsername || botStatus == 0 || botStatus == 2)
-								? user->botInfo->commands.at(j).command + '@' + user->username
-								: user->botInfo->commands.at(j).command;
-							if (!toFilter.startsWith(_filter, Qt::CaseInsensitive)/* || toFilter.size() == _filter.size()*/) {
-								continue;
+			if (cnt) {
+				brows.reserve(cnt);
+				int32 botStatus = _chat ? _chat->botStatus : ((_channel && _channel->isMegagroup()) ? _channel->mgInfo->botStatus : -1);
+				if (_chat) {
+					for (const auto &user : _chat->lastAuthors) {
+						if (!user->isBot()) {
+							continue;
+						} else if (!bots.contains(user)) {
+							continue;
+						} else if (!user->botInfo->inited) {
+							user->session().api().requestFullPeer(user);
+						}
+						if (user->botInfo->commands.isEmpty()) {
+							continue;
+						}
+						bots.remove(user);
+						for (auto j = 0, l = user->botInfo->commands.size(); j != l; ++j) {
+							if (!listAllSuggestions) {
+								auto toFilter = (hasUsername || botStatus == 0 || botStatus == 2)
+									? user->botInfo->commands.at(j).command + '@' + user->username
+									: user->botInfo->commands.at(j).command;
+								if (!toFilter.startsWith(_filter, Qt::CaseInsensitive)/* || toFilter.size() == _filter.size()*/) {
+									continue;
+								}
 							}
+							brows.push_back({ user, &user->botInfo->commands.at(j) });
 						}
-						brows.push_back({ user, &user->botInfo->commands.at(j) });
 					}
 				}
-			}
-			if (!bots.isEmpty()) {
-				for (QMap<UserData*, bool>::const_iterator i = bots.cbegin(), e = bots.cend(); i != e; ++i) {
-					UserData *user = i.key();
-					for (int32 j = 0, l = user->botInfo->commands.size(); j < l; ++j) {
-						if (!listAllSuggestions) {
-							QString toFilter = (hasUsername || botStatus == 0 || botStatus == 2) ? user->botInfo->commands.at(j).command + '@' + user->username : user->botInfo->commands.at(j).command;
-							if (!toFilter.startsWith(_filter, Qt::CaseInsensitive)/* || toFilter.size() == _filter.size()*/) continue;
+				if (!bots.isEmpty()) {
+					for (QMap<UserData*, bool>::const_iterator i = bots.cbegin(), e = bots.cend(); i != e; ++i) {
+						UserData *user = i.key();
+						for (int32 j = 0, l = user->botInfo->commands.size(); j < l; ++j) {
+							if (!listAllSuggestions) {
+								QString toFilter = (hasUsername || botStatus == 0 || botStatus == 2) ? user->botInfo->commands.at(j).command + '@' + user->username : user->botInfo->commands.at(j).command;
+								if (!toFilter.startsWith(_filter, Qt::CaseInsensitive)/* || toFilter.size() == _filter.size()*/) continue;
+							}
+							brows.push_back({ user, &user->botInfo->commands.at(j) });
 						}
-						brows.push_back({ user, &user->botInfo->commands.at(j) });
 					}
 				}
 			}
@@ -400,6 +461,7 @@ void FieldAutocomplete::updateFiltered(bool resetScroll) {
 		std::move(brows),
 		std::move(srows),
 		resetScroll);
+	_recentInlineBotsInRows = recentInlineBots;
 	_inner->setRecentInlineBotsInRows(recentInlineBots);
 }
 
@@ -124,7 +124,7 @@ private:
 	void animationCallback();
 	void hideFinish();
 
-	void updateFiltered(bool resetScroll = false);
+	void updateFiltered(bool resetScroll = false, bool refine = false);
 	void recount(bool resetScroll = false);
 	internal::StickerRows getStickerSuggestions();
 
@@ -160,6 +160,7 @@ private:
 	QString _filter;
 	QRect _boundings;
 	bool _addInlineBots;
+	int _recentInlineBotsInRows = 0;
 
 	int32 _width, _height;
 	bool _hiding = false;
@@ -22,6 +22,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "boxes/stickers_box.h"
 #include "inline_bots/inline_bot_result.h"
 #include "chat_helpers/stickers.h"
+#include "main/main_session.h"
 #include "storage/localstorage.h"
 #include "lang/lang_keys.h"
 #include "mainwindow.h"
@@ -196,6 +197,24 @@ void GifsListWidget::visibleTopBottomUpdated(
 		_lastScrolled = crl::now();
 	}
 	checkLoadMore();
+	unloadScrolledAwayItems();
+}
+
+void GifsListWidget::unloadScrolledAwayItems() {
+	const auto visibleTop = getVisibleTop();
+	const auto visibleBottom = getVisibleBottom();
+	const auto unloadDistance = (visibleBottom - visibleTop);
+	auto top = st::stickerPanPadding;
+	for (auto row = 0, rows = _rows.size(); row != rows; ++row) {
+		auto &inlineRow = _rows[row];
+		if (top + inlineRow.height <= visibleTop - unloadDistance
+			|| top >= visibleBottom + unloadDistance) {
+			for (const auto item : inlineRow.items) {
+				item->unloadHeavyPart();
+			}
+		}
+		top += inlineRow.height;
+	}
 }
 
 void GifsListWidget::checkLoadMore() {
@@ -299,8 +318,11 @@ void GifsListWidget::paintInlineItems(Painter &p, QRect clip) {
 		return;
 	}
 	auto gifPaused = controller()->isGifPausedAtLeastFor(Window::GifPauseReason::SavedGifs);
+	const auto autoplay = controller()->session().settings().autoplayGifs();
 	InlineBots::Layout::PaintContext context(crl::now(), false, gifPaused, false);
 
+	const auto visibleTop = getVisibleTop();
+	const auto visibleBottom = getVisibleBottom();
 	auto top = st::stickerPanPadding;
 	auto fromx = rtl() ? (width() - clip.x() - clip.width()) : clip.x();
 	auto tox = rtl() ? (width() - clip.x()) : (clip.x() + clip.width());
@@ -310,6 +332,13 @@ void GifsListWidget::paintInlineItems(Painter &p, QRect clip) {
 			break;
 		}
 		if (top + inlineRow.height > clip.top()) {
+			// Only fully visible rows animate, partially visible ones show
+			// a static frame, so scrolling doesn't spin up clip readers for
+			// rows that are just peeking into the viewport.
+			const auto fullyVisible = (top >= visibleTop)
+				&& (top + inlineRow.height <= visibleBottom);
+			context.startAnimations = autoplay && fullyVisible;
+			context.paused = gifPaused || !fullyVisible;
 			auto left = st::inlineResultsLeft - st::buttonRadius;
 			if (row == rows - 1) context.lastRow = true;
 			for (int col = 0, cols = inlineRow.items.size(); col < cols; ++col) {
@@ -108,6 +108,7 @@ private:
 	void refreshSavedGifs();
 	int refreshInlineRows(const InlineCacheEntry *results, bool resultsDeleted);
 	void checkLoadMore();
+	void unloadScrolledAwayItems();
 
 	int32 showInlineRows(bool newResults);
 	bool refreshInlineRows(int32 *added = 0);
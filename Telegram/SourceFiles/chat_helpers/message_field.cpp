@@ -496,9 +496,26 @@ void MessageLinksParser::parse() {
 	const auto &tags = textWithTags.tags;
 	const auto &markdownTags = _field->getMarkdownTags();
 	if (text.isEmpty()) {
+		_lastParsed = TextWithTags();
+		_lastRanges = QVector<LinkRange>();
 		_list = QStringList();
 		return;
+	} else if (textWithTags == _lastParsed) {
+		// Cursor movement and overlapping schedule triggers re-request
+		// parsing of the same content, which is expensive for a large
+		// pasted text, while this comparison is a plain memory scan.
+		return;
+	} else if (tags.isEmpty()
+		&& markdownTags.empty()
+		&& _lastParsed.tags.isEmpty()
+		&& !_lastParsed.text.isEmpty()
+		&& parseIncremental(text)) {
+		// Plain-text edits re-scan only the changed words and reuse
+		// the untouched link ranges from the previous parse.
+		_lastParsed = textWithTags;
+		return;
 	}
+	_lastParsed = textWithTags;
 	const auto tagCanIntersectWithLink = [](const QString &tag) {
 		return (tag == Ui::InputField::kTagBold)
 			|| (tag == Ui::InputField::kTagItalic)
@@ -557,7 +574,12 @@ void MessageLinksParser::parse() {
 				+ markdownTag->adjustedLength < from + length);
 	};
 
-	const auto len = text.size();
+	// A plain-text link always contains a dot or a protocol colon, so
+	// texts without both are rejected by two flat character scans
+	// instead of running the domain regexp over the whole content.
+	// Markdown link tags are still collected below.
+	const auto mayHaveLinks = text.contains('.') || text.contains(':');
+	const auto len = mayHaveLinks ? text.size() : 0;
 	const QChar *start = text.unicode(), *end = start + text.size();
 	for (auto offset = 0, matchOffset = offset; offset < len;) {
 		auto m = qthelp::RegExpDomain().match(text, matchOffset);
@@ -635,9 +657,138 @@ void MessageLinksParser::parse() {
 	apply(text, ranges);
 }
 
+bool MessageLinksParser::parseIncremental(const QString &text) {
+	const auto &was = _lastParsed.text;
+	const auto oldLength = int(was.size());
+	const auto newLength = int(text.size());
+	const auto shared = std::min(oldLength, newLength);
+	auto prefix = 0;
+	while (prefix != shared && was[prefix] == text[prefix]) {
+		++prefix;
+	}
+	const auto maxSuffix = shared - prefix;
+	auto suffix = 0;
+	while (suffix != maxSuffix
+		&& was[oldLength - suffix - 1] == text[newLength - suffix - 1]) {
+		++suffix;
+	}
+
+	// Expand the changed range to whitespace boundaries: links never
+	// contain spaces, so the words outside keep their previous ranges.
+	auto from = prefix;
+	while (from > 0 && !text[from - 1].isSpace()) {
+		--from;
+	}
+	auto till = newLength - suffix;
+	while (till < newLength && !text[till].isSpace()) {
+		++till;
+	}
+	const auto delta = newLength - oldLength;
+	const auto oldTill = till - delta;
+	if (oldTill < from || oldTill > oldLength) {
+		return false;
+	}
+
+	auto ranges = QVector<LinkRange>();
+	for (const auto &range : _lastRanges) {
+		if (range.start + range.length <= from) {
+			ranges.push_back(range);
+		}
+	}
+	scanPlainRanges(text, from, till, ranges);
+	for (const auto &range : _lastRanges) {
+		if (range.start >= oldTill) {
+			ranges.push_back({
+				range.start + delta,
+				range.length,
+				range.custom });
+		}
+	}
+	apply(text, ranges);
+	return true;
+}
+
+void MessageLinksParser::scanPlainRanges(
+		const QString &text,
+		int from,
+		int till,
+		QVector<LinkRange> &ranges) const {
+	if (!text.midRef(from, till - from).contains('.')
+		&& !text.midRef(from, till - from).contains(':')) {
+		return;
+	}
+	const QChar *start = text.unicode(), *end = start + text.size();
+	for (auto offset = from, matchOffset = offset; offset < till;) {
+		auto m = qthelp::RegExpDomain().match(text, matchOffset);
+		if (!m.hasMatch()) break;
+
+		auto domainOffset = m.capturedStart();
+		if (domainOffset >= till) break;
+
+		auto protocol = m.captured(1).toLower();
+		auto topDomain = m.captured(3).toLower();
+		auto isProtocolValid = protocol.isEmpty() || TextUtilities::IsValidProtocol(protocol);
+		auto isTopDomainValid = !protocol.isEmpty() || TextUtilities::IsValidTopDomain(topDomain);
+
+		if (protocol.isEmpty() && domainOffset > offset + 1 && *(start + domainOffset - 1) == QChar('@')) {
+			auto forMailName = text.mid(offset, domainOffset - offset - 1);
+			auto mMailName = TextUtilities::RegExpMailNameAtEnd().match(forMailName);
+			if (mMailName.hasMatch()) {
+				offset = matchOffset = m.capturedEnd();
+				continue;
+			}
+		}
+		if (!isProtocolValid || !isTopDomainValid) {
+			offset = matchOffset = m.capturedEnd();
+			continue;
+		}
+
+		QStack<const QChar*> parenth;
+		const QChar *domainEnd = start + m.capturedEnd(), *p = domainEnd;
+		for (; p < end; ++p) {
+			QChar ch(*p);
+			if (IsLinkEnd(ch)) {
+				break; // link finished
+			} else if (IsAlmostLinkEnd(ch)) {
+				const QChar *endTest = p + 1;
+				while (endTest < end && IsAlmostLinkEnd(*endTest)) {
+					++endTest;
+				}
+				if (endTest >= end || IsLinkEnd(*endTest)) {
+					break; // link finished at p
+				}
+				p = endTest;
+				ch = *p;
+			}
+			if (ch == '(' || ch == '[' || ch == '{' || ch == '<') {
+				parenth.push(p);
+			} else if (ch == ')' || ch == ']' || ch == '}' || ch == '>') {
+				if (parenth.isEmpty()) break;
+				const QChar *q = parenth.pop(), open(*q);
+				if ((ch == ')' && open != '(') || (ch == ']' && open != '[') || (ch == '}' && open != '{') || (ch == '>' && open != '<')) {
+					p = q;
+					break;
+				}
+			}
+		}
+		if (p > domainEnd) { // check, that domain ended
+			if (domainEnd->unicode() != '/' && domainEnd->unicode() != '?') {
+				matchOffset = domainEnd - start;
+				continue;
+			}
+		}
+		ranges.push_back({
+			domainOffset,
+			static_cast<int>(p - start - domainOffset),
+			QString() });
+		offset = matchOffset = p - start;
+	}
+}
+
 void MessageLinksParser::apply(
 		const QString &text,
 		const QVector<LinkRange> &ranges) {
+	_lastRanges = ranges;
 	const auto count = int(ranges.size());
 	const auto current = _list.current();
 	const auto computeLink = [&](const LinkRange &range) {
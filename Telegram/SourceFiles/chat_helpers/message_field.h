@@ -86,11 +86,19 @@ private:
 	}
 
 	void parse();
+	bool parseIncremental(const QString &text);
+	void scanPlainRanges(
+		const QString &text,
+		int from,
+		int till,
+		QVector<LinkRange> &ranges) const;
 	void apply(const QString &text, const QVector<LinkRange> &ranges);
 
 	not_null<Ui::InputField*> _field;
 	rpl::variable<QStringList> _list;
 	int _lastLength = 0;
+	TextWithTags _lastParsed;
+	QVector<LinkRange> _lastRanges;
 	base::Timer _timer;
 	base::qt_connection _connection;
 
@@ -172,6 +172,20 @@ void DownloadDictionaryInBackground(
 	BackgroundLoaderChanged.fire_copy(id);
 }
 
+// Process-wide list of languages last passed to the platform
+// spellchecker, so restarting a session with the same dictionaries
+// doesn't reload them from disk.
+std::vector<int> LoadedLanguages;
+
+void UpdateLanguagesIfChanged(std::vector<int> languages) {
+	ranges::sort(languages);
+	if (languages == LoadedLanguages) {
+		return;
+	}
+	LoadedLanguages = languages;
+	Platform::Spellchecker::UpdateLanguages(std::move(languages));
+}
+
 void AddExceptions() {
 	const auto exceptions = ranges::view::all(
 		kExceptions
@@ -377,14 +391,18 @@ void Start(not_null<Main::Session*> session) {
 	const auto settings = &session->settings();
 
 	const auto onEnabled = [=](auto enabled) {
-		Platform::Spellchecker::UpdateLanguages(
-			enabled
-				? settings->dictionariesEnabled()
-				: std::vector<int>());
+		UpdateLanguagesIfChanged(enabled
+			? settings->dictionariesEnabled()
+			: std::vector<int>());
 	};
 
 	const auto guard = gsl::finally([=] {
-		onEnabled(settings->spellcheckerEnabled());
+		// Loading dictionaries is not cheap, so postpone it until the
+		// session start is finished and the input field is responsive,
+		// spellchecking simply activates when they are ready.
+		crl::on_main(session, [=] {
+			onEnabled(settings->spellcheckerEnabled());
+		});
 	});
 
 	if (Platform::Spellchecker::IsSystemSpellchecker()) {
@@ -408,7 +426,7 @@ void Start(not_null<Main::Session*> session) {
 
 	settings->dictionariesEnabledChanges(
 	) | rpl::start_with_next([](auto dictionaries) {
-		Platform::Spellchecker::UpdateLanguages(dictionaries);
+		UpdateLanguagesIfChanged(std::move(dictionaries));
 	}, session->lifetime());
 
 	settings->spellcheckerEnabledChanges(
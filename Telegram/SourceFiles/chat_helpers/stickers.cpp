@@ -17,6 +17,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "lang/lang_keys.h"
 #include "apiwrap.h"
 #include "storage/localstorage.h"
+#include "storage/cache_statistics.h"
 #include "mainwidget.h"
 #include "main/main_session.h"
 #include "mainwindow.h"
@@ -1146,11 +1147,21 @@ auto LottieCachedFromContent(
 	const auto get = [=](FnMut<void(QByteArray &&cached)> handler) {
 		session->data().cacheBigFile().get(
 			key,
-			std::move(handler));
+			[=, handler = std::move(handler)](QByteArray &&cached) mutable {
+				Storage::CacheStats::RecordGet(
+					Storage::CacheStats::Class::Stickers,
+					key,
+					cached.size());
+				handler(std::move(cached));
+			});
 	};
 	const auto weak = base::make_weak(session.get());
 	const auto put = [=](QByteArray &&cached) {
 		crl::on_main(weak, [=, data = std::move(cached)]() mutable {
+			Storage::CacheStats::RecordPut(
+				Storage::CacheStats::Class::Stickers,
+				key,
+				data.size());
 			weak->data().cacheBigFile().put(key, std::move(data));
 		});
 	};
@@ -1224,6 +1235,38 @@ std::unique_ptr<Lottie::SinglePlayer> LottiePlayerFromDocument(
 	return LottieFromDocument(method, media, uint8(keyShift), box);
 }
 
+std::shared_ptr<Lottie::SinglePlayer> LottieSharedPlayerFromDocument(
+		not_null<Data::DocumentMedia*> media,
+		LottieSize sizeTag,
+		QSize box,
+		Lottie::Quality quality) {
+	static auto Players = base::flat_map<
+		std::pair<DocumentData*, uint64>,
+		std::weak_ptr<Lottie::SinglePlayer>>();
+
+	for (auto i = Players.begin(); i != Players.end();) {
+		if (i->second.expired()) {
+			i = Players.erase(i);
+		} else {
+			++i;
+		}
+	}
+	const auto packed = (uint64(uint8(sizeTag)) << 48)
+		| (uint64(uint32(box.width())) << 24)
+		| uint64(uint32(box.height()));
+	const auto key = std::make_pair(media->owner().get(), packed);
+	const auto i = Players.find(key);
+	if (i != end(Players)) {
+		if (auto result = i->second.lock()) {
+			return result;
+		}
+	}
+	auto result = std::shared_ptr<Lottie::SinglePlayer>(
+		LottiePlayerFromDocument(media, sizeTag, box, quality));
+	Players.emplace(key, result);
+	return result;
+}
+
 not_null<Lottie::Animation*> LottieAnimationFromDocument(
 		not_null<Lottie::MultiPlayer*> player,
 		not_null<Data::DocumentMedia*> media,
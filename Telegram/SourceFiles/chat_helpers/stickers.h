@@ -106,6 +106,15 @@ enum class LottieSize : uchar {
 	QSize box,
 	Lottie::Quality quality = Lottie::Quality(),
 	std::shared_ptr<Lottie::FrameRenderer> renderer = nullptr);
+
+// All the consumers asking for the same document at the same size share
+// one player, so each frame is rasterized only once no matter in how
+// many places the sticker is playing.
+[[nodiscard]] std::shared_ptr<Lottie::SinglePlayer> LottieSharedPlayerFromDocument(
+	not_null<Data::DocumentMedia*> media,
+	LottieSize sizeTag,
+	QSize box,
+	Lottie::Quality quality = Lottie::Quality());
 [[nodiscard]] not_null<Lottie::Animation*> LottieAnimationFromDocument(
 	not_null<Lottie::MultiPlayer*> player,
 	not_null<Data::DocumentMedia*> media,
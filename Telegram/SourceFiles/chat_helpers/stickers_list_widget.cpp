@@ -925,6 +925,9 @@ object_ptr<TabbedSelector::InnerFooter> StickersListWidget::createFooter() {
 void StickersListWidget::visibleTopBottomUpdated(
 		int visibleTop,
 		int visibleBottom) {
+	if (visibleTop != getVisibleTop()) {
+		_scrollingDown = (visibleTop > getVisibleTop());
+	}
 	Inner::visibleTopBottomUpdated(visibleTop, visibleBottom);
 	if (_section == Section::Featured) {
 		checkVisibleFeatured(visibleTop, visibleBottom);
@@ -1649,14 +1652,27 @@ void StickersListWidget::checkVisibleLottie() {
 	}
 	const auto visibleTop = getVisibleTop();
 	const auto visibleBottom = getVisibleBottom();
-	const auto destroyAfterDistance = (visibleBottom - visibleTop) * 2;
+	const auto visibleHeight = visibleBottom - visibleTop;
+	const auto destroyAfterDistance = visibleHeight * 2;
 	const auto destroyAbove = visibleTop - destroyAfterDistance;
 	const auto destroyBelow = visibleBottom + destroyAfterDistance;
+
+	// Prefetch a viewport of thumbnails in the scroll direction and just
+	// one row in the opposite one, so rows come on screen already drawn.
+	const auto preloadAbove = visibleTop
+		- (_scrollingDown ? _singleSize.height() : visibleHeight);
+	const auto preloadBelow = visibleBottom
+		+ (_scrollingDown ? visibleHeight : _singleSize.height());
 	enumerateSections([&](const SectionInfo &info) {
 		if (destroyBelow <= info.rowsTop
 			|| destroyAbove >= info.rowsBottom) {
 			clearHeavyIn(shownSets()[info.section]);
-		} else if ((visibleTop > info.rowsTop && visibleTop < info.rowsBottom)
+			return true;
+		}
+		if (preloadBelow > info.rowsTop && preloadAbove < info.rowsBottom) {
+			preloadThumbnailsIn(info, preloadAbove, preloadBelow);
+		}
+		if ((visibleTop > info.rowsTop && visibleTop < info.rowsBottom)
 			|| (visibleBottom > info.rowsTop
 				&& visibleBottom < info.rowsBottom)) {
 			pauseInvisibleLottieIn(info);
@@ -1665,6 +1681,32 @@ void StickersListWidget::checkVisibleLottie() {
 	});
 }
 
+void StickersListWidget::preloadThumbnailsIn(
+		const SectionInfo &info,
+		int fromTop,
+		int tillBottom) {
+	auto &set = shownSets()[info.section];
+	if (set.id == Stickers::MegagroupSetId && set.stickers.empty()) {
+		return;
+	}
+	const auto fromRow = floorclamp(fromTop - info.rowsTop, _singleSize.height(), 0, info.rowsCount);
+	const auto tillRow = ceilclamp(tillBottom - info.rowsTop, _singleSize.height(), 0, info.rowsCount);
+	for (auto i = fromRow; i != tillRow; ++i) {
+		for (auto j = 0; j != _columnCount; ++j) {
+			const auto index = i * _columnCount + j;
+			if (index >= info.count) {
+				break;
+			}
+			auto &sticker = set.stickers[index];
+			if (!sticker.savedFrame.isNull()) {
+				continue;
+			}
+			sticker.ensureMediaCreated();
+			sticker.documentMedia->checkStickerSmall();
+		}
+	}
+}
+
 void StickersListWidget::clearHeavyIn(Set &set, bool clearSavedFrames) {
 	const auto player = base::take(set.lottiePlayer);
 	const auto lifetime = base::take(set.lottieLifetime);
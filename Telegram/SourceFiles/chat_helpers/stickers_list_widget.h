@@ -266,6 +266,10 @@ private:
 	void markLottieFrameShown(Set &set);
 	void checkVisibleLottie();
 	void pauseInvisibleLottieIn(const SectionInfo &info);
+	void preloadThumbnailsIn(
+		const SectionInfo &info,
+		int fromTop,
+		int tillBottom);
 	void takeHeavyData(std::vector<Set> &to, std::vector<Set> &from);
 	void takeHeavyData(Set &to, Set &from);
 	void takeHeavyData(Sticker &to, Sticker &from);
@@ -328,6 +332,7 @@ private:
 	int _officialOffset = 0;
 
 	Section _section = Section::Stickers;
+	bool _scrollingDown = true;
 
 	bool _displayingSet = false;
 	uint64 _removingSetId = 0;
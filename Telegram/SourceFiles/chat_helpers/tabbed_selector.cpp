@@ -11,6 +11,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "chat_helpers/stickers_list_widget.h"
 #include "chat_helpers/gifs_list_widget.h"
 #include "chat_helpers/stickers.h"
+#include "base/call_delayed.h"
 #include "ui/widgets/buttons.h"
 #include "ui/widgets/labels.h"
 #include "ui/widgets/shadow.h"
@@ -28,6 +29,11 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "styles/style_chat_helpers.h"
 
 namespace ChatHelpers {
+namespace {
+
+constexpr auto kWarmUpSectionsTimeout = 5 * crl::time(1000);
+
+} // namespace
 
 class TabbedSelector::SlideAnimation : public Ui::RoundShadowAnimation {
 public:
@@ -370,6 +376,19 @@ TabbedSelector::TabbedSelector(
 		) | rpl::start_with_next([=] {
 			refreshStickers();
 		}, lifetime());
+
+		// The first open would otherwise fill all the sections with
+		// content synchronously, so warm them up shortly after startup,
+		// while the app is idle.
+		base::call_delayed(kWarmUpSectionsTimeout, this, [=] {
+			if (isHidden()) {
+				stickers()->refreshStickers();
+				for (auto &tab : _tabs) {
+					tab.widget()->refreshRecent();
+					tab.widget()->preloadImages();
+				}
+			}
+		});
 	}
 	//setAttribute(Qt::WA_AcceptTouchEvents);
 	setAttribute(Qt::WA_OpaquePaintEvent, false);
@@ -0,0 +1,129 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "core/alloc_stats.h"
+
+#include "core/crash_reports.h"
+#include "base/timer.h"
+
+#include <QtCore/QMutex>
+
+namespace Core {
+namespace AllocStats {
+namespace {
+
+constexpr auto kAnnotationRefreshInterval = 10 * crl::time(1000);
+
+QMutex RegistryMutex;
+
+// The crash handler reads this through an annotation ref, so it is
+// only ever modified on the main thread by the refresh timer.
+QString CrashAnnotationText;
+
+} // namespace
+
+struct Counter::Data {
+	const char *tag = nullptr;
+	std::atomic<int64> live = 0;
+	std::atomic<int64> peak = 0;
+	std::atomic<int64> totalAllocations = 0;
+	std::atomic<int64> totalBytes = 0;
+	std::atomic<int64> currentSecond = 0;
+	std::atomic<int64> allocationsThisSecond = 0;
+	std::atomic<int64> allocationsLastSecond = 0;
+};
+
+namespace {
+
+// Counters are static objects, the registry only ever grows.
+std::vector<std::unique_ptr<Counter::Data>> &Registry() {
+	static auto result = std::vector<std::unique_ptr<Counter::Data>>();
+	return result;
+}
+
+[[nodiscard]] QString FormatBytes(int64 bytes) {
+	if (bytes >= int64(1024 * 1024)) {
+		return qsl("%1 MB").arg(bytes / int64(1024 * 1024));
+	} else if (bytes >= 1024) {
+		return qsl("%1 KB").arg(bytes / 1024);
+	}
+	return qsl("%1 B").arg(bytes);
+}
+
+[[nodiscard]] QString BuildTable() {
+	auto result = QString();
+	QMutexLocker lock(&RegistryMutex);
+	for (const auto &data : Registry()) {
+		if (!result.isEmpty()) {
+			result += '\n';
+		}
+		result += qsl("%1: live %2, peak %3, allocs %4 (%5/s)"
+		).arg(QString::fromLatin1(data->tag)
+		).arg(FormatBytes(data->live.load())
+		).arg(FormatBytes(data->peak.load())
+		).arg(data->totalAllocations.load()
+		).arg(data->allocationsLastSecond.load());
+	}
+	return result;
+}
+
+} // namespace
+
+Counter::Counter(const char *tag)
+: _data([&] {
+	auto data = std::make_unique<Data>();
+	data->tag = tag;
+	const auto raw = data.get();
+	QMutexLocker lock(&RegistryMutex);
+	Registry().push_back(std::move(data));
+	return raw;
+}()) {
+}
+
+void Counter::allocated(int64 bytes) {
+	const auto live = (_data->live += bytes);
+	auto peak = _data->peak.load();
+	while (live > peak && !_data->peak.compare_exchange_weak(peak, live)) {
+	}
+	++_data->totalAllocations;
+	_data->totalBytes += bytes;
+
+	// Per-second rate bookkeeping is racy by design, the numbers are
+	// indicative and must not slow the allocation path down.
+	const auto second = int64(crl::now() / 1000);
+	if (_data->currentSecond.load() != second) {
+		_data->currentSecond = second;
+		_data->allocationsLastSecond
+			= _data->allocationsThisSecond.exchange(0);
+	}
+	++_data->allocationsThisSecond;
+}
+
+void Counter::freed(int64 bytes) {
+	_data->live -= bytes;
+}
+
+QString ReportString() {
+	const auto table = BuildTable();
+	return table.isEmpty()
+		? qsl("Allocation stats: no counters registered.")
+		: qsl("Allocation stats:\n") + table;
+}
+
+void StartCrashAnnotation() {
+	CrashReports::SetAnnotationRef(
+		"AllocationStats",
+		&CrashAnnotationText);
+
+	static auto timer = base::Timer([] {
+		CrashAnnotationText = BuildTable().replace('\n', qsl(" | "));
+	});
+	timer.callEach(kAnnotationRefreshInterval);
+}
+
+} // namespace AllocStats
+} // namespace Core
@@ -0,0 +1,40 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+namespace Core {
+namespace AllocStats {
+
+// A per-tag allocation counter for pools and arenas, updated
+// incrementally by the owning code. Counters are meant to live for
+// the whole process (static storage), the registry is append-only.
+// All methods are thread safe and cheap enough for allocation paths.
+class Counter final {
+public:
+	explicit Counter(const char *tag);
+
+	void allocated(int64 bytes);
+	void freed(int64 bytes);
+
+private:
+	struct Data;
+	not_null<Data*> _data;
+
+};
+
+// One line per tag: live / peak bytes, total allocations and the
+// recent allocations-per-second rate.
+[[nodiscard]] QString ReportString();
+
+// Registers a crash report annotation with the current table and
+// keeps refreshing it, so OOM crash dumps arrive with attribution.
+// Called once at startup from the main thread.
+void StartCrashAnnotation();
+
+} // namespace AllocStats
+} // namespace Core
@@ -16,7 +16,11 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "base/unixtime.h"
 #include "core/update_checker.h"
 #include "core/shortcuts.h"
+#include "core/frame_hud.h"
+#include "core/alloc_stats.h"
 #include "core/sandbox.h"
+#include "core/startup_profiler.h"
+#include "core/idle_maintenance.h"
 #include "core/local_url_handlers.h"
 #include "core/launcher.h"
 #include "core/ui_integration.h"
@@ -36,6 +40,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "lang/lang_hardcoded.h"
 #include "observer_peer.h"
 #include "storage/storage_databases.h"
+#include "storage/cache_statistics.h"
 #include "mainwidget.h"
 #include "core/file_utilities.h"
 #include "main/main_account.h"
@@ -124,6 +129,8 @@ Application::Application(not_null<Launcher*> launcher)
 }
 
 Application::~Application() {
+	IdleMaintenance::Stop();
+
 	_window.reset();
 	if (_mediaView) {
 		_mediaView->clearData();
@@ -132,6 +139,9 @@ Application::~Application() {
 
 	if (activeAccount().sessionExists()) {
 		activeAccount().session().saveSettingsNowIfNeeded();
+		Local::writeSharedMediaCounts();
+		Local::writeDialogsSnapshot();
+		Local::writeSearchIndex();
 	}
 
 	// This can call writeMap() that serializes Main::Session.
@@ -162,12 +172,16 @@ Application::~Application() {
 }
 
 void Application::run() {
+	StartupProfiler::Stage("fonts & third party");
+
 	style::internal::StartFonts();
 
 	ThirdParty::start();
 	Global::start();
 	refreshGlobalProxy(); // Depends on Global::started().
 
+	StartupProfiler::Stage("local storage");
+
 	startLocalStorage();
 	ValidateScale();
 
@@ -188,9 +202,14 @@ void Application::run() {
 	_translator = std::make_unique<Lang::Translator>();
 	QCoreApplication::instance()->installTranslator(_translator.get());
 
+	StartupProfiler::Stage("styles & emoji");
+
 	style::startManager(cScale());
 	Ui::InitTextOptions();
 	Ui::Emoji::Init();
+
+	StartupProfiler::Stage("audio");
+
 	Media::Player::start(_audio.get());
 
 	style::ShortAnimationPlaying(
@@ -209,7 +228,13 @@ void Application::run() {
 	DEBUG_LOG(("Application Info: starting app..."));
 
 	// Create mime database, so it won't be slow later.
-	QMimeDatabase().mimeTypeForName(qsl("text/plain"));
+	// The internal cache is shared and guarded by a mutex, so it can
+	// be warmed up on a worker thread off the startup critical path.
+	crl::async([] {
+		QMimeDatabase().mimeTypeForName(qsl("text/plain"));
+	});
+
+	StartupProfiler::Stage("window");
 
 	_window = std::make_unique<Window::Controller>(&activeAccount());
 
@@ -223,14 +248,53 @@ void Application::run() {
 	DEBUG_LOG(("Application Info: window created..."));
 
 	startShortcuts();
+	AllocStats::StartCrashAnnotation();
+	Storage::CacheStats::StartSummaryTimer();
 	App::initMedia();
 
+	StartupProfiler::Stage("first show");
+
+	_window->widget()->show();
+
+	DEBUG_LOG(("Application Info: showing."));
+	_window->finishFirstShow();
+
+	_window->updateIsActive(Global::OnlineFocusTimeout());
+
+	for (const auto &error : Shortcuts::Errors()) {
+		LOG(("Shortcuts Error: %1").arg(error));
+	}
+
+	// The local map read and the session setup take long enough to miss
+	// the first paint, so let the event loop paint the bare window frame
+	// with the themed background before they run. The dialogs fill the
+	// frame in a moment once the map is read and the session is set up.
+	crl::on_main(this, [=] {
+		startSessionAfterFirstShow();
+	});
+
+	IdleMaintenance::Start();
+}
+
+void Application::startSessionAfterFirstShow() {
+	StartupProfiler::Stage("local map & mtp");
+
 	Local::ReadMapState state = Local::readMap(QByteArray());
 	if (state == Local::ReadMapPassNeeded) {
 		Global::SetLocalPasscode(true);
 		Global::RefLocalPasscodeChanged().notify();
 		lockByPasscode();
 		DEBUG_LOG(("Application Info: passcode needed..."));
+
+		// The initial work mode could have minimized the window before
+		// the passcode requirement was known, while a locked window
+		// should stay visible on autostart so the passcode can be
+		// entered right away.
+		if (cLaunchMode() == LaunchModeAutoStart
+			&& cStartMinimized()
+			&& !cStartInTray()) {
+			_window->widget()->showFromTray();
+		}
 	} else {
 		DEBUG_LOG(("Application Info: local map read..."));
 		activeAccount().startMtp();
@@ -242,24 +306,21 @@ void Application::run() {
 		}
 	}
 
-	_window->widget()->show();
-
-	const auto currentGeometry = _window->widget()->geometry();
-	_mediaView = std::make_unique<Media::View::OverlayWidget>();
-	_window->widget()->setGeometry(currentGeometry);
-
-	DEBUG_LOG(("Application Info: showing."));
-	_window->finishFirstShow();
-
 	if (!locked() && cStartToSettings()) {
 		_window->showSettings();
 	}
+}
 
-	_window->updateIsActive(Global::OnlineFocusTimeout());
-
-	for (const auto &error : Shortcuts::Errors()) {
-		LOG(("Shortcuts Error: %1").arg(error));
+// The media view overlay is a heavy fullscreen widget, so it is
+// created lazily on the first request instead of before the first
+// paint of the main window.
+void Application::ensureMediaViewCreated() {
+	if (_mediaView) {
+		return;
 	}
+	const auto currentGeometry = _window->widget()->geometry();
+	_mediaView = std::make_unique<Media::View::OverlayWidget>();
+	_window->widget()->setGeometry(currentGeometry);
 }
 
 bool Application::hideMediaView() {
@@ -283,7 +344,7 @@ void Application::showPhoto(not_null<const PhotoOpenClickHandler*> link) {
 }
 
 void Application::showPhoto(not_null<PhotoData*> photo, HistoryItem *item) {
-	Expects(_mediaView != nullptr);
+	ensureMediaViewCreated();
 
 	_mediaView->showPhoto(photo, item);
 	_mediaView->activateWindow();
@@ -293,7 +354,7 @@ void Application::showPhoto(not_null<PhotoData*> photo, HistoryItem *item) {
 void Application::showPhoto(
 		not_null<PhotoData*> photo,
 		not_null<PeerData*> peer) {
-	Expects(_mediaView != nullptr);
+	ensureMediaViewCreated();
 
 	_mediaView->showPhoto(photo, peer);
 	_mediaView->activateWindow();
@@ -301,7 +362,7 @@ void Application::showPhoto(
 }
 
 void Application::showDocument(not_null<DocumentData*> document, HistoryItem *item) {
-	Expects(_mediaView != nullptr);
+	ensureMediaViewCreated();
 
 	if (cUseExternalVideoPlayer()
 		&& document->isVideoFile()
@@ -317,7 +378,7 @@ void Application::showDocument(not_null<DocumentData*> document, HistoryItem *it
 void Application::showTheme(
 		not_null<DocumentData*> document,
 		const Data::CloudTheme &cloud) {
-	Expects(_mediaView != nullptr);
+	ensureMediaViewCreated();
 
 	_mediaView->showTheme(document, cloud);
 	_mediaView->activateWindow();
@@ -488,7 +549,7 @@ void Application::call_handleUnreadCounterUpdate() {
 }
 
 void Application::call_handleDelayedPeerUpdates() {
-	Notify::peerUpdatedSendDelayed();
+	Notify::peerUpdatedSendDelayedAligned();
 }
 
 void Application::call_handleObservables() {
@@ -892,6 +953,10 @@ void Application::startShortcuts() {
 		request->check(Command::Close) && request->handle([=] {
 			return closeActiveWindow();
 		});
+		request->check(Command::ToggleFrameHud) && request->handle([] {
+			FrameHud::Toggle();
+			return true;
+		});
 	}, _lifetime);
 }
 
@@ -233,7 +233,9 @@ private:
 	friend Application &App();
 
 	void startLocalStorage();
+	void startSessionAfterFirstShow();
 	void startShortcuts();
+	void ensureMediaViewCreated();
 
 	void stateChanged(Qt::ApplicationState state);
 
@@ -10,20 +10,59 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "storage/serialize_common.h"
 
 namespace Core {
+namespace {
+
+// The legacy format starts with the serialized accent colors QByteArray,
+// so its size field can never match this tag.
+constexpr auto kSectionedTag = quint32(0xFFFFFFF0);
+
+} // namespace
 
 Settings::Variables::Variables() {
 }
 
+QByteArray Settings::serializeSection(Section section) const {
+	switch (section) {
+	case Section::Themes:
+		return _variables.themesAccentColors.serialize();
+	case Section::Video: {
+		auto result = QByteArray();
+		{
+			QDataStream stream(&result, QIODevice::WriteOnly);
+			stream.setVersion(QDataStream::Qt_5_1);
+			stream << qint32(_variables.hardwareAcceleratedVideo ? 1 : 0);
+		}
+		return result;
+	}
+	}
+	Unexpected("Section in Settings::serializeSection.");
+}
+
 QByteArray Settings::serialize() const {
-	const auto themesAccentColors = _variables.themesAccentColors.serialize();
-	auto size = Serialize::bytearraySize(themesAccentColors);
+	const auto refresh = [&](Section section) {
+		const auto id = quint32(section);
+		if ((_dirty & id) || !_sections.contains(id)) {
+			_sections[id] = serializeSection(section);
+		}
+	};
+	refresh(Section::Themes);
+	refresh(Section::Video);
+	_dirty = 0;
+
+	auto size = int(sizeof(quint32) + sizeof(qint32));
+	for (const auto &[id, payload] : _sections) {
+		size += sizeof(quint32) + Serialize::bytearraySize(payload);
+	}
 
 	auto result = QByteArray();
 	result.reserve(size);
 	{
 		QDataStream stream(&result, QIODevice::WriteOnly);
 		stream.setVersion(QDataStream::Qt_5_1);
-		stream << themesAccentColors;
+		stream << kSectionedTag << qint32(_sections.size());
+		for (const auto &[id, payload] : _sections) {
+			stream << id << payload;
+		}
 	}
 	return result;
 }
@@ -33,11 +72,69 @@ void Settings::constructFromSerialized(const QByteArray &serialized) {
 		return;
 	}
 
+	QDataStream stream(serialized);
+	stream.setVersion(QDataStream::Qt_5_1);
+	quint32 tag = 0;
+	stream >> tag;
+	if (stream.status() != QDataStream::Ok) {
+		LOG(("App Error: "
+			"Bad data for Core::Settings::constructFromSerialized()"));
+		return;
+	} else if (tag != kSectionedTag) {
+		constructFromLegacySerialized(serialized);
+		return;
+	}
+
+	qint32 count = 0;
+	stream >> count;
+	if (stream.status() != QDataStream::Ok || count < 0) {
+		LOG(("App Error: "
+			"Bad data for Core::Settings::constructFromSerialized()"));
+		return;
+	}
+	for (auto i = 0; i != count; ++i) {
+		auto id = quint32();
+		auto payload = QByteArray();
+		stream >> id >> payload;
+		if (stream.status() != QDataStream::Ok) {
+			LOG(("App Error: "
+				"Bad data for Core::Settings::constructFromSerialized()"));
+			return;
+		}
+		// Sections from future versions are kept and written back.
+		_sections[id] = payload;
+		applySection(id, payload);
+	}
+	_dirty = 0;
+}
+
+void Settings::applySection(quint32 id, const QByteArray &payload) {
+	switch (Section(id)) {
+	case Section::Themes:
+		_variables.themesAccentColors.setFromSerialized(payload);
+		break;
+	case Section::Video: {
+		QDataStream stream(payload);
+		stream.setVersion(QDataStream::Qt_5_1);
+		qint32 value = 0;
+		stream >> value;
+		if (stream.status() == QDataStream::Ok) {
+			_variables.hardwareAcceleratedVideo = (value == 1);
+		}
+	} break;
+	}
+}
+
+void Settings::constructFromLegacySerialized(const QByteArray &serialized) {
 	QDataStream stream(serialized);
 	stream.setVersion(QDataStream::Qt_5_1);
 	QByteArray themesAccentColors;
+	qint32 hardwareAcceleratedVideo = 0;
 
 	stream >> themesAccentColors;
+	if (!stream.atEnd()) {
+		stream >> hardwareAcceleratedVideo;
+	}
 	if (stream.status() != QDataStream::Ok) {
 		LOG(("App Error: "
 			"Bad data for Core::Settings::constructFromSerialized()"));
@@ -46,6 +143,7 @@ void Settings::constructFromSerialized(const QByteArray &serialized) {
 	if (!_variables.themesAccentColors.setFromSerialized(themesAccentColors)) {
 		return;
 	}
+	_variables.hardwareAcceleratedVideo = (hardwareAcceleratedVideo == 1);
 }
 
 } // namespace Core
@@ -7,6 +7,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 */
 #pragma once
 
+#include "base/flat_map.h"
 #include "window/themes/window_themes_embedded.h"
 
 namespace Core {
@@ -15,25 +16,57 @@ class Settings final {
 public:
 	void moveFrom(Settings &&other) {
 		_variables = std::move(other._variables);
+		_sections = std::move(other._sections);
+		_dirty = other._dirty;
 	}
 	[[nodiscard]] QByteArray serialize() const;
 	void constructFromSerialized(const QByteArray &serialized);
 
 	void setThemesAccentColors(Window::Theme::AccentColors &&colors) {
 		_variables.themesAccentColors = std::move(colors);
+		markDirty(Section::Themes);
 	}
 	[[nodiscard]] Window::Theme::AccentColors &themesAccentColors() {
+		// The colors may be changed through the returned reference.
+		markDirty(Section::Themes);
 		return _variables.themesAccentColors;
 	}
+	void setHardwareAcceleratedVideo(bool value) {
+		if (_variables.hardwareAcceleratedVideo != value) {
+			_variables.hardwareAcceleratedVideo = value;
+			markDirty(Section::Video);
+		}
+	}
+	[[nodiscard]] bool hardwareAcceleratedVideo() const {
+		return _variables.hardwareAcceleratedVideo;
+	}
 
 private:
+	// Sections are serialized independently, so a change re-serializes
+	// only the section it belongs to, while sections unknown to this
+	// version are written back unchanged.
+	enum class Section : quint32 {
+		Themes = 0x01,
+		Video = 0x02,
+	};
+
 	struct Variables {
 		Variables();
 
 		Window::Theme::AccentColors themesAccentColors;
+		bool hardwareAcceleratedVideo = false;
 	};
 
+	void markDirty(Section section) {
+		_dirty |= quint32(section);
+	}
+	[[nodiscard]] QByteArray serializeSection(Section section) const;
+	void applySection(quint32 id, const QByteArray &payload);
+	void constructFromLegacySerialized(const QByteArray &serialized);
+
 	Variables _variables;
+	mutable base::flat_map<quint32, QByteArray> _sections;
+	mutable quint32 _dirty = ~quint32(0);
 
 };
 
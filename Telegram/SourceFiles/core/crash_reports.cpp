@@ -10,6 +10,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "platform/platform_specific.h"
 #include "base/platform/base_platform_info.h"
 #include "core/launcher.h"
+#include "logs.h"
 
 #include <signal.h>
 #include <new>
@@ -170,6 +171,8 @@ void SignalHandler(int signum) {
 	QMutexLocker lock(&ReportingMutex);
 	ReportingThreadId = thread;
 
+	Logs::flushBufferedForCrash();
+
 	if (!ReportingHeaderWritten) {
 		ReportingHeaderWritten = true;
 		auto dec2hex = [](int value) -> char {
@@ -0,0 +1,102 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "core/dispatch_tracer.h"
+
+#include "logs.h"
+
+namespace Core {
+namespace DispatchTracer {
+namespace {
+
+constexpr auto kRingSize = 4096; // entries, oldest overwritten first.
+constexpr auto kReportOrigins = 16;
+
+struct Entry {
+	const char *origin = nullptr;
+	crl::time enqueued = 0;
+	crl::time started = 0;
+	crl::time finished = 0;
+};
+
+// Written only from Record(), which runs on the main thread because
+// that is where the traced callbacks run. No locking required.
+Entry Ring[kRingSize];
+int RingNext = 0;
+
+} // namespace
+
+bool Enabled() {
+	return Logs::DebugEnabled();
+}
+
+void Record(
+		const char *origin,
+		crl::time enqueued,
+		crl::time started,
+		crl::time finished) {
+	auto &entry = Ring[RingNext];
+	RingNext = (RingNext + 1) % kRingSize;
+	entry = { origin, enqueued, started, finished };
+	TraceEvents::RecordTask(origin, enqueued, started, finished);
+}
+
+QString ReportString(crl::time window) {
+	struct Stats {
+		int count = 0;
+		crl::time wait = 0;
+		crl::time maxWait = 0;
+		crl::time run = 0;
+		crl::time maxRun = 0;
+	};
+	const auto since = crl::now() - window;
+	auto byOrigin = base::flat_map<QString, Stats>();
+	for (const auto &entry : Ring) {
+		if (!entry.origin || entry.finished < since) {
+			continue;
+		}
+		auto &stats = byOrigin[QString::fromLatin1(entry.origin)];
+		const auto wait = entry.started - entry.enqueued;
+		const auto run = entry.finished - entry.started;
+		++stats.count;
+		stats.wait += wait;
+		stats.maxWait = std::max(stats.maxWait, wait);
+		stats.run += run;
+		stats.maxRun = std::max(stats.maxRun, run);
+	}
+	if (byOrigin.empty()) {
+		return qsl("No traced main queue activity in the last %1s."
+		).arg(window / 1000);
+	}
+	auto sorted = std::vector<std::pair<QString, Stats>>();
+	sorted.reserve(byOrigin.size());
+	for (const auto &[origin, stats] : byOrigin) {
+		sorted.push_back({ origin, stats });
+	}
+	ranges::sort(sorted, std::greater<>(), [](const auto &pair) {
+		return pair.second.run;
+	});
+	auto result = qsl("Main queue consumers, last %1s:").arg(window / 1000);
+	auto listed = 0;
+	for (const auto &[origin, stats] : sorted) {
+		if (++listed > kReportOrigins) {
+			break;
+		}
+		result += qsl("\n%1: %2 hops, queue %3 / %4 ms avg / max, "
+			"run %5 / %6 ms total / max"
+		).arg(origin
+		).arg(stats.count
+		).arg(stats.wait / stats.count
+		).arg(stats.maxWait
+		).arg(stats.run
+		).arg(stats.maxRun);
+	}
+	return result;
+}
+
+} // namespace DispatchTracer
+} // namespace Core
@@ -0,0 +1,92 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include "core/trace_events.h"
+
+namespace Core {
+namespace DispatchTracer {
+
+// Tracing is active only while DEBUG logs are enabled or a Chrome
+// trace capture is running, so the wrappers cost a couple of checks
+// on the release path.
+[[nodiscard]] bool Enabled();
+
+// Called by Wrap() on the main thread after a traced callback ran.
+void Record(
+	const char *origin,
+	crl::time enqueued,
+	crl::time started,
+	crl::time finished);
+
+// Per-origin "count, queue wait, run duration" lines aggregated over
+// the last |window| milliseconds, heaviest consumers first.
+[[nodiscard]] QString ReportString(crl::time window = crl::time(10000));
+
+// Attaches an origin tag to a callback about to be queued to the main
+// thread. The enqueue time is captured here, the queue wait and run
+// duration are recorded when the callback actually runs.
+template <typename Callable>
+[[nodiscard]] auto Wrap(const char *origin, Callable &&callback) {
+	return [
+		origin,
+		enqueued = crl::now(),
+		callback = std::forward<Callable>(callback)
+	]() mutable {
+		const auto started = crl::now();
+		callback();
+		Record(origin, enqueued, started, crl::now());
+	};
+}
+
+// Drop-in replacements for crl::on_main with an origin tag attached.
+template <typename Callable>
+void OnMain(const char *origin, Callable &&callback) {
+	if (!Enabled() && !TraceEvents::Capturing()) {
+		crl::on_main(std::forward<Callable>(callback));
+	} else {
+		crl::on_main(Wrap(origin, std::forward<Callable>(callback)));
+	}
+}
+
+template <typename Guard, typename Callable>
+void OnMain(const char *origin, Guard &&guard, Callable &&callback) {
+	if (!Enabled() && !TraceEvents::Capturing()) {
+		crl::on_main(
+			std::forward<Guard>(guard),
+			std::forward<Callable>(callback));
+	} else {
+		crl::on_main(
+			std::forward<Guard>(guard),
+			Wrap(origin, std::forward<Callable>(callback)));
+	}
+}
+
+// Drop-in replacement for crl::async: while a trace capture runs the
+// task shows up as a span under its worker thread id, with the queue
+// wait attached. Recording goes straight to TraceEvents because the
+// callback finishes on the worker thread.
+template <typename Callable>
+void Async(const char *origin, Callable &&callback) {
+	if (!TraceEvents::Capturing()) {
+		crl::async(std::forward<Callable>(callback));
+	} else {
+		crl::async([
+			origin,
+			enqueued = crl::now(),
+			callback = std::forward<Callable>(callback)
+		]() mutable {
+			const auto started = crl::now();
+			callback();
+			TraceEvents::RecordTask(origin, enqueued, started, crl::now());
+		});
+	}
+}
+
+} // namespace DispatchTracer
+} // namespace Core
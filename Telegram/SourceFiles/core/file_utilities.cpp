@@ -11,6 +11,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "platform/platform_file_utilities.h"
 #include "core/application.h"
 #include "base/unixtime.h"
+#include "base/timer.h"
 #include "ui/delayed_activation.h"
 #include "mainwindow.h"
 
@@ -19,6 +20,67 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include <QtCore/QStandardPaths>
 #include <QtGui/QDesktopServices>
 
+namespace {
+
+constexpr auto kDialogStallCheckEach = crl::time(100);
+constexpr auto kDialogStallReportThreshold = crl::time(500);
+
+// The native dialog call blocks until the dialog is closed, relying on
+// a nested (or the platform) event loop to keep servicing our timers
+// and sockets meanwhile. If it fails to do that MTP and animations
+// freeze, so watch the gaps between ticks of a fast timer while the
+// dialog is up and report the longest one.
+class DialogStallWatcher {
+public:
+	DialogStallWatcher()
+	: _timer([=] { tick(); })
+	, _lastTick(crl::now()) {
+		_timer.callEach(kDialogStallCheckEach);
+	}
+	~DialogStallWatcher() {
+		const auto longest = std::max(
+			_longestGap,
+			crl::now() - _lastTick);
+		if (longest >= kDialogStallReportThreshold) {
+			LOG(("FileDialog Warning: main loop stalled for %1 ms "
+				"while a native dialog was up.").arg(longest));
+		}
+	}
+
+private:
+	void tick() {
+		const auto now = crl::now();
+		_longestGap = std::max(_longestGap, now - _lastTick);
+		_lastTick = now;
+	}
+
+	base::Timer _timer;
+	crl::time _lastTick = 0;
+	crl::time _longestGap = 0;
+
+};
+
+bool GetWatched(
+		QPointer<QWidget> parent,
+		QStringList &files,
+		QByteArray &remoteContent,
+		const QString &caption,
+		const QString &filter,
+		FileDialog::internal::Type type,
+		QString startFile = QString()) {
+	const auto watcher = DialogStallWatcher();
+	return Platform::FileDialog::Get(
+		parent,
+		files,
+		remoteContent,
+		caption,
+		filter,
+		type,
+		startFile);
+}
+
+} // namespace
+
 bool filedialogGetSaveFile(
 		QPointer<QWidget> parent,
 		QString &file,
@@ -28,7 +90,7 @@ bool filedialogGetSaveFile(
 	QStringList files;
 	QByteArray remoteContent;
 	Ui::PreventDelayedActivation();
-	bool result = Platform::FileDialog::Get(
+	bool result = GetWatched(
 		parent,
 		files,
 		remoteContent,
@@ -197,7 +259,7 @@ void GetOpenPath(
 		auto files = QStringList();
 		auto remoteContent = QByteArray();
 		Ui::PreventDelayedActivation();
-		const auto success = Platform::FileDialog::Get(
+		const auto success = GetWatched(
 			parent,
 			files,
 			remoteContent,
@@ -231,7 +293,7 @@ void GetOpenPaths(
 		auto files = QStringList();
 		auto remoteContent = QByteArray();
 		Ui::PreventDelayedActivation();
-		const auto success = Platform::FileDialog::Get(
+		const auto success = GetWatched(
 			parent,
 			files,
 			remoteContent,
@@ -280,7 +342,7 @@ void GetFolder(
 		auto files = QStringList();
 		auto remoteContent = QByteArray();
 		Ui::PreventDelayedActivation();
-		const auto success = Platform::FileDialog::Get(
+		const auto success = GetWatched(
 			parent,
 			files,
 			remoteContent,
@@ -0,0 +1,228 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "core/frame_hud.h"
+
+#include "mainwindow.h"
+#include "settings.h"
+
+#include <QtCore/QFile>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+
+namespace Core {
+namespace FrameHud {
+namespace {
+
+constexpr auto kFrameHistory = 300; // Frames kept for the jank dump.
+constexpr auto kJankThreshold = crl::time(34); // Two vsyncs at 60 Hz.
+constexpr auto kDumpCooldown = crl::time(5000);
+constexpr auto kLatencyProbeEachFrames = 32;
+constexpr auto kAverageWindow = crl::time(2000);
+constexpr auto kHudPadding = 6;
+
+struct Frame {
+	const char *section = nullptr;
+	QRect region;
+	crl::time started = 0;
+	crl::time paint = 0;
+	crl::time gap = 0; // Since the previous frame of the same section.
+	crl::time latency = 0; // Event loop latency from the latest probe.
+};
+
+// All the state is main thread only, like the paint events feeding it.
+bool HudEnabled/* = false*/;
+Frame Frames[kFrameHistory];
+int FramesNext/* = 0*/;
+crl::time LoopLatency/* = 0*/;
+bool LatencyProbePending/* = false*/;
+int FramesSinceProbe/* = 0*/;
+crl::time LastDumpTime/* = 0*/;
+base::flat_map<const char*, crl::time> LastFrameStart;
+
+void ProbeLoopLatency() {
+	if (LatencyProbePending) {
+		return;
+	}
+	LatencyProbePending = true;
+	const auto scheduled = crl::now();
+	crl::on_main([=] {
+		LoopLatency = crl::now() - scheduled;
+		LatencyProbePending = false;
+	});
+}
+
+void DumpJankFrames(crl::time now) {
+	LastDumpTime = now;
+
+	auto list = QJsonArray();
+	for (auto i = 0; i != kFrameHistory; ++i) {
+		const auto &frame = Frames[(FramesNext + i) % kFrameHistory];
+		if (!frame.section) {
+			continue;
+		}
+		auto entry = QJsonObject();
+		entry["section"] = QString::fromLatin1(frame.section);
+		entry["region"] = qsl("%1,%2 %3x%4"
+		).arg(frame.region.x()
+		).arg(frame.region.y()
+		).arg(frame.region.width()
+		).arg(frame.region.height());
+		entry["started"] = frame.started;
+		entry["paint_ms"] = frame.paint;
+		entry["gap_ms"] = frame.gap;
+		entry["loop_latency_ms"] = frame.latency;
+		list.append(entry);
+	}
+
+	const auto path = cWorkingDir() + qsl("jank_frames.json");
+	auto file = QFile(path);
+	if (file.open(QIODevice::WriteOnly)) {
+		file.write(QJsonDocument(list).toJson(QJsonDocument::Indented));
+		LOG(("HUD Info: Jank detected, %1 frames dumped to '%2'."
+			).arg(list.size()
+			).arg(path));
+	}
+}
+
+void RecordFrame(const Frame &frame) {
+	Frames[FramesNext] = frame;
+	FramesNext = (FramesNext + 1) % kFrameHistory;
+
+	if (++FramesSinceProbe >= kLatencyProbeEachFrames) {
+		FramesSinceProbe = 0;
+		ProbeLoopLatency();
+	}
+
+	const auto janky = (frame.paint > kJankThreshold)
+		|| (frame.gap > 0 && frame.gap > 2 * kJankThreshold);
+	const auto now = frame.started + frame.paint;
+	if (janky && now - LastDumpTime > kDumpCooldown) {
+		DumpJankFrames(now);
+	}
+}
+
+void PaintHud(Painter &p, const char *section, int outerWidth) {
+	const auto now = crl::now();
+	auto count = 0;
+	auto paintTotal = crl::time(0);
+	auto paintMax = crl::time(0);
+	auto gapTotal = crl::time(0);
+	auto gapMax = crl::time(0);
+	for (const auto &frame : Frames) {
+		if (frame.section != section
+			|| frame.started < now - kAverageWindow) {
+			continue;
+		}
+		++count;
+		paintTotal += frame.paint;
+		paintMax = std::max(paintMax, frame.paint);
+		gapTotal += frame.gap;
+		gapMax = std::max(gapMax, frame.gap);
+	}
+	const auto lines = QStringList{
+		qsl("%1 (%2 frames)").arg(section).arg(count),
+		qsl("paint %1 / %2 ms"
+		).arg(count ? paintTotal / count : 0
+		).arg(paintMax),
+		qsl("frame %1 / %2 ms"
+		).arg(count ? gapTotal / count : 0
+		).arg(gapMax),
+		qsl("loop latency %1 ms").arg(LoopLatency),
+	};
+
+	auto textWidth = 0;
+	for (const auto &line : lines) {
+		textWidth = std::max(textWidth, st::normalFont->width(line));
+	}
+	const auto width = textWidth + 2 * kHudPadding;
+	const auto height = lines.size() * st::normalFont->height
+		+ 2 * kHudPadding;
+	const auto rect = QRect(outerWidth - width, 0, width, height);
+
+	p.fillRect(rect, QColor(0, 0, 0, 160));
+	p.setFont(st::normalFont);
+	p.setPen(QColor(255, 255, 255));
+	auto top = rect.y() + kHudPadding;
+	for (const auto &line : lines) {
+		p.drawText(
+			rect.x() + kHudPadding,
+			top + st::normalFont->ascent,
+			line);
+		top += st::normalFont->height;
+	}
+}
+
+} // namespace
+
+bool Enabled() {
+	return HudEnabled;
+}
+
+void Toggle() {
+	HudEnabled = !HudEnabled;
+	for (auto &frame : Frames) {
+		frame = Frame();
+	}
+	FramesNext = 0;
+	LoopLatency = 0;
+	FramesSinceProbe = 0;
+	LastFrameStart.clear();
+	if (const auto window = App::wnd()) {
+		window->update();
+	}
+}
+
+FramesSummary SummarizeSince(crl::time since) {
+	auto result = FramesSummary();
+	for (const auto &frame : Frames) {
+		if (!frame.section || frame.started < since) {
+			continue;
+		}
+		++result.frames;
+		result.paintTotal += frame.paint;
+		result.paintMax = std::max(result.paintMax, frame.paint);
+	}
+	return result;
+}
+
+PaintScope::PaintScope(
+	Painter &p,
+	const char *section,
+	QRect region,
+	int outerWidth)
+: _p(p)
+, _section(section)
+, _region(region)
+, _outerWidth(outerWidth)
+, _started(HudEnabled ? crl::now() : 0) {
+}
+
+PaintScope::~PaintScope() {
+	if (!_started) {
+		return;
+	}
+	auto frame = Frame();
+	frame.section = _section;
+	frame.region = _region;
+	frame.started = _started;
+	frame.paint = crl::now() - _started;
+	const auto i = LastFrameStart.find(_section);
+	if (i != end(LastFrameStart)) {
+		frame.gap = _started - i->second;
+		i->second = _started;
+	} else {
+		LastFrameStart.emplace(_section, _started);
+	}
+	frame.latency = LoopLatency;
+	RecordFrame(frame);
+	PaintHud(_p, _section, _outerWidth);
+}
+
+} // namespace FrameHud
+} // namespace Core
@@ -0,0 +1,55 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+class Painter;
+
+namespace Core {
+namespace FrameHud {
+
+[[nodiscard]] bool Enabled();
+void Toggle();
+
+struct FramesSummary {
+	int frames = 0;
+	crl::time paintTotal = 0;
+	crl::time paintMax = 0;
+};
+
+// Aggregates the recorded frames started after |since| across all
+// sections; only meaningful while the HUD recording is toggled on.
+[[nodiscard]] FramesSummary SummarizeSince(crl::time since);
+
+// Attributes one paintEvent to a top-level section ("dialogs",
+// "history"). Records the paint duration and the gap to the previous
+// frame of the same section, probes the event loop latency and, when a
+// frame exceeds the jank threshold, dumps the recent frame history to
+// jank_frames.json in the working directory. While the HUD is toggled
+// on the destructor also paints rolling statistics in the top right
+// corner of the section, so it must be constructed after the Painter
+// and before any painting.
+class PaintScope {
+public:
+	PaintScope(
+		Painter &p,
+		const char *section,
+		QRect region,
+		int outerWidth);
+	~PaintScope();
+
+private:
+	Painter &_p;
+	const char *_section = nullptr;
+	QRect _region;
+	int _outerWidth = 0;
+	crl::time _started = 0;
+
+};
+
+} // namespace FrameHud
+} // namespace Core
@@ -0,0 +1,136 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "core/idle_maintenance.h"
+
+#include "core/application.h"
+#include "ui/image/image.h"
+#include "base/timer.h"
+#include "logs.h"
+
+#ifdef Q_OS_LINUX
+#include <malloc.h>
+#endif // Q_OS_LINUX
+
+namespace Core {
+namespace IdleMaintenance {
+namespace {
+
+constexpr auto kCheckEach = 10 * crl::time(1000);
+constexpr auto kUserIdleAfter = 60 * crl::time(1000);
+
+// An idle user means no input-driven frames, so a few milliseconds of
+// cleanup per check stay invisible even if an animation is running.
+constexpr auto kSliceBudget = crl::time(8);
+
+void CheckIdle();
+
+struct Task {
+	QString name;
+	Fn<int64()> run;
+	int64 reclaimed = 0;
+	int runs = 0;
+};
+
+struct State {
+	State() : timer([] { CheckIdle(); }) {
+	}
+
+	base::Timer timer;
+	std::vector<Task> tasks;
+	int next = 0;
+};
+
+State *Instance = nullptr;
+
+[[nodiscard]] bool UserIsIdle() {
+	return (crl::now() - App().lastNonIdleTime()) >= kUserIdleAfter;
+}
+
+void RunSlice() {
+	const auto state = Instance;
+	const auto count = int(state->tasks.size());
+	const auto started = crl::now();
+	auto reclaimed = int64(0);
+	// Each task gets at most one step per slice, so a single expensive
+	// task cannot starve the others.
+	for (auto i = 0; i != count; ++i) {
+		if (crl::now() - started >= kSliceBudget) {
+			break;
+		}
+		auto &task = state->tasks[state->next];
+		state->next = (state->next + 1) % count;
+		const auto bytes = task.run();
+		++task.runs;
+		task.reclaimed += bytes;
+		reclaimed += bytes;
+	}
+	if (reclaimed > 0) {
+		DEBUG_LOG(("Idle Maintenance: reclaimed %1 bytes.").arg(reclaimed));
+	}
+}
+
+void CheckIdle() {
+	const auto state = Instance;
+	if (!state || state->tasks.empty()) {
+		return;
+	}
+	if (UserIsIdle()) {
+		RunSlice();
+	}
+	state->timer.callOnce(kCheckEach);
+}
+
+void RegisterBuiltInTasks() {
+	Register(qsl("image cache"), [] {
+		return Images::TrimCacheForIdle();
+	});
+#ifdef Q_OS_LINUX
+	Register(qsl("malloc trim"), [] {
+		// Returns freed pages to the kernel, the amount is not reported.
+		malloc_trim(0);
+		return int64(0);
+	});
+#endif // Q_OS_LINUX
+}
+
+} // namespace
+
+void Register(const QString &name, Fn<int64()> task) {
+	Expects(Instance != nullptr);
+
+	Instance->tasks.push_back({ name, std::move(task) });
+}
+
+void Start() {
+	Expects(Instance == nullptr);
+
+	Instance = new State();
+	RegisterBuiltInTasks();
+	Instance->timer.callOnce(kCheckEach);
+}
+
+void Stop() {
+	if (const auto state = base::take(Instance)) {
+		delete state;
+	}
+}
+
+QString ReportString() {
+	if (!Instance) {
+		return QString();
+	}
+	auto result = QString();
+	for (const auto &task : Instance->tasks) {
+		result += qsl("%1: %2 bytes reclaimed in %3 runs\n"
+		).arg(task.name).arg(task.reclaimed).arg(task.runs);
+	}
+	return result;
+}
+
+} // namespace IdleMaintenance
+} // namespace Core
@@ -0,0 +1,26 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+namespace Core {
+namespace IdleMaintenance {
+
+// Maintenance tasks run on the main thread in bounded slices while the
+// user is idle, so they never compete with input handling or painting.
+// A task performs one bounded step per call and returns the number of
+// bytes it reclaimed, zero when it has nothing left to do.
+void Register(const QString &name, Fn<int64()> task);
+
+void Start();
+void Stop();
+
+// Per-task "name: bytes reclaimed in N runs" lines, for diagnostics.
+[[nodiscard]] QString ReportString();
+
+} // namespace IdleMaintenance
+} // namespace Core
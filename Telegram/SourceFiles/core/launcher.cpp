@@ -15,6 +15,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "core/crash_reports.h"
 #include "core/update_checker.h"
 #include "core/sandbox.h"
+#include "core/startup_profiler.h"
 #include "base/concurrent_timer.h"
 #include "facades.h"
 
@@ -311,6 +312,8 @@ void Launcher::init() {
 }
 
 int Launcher::exec() {
+	StartupProfiler::Stage("launcher init");
+
 	init();
 
 	if (cLaunchMode() == LaunchModeFixPrevious) {
@@ -319,6 +322,8 @@ int Launcher::exec() {
 		return psCleanup();
 	}
 
+	StartupProfiler::Stage("logs & platform");
+
 	// Must be started before Platform is started.
 	Logs::start(this);
 
@@ -435,6 +440,7 @@ void Launcher::processArguments() {
 	auto parseMap = std::map<QByteArray, KeyFormat> {
 		{ "-testmode"       , KeyFormat::NoValues },
 		{ "-debug"          , KeyFormat::NoValues },
+		{ "-startuptrace"   , KeyFormat::NoValues },
 		{ "-freetype"       , KeyFormat::NoValues },
 		{ "-many"           , KeyFormat::NoValues },
 		{ "-key"            , KeyFormat::OneValue },
@@ -479,6 +485,7 @@ void Launcher::processArguments() {
 	gTestMode = parseResult.contains("-testmode");
 	gUseFreeType = parseResult.contains("-freetype");
 	Logs::SetDebugEnabled(parseResult.contains("-debug"));
+	StartupProfiler::EnableReport(parseResult.contains("-startuptrace"));
 	gManyInstance = parseResult.contains("-many");
 	gKeyFile = parseResult.value("-key", {}).join(QString()).toLower();
 	gKeyFile = gKeyFile.replace(QRegularExpression("[^a-z0-9\\-_]"), {});
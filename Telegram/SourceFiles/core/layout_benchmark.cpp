@@ -0,0 +1,121 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "core/layout_benchmark.h"
+
+#include "core/version.h"
+#include "ui/text/text.h"
+#include "ui/text_options.h"
+#include "settings.h"
+#include "styles/style_history.h"
+
+#include <QtCore/QFile>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+
+namespace Core {
+namespace LayoutBenchmark {
+namespace {
+
+constexpr auto kIterations = 100;
+
+struct Case {
+	const char *name = nullptr;
+	QString text;
+};
+
+// The corpus is fixed so numbers stay comparable between builds; only
+// relative changes across commits are meaningful, not absolute times.
+std::vector<Case> PrepareCases() {
+	const auto plain = QString::fromUtf8(
+		"The quick brown fox jumps over the lazy dog. "
+		"Pack my box with five dozen liquor jugs. "
+		"Sphinx of black quartz, judge my vow. ");
+	const auto emoji = QString::fromUtf8(
+		"\xF0\x9F\x98\x80 hello \xE2\x9D\xA4\xEF\xB8\x8F world "
+		"\xF0\x9F\x91\x8D\xF0\x9F\x98\x80\xE2\x9D\xA4\xEF\xB8\x8F "
+		"\xF0\x9F\x91\xA8\xE2\x80\x8D\xF0\x9F\x91\xA9\xE2\x80\x8D"
+		"\xF0\x9F\x91\xA7 family ");
+	const auto rtl = QString::fromUtf8(
+		"\xD9\x85\xD8\xB1\xD8\xAD\xD8\xA8\xD8\xA7 hello "
+		"\xD8\xA8\xD8\xA7\xD9\x84\xD8\xB9\xD8\xA7\xD9\x84\xD9\x85 "
+		"world 123 ");
+	const auto links = QString::fromUtf8(
+		"See https://telegram.org and t.me/durov, "
+		"mail to test@example.com, #hashtag @mention ");
+	auto result = std::vector<Case>();
+	result.push_back({ "plain", plain.repeated(8) });
+	result.push_back({ "emoji", emoji.repeated(8) });
+	result.push_back({ "rtl_mix", rtl.repeated(8) });
+	result.push_back({ "links", links.repeated(8) });
+	return result;
+}
+
+} // namespace
+
+QString Run() {
+	const auto widths = std::vector<int>{ 320, 480, 720 };
+	auto cases = QJsonArray();
+	auto summary = qsl("Layout benchmark, %1 iterations:").arg(kIterations);
+	for (const auto &testCase : PrepareCases()) {
+		const auto parseStart = crl::profile();
+		for (auto i = 0; i != kIterations; ++i) {
+			auto string = Ui::Text::String(st::msgMinWidth);
+			string.setText(
+				st::messageTextStyle,
+				testCase.text,
+				Ui::ItemTextDefaultOptions());
+		}
+		const auto parseTime = qint64(crl::profile() - parseStart);
+
+		auto string = Ui::Text::String(st::msgMinWidth);
+		string.setText(
+			st::messageTextStyle,
+			testCase.text,
+			Ui::ItemTextDefaultOptions());
+		auto byWidth = QJsonObject();
+		auto layoutTotal = qint64(0);
+		for (const auto width : widths) {
+			const auto layoutStart = crl::profile();
+			for (auto i = 0; i != kIterations; ++i) {
+				string.countHeight(width);
+			}
+			const auto layoutTime = qint64(crl::profile() - layoutStart);
+			layoutTotal += layoutTime;
+			byWidth[QString::number(width)] = layoutTime;
+		}
+
+		auto entry = QJsonObject();
+		entry["name"] = QString::fromLatin1(testCase.name);
+		entry["length"] = testCase.text.size();
+		entry["parse_profile_units"] = parseTime;
+		entry["layout_profile_units_by_width"] = byWidth;
+		cases.append(entry);
+
+		summary += qsl("\n%1: parse %2, layout %3"
+		).arg(testCase.name
+		).arg(parseTime
+		).arg(layoutTotal);
+	}
+
+	auto root = QJsonObject();
+	root["version"] = QString::fromLatin1(AppVersionStr);
+	root["iterations"] = kIterations;
+	root["cases"] = cases;
+
+	const auto path = cWorkingDir() + qsl("layout_benchmark.json");
+	auto file = QFile(path);
+	if (file.open(QIODevice::WriteOnly)) {
+		file.write(QJsonDocument(root).toJson(QJsonDocument::Indented));
+		summary += qsl("\n\nSaved to %1").arg(path);
+	}
+	return summary;
+}
+
+} // namespace LayoutBenchmark
+} // namespace Core
@@ -0,0 +1,20 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+namespace Core {
+namespace LayoutBenchmark {
+
+// Parses and lays out a fixed text corpus (plain, emoji-heavy, RTL mix,
+// link-heavy) at several message widths, writes the timings as JSON to
+// layout_benchmark.json in the working directory for comparison across
+// builds and returns a short human-readable summary.
+[[nodiscard]] QString Run();
+
+} // namespace LayoutBenchmark
+} // namespace Core
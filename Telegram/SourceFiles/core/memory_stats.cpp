@@ -0,0 +1,128 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "core/memory_stats.h"
+
+#include "ui/image/image.h"
+#include "media/streaming/media_streaming_reader.h"
+#include "settings.h"
+
+#include <QtCore/QFile>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+
+namespace Core {
+namespace MemoryStats {
+namespace {
+
+struct Provider {
+	QString subsystem;
+	Fn<std::vector<Entry>()> list;
+};
+
+int RegistrationAutoIncrementId/* = 0*/;
+base::flat_map<int, Provider> Providers;
+
+[[nodiscard]] QString FormatBytes(qint64 bytes) {
+	if (bytes >= qint64(1024 * 1024)) {
+		return qsl("%1 MB").arg(bytes / qint64(1024 * 1024));
+	} else if (bytes >= 1024) {
+		return qsl("%1 KB").arg(bytes / 1024);
+	}
+	return qsl("%1 B").arg(bytes);
+}
+
+[[nodiscard]] std::vector<std::pair<QString, std::vector<Entry>>> Collect() {
+	auto result = std::vector<std::pair<QString, std::vector<Entry>>>();
+	for (const auto &[id, provider] : Providers) {
+		result.emplace_back(provider.subsystem, provider.list());
+	}
+
+	const auto images = Images::CurrentCacheState();
+	result.emplace_back(qsl("image_cache"), std::vector<Entry>{
+		{ qsl("pixmaps"), images.images, images.bytes },
+	});
+
+	const auto slices = Media::Streaming::CurrentSlicesMemoryUsage();
+	result.emplace_back(qsl("streaming"), std::vector<Entry>{
+		{ qsl("slice_parts"), slices.parts, slices.bytes },
+	});
+
+	return result;
+}
+
+} // namespace
+
+void Register(
+		const QString &subsystem,
+		Fn<std::vector<Entry>()> provider,
+		rpl::lifetime &lifetime) {
+	const auto id = ++RegistrationAutoIncrementId;
+	Providers.emplace(id, Provider{ subsystem, std::move(provider) });
+	lifetime.add([id] {
+		Providers.remove(id);
+	});
+}
+
+qint64 AccountedTotalBytes() {
+	auto result = qint64(0);
+	for (const auto &[subsystem, entries] : Collect()) {
+		for (const auto &entry : entries) {
+			result += entry.bytes;
+		}
+	}
+	return result;
+}
+
+QString ReportString() {
+	const auto collected = Collect();
+
+	auto subsystems = QJsonArray();
+	auto summary = qsl("Memory accounting:");
+	auto totalBytes = qint64(0);
+	for (const auto &[subsystem, entries] : collected) {
+		auto list = QJsonArray();
+		auto subsystemBytes = qint64(0);
+		for (const auto &entry : entries) {
+			auto object = QJsonObject();
+			object["name"] = entry.name;
+			object["count"] = entry.count;
+			object["bytes"] = entry.bytes;
+			list.append(object);
+			subsystemBytes += entry.bytes;
+
+			summary += qsl("\n%1 / %2: %3, %4"
+			).arg(subsystem
+			).arg(entry.name
+			).arg(entry.count
+			).arg(FormatBytes(entry.bytes));
+		}
+		auto object = QJsonObject();
+		object["subsystem"] = subsystem;
+		object["bytes"] = subsystemBytes;
+		object["entries"] = list;
+		subsystems.append(object);
+		totalBytes += subsystemBytes;
+	}
+	summary += qsl("\n\nAccounted total: %1").arg(FormatBytes(totalBytes));
+
+	auto root = QJsonObject();
+	root["accounted_bytes"] = totalBytes;
+	root["subsystems"] = subsystems;
+
+	const auto path = cWorkingDir() + qsl("memory_stats.json");
+	auto file = QFile(path);
+	if (file.open(QIODevice::WriteOnly)) {
+		file.write(QJsonDocument(root).toJson(QJsonDocument::Indented));
+		summary += qsl("\nSaved to %1").arg(path);
+	}
+	return summary;
+}
+
+} // namespace MemoryStats
+} // namespace Core
@@ -0,0 +1,36 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+namespace Core {
+namespace MemoryStats {
+
+struct Entry {
+	QString name;
+	qint64 count = 0;
+	qint64 bytes = 0;
+};
+
+// Providers snapshot counters the owning code already keeps updated,
+// so a report never walks the heap. The provider is called on the
+// main thread and is removed when |lifetime| ends.
+void Register(
+	const QString &subsystem,
+	Fn<std::vector<Entry>()> provider,
+	rpl::lifetime &lifetime);
+
+// Collects all providers plus the process-wide caches (images,
+// streaming slices), writes memory_stats.json to the working
+// directory and returns a short text summary.
+[[nodiscard]] QString ReportString();
+
+// The sum of all accounted bytes, for cheap before / after deltas.
+[[nodiscard]] qint64 AccountedTotalBytes();
+
+} // namespace MemoryStats
+} // namespace Core
@@ -0,0 +1,276 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "core/replay_script.h"
+
+#include "core/application.h"
+#include "core/frame_hud.h"
+#include "core/memory_stats.h"
+#include "base/timer.h"
+#include "data/data_session.h"
+#include "data/data_media_types.h"
+#include "dialogs/dialogs_main_list.h"
+#include "history/history.h"
+#include "history/history_item.h"
+#include "history/view/history_view_element.h"
+#include "main/main_session.h"
+#include "window/window_session_controller.h"
+#include "window/window_controller.h"
+#include "mainwindow.h"
+#include "settings.h"
+
+#include <QtCore/QFile>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtGui/QWheelEvent>
+
+namespace Core {
+namespace ReplayScript {
+namespace {
+
+constexpr auto kScrollTickInterval = crl::time(16);
+constexpr auto kDefaultActionDuration = crl::time(1000);
+
+struct Action {
+	QString type;
+	int index = 0;
+	crl::time duration = 0;
+	int pixelsPerSecond = 0;
+};
+
+class Runner final {
+public:
+	explicit Runner(not_null<Window::SessionController*> controller);
+
+	void start(std::vector<Action> &&actions);
+
+private:
+	void next();
+	void perform(const Action &action);
+	void openChat(int index);
+	void openMedia();
+	void scrollTick();
+	void recordActionResult(const Action &action);
+	void finish();
+
+	const not_null<Window::SessionController*> _controller;
+	std::vector<Action> _actions;
+	int _current = -1;
+	crl::time _actionStarted = 0;
+	int _scrollPixelsPerSecond = 0;
+	qint64 _accountedStart = 0;
+	bool _hudWasEnabled = false;
+	std::shared_ptr<bool> _alive = std::make_shared<bool>(true);
+	base::Timer _timer;
+	base::Timer _scrollTimer;
+	QJsonArray _results;
+
+};
+
+Runner *Running/* = nullptr*/;
+
+Runner::Runner(not_null<Window::SessionController*> controller)
+: _controller(controller)
+, _timer([=] { next(); })
+, _scrollTimer([=] { scrollTick(); }) {
+	// The controller owns the navigation we drive, an unfinished
+	// replay must not outlive it.
+	const auto alive = _alive;
+	const auto that = this;
+	controller->lifetime().add([=] {
+		if (*alive) {
+			*alive = false;
+			Running = nullptr;
+			delete that;
+		}
+	});
+}
+
+void Runner::start(std::vector<Action> &&actions) {
+	_actions = std::move(actions);
+	_accountedStart = MemoryStats::AccountedTotalBytes();
+	_hudWasEnabled = FrameHud::Enabled();
+	if (!_hudWasEnabled) {
+		FrameHud::Toggle();
+	}
+	next();
+}
+
+void Runner::next() {
+	_scrollTimer.cancel();
+	if (_current >= 0) {
+		recordActionResult(_actions[_current]);
+	}
+	if (++_current >= int(_actions.size())) {
+		finish();
+		return;
+	}
+	const auto &action = _actions[_current];
+	_actionStarted = crl::now();
+	perform(action);
+	_timer.callOnce(action.duration);
+}
+
+void Runner::perform(const Action &action) {
+	if (action.type == qsl("open_chat")) {
+		openChat(action.index);
+	} else if (action.type == qsl("open_media")) {
+		openMedia();
+	} else if (action.type == qsl("back")) {
+		_controller->showBackFromStack();
+	} else if (action.type == qsl("scroll")) {
+		_scrollPixelsPerSecond = action.pixelsPerSecond;
+		_scrollTimer.callEach(kScrollTickInterval);
+	} else if (action.type != qsl("wait")) {
+		LOG(("Replay Error: unknown action '%1'.").arg(action.type));
+	}
+}
+
+void Runner::openChat(int index) {
+	const auto list = _controller->session().data().chatsList()->indexed();
+	if (index < 0 || index >= list->size()) {
+		LOG(("Replay Error: no chat at index %1.").arg(index));
+		return;
+	}
+	const auto row = *(list->cbegin() + index);
+	if (const auto history = row->key().history()) {
+		_controller->showPeerHistory(
+			history,
+			Window::SectionShow::Way::ClearStack);
+	}
+}
+
+void Runner::openMedia() {
+	const auto history = _controller->activeChatCurrent().history();
+	if (!history) {
+		LOG(("Replay Error: open_media without an opened history."));
+		return;
+	}
+	for (const auto &block : history->blocks) {
+		for (const auto &message : block->messages) {
+			const auto item = message->data();
+			if (const auto media = item->media()) {
+				if (const auto photo = media->photo()) {
+					Core::App().showPhoto(photo, item);
+					return;
+				}
+			}
+		}
+	}
+	LOG(("Replay Error: no photo found for open_media."));
+}
+
+void Runner::scrollTick() {
+	const auto widget = Core::App().activeWindow()->widget().get();
+	const auto local = QPoint(
+		(widget->width() * 2) / 3,
+		widget->height() / 2);
+	const auto target = widget->childAt(local);
+	if (!target) {
+		return;
+	}
+	const auto delta = -int(_scrollPixelsPerSecond
+		* kScrollTickInterval
+		/ 1000);
+	const auto position = QPointF(target->mapFrom(widget, local));
+	auto event = QWheelEvent(
+		position,
+		QPointF(widget->mapToGlobal(local)),
+		QPoint(0, delta),
+		QPoint(0, delta),
+		delta,
+		Qt::Vertical,
+		Qt::NoButton,
+		Qt::NoModifier);
+	QCoreApplication::sendEvent(target, &event);
+}
+
+void Runner::recordActionResult(const Action &action) {
+	const auto summary = FrameHud::SummarizeSince(_actionStarted);
+	auto entry = QJsonObject();
+	entry["action"] = action.type;
+	if (action.type == qsl("open_chat")) {
+		entry["index"] = action.index;
+	}
+	entry["duration_ms"] = action.duration;
+	entry["frames"] = summary.frames;
+	entry["paint_avg_ms"] = summary.frames
+		? (summary.paintTotal / summary.frames)
+		: 0;
+	entry["paint_max_ms"] = summary.paintMax;
+	_results.append(entry);
+}
+
+void Runner::finish() {
+	if (!_hudWasEnabled) {
+		FrameHud::Toggle();
+	}
+
+	auto root = QJsonObject();
+	root["actions"] = _results;
+	root["accounted_bytes_before"] = _accountedStart;
+	root["accounted_bytes_after"] = MemoryStats::AccountedTotalBytes();
+
+	const auto path = cWorkingDir() + qsl("replay_report.json");
+	auto file = QFile(path);
+	if (file.open(QIODevice::WriteOnly)) {
+		file.write(QJsonDocument(root).toJson(QJsonDocument::Indented));
+	}
+	LOG(("Replay Info: finished %1 actions, report in '%2'."
+		).arg(_results.size()
+		).arg(path));
+
+	*_alive = false;
+	Running = nullptr;
+	crl::on_main([copy = this] {
+		delete copy;
+	});
+}
+
+[[nodiscard]] std::vector<Action> LoadScript() {
+	auto file = QFile(cWorkingDir() + qsl("replay_script.json"));
+	if (!file.open(QIODevice::ReadOnly)) {
+		return {};
+	}
+	auto error = QJsonParseError{ 0, QJsonParseError::NoError };
+	const auto document = QJsonDocument::fromJson(file.readAll(), &error);
+	if (error.error != QJsonParseError::NoError || !document.isArray()) {
+		LOG(("Replay Error: could not parse replay_script.json."));
+		return {};
+	}
+	auto result = std::vector<Action>();
+	for (const auto &value : document.array()) {
+		const auto entry = value.toObject();
+		auto action = Action();
+		action.type = entry["action"].toString();
+		action.index = entry["index"].toInt();
+		action.duration = crl::time(entry["duration_ms"].toInt(
+			int(kDefaultActionDuration)));
+		action.pixelsPerSecond = entry["pixels_per_second"].toInt();
+		result.push_back(action);
+	}
+	return result;
+}
+
+} // namespace
+
+bool Run(not_null<Window::SessionController*> controller) {
+	if (Running) {
+		return false;
+	}
+	auto actions = LoadScript();
+	if (actions.empty()) {
+		return false;
+	}
+	Running = new Runner(controller);
+	Running->start(std::move(actions));
+	return true;
+}
+
+} // namespace ReplayScript
+} // namespace Core
@@ -0,0 +1,28 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+namespace Window {
+class SessionController;
+} // namespace Window
+
+namespace Core {
+namespace ReplayScript {
+
+// Executes a JSON script of synthetic actions (replay_script.json in
+// the working directory) against the current session through the
+// production navigation and input paths: open_chat goes through
+// SessionController::showPeerHistory, scroll posts wheel events into
+// the widget tree, open_media uses the media viewer entry point.
+// Frame statistics and accounted memory deltas are written per action
+// to replay_report.json. Returns false when no script could be loaded
+// or a replay is already running.
+bool Run(not_null<Window::SessionController*> controller);
+
+} // namespace ReplayScript
+} // namespace Core
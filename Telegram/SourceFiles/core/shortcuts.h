@@ -49,6 +49,8 @@ enum class Command {
 
 	ShowArchive,
 
+	ToggleFrameHud,
+
 	JustSendMessage,
 	SendSilentMessage,
 	ScheduleMessage,
@@ -0,0 +1,143 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "core/startup_profiler.h"
+
+#include "logs.h"
+#include "settings.h"
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+
+namespace Core {
+namespace StartupProfiler {
+namespace {
+
+struct Event {
+	const char *name = nullptr;
+	qint64 begin = 0; // Microseconds from the profiler start.
+	qint64 end = 0;
+	int depth = 0;
+};
+
+QElapsedTimer Timer;
+std::vector<Event> Events;
+std::vector<int> Open;
+bool ReportEnabled/* = false*/;
+bool Finished/* = false*/;
+
+qint64 Now() {
+	if (!Timer.isValid()) {
+		Timer.start();
+	}
+	return Timer.nsecsElapsed() / 1000;
+}
+
+void Push(const char *name) {
+	auto event = Event();
+	event.name = name;
+	event.begin = Now();
+	event.depth = int(Open.size());
+	Open.push_back(int(Events.size()));
+	Events.push_back(event);
+}
+
+void Pop() {
+	Expects(!Open.empty());
+
+	Events[Open.back()].end = Now();
+	Open.pop_back();
+}
+
+void WriteReport() {
+	QFile f(cWorkingDir() + qsl("startup_trace.json"));
+	if (!f.open(QIODevice::WriteOnly)) {
+		LOG(("Startup Trace Error: could not write '%1'."
+			).arg(f.fileName()));
+		return;
+	}
+	auto json = QByteArray();
+	json += "{\"traceEvents\":[";
+	auto first = true;
+	for (const auto &event : Events) {
+		if (!first) {
+			json += ',';
+		}
+		first = false;
+		json += "{\"name\":\"";
+		json += event.name;
+		json += "\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":";
+		json += QByteArray::number(event.begin);
+		json += ",\"dur\":";
+		json += QByteArray::number(event.end - event.begin);
+		json += '}';
+	}
+	json += "]}";
+	f.write(json);
+	LOG(("Startup Trace: report written to '%1'.").arg(f.fileName()));
+}
+
+} // namespace
+
+void EnableReport(bool enabled) {
+	ReportEnabled = enabled;
+}
+
+void Stage(const char *name) {
+	if (Finished) {
+		return;
+	}
+	while (!Open.empty()) {
+		Pop();
+	}
+	Push(name);
+}
+
+void Begin(const char *name) {
+	if (Finished) {
+		return;
+	}
+	Push(name);
+}
+
+void End(const char *name) {
+	if (Finished || Open.empty()) {
+		return;
+	}
+	Pop();
+}
+
+void Finish() {
+	if (Finished) {
+		return;
+	}
+	Finished = true;
+	while (!Open.empty()) {
+		Pop();
+	}
+
+	auto summary = QString();
+	for (const auto &event : Events) {
+		if (event.depth > 0) {
+			continue;
+		}
+		summary += qsl("%1: %2ms, "
+		).arg(event.name
+		).arg((event.end - event.begin) / 1000);
+	}
+	LOG(("Startup Trace: %1total: %2ms"
+		).arg(summary
+		).arg(Now() / 1000));
+
+	if (ReportEnabled) {
+		WriteReport();
+	}
+	Events.clear();
+}
+
+} // namespace StartupProfiler
+} // namespace Core
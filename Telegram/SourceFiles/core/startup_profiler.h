@@ -0,0 +1,35 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+namespace Core {
+namespace StartupProfiler {
+
+// Collects timings of the startup path from Launcher::exec till the
+// first MainWindow paint. Everything runs on the main thread during
+// startup, so no synchronization is needed. After Finish() all calls
+// become no-ops, so repeated work (like a passcode unlock reading the
+// map again) is not traced.
+
+// Write a Chrome-tracing JSON report on Finish(), set from the
+// '-startuptrace' command line switch.
+void EnableReport(bool enabled);
+
+// Closes the previous stage and opens a new top-level one.
+void Stage(const char *name);
+
+// Nested events inside the current stage.
+void Begin(const char *name);
+void End(const char *name);
+
+// Closes all open events, writes the summary to the log and the JSON
+// report if enabled.
+void Finish();
+
+} // namespace StartupProfiler
+} // namespace Core
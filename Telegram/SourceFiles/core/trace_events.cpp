@@ -0,0 +1,122 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "core/trace_events.h"
+
+#include "settings.h"
+
+#include <QtCore/QFile>
+#include <QtCore/QMutex>
+#include <QtCore/QThread>
+
+namespace Core {
+namespace TraceEvents {
+namespace {
+
+constexpr auto kEventsLimit = 65536;
+
+struct Event {
+	const char *queue = nullptr;
+	crl::time enqueued = 0;
+	crl::time started = 0;
+	crl::time finished = 0;
+	quint64 tid = 0;
+};
+
+std::atomic<bool> IsCapturing/* = false*/;
+QMutex Mutex;
+std::vector<Event> Events;
+int Dropped/* = 0*/;
+
+} // namespace
+
+bool Capturing() {
+	return IsCapturing.load(std::memory_order_relaxed);
+}
+
+void Start() {
+	QMutexLocker lock(&Mutex);
+	Events.clear();
+	Events.reserve(kEventsLimit);
+	Dropped = 0;
+	IsCapturing = true;
+}
+
+void RecordTask(
+		const char *queue,
+		crl::time enqueued,
+		crl::time started,
+		crl::time finished) {
+	if (!Capturing()) {
+		return;
+	}
+	auto event = Event();
+	event.queue = queue;
+	event.enqueued = enqueued;
+	event.started = started;
+	event.finished = finished;
+	event.tid = quint64(reinterpret_cast<quintptr>(
+		QThread::currentThreadId()));
+
+	QMutexLocker lock(&Mutex);
+	if (int(Events.size()) >= kEventsLimit) {
+		++Dropped;
+		return;
+	}
+	Events.push_back(event);
+}
+
+QString Finish() {
+	auto events = std::vector<Event>();
+	auto dropped = 0;
+	{
+		QMutexLocker lock(&Mutex);
+		IsCapturing = false;
+		events = base::take(Events);
+		dropped = base::take(Dropped);
+	}
+
+	QFile f(cWorkingDir() + qsl("trace_events.json"));
+	if (!f.open(QIODevice::WriteOnly)) {
+		return qsl("Could not write '%1'.").arg(f.fileName());
+	}
+	auto json = QByteArray();
+	json += "{\"traceEvents\":[";
+	auto first = true;
+	for (const auto &event : events) {
+		if (!first) {
+			json += ',';
+		}
+		first = false;
+		json += "{\"name\":\"";
+		json += event.queue;
+		json += "\",\"ph\":\"X\",\"pid\":1,\"tid\":";
+		json += QByteArray::number(event.tid);
+		json += ",\"ts\":";
+		json += QByteArray::number(qint64(event.started) * 1000);
+		json += ",\"dur\":";
+		json += QByteArray::number(
+			qint64(event.finished - event.started) * 1000);
+		json += ",\"args\":{\"wait_ms\":";
+		json += QByteArray::number(qint64(event.started - event.enqueued));
+		json += "}}";
+	}
+	json += "]}";
+	f.write(json);
+
+	auto result = qsl("Trace capture finished: %1 events in '%2'."
+	).arg(events.size()
+	).arg(f.fileName());
+	if (dropped > 0) {
+		result += qsl("\n%1 events were dropped (buffer full)."
+		).arg(dropped);
+	}
+	return result;
+}
+
+} // namespace TraceEvents
+} // namespace Core
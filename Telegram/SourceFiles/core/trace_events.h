@@ -0,0 +1,33 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+namespace Core {
+namespace TraceEvents {
+
+// The capture flag is checked on hot paths from any thread.
+[[nodiscard]] bool Capturing();
+
+void Start();
+
+// Writes the capture as Chrome trace_event JSON (openable in
+// chrome://tracing) to trace_events.json in the working directory and
+// returns a short summary.
+[[nodiscard]] QString Finish();
+
+// Thread safe. Records one completed task span under the calling
+// thread's id; |enqueued| to |started| becomes the queue-wait
+// argument of the span.
+void RecordTask(
+	const char *queue,
+	crl::time enqueued,
+	crl::time started,
+	crl::time finished);
+
+} // namespace TraceEvents
+} // namespace Core
@@ -45,6 +45,10 @@ namespace {
 constexpr auto kUpdaterTimeout = 10 * crl::time(1000);
 constexpr auto kMaxResponseSize = 1024 * 1024;
 
+constexpr auto kDeltaMagic = quint32(0x54444546); // "TDEF"
+constexpr auto kDeltaOpCopy = quint8(0);
+constexpr auto kDeltaOpInsert = quint8(1);
+
 #ifdef TDESKTOP_DISABLE_AUTOUPDATE
 bool UpdaterIsDisabled = true;
 #else // TDESKTOP_DISABLE_AUTOUPDATE
@@ -135,6 +139,8 @@ class HttpLoader : public Loader {
 public:
 	HttpLoader(const QString &url);
 
+	QString url() const;
+
 	~HttpLoader();
 
 private:
@@ -244,6 +250,178 @@ QString ExtractFilename(const QString &url) {
 	return QString();
 }
 
+QString DeltaSourceFolder() {
+	return cWorkingDir() + qsl("tupdates_prev");
+}
+
+QString DeltaSourcePath() {
+	return DeltaSourceFolder() + qsl("/package");
+}
+
+void ClearDeltaSource() {
+	psDeleteDir(DeltaSourceFolder());
+}
+
+// The version installed by the retained package, or 0 if there is none.
+int32 DeltaSourceVersion() {
+	if (!QFile(DeltaSourcePath()).exists()) {
+		return 0;
+	}
+	QFile f(DeltaSourceFolder() + qsl("/version"));
+	if (!f.open(QIODevice::ReadOnly)) {
+		return 0;
+	}
+	return f.readAll().toInt();
+}
+
+// Keeps the package that installs the given version, so that the next
+// update can be downloaded as a delta from it.
+void RetainDeltaSource(const QString &filepath, int32 version) {
+	ClearDeltaSource();
+	if (!QDir().mkpath(DeltaSourceFolder())
+		|| !QFile::copy(filepath, DeltaSourcePath())) {
+		LOG(("Update Error: cant retain package '%1' for deltas."
+			).arg(filepath));
+		ClearDeltaSource();
+		return;
+	}
+	QFile f(DeltaSourceFolder() + qsl("/version"));
+	if (!f.open(QIODevice::WriteOnly)
+		|| f.write(QByteArray::number(version)) <= 0) {
+		LOG(("Update Error: cant write delta source version file."));
+		ClearDeltaSource();
+	}
+}
+
+// Reconstructs the full package from the retained one and the delta,
+// verifying the SHA256 from the delta header. The result goes through
+// the regular signature check in UnpackUpdate() afterwards.
+QString ApplyDeltaUpdate(const QString &deltapath) {
+	QFile delta(deltapath);
+	if (!delta.open(QIODevice::ReadOnly)) {
+		LOG(("Update Error: cant read delta file '%1'!").arg(deltapath));
+		return QString();
+	}
+	const auto deltaBytes = delta.readAll();
+	delta.close();
+
+	QFile source(DeltaSourcePath());
+	if (!source.open(QIODevice::ReadOnly)) {
+		LOG(("Update Error: cant read delta source package!"));
+		return QString();
+	}
+	const auto sourceBytes = source.readAll();
+	source.close();
+
+	QDataStream stream(deltaBytes);
+	stream.setVersion(QDataStream::Qt_5_1);
+
+	quint32 magic = 0;
+	qint32 fromVersion = 0, toVersion = 0, targetSize = 0;
+	QByteArray targetHash;
+	stream >> magic >> fromVersion >> toVersion >> targetSize >> targetHash;
+	if (stream.status() != QDataStream::Ok || magic != kDeltaMagic) {
+		LOG(("Update Error: bad delta file header."));
+		return QString();
+	} else if (fromVersion != AppVersion) {
+		LOG(("Update Error: delta is from version %1, mine is %2."
+			).arg(fromVersion).arg(AppVersion));
+		return QString();
+	} else if (targetSize <= 0
+		|| targetSize > Loader::kMaxFileSize
+		|| targetHash.size() != 32) {
+		LOG(("Update Error: bad delta target size %1.").arg(targetSize));
+		return QString();
+	}
+
+	auto target = QByteArray();
+	target.reserve(targetSize);
+	while (target.size() < targetSize) {
+		quint8 op = 0;
+		stream >> op;
+		if (stream.status() != QDataStream::Ok) {
+			LOG(("Update Error: cant read delta op, status: %1"
+				).arg(stream.status()));
+			return QString();
+		}
+		if (op == kDeltaOpCopy) {
+			qint64 offset = 0;
+			qint32 size = 0;
+			stream >> offset >> size;
+			if (stream.status() != QDataStream::Ok
+				|| offset < 0
+				|| size <= 0
+				|| offset + size > qint64(sourceBytes.size())) {
+				LOG(("Update Error: bad delta copy %1:%2 of %3."
+					).arg(offset).arg(size).arg(sourceBytes.size()));
+				return QString();
+			}
+			target.append(sourceBytes.constData() + offset, size);
+		} else if (op == kDeltaOpInsert) {
+			QByteArray inserted;
+			stream >> inserted;
+			if (stream.status() != QDataStream::Ok || inserted.isEmpty()) {
+				LOG(("Update Error: bad delta insert, status: %1"
+					).arg(stream.status()));
+				return QString();
+			}
+			target.append(inserted);
+		} else {
+			LOG(("Update Error: bad delta op %1.").arg(op));
+			return QString();
+		}
+	}
+	if (target.size() != targetSize) {
+		LOG(("Update Error: delta result size %1 not matching %2."
+			).arg(target.size()).arg(targetSize));
+		return QString();
+	}
+	const auto hash = hashSha256(target.constData(), target.size());
+	if (memcmp(hash.data(), targetHash.constData(), targetHash.size())) {
+		LOG(("Update Error: bad SHA256 hash of delta result!"));
+		return QString();
+	}
+
+	const auto name = QFileInfo(deltapath).fileName();
+	const auto cut = name.indexOf(qsl("_from"));
+	if (cut <= 0) {
+		LOG(("Update Error: bad delta file name '%1'.").arg(name));
+		return QString();
+	}
+	const auto result = UpdatesFolder() + '/' + name.left(cut);
+	QFile output(result);
+	if (!output.open(QIODevice::WriteOnly)
+		|| output.write(target) != target.size()) {
+		LOG(("Update Error: cant write delta result '%1'.").arg(result));
+		return QString();
+	}
+	output.close();
+	QFile::remove(deltapath);
+	LOG(("Update Info: delta %1 -> %2 applied, %3 bytes."
+		).arg(fromVersion).arg(toVersion).arg(target.size()));
+	return result;
+}
+
+// The delta merely reconstructs the full package, so a successful
+// signature check in UnpackUpdate() covers the patched bytes as well.
+std::shared_ptr<Loader> MakeDeltaLoader(const QString &packageUrl) {
+	if (cAlphaVersion()) {
+		// Alpha packages are signed per-user, no deltas are built for them.
+		return nullptr;
+	}
+	const auto retained = DeltaSourceVersion();
+	if (!retained) {
+		return nullptr;
+	} else if (retained != AppVersion) {
+		// We run a version the retained package didn't install,
+		// it can no longer serve as a delta source.
+		ClearDeltaSource();
+		return nullptr;
+	}
+	return std::make_shared<HttpLoader>(
+		packageUrl + qsl("_from%1").arg(retained));
+}
+
 bool UnpackUpdate(const QString &filepath) {
 	QFile input(filepath);
 	QByteArray packed;
@@ -480,6 +658,9 @@ bool UnpackUpdate(const QString &filepath) {
 		LOG(("Update Error: cant create ready file '%1'").arg(readyFilePath));
 		return false;
 	}
+	if (version != 0x7FFFFFFF) { // no deltas for alpha versions
+		RetainDeltaSource(filepath, int32(version));
+	}
 	input.remove();
 
 	return true;
@@ -759,6 +940,10 @@ HttpLoader::HttpLoader(const QString &url)
 , _url(url) {
 }
 
+QString HttpLoader::url() const {
+	return _url;
+}
+
 void HttpLoader::startLoading() {
 	LOG(("Update Info: Loading using HTTP from '%1'.").arg(_url));
 
@@ -1050,6 +1235,9 @@ private:
 		not_null<Implementation*> which,
 		std::unique_ptr<Checker> checker);
 	bool tryLoaders();
+	void startLoader();
+	void loaderFailed();
+	bool retryWithFullLoader();
 	void handleTimeout();
 	void checkerDone(
 		not_null<Implementation*> which,
@@ -1077,6 +1265,8 @@ private:
 	Implementation _httpImplementation;
 	Implementation _mtpImplementation;
 	std::shared_ptr<Loader> _activeLoader;
+	std::shared_ptr<Loader> _fullLoader;
+	bool _usingDeltaLoader = false;
 	bool _usingMtprotoLoader = (cAlphaVersion() != 0);
 	QPointer<MTP::Instance> _mtproto;
 
@@ -1188,6 +1378,8 @@ void Updater::stop() {
 	_httpImplementation = Implementation();
 	_mtpImplementation = Implementation();
 	_activeLoader = nullptr;
+	_fullLoader = nullptr;
+	_usingDeltaLoader = false;
 	_action = Action::Waiting;
 }
 
@@ -1307,7 +1499,7 @@ void Updater::handleTimeout() {
 			_timer.callOnce(kUpdaterTimeout);
 		}
 	} else if (_action == Action::Loading) {
-		_failed.fire({});
+		loaderFailed();
 	}
 }
 
@@ -1319,27 +1511,24 @@ bool Updater::tryLoaders() {
 	_retryTimer.cancel();
 
 	const auto tryOne = [&](Implementation &which) {
+		_usingDeltaLoader = false;
+		_fullLoader = nullptr;
 		_activeLoader = std::move(which.loader);
-		if (const auto loader = _activeLoader.get()) {
-			_action = Action::Loading;
-
-			loader->progress(
-			) | rpl::start_to_stream(_progress, loader->lifetime());
-			loader->ready(
-			) | rpl::start_with_next([=](QString &&filepath) {
-				finalize(std::move(filepath));
-			}, loader->lifetime());
-			loader->failed(
-			) | rpl::start_with_next([=] {
-				_failed.fire({});
-			}, loader->lifetime());
-
-			_retryTimer.callOnce(kUpdaterTimeout);
-			loader->wipeFolder();
-			loader->start();
-		} else {
+		if (!_activeLoader) {
 			_isLatest.fire({});
+			return;
 		}
+		if (&which == &_httpImplementation) {
+			// The http implementation loader is always an HttpLoader.
+			const auto url = static_cast<HttpLoader*>(
+				_activeLoader.get())->url();
+			if (auto delta = MakeDeltaLoader(url)) {
+				_fullLoader = std::move(_activeLoader);
+				_activeLoader = std::move(delta);
+				_usingDeltaLoader = true;
+			}
+		}
+		startLoader();
 	};
 	if (_mtpImplementation.failed && _httpImplementation.failed) {
 		_failed.fire({});
@@ -1357,6 +1546,49 @@ bool Updater::tryLoaders() {
 	return true;
 }
 
+void Updater::startLoader() {
+	Expects(_activeLoader != nullptr);
+
+	const auto loader = _activeLoader.get();
+	_action = Action::Loading;
+
+	loader->progress(
+	) | rpl::start_to_stream(_progress, loader->lifetime());
+	loader->ready(
+	) | rpl::start_with_next([=](QString &&filepath) {
+		finalize(std::move(filepath));
+	}, loader->lifetime());
+	loader->failed(
+	) | rpl::start_with_next([=] {
+		loaderFailed();
+	}, loader->lifetime());
+
+	_retryTimer.callOnce(kUpdaterTimeout);
+	loader->wipeFolder();
+	loader->start();
+}
+
+void Updater::loaderFailed() {
+	if (retryWithFullLoader()) {
+		return;
+	}
+	_failed.fire({});
+}
+
+bool Updater::retryWithFullLoader() {
+	if (!base::take(_usingDeltaLoader)) {
+		return false;
+	}
+	LOG(("Update Info: delta failed, falling back to the full package."));
+	ClearDeltaSource();
+	_activeLoader = base::take(_fullLoader);
+	if (!_activeLoader) {
+		return false;
+	}
+	startLoader();
+	return true;
+}
+
 void Updater::finalize(QString filepath) {
 	if (_action != Action::Loading) {
 		return;
@@ -1364,8 +1596,12 @@ void Updater::finalize(QString filepath) {
 	_retryTimer.cancel();
 	_activeLoader = nullptr;
 	_action = Action::Unpacking;
+	const auto delta = _usingDeltaLoader;
 	crl::async([=] {
-		const auto ready = UnpackUpdate(filepath);
+		const auto package = delta
+			? ApplyDeltaUpdate(filepath)
+			: filepath;
+		const auto ready = !package.isEmpty() && UnpackUpdate(package);
 		crl::on_main([=] {
 			GetUpdaterInstance()->unpackDone(ready);
 		});
@@ -1374,9 +1610,14 @@ void Updater::finalize(QString filepath) {
 
 void Updater::unpackDone(bool ready) {
 	if (ready) {
+		_usingDeltaLoader = false;
+		_fullLoader = nullptr;
 		_ready.fire({});
 	} else {
 		ClearAll();
+		if (retryWithFullLoader()) {
+			return;
+		}
 		_failed.fire({});
 	}
 }
@@ -815,12 +815,13 @@ void ApplyMegagroupAdmins(
 	}
 	auto removing = channel->mgInfo->admins;
 	if (removing.empty() && adding.empty()) {
-		// Add some admin-placeholder so we don't DDOS
-		// server with admins list requests.
 		LOG(("API Error: Got empty admins list from server."));
-		adding.emplace(0, QString());
 	}
 
+	// Even an empty response bumps the generation, marking the list
+	// as received, so the server is not DDOSed with admins requests.
+	++channel->mgInfo->adminsGeneration;
+
 	Data::ChannelAdminChanges changes(channel);
 	for (const auto &[addingId, rank] : adding) {
 		if (!removing.remove(addingId)) {
@@ -65,6 +65,10 @@ public:
 	// For admin badges, full admins list with ranks.
 	base::flat_map<UserId, QString> admins;
 
+	// Bumped on every applied admins diff, zero means the list was
+	// never received from the server, so it should be requested.
+	int adminsGeneration = 0;
+
 	UserData *creator = nullptr; // nullptr means unknown
 	QString creatorRank;
 	int botStatus = 0; // -1 - no bots, 0 - unknown, 1 - one bot, that sees all history, 2 - other
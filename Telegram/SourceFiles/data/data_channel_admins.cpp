@@ -22,19 +22,33 @@ ChannelAdminChanges::ChannelAdminChanges(not_null<ChannelData*> channel)
 void ChannelAdminChanges::add(UserId userId, const QString &rank) {
 	const auto i = _admins.find(userId);
 	if (i == end(_admins) || i->second != rank) {
-		_admins[userId] = rank;
+		_adds[userId] = rank;
+		_removes.remove(userId);
 		_changes.emplace(userId);
 	}
 }
 
 void ChannelAdminChanges::remove(UserId userId) {
-	if (_admins.contains(userId)) {
-		_admins.remove(userId);
+	if (_admins.contains(userId) && !_removes.contains(userId)) {
+		_removes.emplace(userId);
 		_changes.emplace(userId);
 	}
+	_adds.remove(userId);
 }
 
 ChannelAdminChanges::~ChannelAdminChanges() {
+	if (!_adds.empty() || !_removes.empty()) {
+		// The map stays untouched while a diff against it is being
+		// collected and the whole diff is applied in one pass here,
+		// bumping the generation once however large the diff was.
+		for (const auto &[userId, rank] : _adds) {
+			_admins[userId] = rank;
+		}
+		for (const auto userId : _removes) {
+			_admins.remove(userId);
+		}
+		++_channel->mgInfo->adminsGeneration;
+	}
 	if (_changes.size() > 1
 		|| (!_changes.empty()
 			&& _changes.front() != _channel->session().userId())) {
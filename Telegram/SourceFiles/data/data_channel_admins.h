@@ -21,6 +21,8 @@ public:
 private:
 	not_null<ChannelData*> _channel;
 	base::flat_map<UserId, QString> &_admins;
+	base::flat_map<UserId, QString> _adds;
+	base::flat_set<UserId> _removes;
 	base::flat_set<UserId> _changes;
 
 };
@@ -161,7 +161,7 @@ auto ChatData::applyUpdateVersion(int version) -> UpdateStatus {
 		return UpdateStatus::TooOld;
 	} else if (_version + 1 < version) {
 		invalidateParticipants();
-		session().api().requestFullPeer(this);
+		session().api().invalidateFullPeer(this);
 		return UpdateStatus::Skipped;
 	}
 	setVersion(version);
@@ -295,7 +295,7 @@ void ApplyChatUpdate(
 	}
 	if (mtpIsTrue(update.vis_admin())) {
 		if (chat->noParticipantInfo()) {
-			chat->session().api().requestFullPeer(chat);
+			chat->session().api().invalidateFullPeer(chat);
 		} else {
 			chat->admins.emplace(user);
 		}
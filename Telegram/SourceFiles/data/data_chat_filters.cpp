@@ -18,6 +18,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "dialogs/dialogs_main_list.h"
 #include "ui/ui_utility.h"
 #include "main/main_session.h"
+#include "observer_peer.h"
 #include "apiwrap.h"
 
 namespace Data {
@@ -215,6 +216,27 @@ bool ChatFilter::contains(not_null<History*> history) const {
 		|| _always.contains(history);
 }
 
+ChatFilter::Inputs ChatFilter::inputsUsed() const {
+	if (!_flags) {
+		// A pure chats-list filter, membership changes only together
+		// with the filter itself.
+		return Inputs();
+	}
+	auto result = Inputs(Input::PeerType);
+	if (_flags & Flag::NoMuted) {
+		// The muted check makes an exception for chats with unread
+		// mentions outside of the archive.
+		result |= Input::Muted | Input::Unread | Input::Archive;
+	}
+	if (_flags & Flag::NoRead) {
+		result |= Input::Unread;
+	}
+	if (_flags & Flag::NoArchived) {
+		result |= Input::Archive;
+	}
+	return result;
+}
+
 ChatFilters::ChatFilters(not_null<Session*> owner) : _owner(owner) {
 	//using Flag = ChatFilter::Flag;
 	//const auto all = Flag::Contacts
@@ -227,6 +249,13 @@ ChatFilters::ChatFilters(not_null<Session*> owner) : _owner(owner) {
 	//	ChatFilter(1, "Unmuted", all | Flag::NoMuted, {}, {}));
 	//_list.push_back(
 	//	ChatFilter(2, "Unread", all | Flag::NoRead, {}, {}));
+	Notify::PeerUpdateViewer(
+		Notify::PeerUpdate::Flag::UserIsContact
+	) | rpl::start_with_next([=](const Notify::PeerUpdate &update) {
+		if (const auto history = _owner->historyLoaded(update.peer)) {
+			refreshHistory(history, ChatFilter::Input::PeerType);
+		}
+	}, _lifetime);
 	load();
 }
 
@@ -559,7 +588,41 @@ bool ChatFilters::loadNextExceptions(bool chatsListLoaded) {
 }
 
 void ChatFilters::refreshHistory(not_null<History*> history) {
-	_refreshHistoryRequests.fire_copy(history);
+	refreshHistory(history, ChatFilter::kAllInputs);
+}
+
+void ChatFilters::refreshHistory(
+		not_null<History*> history,
+		ChatFilter::Inputs inputs) {
+	if (!inputs) {
+		return;
+	}
+	_refreshInputs[history] |= inputs;
+	_refreshQueue.emplace(history);
+	if (_refreshScheduled) {
+		return;
+	}
+	// Unread state often changes for a lot of dialogs at once, for
+	// example when a whole folder is read, so the requests from one
+	// burst are accumulated and sent out together.
+	_refreshScheduled = true;
+	Ui::PostponeCall(&_owner->session(), [=] {
+		_refreshScheduled = false;
+		for (const auto history : base::take(_refreshQueue)) {
+			_refreshHistoryRequests.fire_copy(history);
+		}
+	});
+}
+
+ChatFilter::Inputs ChatFilters::takeRefreshInputs(
+		not_null<History*> history) {
+	const auto i = _refreshInputs.find(history);
+	if (i == end(_refreshInputs)) {
+		return ChatFilter::Inputs();
+	}
+	const auto result = i->second;
+	_refreshInputs.erase(i);
+	return result;
 }
 
 auto ChatFilters::refreshHistoryRequests() const
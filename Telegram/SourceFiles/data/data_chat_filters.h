@@ -35,6 +35,23 @@ public:
 	friend constexpr inline bool is_flag_type(Flag) { return true; };
 	using Flags = base::flags<Flag>;
 
+	// Predicate inputs of contains(). A change in one of them can only
+	// change membership in the filters that actually use it, so the
+	// refresh doesn't have to re-test all the other filters.
+	enum class Input : uchar {
+		Unread   = 0x01,
+		Muted    = 0x02,
+		PeerType = 0x04,
+		Archive  = 0x08,
+	};
+	friend constexpr inline bool is_flag_type(Input) { return true; };
+	using Inputs = base::flags<Input>;
+
+	static constexpr auto kAllInputs = Input::Unread
+		| Input::Muted
+		| Input::PeerType
+		| Input::Archive;
+
 	static constexpr int kPinnedLimit = 100;
 
 	ChatFilter() = default;
@@ -61,6 +78,7 @@ public:
 	[[nodiscard]] const base::flat_set<not_null<History*>> &never() const;
 
 	[[nodiscard]] bool contains(not_null<History*> history) const;
+	[[nodiscard]] Inputs inputsUsed() const;
 
 private:
 	FilterId _id = 0;
@@ -105,6 +123,11 @@ public:
 	bool loadNextExceptions(bool chatsListLoaded);
 
 	void refreshHistory(not_null<History*> history);
+	void refreshHistory(
+		not_null<History*> history,
+		ChatFilter::Inputs inputs);
+	[[nodiscard]] ChatFilter::Inputs takeRefreshInputs(
+		not_null<History*> history);
 	[[nodiscard]] auto refreshHistoryRequests() const
 		-> rpl::producer<not_null<History*>>;
 
@@ -151,6 +174,12 @@ private:
 	std::deque<FilterId> _exceptionsToLoad;
 	mtpRequestId _exceptionsLoadRequestId = 0;
 
+	base::flat_map<not_null<History*>, ChatFilter::Inputs> _refreshInputs;
+	base::flat_set<not_null<History*>> _refreshQueue;
+	bool _refreshScheduled = false;
+
+	rpl::lifetime _lifetime;
+
 };
 
 } // namespace Data
@@ -204,6 +204,9 @@ void LoadCloudFile(
 		if (fromCloud == LoadFromCloudOrLocal) {
 			file.loader->permitLoadFromCloud();
 		}
+		if (!autoLoading) {
+			file.loader->increaseLoadPriority();
+		}
 		return;
 	} else if ((file.flags & CloudFile::Flag::Failed)
 		|| !file.location.valid()
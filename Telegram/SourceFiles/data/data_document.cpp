@@ -949,6 +949,9 @@ void DocumentData::save(
 		if (fromCloud == LoadFromCloudOrLocal) {
 			_loader->permitLoadFromCloud();
 		}
+		if (!autoLoading) {
+			_loader->increaseLoadPriority();
+		}
 	} else {
 		status = FileReady;
 		auto reader = owner().streaming().sharedReader(this, origin, true);
@@ -1210,6 +1213,20 @@ Image *DocumentData::getReplyPreview(Data::FileOrigin origin) {
 	return _replyPreview->image(origin);
 }
 
+bool DocumentData::hasUnreferencedReplyPreview() const {
+	if (!_replyPreview) {
+		return false;
+	}
+	const auto media = activeMediaView();
+	// One strong reference is the local one and one may be held
+	// by the reply preview itself, more mean an active user.
+	return !media || (media.use_count() <= 2);
+}
+
+void DocumentData::clearReplyPreview() {
+	_replyPreview = nullptr;
+}
+
 StickerData *DocumentData::sticker() const {
 	return (type == StickerDocument)
 		? static_cast<StickerData*>(_additional.get())
@@ -1371,6 +1388,14 @@ Storage::Cache::Key DocumentData::cacheKey() const {
 	}
 }
 
+Storage::Cache::Key DocumentData::voiceWaveformCacheKey() const {
+	return Data::VoiceWaveformCacheKey(_dc, id);
+}
+
+Storage::Cache::Key DocumentData::streamingVerdictCacheKey() const {
+	return Data::StreamingVerdictCacheKey(_dc, id);
+}
+
 uint8 DocumentData::cacheTag() const {
 	if (type == StickerDocument) {
 		return Data::kStickerCacheTag;
@@ -1488,8 +1513,19 @@ bool DocumentData::supportsStreaming() const {
 }
 
 void DocumentData::setNotSupportsStreaming() {
+	if ((_flags & kStreamingSupportedMask) == kStreamingSupportedNo) {
+		return;
+	}
 	_flags &= ~kStreamingSupportedMask;
 	_flags |= kStreamingSupportedNo;
+
+	// Remember the verdict, so after a restart the play button can
+	// offer the download right away, without a failing probe first.
+	owner().cache().put(
+		streamingVerdictCacheKey(),
+		Storage::Cache::Database::TaggedValue(
+			QByteArray(1, 1),
+			cacheTag()));
 }
 
 void DocumentData::setMaybeSupportsStreaming(bool supports) {
@@ -1500,6 +1536,25 @@ void DocumentData::setMaybeSupportsStreaming(bool supports) {
 	_flags |= supports
 		? kStreamingSupportedMaybeYes
 		: kStreamingSupportedMaybeNo;
+	if (supports && !(_flags & Flag::StreamingVerdictChecked)) {
+		_flags |= Flag::StreamingVerdictChecked;
+		checkStreamingVerdictCache();
+	}
+}
+
+void DocumentData::checkStreamingVerdictCache() {
+	const auto guard = base::make_weak(&session());
+	const auto document = this;
+	owner().cache().get(streamingVerdictCacheKey(), [=](QByteArray value) {
+		if (value.isEmpty()) {
+			return;
+		}
+		crl::on_main(guard, [=] {
+			// Apply the flags directly, the verdict is already cached.
+			document->_flags &= ~kStreamingSupportedMask;
+			document->_flags |= kStreamingSupportedNo;
+		});
+	});
 }
 
 void DocumentData::recountIsImage() {
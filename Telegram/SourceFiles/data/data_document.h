@@ -126,6 +126,8 @@ public:
 	[[nodiscard]] bool saveToCache() const;
 
 	[[nodiscard]] Image *getReplyPreview(Data::FileOrigin origin);
+	[[nodiscard]] bool hasUnreferencedReplyPreview() const;
+	void clearReplyPreview();
 
 	[[nodiscard]] StickerData *sticker() const;
 	[[nodiscard]] Data::FileOrigin stickerSetOrigin() const;
@@ -223,6 +225,8 @@ public:
 
 	[[nodiscard]] MediaKey mediaKey() const;
 	[[nodiscard]] Storage::Cache::Key cacheKey() const;
+	[[nodiscard]] Storage::Cache::Key voiceWaveformCacheKey() const;
+	[[nodiscard]] Storage::Cache::Key streamingVerdictCacheKey() const;
 	[[nodiscard]] uint8 cacheTag() const;
 
 	[[nodiscard]] static QString ComposeNameString(
@@ -259,6 +263,7 @@ private:
 		ImageType = 0x08,
 		DownloadCancelled = 0x10,
 		LoadedInMediaCache = 0x20,
+		StreamingVerdictChecked = 0x40,
 	};
 	using Flags = base::flags<Flag>;
 	friend constexpr bool is_flag_type(Flag) { return true; };
@@ -291,6 +296,7 @@ private:
 	[[nodiscard]] LocationType locationType() const;
 	void validateLottieSticker();
 	void setMaybeSupportsStreaming(bool supports);
+	void checkStreamingVerdictCache();
 	void setLoadedInMediaCacheLocation();
 
 	void finishLoad();
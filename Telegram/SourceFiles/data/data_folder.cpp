@@ -28,7 +28,6 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 namespace Data {
 namespace {
 
-constexpr auto kLoadedChatsMinCount = 20;
 constexpr auto kShowChatNamesCount = 8;
 
 rpl::producer<int> PinnedDialogsInFolderMaxValue(
@@ -349,7 +348,17 @@ void Folder::applyDialog(const MTPDdialogFolder &data) {
 		_chatsList.clear();
 		updateChatListExistence();
 	}
-	if (_chatsList.indexed()->size() < kLoadedChatsMinCount) {
+	// Load eagerly only enough entries for the collapsed row preview,
+	// the unread counters come with the dialogFolder data itself. The
+	// rest of the list is hydrated when the archive is actually opened.
+	if (_chatsList.indexed()->size() < kShowChatNamesCount
+		&& !_chatsList.loaded()) {
+		session().api().requestDialogs(this);
+	}
+}
+
+void Folder::requestChatsList() {
+	if (!_chatsList.loaded()) {
 		session().api().requestDialogs(this);
 	}
 }
@@ -39,6 +39,7 @@ public:
 	void oneListMessageChanged(HistoryItem *from, HistoryItem *to);
 
 	not_null<Dialogs::MainList*> chatsList();
+	void requestChatsList();
 
 	void applyDialog(const MTPDdialogFolder &data);
 	void applyPinnedUpdate(const MTPDupdateDialogPinned &data);
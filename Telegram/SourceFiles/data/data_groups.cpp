@@ -10,6 +10,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "history/history_item.h"
 #include "data/data_media_types.h"
 #include "data/data_session.h"
+#include "main/main_session.h"
 
 namespace Data {
 namespace {
@@ -140,8 +141,31 @@ const Group *Groups::find(not_null<HistoryItem*> item) const {
 }
 
 void Groups::refreshViews(const HistoryItemsList &items) {
-	for (const auto item : items) {
-		_data->requestItemViewRefresh(item);
+	if (items.empty()) {
+		return;
+	}
+	// Album members arrive one by one, both from a history slice and
+	// as uploads finish, and every arrival used to refresh each view
+	// of the whole group again. Coalesce to one refresh per group for
+	// a batch of arrivals, the items list is already up to date when
+	// the refresh runs.
+	_pendingRefreshViews.emplace(items.front()->groupId());
+	if (_pendingRefreshViews.size() == 1) {
+		crl::on_main(&_data->session(), [=] {
+			refreshPendingViews();
+		});
+	}
+}
+
+void Groups::refreshPendingViews() {
+	for (const auto groupId : base::take(_pendingRefreshViews)) {
+		const auto i = _groups.find(groupId);
+		if (i == end(_groups)) {
+			continue;
+		}
+		for (const auto item : i->second.items) {
+			_data->requestItemViewRefresh(item);
+		}
 	}
 }
 
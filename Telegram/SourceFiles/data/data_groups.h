@@ -7,6 +7,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 */
 #pragma once
 
+#include "base/flat_set.h"
 #include "data/data_types.h"
 
 namespace Data {
@@ -36,10 +37,12 @@ private:
 		const HistoryItemsList &group,
 		not_null<HistoryItem*> item);
 	void refreshViews(const HistoryItemsList &items);
+	void refreshPendingViews();
 
 	not_null<Session*> _data;
 	std::map<MessageGroupId, Group> _groups;
 	std::map<MessageGroupId, MessageGroupId> _alias;
+	base::flat_set<MessageGroupId> _pendingRefreshViews;
 
 };
 
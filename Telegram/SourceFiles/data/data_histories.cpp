@@ -23,6 +23,10 @@ namespace {
 
 constexpr auto kReadRequestTimeout = 3 * crl::time(1000);
 
+// Mass-reading a lot of dialogs at once floods the server with
+// readHistory requests and they get throttled, so cap the parallelism.
+constexpr auto kMaxReadRequestsInFlight = 8;
+
 } // namespace
 
 Histories::Histories(not_null<Session*> owner)
@@ -454,19 +458,36 @@ void Histories::sendReadRequests() {
 	}
 	const auto now = crl::now();
 	auto next = std::optional<crl::time>();
+	auto ready = std::vector<std::pair<not_null<History*>, State*>>();
 	for (auto &[history, state] : _states) {
 		if (!state.willReadTill) {
 			DEBUG_LOG(("Reading: skipping zero till."));
 			continue;
 		} else if (state.willReadWhen <= now) {
-			DEBUG_LOG(("Reading: sending with till %1."
-				).arg(state.willReadTill));
-			sendReadRequest(history, state);
+			ready.push_back({ history, &state });
 		} else if (!next || *next > state.willReadWhen) {
 			DEBUG_LOG(("Reading: scheduling for later send."));
 			next = state.willReadWhen;
 		}
 	}
+	// The opened dialog reads with force and gets a zero willReadWhen,
+	// so sorting lets it jump the queue when the cap is reached.
+	ranges::sort(ready, ranges::less(), [](const auto &pair) {
+		return pair.second->willReadWhen;
+	});
+	auto inFlight = sentRequestsCount(RequestType::ReadInbox);
+	for (const auto &[history, state] : ready) {
+		if (inFlight >= kMaxReadRequestsInFlight) {
+			// Each finished request invokes sendReadRequests() again.
+			DEBUG_LOG(("Reading: waiting, %1 requests in flight."
+				).arg(inFlight));
+			break;
+		}
+		DEBUG_LOG(("Reading: sending with till %1."
+			).arg(state->willReadTill));
+		sendReadRequest(history, *state);
+		++inFlight;
+	}
 	if (next.has_value()) {
 		_readRequestsTimer.callOnce(*next - now);
 	} else {
@@ -539,6 +560,17 @@ void Histories::checkEmptyState(not_null<History*> history) {
 	}
 }
 
+int Histories::sentRequestsCount(RequestType type) const {
+	const auto proj = [](const auto &pair) {
+		return pair.second.type;
+	};
+	auto result = 0;
+	for (const auto &[history, state] : _states) {
+		result += ranges::count(state.sent, type, proj);
+	}
+	return result;
+}
+
 bool Histories::postponeHistoryRequest(const State &state) const {
 	const auto proj = [](const auto &pair) {
 		return pair.second.type;
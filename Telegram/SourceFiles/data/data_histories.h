@@ -107,6 +107,7 @@ private:
 		int id);
 	[[nodiscard]] bool postponeHistoryRequest(const State &state) const;
 	[[nodiscard]] bool postponeEntryRequest(const State &state) const;
+	[[nodiscard]] int sentRequestsCount(RequestType type) const;
 	void postponeRequestDialogEntries();
 
 	void sendDialogRequests();
@@ -39,7 +39,15 @@ int MessagesList::uniteAndAdd(
 		MessagesRange noSkipRange) {
 	auto uniteFromIndex = uniteFrom - _slices.begin();
 	auto was = uniteFrom->messages.size();
+
+	// Reserve the united size at once, so merging a long row of slices
+	// doesn't reallocate the ever-growing set on every single merge.
+	auto united = was + (std::end(messages) - std::begin(messages));
+	for (auto it = uniteFrom + 1; it != uniteTill; ++it) {
+		united += it->messages.size();
+	}
 	_slices.modify(uniteFrom, [&](Slice &slice) {
+		slice.messages.reserve(united);
 		slice.merge(messages, noSkipRange);
 	});
 	auto firstToErase = uniteFrom + 1;
@@ -217,8 +225,12 @@ MessagesResult MessagesList::queryFromSlice(
 	auto haveEqualOrAfter = int(end(slice.messages) - position);
 	auto before = qMin(haveBefore, query.limitBefore);
 	auto equalOrAfter = qMin(haveEqualOrAfter, query.limitAfter + 1);
-	auto ids = std::vector<MessagePosition>(position - before, position + equalOrAfter);
-	result.messageIds.merge(ids.begin(), ids.end());
+
+	// A subrange of a sorted set is already sorted and unique, build the
+	// result from it directly instead of copying through a vector first.
+	result.messageIds = base::flat_set<MessagePosition>(
+		position - before,
+		position + equalOrAfter);
 	if (slice.range.from == MinMessagePosition) {
 		result.skippedBefore = haveBefore - before;
 	}
@@ -34,9 +34,12 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "history/view/history_view_element.h"
 #include "history/history_item.h"
 #include "storage/file_download.h"
+#include "storage/cache/storage_cache_database.h"
 #include "facades.h"
 #include "app.h"
 
+#include <QtCore/QBuffer>
+
 namespace {
 
 constexpr auto kUpdateFullPeerTimeout = crl::time(5000); // Not more than once in 5 seconds.
@@ -234,12 +237,88 @@ void PeerData::paintUserpic(
 		int y,
 		int size) const {
 	if (const auto userpic = currentUserpic(view)) {
-		p.drawPixmap(x, y, userpic->pixCircled(size, size));
-	} else {
+		const auto circled = userpic->pixCircled(size, size);
+		p.drawPixmap(x, y, circled);
+		storeUserpicInCache(circled);
+	} else if (!paintUserpicFromCache(p, x, y, size)) {
 		ensureEmptyUserpic()->paint(p, x, y, x + size + x, size);
 	}
 }
 
+bool PeerData::paintUserpicFromCache(
+		Painter &p,
+		int x,
+		int y,
+		int size) const {
+	if (!userpicPhotoId()) {
+		return false;
+	} else if (_userpicCircledCachedPhotoId == userpicPhotoId()
+		&& _userpicCircledCached.width() == size * cIntRetinaFactor()) {
+		p.drawPixmap(x, y, _userpicCircledCached);
+		return true;
+	}
+	loadUserpicFromCache(size);
+	return false;
+}
+
+void PeerData::storeUserpicInCache(const QPixmap &circled) const {
+	if (!userpicPhotoId()
+		|| _userpicCircledStoredPhotoId == userpicPhotoId()) {
+		return;
+	}
+	_userpicCircledStoredPhotoId = userpicPhotoId();
+	auto value = QByteArray();
+	{
+		auto buffer = QBuffer(&value);
+		buffer.open(QIODevice::WriteOnly);
+		auto stream = QDataStream(&buffer);
+		stream << quint64(userpicPhotoId())
+			<< qint32(circled.width())
+			<< circled.toImage();
+	}
+	owner().cache().put(
+		Data::UserpicCacheKey(id),
+		Storage::Cache::Database::TaggedValue(
+			std::move(value),
+			Data::kImageCacheTag));
+}
+
+void PeerData::loadUserpicFromCache(int size) const {
+	if (_userpicCircledCacheRequested) {
+		return;
+	}
+	_userpicCircledCacheRequested = true;
+	const auto guard = base::make_weak(&session());
+	const auto peer = this;
+	const auto pixels = size * cIntRetinaFactor();
+	owner().cache().get(Data::UserpicCacheKey(id), [=](QByteArray value) {
+		if (value.isEmpty()) {
+			return;
+		}
+		auto stream = QDataStream(value);
+		auto photoId = quint64();
+		auto side = qint32();
+		auto image = QImage();
+		stream >> photoId >> side >> image;
+		if (stream.status() != QDataStream::Ok
+			|| side != pixels
+			|| image.isNull()) {
+			return;
+		}
+		crl::on_main(guard, [=] {
+			// The photo could have changed while the value was read.
+			if (peer->userpicPhotoId() != PhotoId(photoId)) {
+				return;
+			}
+			peer->_userpicCircledCached = QPixmap::fromImage(image);
+			peer->_userpicCircledCached.setDevicePixelRatio(
+				cRetinaFactor());
+			peer->_userpicCircledCachedPhotoId = PhotoId(photoId);
+			peer->session().downloaderTaskFinished().notify();
+		});
+	});
+}
+
 void PeerData::paintUserpicRounded(
 		Painter &p,
 		std::shared_ptr<Data::CloudImageView> &view,
@@ -483,6 +562,24 @@ bool PeerData::setAbout(const QString &newAbout) {
 	return true;
 }
 
+std::optional<bool> PeerData::notifyMutedCached(int revision) const {
+	if (_notifyMutedCacheRevision != revision
+		|| (_notifyMutedCacheTill
+			&& crl::now() >= _notifyMutedCacheTill)) {
+		return std::nullopt;
+	}
+	return _notifyMutedCache;
+}
+
+void PeerData::cacheNotifyMuted(
+		bool muted,
+		crl::time till,
+		int revision) const {
+	_notifyMutedCache = muted;
+	_notifyMutedCacheTill = till;
+	_notifyMutedCacheRevision = revision;
+}
+
 void PeerData::checkFolder(FolderId folderId) {
 	const auto folder = folderId
 		? owner().folderLoaded(folderId)
@@ -531,7 +628,9 @@ void PeerData::fillNames() {
 
 	const auto namesList = TextUtilities::PrepareSearchWords(toIndex);
 	for (const auto &name : namesList) {
-		_nameWords.insert(name);
+		// Many peers share words like a common first name or a bot
+		// suffix, intern them so that all the copies share one data.
+		_nameWords.insert(Data::InternSearchWord(name));
 		_nameFirstLetters.insert(name[0]);
 	}
 }
@@ -546,7 +645,7 @@ void PeerData::updateFull() {
 }
 
 void PeerData::updateFullForced() {
-	session().api().requestFullPeer(this);
+	session().api().invalidateFullPeer(this);
 	if (const auto channel = asChannel()) {
 		if (!channel->amCreator() && !channel->inviter) {
 			session().api().requestSelfParticipant(channel);
@@ -797,6 +896,24 @@ bool PeerData::canSendPolls() const {
 }
 
 namespace Data {
+namespace {
+
+// A soft cap, so that a pathological contact list can not keep growing
+// the table forever - words over the limit are simply not shared.
+constexpr auto kInternedSearchWordsLimit = 65536;
+
+} // namespace
+
+QString InternSearchWord(const QString &word) {
+	static auto Words = base::flat_set<QString>();
+	const auto i = Words.find(word);
+	if (i != Words.end()) {
+		return *i;
+	} else if (Words.size() >= kInternedSearchWordsLimit) {
+		return word;
+	}
+	return *Words.emplace(word).first;
+}
 
 std::vector<ChatRestrictions> ListOfRestrictions() {
 	using Flag = ChatRestriction;
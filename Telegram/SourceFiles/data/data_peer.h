@@ -187,6 +187,8 @@ public:
 	[[nodiscard]] MTPinputPeerNotifySettings notifySerialize() const {
 		return _notify.serialize();
 	}
+	[[nodiscard]] std::optional<bool> notifyMutedCached(int revision) const;
+	void cacheNotifyMuted(bool muted, crl::time till, int revision) const;
 
 	[[nodiscard]] bool canWrite() const;
 	[[nodiscard]] Data::RestrictionCheckResult amRestricted(
@@ -381,6 +383,10 @@ private:
 
 	void setUserpicChecked(PhotoId photoId, const ImageLocation &location);
 
+	bool paintUserpicFromCache(Painter &p, int x, int y, int size) const;
+	void storeUserpicInCache(const QPixmap &circled) const;
+	void loadUserpicFromCache(int size) const;
+
 	static constexpr auto kUnknownPhotoId = PhotoId(0xFFFFFFFFFFFFFFFFULL);
 
 	const not_null<Data::Session*> _owner;
@@ -388,10 +394,24 @@ private:
 	mutable Data::CloudImage _userpic;
 	PhotoId _userpicPhotoId = kUnknownPhotoId;
 	mutable std::unique_ptr<Ui::EmptyUserpic> _userpicEmpty;
+
+	// The circled userpic bitmap persisted in the local cache, blitted
+	// till the photo itself is loaded and decoded after a restart.
+	mutable QPixmap _userpicCircledCached;
+	mutable PhotoId _userpicCircledCachedPhotoId = 0;
+	mutable PhotoId _userpicCircledStoredPhotoId = 0;
+	mutable bool _userpicCircledCacheRequested = false;
 	Ui::Text::String _nameText;
 
 	Data::NotifySettings _notify;
 
+	// Effective mute state with the default settings fallback already
+	// resolved, cached by Data::Session against its notify cache
+	// revision. The value expires by itself when the mute period ends.
+	mutable crl::time _notifyMutedCacheTill = 0;
+	mutable int _notifyMutedCacheRevision = -1;
+	mutable bool _notifyMutedCache = false;
+
 	ClickHandlerPtr _openLink;
 	base::flat_set<QString> _nameWords; // for filtering
 	base::flat_set<QChar> _nameFirstLetters;
@@ -409,6 +429,12 @@ namespace Data {
 
 std::vector<ChatRestrictions> ListOfRestrictions();
 
+// Returns a copy sharing its data with a single interned instance of
+// the word, so that equal search words of different peers don't each
+// keep their own heap allocation. Comparing two interned equal words
+// also takes the same-data shortcut inside QString comparison.
+[[nodiscard]] QString InternSearchWord(const QString &word);
+
 std::optional<QString> RestrictionError(
 	not_null<PeerData*> peer,
 	ChatRestriction restriction);
@@ -175,6 +175,20 @@ Image *PhotoData::getReplyPreview(Data::FileOrigin origin) {
 	return _replyPreview->image(origin);
 }
 
+bool PhotoData::hasUnreferencedReplyPreview() const {
+	if (!_replyPreview) {
+		return false;
+	}
+	const auto media = activeMediaView();
+	// One strong reference is the local one and one may be held
+	// by the reply preview itself, more mean an active user.
+	return !media || (media.use_count() <= 2);
+}
+
+void PhotoData::clearReplyPreview() {
+	_replyPreview = nullptr;
+}
+
 void PhotoData::setRemoteLocation(
 		int32 dc,
 		uint64 access,
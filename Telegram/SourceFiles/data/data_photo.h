@@ -59,6 +59,8 @@ public:
 	[[nodiscard]] bool waitingForAlbum() const;
 
 	[[nodiscard]] Image *getReplyPreview(Data::FileOrigin origin);
+	[[nodiscard]] bool hasUnreferencedReplyPreview() const;
+	void clearReplyPreview();
 
 	void setRemoteLocation(
 		int32 dc,
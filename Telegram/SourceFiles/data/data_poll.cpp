@@ -118,16 +118,20 @@ bool PollData::applyChanges(const MTPDpoll &poll) {
 	return true;
 }
 
-bool PollData::applyResults(const MTPPollResults &results) {
+PollResultsChange PollData::applyResults(const MTPPollResults &results) {
 	return results.match([&](const MTPDpollResults &results) {
 		_lastResultsUpdate = crl::now();
 
 		const auto newTotalVoters =
 			results.vtotal_voters().value_or(totalVoters);
 		auto changed = (newTotalVoters != totalVoters);
+		auto layoutChanged = false;
 		if (const auto list = results.vresults()) {
 			for (const auto &result : list->v) {
-				if (applyResultToAnswers(result, results.is_min())) {
+				if (applyResultToAnswers(
+						result,
+						results.is_min(),
+						&layoutChanged)) {
 					changed = true;
 				}
 			}
@@ -165,14 +169,17 @@ bool PollData::applyResults(const MTPPollResults &results) {
 			if (solution != newSolution) {
 				solution = std::move(newSolution);
 				changed = true;
+				layoutChanged = true;
 			}
 		}
 		if (!changed) {
-			return false;
+			return PollResultsChange::None;
 		}
 		totalVoters = newTotalVoters;
 		++version;
-		return changed;
+		return layoutChanged
+			? PollResultsChange::Layout
+			: PollResultsChange::Votes;
 	});
 }
 
@@ -199,7 +206,8 @@ const PollAnswer *PollData::answerByOption(const QByteArray &option) const {
 
 bool PollData::applyResultToAnswers(
 		const MTPPollAnswerVoters &result,
-		bool isMinResults) {
+		bool isMinResults,
+		not_null<bool*> layoutChanged) {
 	return result.match([&](const MTPDpollAnswerVoters &voters) {
 		const auto &option = voters.voption().v;
 		const auto answer = answerByOption(option);
@@ -214,6 +222,8 @@ bool PollData::applyResultToAnswers(
 			if (answer->chosen != voters.is_chosen()) {
 				answer->chosen = voters.is_chosen();
 				changed = true;
+				// Switches between options and results display.
+				*layoutChanged = true;
 			}
 		}
 		if (voters.is_correct() && !answer->correct) {
@@ -15,6 +15,12 @@ namespace Main {
 class Session;
 } // namespace Main
 
+enum class PollResultsChange : uchar {
+	None,
+	Votes, // Only vote counts / voters changed, the layout is intact.
+	Layout,
+};
+
 struct PollAnswer {
 	QString text;
 	QByteArray option;
@@ -49,7 +55,7 @@ struct PollData {
 
 	bool closeByTimer();
 	bool applyChanges(const MTPDpoll &poll);
-	bool applyResults(const MTPPollResults &results);
+	PollResultsChange applyResults(const MTPPollResults &results);
 	void checkResultsReload(not_null<HistoryItem*> item, crl::time now);
 
 	[[nodiscard]] PollAnswer *answerByOption(const QByteArray &option);
@@ -80,7 +86,8 @@ struct PollData {
 private:
 	bool applyResultToAnswers(
 		const MTPPollAnswerVoters &result,
-		bool isMinResults);
+		bool isMinResults,
+		not_null<bool*> layoutChanged);
 
 	const not_null<Data::Session*> _owner;
 	Flags _flags = Flags();
@@ -9,6 +9,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 #include "mainwidget.h"
 #include "main/main_session.h"
+#include "data/data_session.h"
+#include "observer_peer.h"
 #include "apiwrap.h"
 #include "app.h"
 
@@ -53,6 +55,8 @@ void PtsWaiter::applySkippedUpdates(ChannelData *channel) {
 
 	if (_queue.isEmpty()) return;
 
+	// The queue is sorted by pts, so the whole contiguous run is
+	// applied in one batch, as a single transaction on the data.
 	++_applySkippedLevel;
 	for (auto i = _queue.cbegin(), e = _queue.cend(); i != e; ++i) {
 		switch (i.value()) {
@@ -62,6 +66,13 @@ void PtsWaiter::applySkippedUpdates(ChannelData *channel) {
 	}
 	--_applySkippedLevel;
 	clearSkippedUpdates();
+
+	// Send the accumulated change notifications once for the whole
+	// run instead of relying on each caller to flush them after every
+	// single update, so gap recovery cost scales with the number of
+	// messages and not with the number of notifications.
+	Auth().data().sendHistoryChangeNotifications();
+	Notify::peerUpdatedSendDelayed();
 }
 
 void PtsWaiter::clearSkippedUpdates() {
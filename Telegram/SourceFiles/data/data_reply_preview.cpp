@@ -12,7 +12,12 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_document_media.h"
 #include "data/data_photo.h"
 #include "data/data_photo_media.h"
+#include "data/data_session.h"
+#include "storage/cache/storage_cache_database.h"
 #include "ui/image/image.h"
+#include "app.h"
+
+#include <QtCore/QBuffer>
 
 namespace Data {
 
@@ -51,18 +56,82 @@ void ReplyPreview::prepare(not_null<Image*> image, Images::Options options) {
 		prepareOptions,
 		outerSize,
 		outerSize);
-	_image = std::make_unique<Image>(bitmap.toImage());
+	auto prepared = bitmap.toImage();
 	_good = ((options & Images::Option::Blurred) == 0);
+	if (_good) {
+		saveToCache(prepared);
+	}
+	_image = std::make_unique<Image>(std::move(prepared));
+}
+
+Storage::Cache::Key ReplyPreview::cacheKey() const {
+	return ReplyPreviewCacheKey(
+		_photo ? _photo->id : _document->id,
+		_photo != nullptr,
+		st::msgReplyBarSize.height() * cIntRetinaFactor());
+}
+
+void ReplyPreview::loadFromCache() {
+	auto &owner = _photo ? _photo->owner() : _document->owner();
+	const auto weak = base::make_weak(this);
+	owner.cache().get(cacheKey(), [=](QByteArray &&value) {
+		crl::on_main(weak, [=, value = std::move(value)] {
+			cacheLoaded(value);
+		});
+	});
+}
+
+void ReplyPreview::cacheLoaded(const QByteArray &value) {
+	_cacheChecked = true;
+	if (!value.isEmpty() && (!_image || !_good)) {
+		auto image = App::readImage(value, nullptr, false);
+		if (!image.isNull()) {
+			_image = std::make_unique<Image>(std::move(image));
+			_good = true;
+			_checked = true;
+			_photoMedia = nullptr;
+			_documentMedia = nullptr;
+		}
+	}
+	// Repaint the views, either to show the cached thumbnail or to
+	// rerun image() now that the cache miss allows media requests.
+	if (_photo) {
+		_photo->owner().requestPhotoViewRepaint(_photo);
+	} else {
+		_document->owner().requestDocumentViewRepaint(_document);
+	}
+}
+
+void ReplyPreview::saveToCache(const QImage &image) {
+	auto bytes = QByteArray();
+	auto buffer = QBuffer(&bytes);
+	image.save(&buffer, "PNG");
+	if (bytes.isEmpty()) {
+		return;
+	}
+	auto &owner = _photo ? _photo->owner() : _document->owner();
+	owner.cache().put(cacheKey(), Storage::Cache::Database::TaggedValue{
+		std::move(bytes),
+		kImageCacheTag });
 }
 
 Image *ReplyPreview::image(Data::FileOrigin origin) {
 	if (_checked) {
 		return _image.get();
 	}
+	if (!_cacheRequested) {
+		_cacheRequested = true;
+		loadFromCache();
+	}
 	if (_document) {
 		if (!_image || (!_good && _document->hasThumbnail())) {
 			if (!_documentMedia) {
 				_documentMedia = _document->createMediaView();
+			}
+			// Don't request the original thumbnail while the cache is
+			// still being read, the embedded one is good enough for now.
+			if (_cacheChecked && !_requested) {
+				_requested = true;
 				_documentMedia->thumbnailWanted(origin);
 			}
 			const auto thumbnail = _documentMedia->thumbnail();
@@ -76,7 +145,7 @@ Image *ReplyPreview::image(Data::FileOrigin origin) {
 					prepare(image, option | Images::Option::Blurred);
 				}
 			}
-			if (_good || !_document->hasThumbnail()) {
+			if (_good || (_cacheChecked && !_document->hasThumbnail())) {
 				_checked = true;
 				_documentMedia = nullptr;
 			}
@@ -86,6 +155,9 @@ Image *ReplyPreview::image(Data::FileOrigin origin) {
 		if (!_image || !_good) {
 			if (!_photoMedia) {
 				_photoMedia = _photo->createMediaView();
+			}
+			if (_cacheChecked && !_requested) {
+				_requested = true;
 				_photoMedia->wanted(PhotoSize::Small, origin);
 			}
 			if (const auto small = _photoMedia->image(PhotoSize::Small)) {
@@ -7,17 +7,25 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 */
 #pragma once
 
+#include "base/weak_ptr.h"
+
 class Image;
 class DocumentData;
 class PhotoData;
 
+namespace Storage {
+namespace Cache {
+struct Key;
+} // namespace Cache
+} // namespace Storage
+
 namespace Data {
 
 class PhotoMedia;
 class DocumentMedia;
 struct FileOrigin;
 
-class ReplyPreview {
+class ReplyPreview final : public base::has_weak_ptr {
 public:
 	explicit ReplyPreview(not_null<DocumentData*> document);
 	explicit ReplyPreview(not_null<PhotoData*> photo);
@@ -28,6 +36,11 @@ public:
 private:
 	void prepare(not_null<Image*> image, Images::Options options);
 
+	[[nodiscard]] Storage::Cache::Key cacheKey() const;
+	void loadFromCache();
+	void cacheLoaded(const QByteArray &value);
+	void saveToCache(const QImage &image);
+
 	std::unique_ptr<Image> _image;
 	PhotoData *_photo = nullptr;
 	DocumentData *_document = nullptr;
@@ -35,6 +48,9 @@ private:
 	std::shared_ptr<DocumentMedia> _documentMedia;
 	bool _good = false;
 	bool _checked = false;
+	bool _cacheRequested = false;
+	bool _cacheChecked = false;
+	bool _requested = false;
 
 };
 
@@ -200,10 +200,13 @@ void ScheduledMessages::apply(const MTPDupdateNewScheduledMessage &update) {
 	if (!history) {
 		return;
 	}
+	const auto hashBefore = listHash(history);
 	auto &list = _data[history];
 	append(history, list, message);
-	sort(list);
-	_updates.fire_copy(history);
+	if (countListHash(list) != hashBefore) {
+		sort(list);
+		_updates.fire_copy(history);
+	}
 }
 
 void ScheduledMessages::checkEntitiesAndUpdate(const MTPDmessage &data) {
@@ -381,6 +384,7 @@ void ScheduledMessages::parse(
 			clearNotSending(history);
 			return;
 		}
+		const auto hashBefore = listHash(history);
 		auto received = base::flat_set<not_null<HistoryItem*>>();
 		auto clear = base::flat_set<not_null<HistoryItem*>>();
 		auto &list = _data.emplace(history, List()).first->second;
@@ -395,7 +399,7 @@ void ScheduledMessages::parse(
 				clear.emplace(item);
 			}
 		}
-		updated(history, received, clear);
+		updated(history, hashBefore, received, clear);
 	});
 }
 
@@ -443,17 +447,19 @@ void ScheduledMessages::clearNotSending(not_null<History*> history) {
 	if (i == end(_data)) {
 		return;
 	}
+	const auto hashBefore = countListHash(i->second);
 	auto clear = base::flat_set<not_null<HistoryItem*>>();
 	for (const auto &owned : i->second.items) {
 		if (!owned->isSending() && !owned->hasFailed()) {
 			clear.emplace(owned.get());
 		}
 	}
-	updated(history, {}, clear);
+	updated(history, hashBefore, {}, clear);
 }
 
 void ScheduledMessages::updated(
 		not_null<History*> history,
+		int32 hashBefore,
 		const base::flat_set<not_null<HistoryItem*>> &added,
 		const base::flat_set<not_null<HistoryItem*>> &clear) {
 	if (!clear.empty()) {
@@ -461,13 +467,22 @@ void ScheduledMessages::updated(
 			item->destroy();
 		}
 	}
+	// Fire the update only if the list differs by the same criterion the
+	// server uses for messagesNotModified, a re-received identical list
+	// shouldn't cause a full relayout of the scheduled section.
+	if (listHash(history) == hashBefore) {
+		return;
+	}
 	const auto i = _data.find(history);
 	if (i != end(_data)) {
 		sort(i->second);
 	}
-	if (!added.empty() || !clear.empty()) {
-		_updates.fire_copy(history);
-	}
+	_updates.fire_copy(history);
+}
+
+int32 ScheduledMessages::listHash(not_null<History*> history) const {
+	const auto i = _data.find(history);
+	return (i != end(_data)) ? countListHash(i->second) : 0;
 }
 
 void ScheduledMessages::sort(List &list) {
@@ -74,8 +74,10 @@ private:
 	void clearNotSending(not_null<History*> history);
 	void updated(
 		not_null<History*> history,
+		int32 hashBefore,
 		const base::flat_set<not_null<HistoryItem*>> &added,
 		const base::flat_set<not_null<HistoryItem*>> &clear);
+	[[nodiscard]] int32 listHash(not_null<History*> history) const;
 	void sort(List &list);
 	void remove(not_null<const HistoryItem*> item);
 	[[nodiscard]] int32 countListHash(const List &list) const;
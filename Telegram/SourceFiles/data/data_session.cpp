@@ -15,6 +15,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "core/application.h"
 #include "core/mime_type.h" // Core::IsMimeSticker
 #include "core/crash_reports.h" // CrashReports::SetAnnotation
+#include "core/dispatch_tracer.h"
+#include "core/memory_stats.h"
 #include "ui/image/image.h"
 #include "ui/image/image_location_factory.h" // Images::FromPhotoSize
 #include "export/export_controller.h"
@@ -63,6 +65,21 @@ namespace {
 constexpr auto kMaxNotifyCheckDelay = 24 * 3600 * crl::time(1000);
 constexpr auto kMaxWallpaperSize = 10 * 1024 * 1024;
 
+// Look for unreferenced media objects with this interval,
+// but only when the user stays idle long enough.
+constexpr auto kMediaSweepInterval = 60 * crl::time(1000);
+constexpr auto kMediaSweepIdleDuration = 30 * crl::time(1000);
+
+// The typing and play-game animations have periods of hundreds of
+// milliseconds, stepping them at about half the display rate is
+// indistinguishable but halves the repaints of the chats list rows
+// and the top bar while someone is typing.
+constexpr auto kSendActionsAnimationStep = crl::time(30);
+
+// Rough lower bound for a HistoryItem with its components, the text
+// layout and media caches are not included.
+constexpr auto kHistoryItemBytesEstimate = qint64(512);
+
 using ViewElement = HistoryView::Element;
 
 // s: box 100x100
@@ -211,6 +228,7 @@ Session::Session(not_null<Main::Session*> session)
 , _contactsList(Dialogs::SortMode::Name)
 , _contactsNoChatsList(Dialogs::SortMode::Name)
 , _selfDestructTimer([=] { checkSelfDestructItems(); })
+, _mediaSweepTimer([=] { sweepUnreferencedMedia(); })
 , _sendActionsAnimation([=](crl::time now) {
 	return sendActionsAnimationCallback(now);
 })
@@ -243,6 +261,33 @@ Session::Session(not_null<Main::Session*> session)
 	) | rpl::start_with_next([] {
 		Notify::unreadCounterUpdated();
 	}, _lifetime);
+
+	Core::MemoryStats::Register(qsl("data_session"), [=] {
+		using Entry = Core::MemoryStats::Entry;
+		auto items = qint64(_messages.size());
+		for (const auto &[channelId, messages] : _channelMessages) {
+			items += messages.size();
+		}
+		return std::vector<Entry>{
+			{
+				qsl("history_items"),
+				items,
+				items * kHistoryItemBytesEstimate,
+			},
+			{
+				qsl("photos"),
+				qint64(_photos.size()),
+				qint64(_photos.size() * sizeof(PhotoData)),
+			},
+			{
+				qsl("documents"),
+				qint64(_documents.size()),
+				qint64(_documents.size() * sizeof(DocumentData)),
+			},
+		};
+	}, _lifetime);
+
+	_mediaSweepTimer.callEach(kMediaSweepInterval);
 }
 
 void Session::clear() {
@@ -263,6 +308,8 @@ void Session::clear() {
 	_locations.clear();
 	_polls.clear();
 	_games.clear();
+	_documentSweepCandidates.clear();
+	_photoSweepCandidates.clear();
 	_documents.clear();
 	_photos.clear();
 }
@@ -775,8 +822,19 @@ PeerData *Session::peerByUsername(const QString &username) const {
 	return nullptr;
 }
 
-void Session::enumerateUsers(Fn<void(not_null<UserData*>)> action) const {
+std::vector<not_null<PeerData*>> Session::peersSnapshot() const {
+	auto result = std::vector<not_null<PeerData*>>();
+	result.reserve(_peers.size());
 	for (const auto &[peerId, peer] : _peers) {
+		result.push_back(peer.get());
+	}
+	return result;
+}
+
+void Session::enumerateUsers(Fn<void(not_null<UserData*>)> action) const {
+	// The action may end up loading new peers, which would invalidate
+	// the live unordered_map iterators, so enumerate over a snapshot.
+	for (const auto &peer : peersSnapshot()) {
 		if (const auto user = peer->asUser()) {
 			action(user);
 		}
@@ -784,16 +842,16 @@ void Session::enumerateUsers(Fn<void(not_null<UserData*>)> action) const {
 }
 
 void Session::enumerateGroups(Fn<void(not_null<PeerData*>)> action) const {
-	for (const auto &[peerId, peer] : _peers) {
+	for (const auto &peer : peersSnapshot()) {
 		if (peer->isChat() || peer->isMegagroup()) {
-			action(peer.get());
+			action(peer);
 		}
 	}
 }
 
 void Session::enumerateChannels(
 		Fn<void(not_null<ChannelData*>)> action) const {
-	for (const auto &[peerId, peer] : _peers) {
+	for (const auto &peer : peersSnapshot()) {
 		if (const auto channel = peer->asChannel()) {
 			if (!channel->isMegagroup()) {
 				action(channel);
@@ -847,7 +905,6 @@ void Session::registerSendAction(
 	if (history->updateSendActionNeedsAnimating(user, action)) {
 		user->madeAction(when);
 
-		const auto i = _sendActions.find(history);
 		if (!_sendActions.contains(history)) {
 			_sendActions.emplace(history, crl::now());
 			_sendActionsAnimation.start();
@@ -856,6 +913,10 @@ void Session::registerSendAction(
 }
 
 bool Session::sendActionsAnimationCallback(crl::time now) {
+	if (now < _lastSendActionsStep + kSendActionsAnimationStep) {
+		return !_sendActions.empty();
+	}
+	_lastSendActionsStep = now;
 	for (auto i = begin(_sendActions); i != end(_sendActions);) {
 		if (i->first->updateSendActionNeedsAnimating(now)) {
 			++i;
@@ -1845,16 +1906,17 @@ void Session::registerMessage(not_null<HistoryItem*> item) {
 void Session::processMessagesDeleted(
 		ChannelId channelId,
 		const QVector<MTPint> &data) {
-	const auto list = messagesList(channelId);
 	const auto affected = (channelId != NoChannel)
 		? historyLoaded(peerFromChannel(channelId))
 		: nullptr;
-	if (!list && !affected) {
+	if (!messagesList(channelId) && !affected) {
 		return;
 	}
 
 	auto historiesToCheck = base::flat_set<not_null<History*>>();
 	for (const auto messageId : data) {
+		// destroy() drops the whole list when the last message goes away.
+		const auto list = messagesList(channelId);
 		const auto i = list ? list->find(messageId.v) : Messages::iterator();
 		if (list && i != list->end()) {
 			const auto history = i->second->history();
@@ -1889,7 +1951,20 @@ void Session::unregisterMessage(not_null<HistoryItem*> item) {
 	_itemRemoved.fire_copy(item);
 	groups().unregisterMessage(item);
 	removeDependencyMessage(item);
-	messagesListForInsert(peerToChannel(peerId))->erase(item->id);
+	const auto channelId = peerToChannel(peerId);
+	if (channelId == NoChannel) {
+		_messages.erase(item->id);
+		return;
+	}
+	const auto i = _channelMessages.find(channelId);
+	if (i != end(_channelMessages)) {
+		i->second.erase(item->id);
+		if (i->second.empty()) {
+			// Free the whole index table, it can get large
+			// after scrolling through an old broadcast channel.
+			_channelMessages.erase(i);
+		}
+	}
 }
 
 MsgId Session::nextLocalMessageId() {
@@ -2167,6 +2242,45 @@ void Session::checkSelfDestructItems() {
 	}
 }
 
+void Session::sweepUnreferencedMedia() {
+	if (Core::App().lastNonIdleTime() + kMediaSweepIdleDuration
+		> crl::now()) {
+		return;
+	}
+	const auto sweep = [](auto &objects, auto &candidates, int &counter) {
+		auto result = 0;
+		auto next = std::remove_reference_t<decltype(candidates)>();
+		for (const auto &[id, object] : objects) {
+			if (!object->hasUnreferencedReplyPreview()) {
+				continue;
+			} else if (candidates.contains(object.get())) {
+				object->clearReplyPreview();
+				++result;
+			} else {
+				next.emplace(object.get());
+			}
+		}
+		candidates = std::move(next);
+		counter += result;
+		return result;
+	};
+	const auto photos = sweep(_photos, _photoSweepCandidates, _photoPreviewsSwept);
+	const auto documents = sweep(
+		_documents,
+		_documentSweepCandidates,
+		_documentPreviewsSwept);
+	if (photos || documents) {
+		DEBUG_LOG(("Media Sweep: Freed %1 photo and %2 document previews, "
+			"%3 / %4 total, %5 / %6 candidates left."
+			).arg(photos
+			).arg(documents
+			).arg(_photoPreviewsSwept
+			).arg(_documentPreviewsSwept
+			).arg(_photoSweepCandidates.size()
+			).arg(_documentSweepCandidates.size()));
+	}
+}
+
 not_null<PhotoData*> Session::photo(PhotoId id) {
 	auto i = _photos.find(id);
 	if (i == _photos.end()) {
@@ -2393,6 +2507,20 @@ not_null<DocumentData*> Session::document(DocumentId id) {
 	return i->second.get();
 }
 
+DocumentData *Session::documentLoaded(DocumentId id) const {
+	const auto i = _documents.find(id);
+	return (i != _documents.cend()) ? i->second.get() : nullptr;
+}
+
+std::vector<DocumentId> Session::documentIdsSnapshot() const {
+	auto result = std::vector<DocumentId>();
+	result.reserve(_documents.size());
+	for (const auto &[documentId, document] : _documents) {
+		result.push_back(documentId);
+	}
+	return result;
+}
+
 not_null<DocumentData*> Session::processDocument(const MTPDocument &data) {
 	return data.match([&](const MTPDdocument &data) {
 		return processDocument(data);
@@ -2935,10 +3063,7 @@ not_null<PollData*> Session::processPoll(const MTPPoll &data) {
 
 not_null<PollData*> Session::processPoll(const MTPDmessageMediaPoll &data) {
 	const auto result = processPoll(data.vpoll());
-	const auto changed = result->applyResults(data.vresults());
-	if (changed) {
-		notifyPollUpdateDelayed(result);
-	}
+	notifyPollResultsChange(result, result->applyResults(data.vresults()));
 	return result;
 }
 
@@ -2975,8 +3100,10 @@ void Session::applyUpdate(const MTPDupdateMessagePoll &update) {
 			? processPoll(*poll).get()
 			: i->second.get();
 	}();
-	if (updated && updated->applyResults(update.vresults())) {
-		notifyPollUpdateDelayed(updated);
+	if (updated) {
+		notifyPollResultsChange(
+			updated,
+			updated->applyResults(update.vresults()));
 	}
 }
 
@@ -3276,14 +3403,17 @@ QString Session::findContactPhone(UserId contactId) const {
 bool Session::hasPendingWebPageGamePollNotification() const {
 	return !_webpagesUpdated.empty()
 		|| !_gamesUpdated.empty()
-		|| !_pollsUpdated.empty();
+		|| !_pollsUpdated.empty()
+		|| !_pollsVotesUpdated.empty();
 }
 
 void Session::notifyWebPageUpdateDelayed(not_null<WebPageData*> page) {
 	const auto invoke = !hasPendingWebPageGamePollNotification();
 	_webpagesUpdated.insert(page);
 	if (invoke) {
-		crl::on_main(_session, [=] { sendWebPageGamePollNotifications(); });
+		Core::DispatchTracer::OnMain("data notifications", _session, [=] {
+			sendWebPageGamePollNotifications();
+		});
 	}
 }
 
@@ -3291,7 +3421,9 @@ void Session::notifyGameUpdateDelayed(not_null<GameData*> game) {
 	const auto invoke = !hasPendingWebPageGamePollNotification();
 	_gamesUpdated.insert(game);
 	if (invoke) {
-		crl::on_main(_session, [=] { sendWebPageGamePollNotifications(); });
+		Core::DispatchTracer::OnMain("data notifications", _session, [=] {
+			sendWebPageGamePollNotifications();
+		});
 	}
 }
 
@@ -3299,7 +3431,28 @@ void Session::notifyPollUpdateDelayed(not_null<PollData*> poll) {
 	const auto invoke = !hasPendingWebPageGamePollNotification();
 	_pollsUpdated.insert(poll);
 	if (invoke) {
-		crl::on_main(_session, [=] { sendWebPageGamePollNotifications(); });
+		Core::DispatchTracer::OnMain("data notifications", _session, [=] {
+			sendWebPageGamePollNotifications();
+		});
+	}
+}
+
+void Session::notifyPollResultsChange(
+		not_null<PollData*> poll,
+		PollResultsChange change) {
+	// Vote-count-only changes don't move the layout, so the views just
+	// repaint and apply the deltas to their cached answers, instead of
+	// going through a full resize cascade on every burst of votes.
+	if (change == PollResultsChange::Layout) {
+		notifyPollUpdateDelayed(poll);
+	} else if (change == PollResultsChange::Votes) {
+		const auto invoke = !hasPendingWebPageGamePollNotification();
+		_pollsVotesUpdated.insert(poll);
+		if (invoke) {
+			Core::DispatchTracer::OnMain("data notifications", _session, [=] {
+				sendWebPageGamePollNotifications();
+			});
+		}
 	}
 }
 
@@ -3320,12 +3473,20 @@ void Session::sendWebPageGamePollNotifications() {
 		}
 	}
 	for (const auto poll : base::take(_pollsUpdated)) {
+		_pollsVotesUpdated.remove(poll);
 		if (const auto i = _pollViews.find(poll); i != _pollViews.end()) {
 			for (const auto view : i->second) {
 				requestViewResize(view);
 			}
 		}
 	}
+	for (const auto poll : base::take(_pollsVotesUpdated)) {
+		if (const auto i = _pollViews.find(poll); i != _pollViews.end()) {
+			for (const auto view : i->second) {
+				requestViewRepaint(view);
+			}
+		}
+	}
 }
 
 void Session::registerItemView(not_null<ViewElement*> view) {
@@ -3442,11 +3603,23 @@ auto Session::refreshChatListEntry(
 	if (!history) {
 		return result;
 	}
+	auto dirtyInputs = _chatsFilters->takeRefreshInputs(history);
+	if (mainListResult.changed) {
+		dirtyInputs = ChatFilter::kAllInputs;
+	}
 	for (const auto &filter : _chatsFilters->list()) {
 		const auto id = filter.id();
 		const auto filterList = chatsFilters().chatsList(id);
 		auto filterResult = RefreshChatListEntryResult();
-		if (filter.contains(history)) {
+		if (!(dirtyInputs & filter.inputsUsed())) {
+			// No predicate input of this filter has changed, so the
+			// membership is up to date and only the position can move.
+			if (entry->inChatList(id)) {
+				filterResult.moved = entry->adjustByPosInChatList(
+					id,
+					filterList);
+			}
+		} else if (filter.contains(history)) {
 			filterResult.changed = !entry->inChatList(id);
 			if (filterResult.changed) {
 				entry->addToChatList(id, filterList);
@@ -3518,6 +3691,7 @@ void Session::applyNotifySetting(
 	switch (notifyPeer.type()) {
 	case mtpc_notifyUsers: {
 		if (_defaultUserNotifySettings.change(settings)) {
+			++_notifyCacheRevision;
 			_defaultUserNotifyUpdates.fire({});
 
 			enumerateUsers([&](not_null<UserData*> user) {
@@ -3533,6 +3707,7 @@ void Session::applyNotifySetting(
 	} break;
 	case mtpc_notifyChats: {
 		if (_defaultChatNotifySettings.change(settings)) {
+			++_notifyCacheRevision;
 			_defaultChatNotifyUpdates.fire({});
 
 			enumerateGroups([&](not_null<PeerData*> peer) {
@@ -3548,6 +3723,7 @@ void Session::applyNotifySetting(
 	} break;
 	case mtpc_notifyBroadcasts: {
 		if (_defaultBroadcastNotifySettings.change(settings)) {
+			++_notifyCacheRevision;
 			_defaultBroadcastNotifyUpdates.fire({});
 
 			enumerateChannels([&](not_null<ChannelData*> channel) {
@@ -3585,6 +3761,15 @@ void Session::updateNotifySettings(
 bool Session::notifyIsMuted(
 		not_null<const PeerData*> peer,
 		crl::time *changesIn) const {
+	if (!changesIn) {
+		// The dialogs list and the notifications manager check the
+		// mute state over and over, so the resolved value is cached
+		// on the peer till the settings or the defaults change.
+		if (const auto cached = peer->notifyMutedCached(
+				_notifyCacheRevision)) {
+			return *cached;
+		}
+	}
 	const auto resultFromUntil = [&](TimeId until) {
 		const auto now = base::unixtime::now();
 		const auto result = (until > now) ? (until - now) : 0;
@@ -3593,6 +3778,10 @@ bool Session::notifyIsMuted(
 				? std::min(result * crl::time(1000), kMaxNotifyCheckDelay)
 				: kMaxNotifyCheckDelay;
 		}
+		peer->cacheNotifyMuted(
+			(result > 0),
+			(result > 0) ? (crl::now() + result * crl::time(1000)) : 0,
+			_notifyCacheRevision);
 		return (result > 0);
 	};
 	if (const auto until = peer->notifyMuteUntil()) {
@@ -3602,6 +3791,7 @@ bool Session::notifyIsMuted(
 	if (const auto until = settings.muteUntil()) {
 		return resultFromUntil(*until);
 	}
+	peer->cacheNotifyMuted(true, 0, _notifyCacheRevision);
 	return true;
 }
 
@@ -26,6 +26,7 @@ class HistoryService;
 struct WebPageCollage;
 enum class WebPageType;
 enum class NewMessageType;
+enum class PollResultsChange : uchar;
 
 namespace HistoryView {
 struct Group;
@@ -165,6 +166,12 @@ public:
 	void enumerateUsers(Fn<void(not_null<UserData*>)> action) const;
 	void enumerateGroups(Fn<void(not_null<PeerData*>)> action) const;
 	void enumerateChannels(Fn<void(not_null<ChannelData*>)> action) const;
+
+	// A stable snapshot for long or re-entrant enumerations: the live
+	// container may grow while the snapshot is being traversed. Loaded
+	// peers are owned by the session till the very cleanup, but they
+	// still must be used from the main thread only.
+	[[nodiscard]] std::vector<not_null<PeerData*>> peersSnapshot() const;
 	[[nodiscard]] PeerData *peerByUsername(const QString &username) const;
 
 	[[nodiscard]] not_null<History*> history(PeerId peerId);
@@ -495,6 +502,13 @@ public:
 		const ImageLocation &thumbnailLocation);
 
 	[[nodiscard]] not_null<DocumentData*> document(DocumentId id);
+	[[nodiscard]] DocumentData *documentLoaded(DocumentId id) const;
+
+	// Unlike peers, documents may be destroyed while a long sliced
+	// enumeration is paused, so the snapshot holds ids and each one is
+	// looked up again through documentLoaded() when its slice runs.
+	[[nodiscard]] std::vector<DocumentId> documentIdsSnapshot() const;
+
 	not_null<DocumentData*> processDocument(const MTPDocument &data);
 	not_null<DocumentData*> processDocument(const MTPDdocument &data);
 	not_null<DocumentData*> processDocument(
@@ -622,6 +636,9 @@ public:
 	void notifyWebPageUpdateDelayed(not_null<WebPageData*> page);
 	void notifyGameUpdateDelayed(not_null<GameData*> game);
 	void notifyPollUpdateDelayed(not_null<PollData*> poll);
+	void notifyPollResultsChange(
+		not_null<PollData*> poll,
+		PollResultsChange change);
 	bool hasPendingWebPageGamePollNotification() const;
 	void sendWebPageGamePollNotifications();
 
@@ -713,6 +730,7 @@ private:
 	void setupUserIsContactViewer();
 
 	void checkSelfDestructItems();
+	void sweepUnreferencedMedia();
 
 	int computeUnreadBadge(const Dialogs::UnreadState &state) const;
 	bool computeUnreadBadgeMuted(const Dialogs::UnreadState &state) const;
@@ -898,7 +916,7 @@ private:
 
 	MsgId _localMessageIdCounter = StartClientMsgId;
 	Messages _messages;
-	std::map<ChannelId, Messages> _channelMessages;
+	base::flat_map<ChannelId, Messages> _channelMessages;
 	std::map<
 		not_null<HistoryItem*>,
 		base::flat_set<not_null<HistoryItem*>>> _dependentMessages;
@@ -909,9 +927,18 @@ private:
 	base::Timer _selfDestructTimer;
 	std::vector<FullMsgId> _selfDestructItems;
 
+	// Media objects survive one full sweep as unreferenced candidates
+	// before their regenerable caches are dropped on the next one.
+	base::Timer _mediaSweepTimer;
+	base::flat_set<not_null<PhotoData*>> _photoSweepCandidates;
+	base::flat_set<not_null<DocumentData*>> _documentSweepCandidates;
+	int _photoPreviewsSwept = 0;
+	int _documentPreviewsSwept = 0;
+
 	// When typing in this history started.
 	base::flat_map<not_null<History*>, crl::time> _sendActions;
 	Ui::Animations::Basic _sendActionsAnimation;
+	crl::time _lastSendActionsStep = 0;
 
 	std::unordered_map<
 		PhotoId,
@@ -959,6 +986,7 @@ private:
 	base::flat_set<not_null<WebPageData*>> _webpagesUpdated;
 	base::flat_set<not_null<GameData*>> _gamesUpdated;
 	base::flat_set<not_null<PollData*>> _pollsUpdated;
+	base::flat_set<not_null<PollData*>> _pollsVotesUpdated;
 
 	base::flat_multi_map<TimeId, not_null<PollData*>> _pollsClosings;
 	base::Timer _pollsClosingTimer;
@@ -983,6 +1011,10 @@ private:
 	std::unordered_set<not_null<const PeerData*>> _mutedPeers;
 	base::Timer _unmuteByFinishedTimer;
 
+	// Invalidates every per-peer cached effective mute state at once
+	// when one of the three default notify settings above changes.
+	int _notifyCacheRevision = 0;
+
 	std::unordered_map<PeerId, std::unique_ptr<PeerData>> _peers;
 
 	MessageIdsList _mimeForwardIds;
@@ -29,6 +29,13 @@ constexpr auto kUrlCacheTag = 0x0000030000000000ULL;
 constexpr auto kUrlCacheMask = 0x000000FFFFFFFFFFULL;
 constexpr auto kGeoPointCacheTag = 0x0000040000000000ULL;
 constexpr auto kGeoPointCacheMask = 0x000000FFFFFFFFFFULL;
+constexpr auto kReplyPreviewCacheTag = 0x0000050000000000ULL;
+constexpr auto kReplyPreviewCacheMask = 0x000000FFFFFFFFFFULL;
+constexpr auto kVoiceWaveformCacheTag = 0x0000060000000000ULL;
+constexpr auto kVoiceWaveformCacheMask = 0x000000FFFFFFFFFFULL;
+constexpr auto kStreamingVerdictCacheTag = 0x0000070000000000ULL;
+constexpr auto kStreamingVerdictCacheMask = 0x000000FFFFFFFFFFULL;
+constexpr auto kUserpicCacheTag = 0x0000080000000000ULL;
 
 } // namespace
 
@@ -93,6 +100,35 @@ Storage::Cache::Key GeoPointCacheKey(const GeoPointLocation &location) {
 	};
 }
 
+Storage::Cache::Key ReplyPreviewCacheKey(uint64 id, bool isPhoto, int32 size) {
+	const auto part = ((isPhoto ? 1ULL : 0ULL) << 32)
+		| uint64(uint32(size));
+	return Storage::Cache::Key{
+		Data::kReplyPreviewCacheTag | (part & Data::kReplyPreviewCacheMask),
+		id
+	};
+}
+
+Storage::Cache::Key VoiceWaveformCacheKey(int32 dcId, uint64 id) {
+	return Storage::Cache::Key{
+		Data::kVoiceWaveformCacheTag
+			| (uint64(dcId) & Data::kVoiceWaveformCacheMask),
+		id
+	};
+}
+
+Storage::Cache::Key StreamingVerdictCacheKey(int32 dcId, uint64 id) {
+	return Storage::Cache::Key{
+		kStreamingVerdictCacheTag
+			| (uint64(dcId) & kStreamingVerdictCacheMask),
+		id
+	};
+}
+
+Storage::Cache::Key UserpicCacheKey(uint64 peerId) {
+	return Storage::Cache::Key{ kUserpicCacheTag, peerId };
+}
+
 } // namespace Data
 
 uint32 AudioMsgId::CreateExternalPlayId() {
@@ -47,6 +47,10 @@ Storage::Cache::Key DocumentThumbCacheKey(int32 dcId, uint64 id);
 Storage::Cache::Key WebDocumentCacheKey(const WebFileLocation &location);
 Storage::Cache::Key UrlCacheKey(const QString &location);
 Storage::Cache::Key GeoPointCacheKey(const GeoPointLocation &location);
+Storage::Cache::Key ReplyPreviewCacheKey(uint64 id, bool isPhoto, int32 size);
+Storage::Cache::Key VoiceWaveformCacheKey(int32 dcId, uint64 id);
+Storage::Cache::Key StreamingVerdictCacheKey(int32 dcId, uint64 id);
+Storage::Cache::Key UserpicCacheKey(uint64 peerId);
 
 constexpr auto kImageCacheTag = uint8(0x01);
 constexpr auto kStickerCacheTag = uint8(0x02);
@@ -55,11 +55,30 @@ Main::Session &Entry::session() const {
 	return _owner->session();
 }
 
-void Entry::pinnedIndexChanged(int was, int now) {
+void Entry::pinnedIndexChanged(FilterId filterId, int was, int now) {
 	if (session().supportMode()) {
 		// Force reorder in support mode.
 		_sortKeyInChatList = 0;
 	}
+	if (was && now && inChatList(filterId)) {
+		// Moving between two pinned positions keeps the entry in all
+		// the same lists, so the full update below, which rebuilds the
+		// filter membership and triggers a wide list refresh on every
+		// step of a reorder drag, is skipped and the row is adjusted
+		// in place inside the pinned slice of the one affected list.
+		if (!filterId) {
+			const auto fixedIndex = fixedOnTopIndex();
+			_sortKeyInChatList = fixedIndex
+				? FixedOnTopDialogPos(fixedIndex)
+				: computeSortPosition(0);
+		}
+		const auto list = filterId
+			? owner().chatsFilters().chatsList(filterId)
+			: owner().chatsList(folder());
+		adjustByPosInChatList(filterId, list);
+		updateChatListEntry();
+		return;
+	}
 	updateChatListSortPosition();
 	updateChatListEntry();
 	if ((was != 0) != (now != 0)) {
@@ -75,14 +94,14 @@ void Entry::cachePinnedIndex(FilterId filterId, int index) {
 	}
 	if (!index) {
 		_pinnedIndex.erase(i);
-		pinnedIndexChanged(was, index);
+		pinnedIndexChanged(filterId, was, index);
 	} else {
 		if (!was) {
 			_pinnedIndex.emplace(filterId, index);
 		} else {
 			i->second = index;
 		}
-		pinnedIndexChanged(was, index);
+		pinnedIndexChanged(filterId, was, index);
 	}
 }
 
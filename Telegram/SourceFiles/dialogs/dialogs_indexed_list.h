@@ -48,6 +48,9 @@ public:
 		return (i != _index.end()) ? &i->second : nullptr;
 	}
 	std::vector<not_null<Row*>> filtered(const QStringList &words) const;
+	[[nodiscard]] static bool RowMatchesWords(
+		not_null<Row*> row,
+		const QStringList &words);
 
 	// Part of List interface is duplicated here for all() list.
 	int size() const { return all().size(); }
@@ -15,6 +15,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "history/history.h"
 #include "history/history_item.h"
 #include "core/shortcuts.h"
+#include "core/frame_hud.h"
 #include "ui/widgets/buttons.h"
 #include "ui/widgets/popup_menu.h"
 #include "ui/text/text_utilities.h"
@@ -58,6 +59,7 @@ namespace {
 
 constexpr auto kHashtagResultsLimit = 5;
 constexpr auto kStartReorderThreshold = 30;
+constexpr auto kRowPaintCachesLimit = 32;
 
 int FixedOnTopDialogsCount(not_null<Dialogs::IndexedList*> list) {
 	auto result = 0;
@@ -137,6 +139,7 @@ InnerWidget::InnerWidget(
 			Window::Notifications::ChangeType change) {
 		if (change == Window::Notifications::ChangeType::CountMessages) {
 			// Folder rows change their unread badge with this setting.
+			_rowPaintCaches.clear();
 			update();
 		}
 	});
@@ -220,6 +223,7 @@ InnerWidget::InnerWidget(
 	subscribe(Window::Theme::Background(), [=](const Window::Theme::BackgroundUpdate &data) {
 		if (data.paletteChanged()) {
 			Layout::clearUnreadBadgesCache();
+			_rowPaintCaches.clear();
 		}
 	});
 
@@ -244,6 +248,7 @@ InnerWidget::InnerWidget(
 		if (update.flags & UpdateFlag::UserIsContact) {
 			if (update.peer->isUser()) {
 				// contactsNoChatsList could've changed.
+				_filterResultsComplete = false;
 				Ui::PostponeCall(this, [=] { refresh(); });
 			}
 		}
@@ -403,6 +408,7 @@ void InnerWidget::paintEvent(QPaintEvent *e) {
 	if (App::wnd()->contentOverlapped(this, r)) {
 		return;
 	}
+	auto frameHud = Core::FrameHud::PaintScope(p, "dialogs", r, width());
 	const auto activeEntry = _controller->activeChatEntryCurrent();
 	auto fullWidth = width();
 	auto dialogsClip = r;
@@ -443,14 +449,18 @@ void InnerWidget::paintEvent(QPaintEvent *e) {
 				}
 				const auto isActive = (row->key() == active);
 				const auto isSelected = (row->key() == selected);
-				Layout::RowPainter::paint(
-					p,
-					row,
-					_filterId,
-					fullWidth,
-					isActive,
-					isSelected,
-					ms);
+				if (isActive
+					|| isSelected
+					|| !paintCachedRow(p, row, fullWidth, ms)) {
+					Layout::RowPainter::paint(
+						p,
+						row,
+						_filterId,
+						fullWidth,
+						isActive,
+						isSelected,
+						ms);
+				}
 				if (xadd || yadd) {
 					p.translate(-xadd, -yadd);
 				}
@@ -668,6 +678,58 @@ void InnerWidget::paintEvent(QPaintEvent *e) {
 	}
 }
 
+bool InnerWidget::paintCachedRow(
+		Painter &p,
+		not_null<Row*> row,
+		int fullWidth,
+		crl::time ms) {
+	const auto history = row->history();
+	if (row->hasRipple()
+		|| row->onlineAnimating()
+		|| (history && history->sendActionPainting())) {
+		_rowPaintCaches.remove(row->key());
+		return false;
+	}
+	// The userpic is a part of the key, it can still be loading while
+	// the row is already rendered, no row update is fired for it.
+	const auto userpicKey = history
+		? history->peer->userpicUniqueKey(row->userpicView())
+		: InMemoryKey();
+	auto &cache = _rowPaintCaches[row->key()];
+	if (cache.width != fullWidth || cache.userpicKey != userpicKey) {
+		const auto size = QSize(fullWidth, st::dialogsRowHeight)
+			* cIntRetinaFactor();
+		if (cache.image.size() != size) {
+			cache.image = QImage(size, QImage::Format_ARGB32_Premultiplied);
+			cache.image.setDevicePixelRatio(cRetinaFactor());
+		}
+		cache.image.fill(Qt::transparent);
+		{
+			Painter q(&cache.image);
+			Layout::RowPainter::paint(
+				q,
+				row,
+				_filterId,
+				fullWidth,
+				false,
+				false,
+				ms);
+		}
+		cache.width = fullWidth;
+		cache.userpicKey = userpicKey;
+	}
+	cache.lastUsed = ms;
+	p.drawImage(0, 0, cache.image);
+	if (_rowPaintCaches.size() > kRowPaintCachesLimit) {
+		const auto oldest = ranges::min_element(
+			_rowPaintCaches,
+			std::less<>(),
+			[](const auto &pair) { return pair.second.lastUsed; });
+		_rowPaintCaches.erase(oldest);
+	}
+	return true;
+}
+
 void InnerWidget::paintCollapsedRows(Painter &p, QRect clip) const {
 	auto index = 0;
 	const auto rowHeight = st::dialogsImportantBarHeight;
@@ -1450,6 +1512,7 @@ void InnerWidget::refreshDialog(Key key) {
 		}
 	}
 
+	_filterResultsComplete = false;
 	const auto result = session().data().refreshChatListEntry(
 		key,
 		_filterId);
@@ -1484,6 +1547,7 @@ void InnerWidget::removeDialog(Key key) {
 	if (_pressed && _pressed->key() == key) {
 		setPressed(nullptr);
 	}
+	_filterResultsComplete = false;
 	session().data().removeChatListEntry(key);
 	if (const auto history = key.history()) {
 		session().notifications().clearFromHistory(history);
@@ -1524,6 +1588,7 @@ int InnerWidget::defaultRowTop(not_null<Row*> row) const {
 void InnerWidget::repaintDialogRow(
 		FilterId filterId,
 		not_null<Row*> row) {
+	_rowPaintCaches.remove(row->key());
 	if (_state == WidgetState::Default) {
 		if (_filterId == filterId) {
 			if (const auto folder = row->folder()) {
@@ -1581,6 +1646,7 @@ void InnerWidget::updateDialogRow(
 		RowDescriptor row,
 		QRect updateRect,
 		UpdateRowSections sections) {
+	_rowPaintCaches.remove(row.key);
 	if (updateRect.isEmpty()) {
 		updateRect = QRect(0, 0, width(), st::dialogsRowHeight);
 	}
@@ -1597,6 +1663,14 @@ void InnerWidget::updateDialogRow(
 	}
 
 	const auto updateRow = [&](int rowTop) {
+		// Per-frame invalidations, like the send action (typing)
+		// animations, come here for every active row on every tick -
+		// skip the rows that are scrolled out of view, they will be
+		// repainted in the actual state when they get back.
+		if (rowTop + updateRect.y() + updateRect.height() <= _visibleTop
+			|| rowTop + updateRect.y() >= _visibleBottom) {
+			return;
+		}
 		rtlupdate(
 			updateRect.x(),
 			rowTop + updateRect.y(),
@@ -1858,29 +1932,49 @@ void InnerWidget::applyFilterUpdate(QString newFilter, bool force) {
 		: TextUtilities::PrepareSearchWords(newFilter);
 	newFilter = words.isEmpty() ? QString() : words.join(' ');
 	if (newFilter != _filter || force) {
+		// When the query only grows every search word can only grow as
+		// well, so the matching set can only shrink and the previous
+		// results are refined in place instead of re-walking the
+		// letter buckets on every keystroke.
+		const auto refine = !force
+			&& _filterResultsComplete
+			&& (_state == WidgetState::Filtered)
+			&& !_filter.isEmpty()
+			&& newFilter.startsWith(_filter)
+			&& !_searchInChat;
 		_filter = newFilter;
 		if (_filter.isEmpty() && !_searchFromUser) {
 			clearFilter();
 		} else {
 			_state = WidgetState::Filtered;
 			_waitingForSearch = true;
-			_filterResults.clear();
 			_filterResultsGlobal.clear();
-			const auto append = [&](not_null<IndexedList*> list) {
-				const auto results = list->filtered(words);
-				_filterResults.insert(
-					end(_filterResults),
-					begin(results),
-					end(results));
-			};
-			if (!_searchInChat && !words.isEmpty()) {
-				append(session().data().chatsList()->indexed());
-				const auto id = Data::Folder::kId;
-				if (const auto folder = session().data().folderLoaded(id)) {
-					append(folder->chatsList()->indexed());
+			if (refine) {
+				_filterResults.erase(
+					ranges::remove_if(_filterResults, [&](
+							not_null<Row*> row) {
+						return !IndexedList::RowMatchesWords(row, words);
+					}),
+					end(_filterResults));
+			} else {
+				_filterResults.clear();
+				const auto append = [&](not_null<IndexedList*> list) {
+					const auto results = list->filtered(words);
+					_filterResults.insert(
+						end(_filterResults),
+						begin(results),
+						end(results));
+				};
+				if (!_searchInChat && !words.isEmpty()) {
+					append(session().data().chatsList()->indexed());
+					const auto id = Data::Folder::kId;
+					if (const auto folder = session().data().folderLoaded(id)) {
+						append(folder->chatsList()->indexed());
+					}
+					append(session().data().contactsNoChatsList());
 				}
-				append(session().data().contactsNoChatsList());
 			}
+			_filterResultsComplete = true;
 			refresh(true);
 		}
 		clearMouseSelection(true);
@@ -2110,6 +2204,22 @@ bool InnerWidget::searchReceived(
 	return lastDateFound != 0;
 }
 
+void InnerWidget::applyLocalSearchResults(
+		std::vector<not_null<HistoryItem*>> items) {
+	if (_state != WidgetState::Filtered || items.empty()) {
+		return;
+	}
+	// Show instant results from the local search index, the server
+	// results will replace them when they arrive, so we keep waiting.
+	clearSearchResults(false);
+	for (const auto item : items) {
+		_searchResults.push_back(
+			std::make_unique<FakeRow>(_searchInChat, item));
+	}
+	_searchedCount = _searchResults.size();
+	refresh();
+}
+
 void InnerWidget::peerSearchReceived(
 		const QString &query,
 		const QVector<MTPPeer> &my,
@@ -2636,6 +2746,7 @@ void InnerWidget::switchToFilter(FilterId filterId) {
 		emit mustScrollTo(0, 0);
 		return;
 	}
+	_rowPaintCaches.clear();
 	if (_openedFolder) {
 		_filterId = filterId;
 	} else {
@@ -79,6 +79,8 @@ public:
 		HistoryItem *inject,
 		SearchRequestType type,
 		int fullCount);
+	void applyLocalSearchResults(
+		std::vector<not_null<HistoryItem*>> items);
 	void peerSearchReceived(
 		const QString &query,
 		const QVector<MTPPeer> &my,
@@ -270,6 +272,11 @@ private:
 	int searchedOffset() const;
 	int searchInChatSkip() const;
 
+	bool paintCachedRow(
+		Painter &p,
+		not_null<Row*> row,
+		int fullWidth,
+		crl::time ms);
 	void paintCollapsedRows(
 		Painter &p,
 		QRect clip) const;
@@ -335,6 +342,17 @@ private:
 	std::vector<std::unique_ptr<CollapsedRow>> _collapsedRows;
 	int _collapsedSelected = -1;
 	int _collapsedPressed = -1;
+	// Rendered row strips are cached, so that repainting the list is
+	// mostly blits. Only the default (not active, not selected) row
+	// state is cached, animating rows are painted directly.
+	struct RowPaintCache {
+		QImage image;
+		InMemoryKey userpicKey;
+		int width = 0;
+		crl::time lastUsed = 0;
+	};
+	base::flat_map<Key, RowPaintCache> _rowPaintCaches;
+
 	int _skipTopDialogs = 0;
 	Row *_selected = nullptr;
 	Row *_pressed = nullptr;
@@ -371,6 +389,11 @@ private:
 	int _filteredSelected = -1;
 	int _filteredPressed = -1;
 
+	// The filter results can only shrink while the query grows, so
+	// each keystroke refines them in place, unless the chats list
+	// changed since they were filled.
+	bool _filterResultsComplete = false;
+
 	bool _waitingForSearch = false;
 	EmptyState _emptyState = EmptyState::None;
 
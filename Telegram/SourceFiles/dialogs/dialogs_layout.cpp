@@ -35,8 +35,42 @@ namespace {
 
 // Show all dates that are in the last 20 hours in time format.
 constexpr int kRecentlyInSeconds = 20 * 3600;
+constexpr auto kDateTextsCacheSize = 1024;
 const auto kPsaBadgePrefix = "cloud_lng_badge_psa_";
 
+// Every visible row formats its date on each repaint and QLocale
+// formatting is expensive enough to show up in the paint profile,
+// so the formatted texts are cached by the exact timestamp / day.
+QString CachedTimeText(const QDateTime &lastTime) {
+	static auto format = QString();
+	static auto cache = base::flat_map<qint64, QString>();
+	if (format != cTimeFormat()) {
+		format = cTimeFormat();
+		cache.clear();
+	} else if (cache.size() >= kDateTextsCacheSize) {
+		cache.clear();
+	}
+	const auto key = lastTime.toMSecsSinceEpoch();
+	const auto i = cache.find(key);
+	return (i != end(cache))
+		? i->second
+		: cache.emplace(key, lastTime.toString(format)).first->second;
+}
+
+QString CachedDateText(const QDate &lastDate) {
+	static auto cache = base::flat_map<qint64, QString>();
+	if (cache.size() >= kDateTextsCacheSize) {
+		cache.clear();
+	}
+	const auto key = qint64(lastDate.toJulianDay());
+	const auto i = cache.find(key);
+	return (i != end(cache))
+		? i->second
+		: cache.emplace(
+			key,
+			lastDate.toString(qsl("d.MM.yy"))).first->second;
+}
+
 bool ShowUserBotIcon(not_null<UserData*> user) {
 	return user->isBot() && !user->isSupport();
 }
@@ -59,12 +93,12 @@ void PaintRowDate(Painter &p, QDateTime date, QRect &rectForName, bool active, b
 		const auto wasSameDay = (lastDate == nowDate);
 		const auto wasRecently = qAbs(lastTime.secsTo(now)) < kRecentlyInSeconds;
 		if (wasSameDay || wasRecently) {
-			return lastTime.toString(cTimeFormat());
+			return CachedTimeText(lastTime);
 		} else if (lastDate.year() == nowDate.year()
 			&& lastDate.weekNumber() == nowDate.weekNumber()) {
 			return langDayOfWeek(lastDate);
 		} else {
-			return lastDate.toString(qsl("d.MM.yy"));
+			return CachedDateText(lastDate);
 		}
 	}();
 	PaintRowTopRight(p, dt, rectForName, active, selected);
@@ -495,6 +529,7 @@ void paintRow(
 struct UnreadBadgeSizeData {
 	QImage circle;
 	QPixmap left[6], right[6];
+	base::flat_map<std::pair<QString, int>, QPixmap> full;
 };
 class UnreadBadgeStyleData : public Data::AbstractStructure {
 public:
@@ -625,12 +660,53 @@ void paintUnreadCount(
 		*outUnreadWidth = unreadRectWidth;
 	}
 
-	paintUnreadBadge(p, QRect(unreadRectLeft, unreadRectTop, unreadRectWidth, unreadRectHeight), st);
-
-	auto textTop = st.textTop ? st.textTop : (unreadRectHeight - st.font->height) / 2;
-	p.setFont(st.font);
-	p.setPen(st.active ? st::dialogsUnreadFgActive : (st.selected ? st::dialogsUnreadFgOver : st::dialogsUnreadFg));
-	p.drawText(unreadRectLeft + (unreadRectWidth - unreadWidth) / 2, unreadRectTop + textTop + st.font->ascent, text);
+	// The whole badge with the counter glyphs is rendered once per
+	// (text, palette, size) and blitted on the following paints, the
+	// glyph rendering otherwise shows up in scroll profiles on
+	// unread-heavy accounts.
+	unreadBadgeStyle.createIfNull();
+	auto badgeData = unreadBadgeStyle->sizes;
+	if (st.sizeId > 0) {
+		Assert(st.sizeId < UnreadBadgeSizesCount);
+		badgeData = &unreadBadgeStyle->sizes[st.sizeId];
+	}
+	const auto index = (st.muted ? 0x03 : 0x00)
+		+ (st.active ? 0x02 : (st.selected ? 0x01 : 0x00));
+	const auto key = std::make_pair(text, index);
+	auto i = badgeData->full.find(key);
+	if (i == badgeData->full.cend()
+		|| (i->second.width()
+			!= unreadRectWidth * cIntRetinaFactor())) {
+		auto image = QImage(
+			QSize(unreadRectWidth, unreadRectHeight) * cIntRetinaFactor(),
+			QImage::Format_ARGB32_Premultiplied);
+		image.setDevicePixelRatio(cRetinaFactor());
+		image.fill(Qt::transparent);
+		{
+			Painter q(&image);
+			paintUnreadBadge(
+				q,
+				QRect(0, 0, unreadRectWidth, unreadRectHeight),
+				st);
+			const auto textTop = st.textTop
+				? st.textTop
+				: (unreadRectHeight - st.font->height) / 2;
+			q.setFont(st.font);
+			q.setPen(st.active
+				? st::dialogsUnreadFgActive
+				: (st.selected
+					? st::dialogsUnreadFgOver
+					: st::dialogsUnreadFg));
+			q.drawText(
+				(unreadRectWidth - unreadWidth) / 2,
+				textTop + st.font->ascent,
+				text);
+		}
+		i = badgeData->full.emplace_or_assign(
+			key,
+			App::pixmapFromImageInPlace(std::move(image))).first;
+	}
+	p.drawPixmap(unreadRectLeft, unreadRectTop, i->second);
 }
 
 void RowPainter::paint(
@@ -976,6 +1052,7 @@ void clearUnreadBadgesCache() {
 			for (auto &right : data.right) {
 				right = QPixmap();
 			}
+			data.full.clear();
 		}
 	}
 }
@@ -120,6 +120,7 @@ void MainList::unreadStateChanged(
 		_cloudUnreadState += nowState - wasState;
 		finalizeCloudUnread();
 	}
+	checkUnreadStateConsistency();
 }
 
 void MainList::unreadEntryChanged(
@@ -144,6 +145,24 @@ void MainList::unreadEntryChanged(
 		}
 		finalizeCloudUnread();
 	}
+	checkUnreadStateConsistency();
+}
+
+void MainList::checkUnreadStateConsistency() const {
+#ifdef _DEBUG
+	// The counters are maintained by delta on each entry change, in
+	// debug builds cross-check them against a full recount of the list.
+	auto recounted = UnreadState();
+	for (const auto row : _all) {
+		recounted += row->entry()->chatListUnreadState();
+	}
+	Assert(recounted.messages == _unreadState.messages);
+	Assert(recounted.messagesMuted == _unreadState.messagesMuted);
+	Assert(recounted.chats == _unreadState.chats);
+	Assert(recounted.chatsMuted == _unreadState.chatsMuted);
+	Assert(recounted.marks == _unreadState.marks);
+	Assert(recounted.marksMuted == _unreadState.marksMuted);
+#endif // _DEBUG
 }
 
 void MainList::updateCloudUnread(const MTPDdialogFolder &data) {
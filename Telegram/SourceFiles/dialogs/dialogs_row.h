@@ -45,6 +45,13 @@ public:
 	void addRipple(QPoint origin, QSize size, Fn<void()> updateCallback);
 	void stopLastRipple();
 
+	[[nodiscard]] bool hasRipple() const {
+		return (_ripple != nullptr);
+	}
+	[[nodiscard]] bool onlineAnimating() const {
+		return _onlineUserpic && _onlineUserpic->animation.animating();
+	}
+
 	void paintRipple(
 		Painter &p,
 		int x,
@@ -32,6 +32,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "window/window_slide_animation.h"
 #include "window/window_connecting_widget.h"
 #include "storage/storage_media_prepare.h"
+#include "storage/storage_facade.h"
 #include "storage/localstorage.h"
 #include "data/data_session.h"
 #include "data/data_channel.h"
@@ -795,6 +796,25 @@ bool Widget::onSearchMessages(bool searchCache) {
 		_searchFull = _searchFullMigrated = false;
 		cancelSearchRequest();
 		if (const auto peer = _searchInChat.peer()) {
+			// Serve instant results from the local search index while
+			// the server results are on their way.
+			const auto localIds = session().storage().searchIndexQuery(
+				peer->id,
+				_searchQuery);
+			if (!localIds.empty()) {
+				auto items = std::vector<not_null<HistoryItem*>>();
+				items.reserve(localIds.size());
+				const auto channelId = peerToChannel(peer->id);
+				for (const auto messageId : localIds) {
+					const auto item = session().data().message(
+						channelId,
+						messageId);
+					if (item) {
+						items.push_back(item);
+					}
+				}
+				_inner->applyLocalSearchResults(std::move(items));
+			}
 			auto &histories = session().data().histories();
 			const auto type = Data::Histories::RequestType::History;
 			const auto history = session().data().history(peer);
@@ -11,9 +11,14 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "export/data/export_data_types.h"
 #include "export/output/export_output_result.h"
 #include "export/output/export_output_file.h"
+#include "export/output/export_output_stats.h"
+#include "export/output/export_output_abstract.h"
 #include "mtproto/mtproto_rpc_sender.h"
 #include "base/value_ordering.h"
 #include "base/bytes.h"
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
 #include <set>
 #include <deque>
 
@@ -23,12 +28,14 @@ namespace {
 constexpr auto kUserpicsSliceLimit = 100;
 constexpr auto kFileChunkSize = 128 * 1024;
 constexpr auto kFileRequestsCount = 2;
-constexpr auto kFileNextRequestDelay = crl::time(20);
+constexpr auto kFilesInFlight = 4;
 constexpr auto kChatsSliceLimit = 100;
 constexpr auto kMessagesSliceLimit = 100;
 constexpr auto kTopPeerSliceLimit = 100;
 constexpr auto kFileMaxSize = 1500 * 1024 * 1024;
 constexpr auto kLocationCacheSize = 100'000;
+constexpr auto kTransferRateWindow = crl::time(1000);
+constexpr auto kTransferLogInterval = 30 * crl::time(1000);
 
 struct LocationKey {
 	uint64 type;
@@ -122,6 +129,7 @@ public:
 	LoadedFileCache(int limit);
 
 	void save(const Location &location, const QString &relativePath);
+	void save(const LocationKey &key, const QString &relativePath);
 	std::optional<QString> find(const Location &location) const;
 
 private:
@@ -131,6 +139,38 @@ private:
 
 };
 
+// Journal of work finished by a previous run of the same export, kept
+// in the target folder. A restarted export reuses the media files that
+// were downloaded completely instead of starting over from zero.
+class ApiWrap::ResumeJournal {
+public:
+	explicit ResumeJournal(const QString &folder);
+
+	struct FileEntry {
+		LocationKey key;
+		QString relativePath;
+	};
+
+	// Entries from the previous run whose files are still on disk
+	// with the expected size.
+	[[nodiscard]] std::vector<FileEntry> collectVerifiedFiles() const;
+
+	void pushFile(
+		const LocationKey &key,
+		int size,
+		const QString &relativePath);
+	void pushDialog(Data::PeerId peerId, int32 lastMessageId);
+
+	void finish();
+
+private:
+	void append(const QByteArray &line);
+
+	QString _folder;
+	QFile _file;
+
+};
+
 struct ApiWrap::StartProcess {
 	FnMut<void(StartInfo)> done;
 
@@ -193,6 +233,7 @@ struct ApiWrap::FileProcess {
 };
 
 struct ApiWrap::FileProgress {
+	QString path;
 	int ready = 0;
 	int total = 0;
 };
@@ -236,6 +277,7 @@ struct ApiWrap::ChatProcess {
 	std::optional<Data::MessagesSlice> slice;
 	bool lastSlice = false;
 	int fileIndex = 0;
+	int fileStage = 0; // 0 - main file, 1 - thumbnail.
 };
 
 
@@ -325,7 +367,12 @@ void ApiWrap::LoadedFileCache::save(
 	if (!location) {
 		return;
 	}
-	const auto key = ComputeLocationKey(location);
+	save(ComputeLocationKey(location), relativePath);
+}
+
+void ApiWrap::LoadedFileCache::save(
+		const LocationKey &key,
+		const QString &relativePath) {
 	_map[key] = relativePath;
 	_list.push_back(key);
 	if (_list.size() > _limit) {
@@ -347,6 +394,87 @@ std::optional<QString> ApiWrap::LoadedFileCache::find(
 	return std::nullopt;
 }
 
+ApiWrap::ResumeJournal::ResumeJournal(const QString &folder)
+: _folder(folder)
+, _file(Output::ResumeJournalPath(folder)) {
+}
+
+auto ApiWrap::ResumeJournal::collectVerifiedFiles() const
+-> std::vector<FileEntry> {
+	auto result = std::vector<FileEntry>();
+	QFile file(_file.fileName());
+	if (!file.open(QIODevice::ReadOnly)) {
+		return result;
+	}
+	while (!file.atEnd()) {
+		const auto line = file.readLine();
+		const auto parts = line.split(' ');
+		if (parts.size() < 5 || parts[0] != "file") {
+			continue;
+		}
+		auto entry = FileEntry();
+		entry.key.type = parts[1].toULongLong();
+		entry.key.id = parts[2].toULongLong();
+		const auto size = parts[3].toLongLong();
+
+		// The relative path is the last field and may contain spaces.
+		auto offset = 0;
+		for (auto i = 0; i != 4; ++i) {
+			offset = line.indexOf(' ', offset) + 1;
+		}
+		entry.relativePath = QString::fromUtf8(line.mid(offset)).trimmed();
+		if (size <= 0 || entry.relativePath.isEmpty()) {
+			continue;
+		} else if (QFileInfo(_folder + entry.relativePath).size() != size) {
+			continue;
+		}
+		result.push_back(std::move(entry));
+	}
+	return result;
+}
+
+void ApiWrap::ResumeJournal::pushFile(
+		const LocationKey &key,
+		int size,
+		const QString &relativePath) {
+	if (size <= 0 || relativePath.isEmpty()) {
+		return;
+	}
+	append("file "
+		+ QByteArray::number(quint64(key.type))
+		+ ' '
+		+ QByteArray::number(quint64(key.id))
+		+ ' '
+		+ QByteArray::number(size)
+		+ ' '
+		+ relativePath.toUtf8());
+}
+
+void ApiWrap::ResumeJournal::pushDialog(
+		Data::PeerId peerId,
+		int32 lastMessageId) {
+	append("dialog "
+		+ QByteArray::number(quint64(peerId))
+		+ ' '
+		+ QByteArray::number(lastMessageId));
+}
+
+void ApiWrap::ResumeJournal::finish() {
+	_file.close();
+	_file.remove();
+}
+
+void ApiWrap::ResumeJournal::append(const QByteArray &line) {
+	if (!_file.isOpen()) {
+		QDir().mkpath(_folder);
+		if (!_file.open(QIODevice::Append)) {
+			return;
+		}
+	}
+	_file.write(line + '\n');
+	_file.flush();
+}
+
 ApiWrap::FileProcess::FileProcess(const QString &path, Output::Stats *stats)
 : file(path, stats) {
 }
@@ -377,22 +505,23 @@ auto ApiWrap::splitRequest(int index, Request &&request) {
 		std::forward<Request>(request)));
 }
 
-auto ApiWrap::fileRequest(const Data::FileLocation &location, int offset) {
-	Expects(location.dcId != 0
-		|| location.data.type() == mtpc_inputTakeoutFileLocation);
+auto ApiWrap::fileRequest(not_null<FileProcess*> process, int offset) {
+	Expects(process->location.dcId != 0
+		|| process->location.data.type() == mtpc_inputTakeoutFileLocation);
 	Expects(_takeoutId.has_value());
 
 	return std::move(_mtp.request(MTPInvokeWithTakeout<MTPupload_GetFile>(
 		MTP_long(*_takeoutId),
 		MTPupload_GetFile(
 			MTP_flags(0),
-			location.data,
+			process->location.data,
 			MTP_int(offset),
 			MTP_int(kFileChunkSize))
 	)).fail([=](RPCError &&result) {
 		if (result.type() == qstr("TAKEOUT_FILE_EMPTY")
 			&& _otherDataProcess != nullptr) {
 			filePartDone(
+				process,
 				0,
 				MTP_upload_file(
 					MTP_storage_filePartial(),
@@ -400,14 +529,16 @@ auto ApiWrap::fileRequest(const Data::FileLocation &location, int offset) {
 					MTP_bytes()));
 		} else if (result.type() == qstr("LOCATION_INVALID")
 			|| result.type() == qstr("VERSION_INVALID")) {
-			filePartUnavailable();
+			filePartUnavailable(process);
 		} else if (result.code() == 400
 			&& result.type().startsWith(qstr("FILE_REFERENCE_"))) {
-			filePartRefreshReference(offset);
+			filePartRefreshReference(process, offset);
 		} else {
 			error(std::move(result));
 		}
-	}).toDC(MTP::ShiftDcId(location.dcId, MTP::kExportMediaDcShift)));
+	}).toDC(MTP::ShiftDcId(
+		process->location.dcId,
+		MTP::kExportMediaDcShift)));
 }
 
 ApiWrap::ApiWrap(Fn<void(FnMut<void()>)> runner)
@@ -432,6 +563,10 @@ void ApiWrap::startExport(
 
 	_settings = std::make_unique<Settings>(settings);
 	_stats = stats;
+	_journal = std::make_unique<ResumeJournal>(_settings->path);
+	for (const auto &entry : _journal->collectVerifiedFiles()) {
+		_fileCache->save(entry.key, entry.relativePath);
+	}
 	_startProcess = std::make_unique<StartProcess>();
 	_startProcess->done = std::move(done);
 
@@ -783,16 +918,21 @@ void ApiWrap::loadNextUserpic() {
 	for (auto &list = _userpicsProcess->slice->list
 		; _userpicsProcess->fileIndex < list.size()
 		; ++_userpicsProcess->fileIndex) {
-		const auto ready = processFileLoad(
-			list[_userpicsProcess->fileIndex].image.file,
-			Data::FileOrigin(),
-			[=](FileProgress value) { return loadUserpicProgress(value); },
-			[=](const QString &path) { loadUserpicDone(path); });
-		if (!ready) {
+		if (_fileProcesses.size() >= kFilesInFlight) {
 			return;
 		}
+		const auto index = _userpicsProcess->fileIndex;
+		processFileLoad(
+			list[index].image.file,
+			Data::FileOrigin(),
+			[=](FileProgress value) {
+				return loadUserpicProgress(index, value);
+			},
+			[=](const QString &path) { loadUserpicDone(index, path); });
+	}
+	if (_fileProcesses.empty()) {
+		finishUserpicsSlice();
 	}
-	finishUserpicsSlice();
 }
 
 void ApiWrap::finishUserpicsSlice() {
@@ -822,29 +962,27 @@ void ApiWrap::finishUserpicsSlice() {
 	}).send();
 }
 
-bool ApiWrap::loadUserpicProgress(FileProgress progress) {
-	Expects(_fileProcess != nullptr);
+bool ApiWrap::loadUserpicProgress(int index, FileProgress progress) {
 	Expects(_userpicsProcess != nullptr);
 	Expects(_userpicsProcess->slice.has_value());
-	Expects((_userpicsProcess->fileIndex >= 0)
-		&& (_userpicsProcess->fileIndex
-			< _userpicsProcess->slice->list.size()));
+	Expects((index >= 0)
+		&& (index < _userpicsProcess->slice->list.size()));
 
 	return _userpicsProcess->fileProgress(DownloadProgress{
-		_fileProcess->relativePath,
-		_userpicsProcess->fileIndex,
+		progress.path,
+		index,
 		progress.ready,
-		progress.total });
+		progress.total,
+		_bytesPerSecond,
+		requestsInFlight() });
 }
 
-void ApiWrap::loadUserpicDone(const QString &relativePath) {
+void ApiWrap::loadUserpicDone(int index, const QString &relativePath) {
 	Expects(_userpicsProcess != nullptr);
 	Expects(_userpicsProcess->slice.has_value());
-	Expects((_userpicsProcess->fileIndex >= 0)
-		&& (_userpicsProcess->fileIndex
-			< _userpicsProcess->slice->list.size()));
+	Expects((index >= 0)
+		&& (index < _userpicsProcess->slice->list.size()));
 
-	const auto index = _userpicsProcess->fileIndex;
 	auto &file = _userpicsProcess->slice->list[index].image.file;
 	file.relativePath = relativePath;
 	if (relativePath.isEmpty()) {
@@ -1034,7 +1172,12 @@ void ApiWrap::finishExport(FnMut<void()> done) {
 
 	mainRequest(MTPaccount_FinishTakeoutSession(
 		MTP_flags(MTPaccount_FinishTakeoutSession::Flag::f_success)
-	)).done(std::move(done)).send();
+	)).done([=, done = std::move(done)]() mutable {
+		if (const auto journal = base::take(_journal)) {
+			journal->finish();
+		}
+		done();
+	}).send();
 }
 
 void ApiWrap::cancelExportFast() {
@@ -1462,25 +1605,19 @@ void ApiWrap::loadMessagesFiles(Data::MessagesSlice &&slice) {
 	}
 	_chatProcess->slice = std::move(slice);
 	_chatProcess->fileIndex = 0;
+	_chatProcess->fileStage = 0;
 
 	loadNextMessageFile();
 }
 
-Data::Message *ApiWrap::currentFileMessage() const {
-	Expects(_chatProcess != nullptr);
-	Expects(_chatProcess->slice.has_value());
-
-	return &_chatProcess->slice->list[_chatProcess->fileIndex];
-}
-
-Data::FileOrigin ApiWrap::currentFileMessageOrigin() const {
+Data::FileOrigin ApiWrap::fileMessageOrigin(
+		const Data::Message &message) const {
 	Expects(_chatProcess != nullptr);
-	Expects(_chatProcess->slice.has_value());
 
 	const auto splitIndex = _chatProcess->info.splits[
 		_chatProcess->localSplitIndex];
 	auto result = Data::FileOrigin();
-	result.messageId = currentFileMessage()->id;
+	result.messageId = message.id;
 	result.split = (splitIndex >= 0)
 		? splitIndex
 		: (int(_splits.size()) + splitIndex);
@@ -1494,39 +1631,52 @@ void ApiWrap::loadNextMessageFile() {
 	Expects(_chatProcess != nullptr);
 	Expects(_chatProcess->slice.has_value());
 
-	for (auto &list = _chatProcess->slice->list
-		; _chatProcess->fileIndex < list.size()
-		; ++_chatProcess->fileIndex) {
-		const auto &message = list[_chatProcess->fileIndex];
+	// Keep up to kFilesInFlight files loading in parallel, the writers
+	// get the whole slice only after all of them have finished.
+	auto &list = _chatProcess->slice->list;
+	while (_chatProcess->fileIndex < list.size()) {
+		const auto index = _chatProcess->fileIndex;
+		auto &message = list[index];
 		if (Data::SkipMessageByDate(message, *_settings)) {
+			_chatProcess->fileStage = 0;
+			++_chatProcess->fileIndex;
 			continue;
 		}
-		const auto fileProgress = [=](FileProgress value) {
-			return loadMessageFileProgress(value);
-		};
-		const auto ready = processFileLoad(
-			list[_chatProcess->fileIndex].file(),
-			currentFileMessageOrigin(),
-			fileProgress,
-			[=](const QString &path) { loadMessageFileDone(path); },
-			currentFileMessage());
-		if (!ready) {
+		if (_fileProcesses.size() >= kFilesInFlight) {
 			return;
 		}
+		if (_chatProcess->fileStage == 0) {
+			const auto fileProgress = [=](FileProgress value) {
+				return loadMessageFileProgress(index, value);
+			};
+			processFileLoad(
+				message.file(),
+				fileMessageOrigin(message),
+				fileProgress,
+				[=](const QString &path) {
+					loadMessageFileDone(index, path);
+				},
+				&message);
+			_chatProcess->fileStage = 1;
+			continue;
+		}
 		const auto thumbProgress = [=](FileProgress value) {
-			return loadMessageThumbProgress(value);
+			return loadMessageThumbProgress(index, value);
 		};
-		const auto thumbReady = processFileLoad(
-			list[_chatProcess->fileIndex].thumb().file,
-			currentFileMessageOrigin(),
+		processFileLoad(
+			message.thumb().file,
+			fileMessageOrigin(message),
 			thumbProgress,
-			[=](const QString &path) { loadMessageThumbDone(path); },
-			currentFileMessage());
-		if (!thumbReady) {
-			return;
-		}
+			[=](const QString &path) {
+				loadMessageThumbDone(index, path);
+			},
+			&message);
+		_chatProcess->fileStage = 0;
+		++_chatProcess->fileIndex;
+	}
+	if (_fileProcesses.empty()) {
+		finishMessagesSlice();
 	}
-	finishMessagesSlice();
 }
 
 void ApiWrap::finishMessagesSlice() {
@@ -1558,27 +1708,27 @@ void ApiWrap::finishMessagesSlice() {
 	}
 }
 
-bool ApiWrap::loadMessageFileProgress(FileProgress progress) {
-	Expects(_fileProcess != nullptr);
+bool ApiWrap::loadMessageFileProgress(int index, FileProgress progress) {
 	Expects(_chatProcess != nullptr);
 	Expects(_chatProcess->slice.has_value());
-	Expects((_chatProcess->fileIndex >= 0)
-		&& (_chatProcess->fileIndex < _chatProcess->slice->list.size()));
+	Expects((index >= 0)
+		&& (index < _chatProcess->slice->list.size()));
 
 	return _chatProcess->fileProgress(DownloadProgress{
-		_fileProcess->relativePath,
-		_chatProcess->fileIndex,
+		progress.path,
+		index,
 		progress.ready,
-		progress.total });
+		progress.total,
+		_bytesPerSecond,
+		requestsInFlight() });
 }
 
-void ApiWrap::loadMessageFileDone(const QString &relativePath) {
+void ApiWrap::loadMessageFileDone(int index, const QString &relativePath) {
 	Expects(_chatProcess != nullptr);
 	Expects(_chatProcess->slice.has_value());
-	Expects((_chatProcess->fileIndex >= 0)
-		&& (_chatProcess->fileIndex < _chatProcess->slice->list.size()));
+	Expects((index >= 0)
+		&& (index < _chatProcess->slice->list.size()));
 
-	const auto index = _chatProcess->fileIndex;
 	auto &file = _chatProcess->slice->list[index].file();
 	file.relativePath = relativePath;
 	if (relativePath.isEmpty()) {
@@ -1587,17 +1737,16 @@ void ApiWrap::loadMessageFileDone(const QString &relativePath) {
 	loadNextMessageFile();
 }
 
-bool ApiWrap::loadMessageThumbProgress(FileProgress progress) {
-	return loadMessageFileProgress(progress);
+bool ApiWrap::loadMessageThumbProgress(int index, FileProgress progress) {
+	return loadMessageFileProgress(index, progress);
 }
 
-void ApiWrap::loadMessageThumbDone(const QString &relativePath) {
+void ApiWrap::loadMessageThumbDone(int index, const QString &relativePath) {
 	Expects(_chatProcess != nullptr);
 	Expects(_chatProcess->slice.has_value());
-	Expects((_chatProcess->fileIndex >= 0)
-		&& (_chatProcess->fileIndex < _chatProcess->slice->list.size()));
+	Expects((index >= 0)
+		&& (index < _chatProcess->slice->list.size()));
 
-	const auto index = _chatProcess->fileIndex;
 	auto &file = _chatProcess->slice->list[index].thumb().file;
 	file.relativePath = relativePath;
 	if (relativePath.isEmpty()) {
@@ -1611,6 +1760,13 @@ void ApiWrap::finishMessages() {
 	Expects(!_chatProcess->slice.has_value());
 
 	const auto process = base::take(_chatProcess);
+
+	// The documents are composed anew on each run, so the high-water
+	// mark is only a progress record - the saved time comes from the
+	// journaled media files of this dialog.
+	_journal->pushDialog(
+		process->info.peerId,
+		process->largestIdPlusOne - 1);
 	process->done();
 }
 
@@ -1696,25 +1852,27 @@ void ApiWrap::loadFile(
 		const Data::FileOrigin &origin,
 		Fn<bool(FileProgress)> progress,
 		FnMut<void(QString)> done) {
-	Expects(_fileProcess == nullptr);
+	Expects(_fileProcesses.size() < kFilesInFlight);
 	Expects(file.location.dcId != 0
 		|| file.location.data.type() == mtpc_inputTakeoutFileLocation);
 
-	_fileProcess = prepareFileProcess(file, origin);
-	_fileProcess->progress = std::move(progress);
-	_fileProcess->done = std::move(done);
+	_fileProcesses.push_back(prepareFileProcess(file, origin));
+	const auto process = _fileProcesses.back().get();
+	process->progress = std::move(progress);
+	process->done = std::move(done);
 
-	if (_fileProcess->progress) {
+	if (process->progress) {
 		const auto progress = FileProgress{
-			_fileProcess->file.size(),
-			_fileProcess->size
+			process->relativePath,
+			process->file.size(),
+			process->size
 		};
-		if (!_fileProcess->progress(progress)) {
+		if (!process->progress(progress)) {
 			return;
 		}
 	}
 
-	loadFilePart();
+	loadFilePart(process);
 }
 
 auto ApiWrap::prepareFileProcess(
@@ -1725,7 +1883,7 @@ auto ApiWrap::prepareFileProcess(
 
 	const auto relativePath = Output::File::PrepareRelativePath(
 		_settings->path,
-		file.suggestedPath);
+		suggestedFilePath(file));
 	auto result = std::make_unique<FileProcess>(
 		_settings->path + relativePath,
 		_stats);
@@ -1736,40 +1894,66 @@ auto ApiWrap::prepareFileProcess(
 	return result;
 }
 
-void ApiWrap::loadFilePart() {
-	if (!_fileProcess
-		|| _fileProcess->requests.size() >= kFileRequestsCount
-		|| (_fileProcess->size > 0
-			&& _fileProcess->offset >= _fileProcess->size)) {
+QString ApiWrap::suggestedFilePath(const Data::File &file) const {
+	Expects(_settings != nullptr);
+
+	if (!_settings->media.contentAddressedStore || !file.location) {
+		return file.suggestedPath;
+	}
+
+	// Forwarded media shows up in many dialogs, so key the file by its
+	// location in one shared folder - every document then references
+	// the single copy through the loaded file cache.
+	const auto key = ComputeLocationKey(file.location);
+	const auto name = file.suggestedPath.mid(
+		file.suggestedPath.lastIndexOf('/') + 1);
+	const auto dot = name.lastIndexOf('.');
+	const auto extension = (dot > 0) ? name.mid(dot) : QString();
+	return "files/"
+		+ QString::number(key.type, 16)
+		+ '_'
+		+ QString::number(key.id, 16)
+		+ extension;
+}
+
+std::unique_ptr<ApiWrap::FileProcess> ApiWrap::takeFileProcess(
+		not_null<FileProcess*> process) {
+	const auto i = ranges::find(
+		_fileProcesses,
+		process.get(),
+		[](const std::unique_ptr<FileProcess> &process) {
+			return process.get();
+		});
+	Assert(i != end(_fileProcesses));
+
+	auto result = std::move(*i);
+	_fileProcesses.erase(i);
+	return result;
+}
+
+void ApiWrap::loadFilePart(not_null<FileProcess*> process) {
+	if (process->requests.size() >= kFileRequestsCount
+		|| (process->size > 0
+			&& process->offset >= process->size)) {
 		return;
 	}
 
-	const auto offset = _fileProcess->offset;
-	_fileProcess->requests.push_back({ offset });
+	const auto offset = process->offset;
+	process->requests.push_back({ offset });
 	fileRequest(
-		_fileProcess->location,
-		_fileProcess->offset
+		process,
+		process->offset
 	).done([=](const MTPupload_File &result) {
-		filePartDone(offset, result);
+		filePartDone(process, offset, result);
 	}).send();
-	_fileProcess->offset += kFileChunkSize;
-
-	if (_fileProcess->size > 0
-		&& _fileProcess->requests.size() < kFileRequestsCount) {
-		//const auto runner = _runner;
-		//crl::on_main([=] {
-		//	QTimer::singleShot(kFileNextRequestDelay, [=] {
-		//		runner([=] {
-		//			loadFilePart();
-		//		});
-		//	});
-		//});
-	}
+	process->offset += kFileChunkSize;
 }
 
-void ApiWrap::filePartDone(int offset, const MTPupload_File &result) {
-	Expects(_fileProcess != nullptr);
-	Expects(!_fileProcess->requests.empty());
+void ApiWrap::filePartDone(
+		not_null<FileProcess*> process,
+		int offset,
+		const MTPupload_File &result) {
+	Expects(!process->requests.empty());
 
 	if (result.type() == mtpc_upload_fileCdnRedirect) {
 		error("Cdn redirect is not supported.");
@@ -1777,18 +1961,18 @@ void ApiWrap::filePartDone(int offset, const MTPupload_File &result) {
 	}
 	const auto &data = result.c_upload_file();
 	if (data.vbytes().v.isEmpty()) {
-		if (_fileProcess->size > 0) {
+		if (process->size > 0) {
 			error("Empty bytes received in file part.");
 			return;
 		}
-		const auto result = _fileProcess->file.writeBlock({});
+		const auto result = process->file.writeBlock({});
 		if (!result) {
 			ioError(result);
 			return;
 		}
 	} else {
 		using Request = FileProcess::Request;
-		auto &requests = _fileProcess->requests;
+		auto &requests = process->requests;
 		const auto i = ranges::find(
 			requests,
 			offset,
@@ -1796,8 +1980,9 @@ void ApiWrap::filePartDone(int offset, const MTPupload_File &result) {
 		Assert(i != end(requests));
 
 		i->bytes = data.vbytes().v;
+		accountNetworkBytes(i->bytes.size());
 
-		auto &file = _fileProcess->file;
+		auto &file = process->file;
 		while (!requests.empty() && !requests.front().bytes.isEmpty()) {
 			const auto &bytes = requests.front().bytes;
 			if (const auto result = file.writeBlock(bytes); !result) {
@@ -1807,30 +1992,74 @@ void ApiWrap::filePartDone(int offset, const MTPupload_File &result) {
 			requests.pop_front();
 		}
 
-		if (_fileProcess->progress) {
-			_fileProcess->progress(FileProgress{
+		if (process->progress) {
+			process->progress(FileProgress{
+				process->relativePath,
 				file.size(),
-				_fileProcess->size });
+				process->size });
 		}
 
 		if (!requests.empty()
-			|| !_fileProcess->size
-			|| _fileProcess->size > _fileProcess->offset) {
-			loadFilePart();
+			|| !process->size
+			|| process->size > process->offset) {
+			loadFilePart(process);
 			return;
 		}
 	}
 
-	auto process = base::take(_fileProcess);
-	const auto relativePath = process->relativePath;
-	_fileCache->save(process->location, relativePath);
-	process->done(process->relativePath);
+	const auto owned = takeFileProcess(process);
+	const auto relativePath = owned->relativePath;
+	_fileCache->save(owned->location, relativePath);
+	if (owned->location) {
+		_journal->pushFile(
+			ComputeLocationKey(owned->location),
+			owned->file.size(),
+			relativePath);
+	}
+	owned->done(owned->relativePath);
+}
+
+void ApiWrap::accountNetworkBytes(int size) {
+	const auto now = crl::now();
+	if (!_transferWindowFrom) {
+		_transferWindowFrom = now;
+		_transferLogged = now;
+	}
+	_bytesDownloaded += size;
+	_transferWindowBytes += size;
+
+	// The rate is measured over completed windows, so a single large
+	// part arriving after a pause doesn't show up as a burst.
+	const auto passed = now - _transferWindowFrom;
+	if (passed >= kTransferRateWindow) {
+		_bytesPerSecond = int(_transferWindowBytes * 1000 / passed);
+		_transferWindowFrom = now;
+		_transferWindowBytes = 0;
+	}
+	if (now - _transferLogged >= kTransferLogInterval) {
+		_transferLogged = now;
+		LOG(("Export Info: Transfer speed %1 KB/s, "
+			"%2 file part requests in flight, "
+			"%3 KB downloaded, %4 KB written to disk."
+			).arg(_bytesPerSecond / 1024
+			).arg(requestsInFlight()
+			).arg(_bytesDownloaded / 1024
+			).arg(_stats ? (_stats->bytesCount() / 1024) : 0));
+	}
 }
 
-void ApiWrap::filePartRefreshReference(int offset) {
-	Expects(_fileProcess != nullptr);
+int ApiWrap::requestsInFlight() const {
+	auto result = 0;
+	for (const auto &process : _fileProcesses) {
+		result += process->requests.size();
+	}
+	return result;
+}
 
-	const auto &origin = _fileProcess->origin;
+void ApiWrap::filePartRefreshReference(
+		not_null<FileProcess*> process,
+		int offset) {
+	const auto &origin = process->origin;
 	if (!origin.messageId) {
 		error("FILE_REFERENCE error for non-message file.");
 		return;
@@ -1851,10 +2080,10 @@ void ApiWrap::filePartRefreshReference(int offset) {
 				1,
 				MTP_inputMessageID(MTP_int(origin.messageId)))
 		)).fail([=](const RPCError &error) {
-			filePartUnavailable();
+			filePartUnavailable(process);
 			return true;
 		}).done([=](const MTPmessages_Messages &result) {
-			filePartExtractReference(offset, result);
+			filePartExtractReference(process, offset, result);
 		}).send();
 	} else {
 		splitRequest(origin.split, MTPmessages_GetMessages(
@@ -1862,19 +2091,18 @@ void ApiWrap::filePartRefreshReference(int offset) {
 				1,
 				MTP_inputMessageID(MTP_int(origin.messageId)))
 		)).fail([=](const RPCError &error) {
-			filePartUnavailable();
+			filePartUnavailable(process);
 			return true;
 		}).done([=](const MTPmessages_Messages &result) {
-			filePartExtractReference(offset, result);
+			filePartExtractReference(process, offset, result);
 		}).send();
 	}
 }
 
 void ApiWrap::filePartExtractReference(
+		not_null<FileProcess*> process,
 		int offset,
 		const MTPmessages_Messages &result) {
-	Expects(_fileProcess != nullptr);
-
 	result.match([&](const MTPDmessages_messagesNotModified &data) {
 		error("Unexpected messagesNotModified received.");
 	}, [&](const auto &data) {
@@ -1886,35 +2114,34 @@ void ApiWrap::filePartExtractReference(
 			data.vchats(),
 			_chatProcess->info.relativePath);
 		for (const auto &message : messages.list) {
-			if (message.id == _fileProcess->origin.messageId) {
+			if (message.id == process->origin.messageId) {
 				const auto refresh1 = Data::RefreshFileReference(
-					_fileProcess->location,
+					process->location,
 					message.file().location);
 				const auto refresh2 = Data::RefreshFileReference(
-					_fileProcess->location,
+					process->location,
 					message.thumb().file.location);
 				if (refresh1 || refresh2) {
 					fileRequest(
-						_fileProcess->location,
+						process,
 						offset
 					).done([=](const MTPupload_File &result) {
-						filePartDone(offset, result);
+						filePartDone(process, offset, result);
 					}).send();
 					return;
 				}
 			}
 		}
-		filePartUnavailable();
+		filePartUnavailable(process);
 	});
 }
 
-void ApiWrap::filePartUnavailable() {
-	Expects(_fileProcess != nullptr);
-	Expects(!_fileProcess->requests.empty());
+void ApiWrap::filePartUnavailable(not_null<FileProcess*> process) {
+	Expects(!process->requests.empty());
 
 	LOG(("Export Error: File unavailable."));
 
-	base::take(_fileProcess)->done(QString());
+	takeFileProcess(process)->done(QString());
 }
 
 void ApiWrap::error(RPCError &&error) {
@@ -64,6 +64,8 @@ public:
 		int itemIndex = 0;
 		int ready = 0;
 		int total = 0;
+		int bytesPerSecond = 0;
+		int requestsInFlight = 0;
 	};
 	void requestUserpics(
 		FnMut<bool(Data::UserpicsInfo&&)> start,
@@ -89,6 +91,7 @@ public:
 
 private:
 	class LoadedFileCache;
+	class ResumeJournal;
 	struct StartProcess;
 	struct ContactsProcess;
 	struct UserpicsProcess;
@@ -113,8 +116,8 @@ private:
 	void handleUserpicsSlice(const MTPphotos_Photos &result);
 	void loadUserpicsFiles(Data::UserpicsSlice &&slice);
 	void loadNextUserpic();
-	bool loadUserpicProgress(FileProgress value);
-	void loadUserpicDone(const QString &relativePath);
+	bool loadUserpicProgress(int index, FileProgress value);
+	void loadUserpicDone(int index, const QString &relativePath);
 	void finishUserpicsSlice();
 	void finishUserpics();
 
@@ -155,15 +158,15 @@ private:
 		FnMut<void(MTPmessages_Messages&&)> done);
 	void loadMessagesFiles(Data::MessagesSlice &&slice);
 	void loadNextMessageFile();
-	bool loadMessageFileProgress(FileProgress value);
-	void loadMessageFileDone(const QString &relativePath);
-	bool loadMessageThumbProgress(FileProgress value);
-	void loadMessageThumbDone(const QString &relativePath);
+	bool loadMessageFileProgress(int index, FileProgress value);
+	void loadMessageFileDone(int index, const QString &relativePath);
+	bool loadMessageThumbProgress(int index, FileProgress value);
+	void loadMessageThumbDone(int index, const QString &relativePath);
 	void finishMessagesSlice();
 	void finishMessages();
 
-	[[nodiscard]] Data::Message *currentFileMessage() const;
-	[[nodiscard]] Data::FileOrigin currentFileMessageOrigin() const;
+	[[nodiscard]] Data::FileOrigin fileMessageOrigin(
+		const Data::Message &message) const;
 
 	bool processFileLoad(
 		Data::File &file,
@@ -174,6 +177,7 @@ private:
 	std::unique_ptr<FileProcess> prepareFileProcess(
 		const Data::File &file,
 		const Data::FileOrigin &origin) const;
+	[[nodiscard]] QString suggestedFilePath(const Data::File &file) const;
 	bool writePreloadedFile(
 		Data::File &file,
 		const Data::FileOrigin &origin);
@@ -182,11 +186,21 @@ private:
 		const Data::FileOrigin &origin,
 		Fn<bool(FileProgress)> progress,
 		FnMut<void(QString)> done);
-	void loadFilePart();
-	void filePartDone(int offset, const MTPupload_File &result);
-	void filePartUnavailable();
-	void filePartRefreshReference(int offset);
+	std::unique_ptr<FileProcess> takeFileProcess(
+		not_null<FileProcess*> process);
+	void accountNetworkBytes(int size);
+	[[nodiscard]] int requestsInFlight() const;
+	void loadFilePart(not_null<FileProcess*> process);
+	void filePartDone(
+		not_null<FileProcess*> process,
+		int offset,
+		const MTPupload_File &result);
+	void filePartUnavailable(not_null<FileProcess*> process);
+	void filePartRefreshReference(
+		not_null<FileProcess*> process,
+		int offset);
 	void filePartExtractReference(
+		not_null<FileProcess*> process,
 		int offset,
 		const MTPmessages_Messages &result);
 
@@ -200,7 +214,7 @@ private:
 	[[nodiscard]] auto splitRequest(int index, Request &&request);
 
 	[[nodiscard]] auto fileRequest(
-		const Data::FileLocation &location,
+		not_null<FileProcess*> process,
 		int offset);
 
 	void error(RPCError &&error);
@@ -216,10 +230,16 @@ private:
 
 	std::unique_ptr<StartProcess> _startProcess;
 	std::unique_ptr<LoadedFileCache> _fileCache;
+	std::unique_ptr<ResumeJournal> _journal;
 	std::unique_ptr<ContactsProcess> _contactsProcess;
 	std::unique_ptr<UserpicsProcess> _userpicsProcess;
 	std::unique_ptr<OtherDataProcess> _otherDataProcess;
-	std::unique_ptr<FileProcess> _fileProcess;
+	std::vector<std::unique_ptr<FileProcess>> _fileProcesses;
+	crl::time _transferWindowFrom = 0;
+	int64 _transferWindowBytes = 0;
+	int64 _bytesDownloaded = 0;
+	int _bytesPerSecond = 0;
+	crl::time _transferLogged = 0;
 	std::unique_ptr<LeftChannelsProcess> _leftChannelsProcess;
 	std::unique_ptr<DialogsProcess> _dialogsProcess;
 	std::unique_ptr<ChatProcess> _chatProcess;
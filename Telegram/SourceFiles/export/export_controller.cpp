@@ -124,6 +124,7 @@ private:
 	std::unique_ptr<Output::AbstractWriter> _writer;
 	std::vector<Step> _steps;
 	int _stepIndex = -1;
+	crl::time _startedAt = 0;
 
 	rpl::lifetime _lifetime;
 
@@ -238,6 +239,7 @@ void ControllerObject::startExport(
 
 	_settings.path = Output::NormalizePath(_settings);
 	_writer = Output::CreateWriter(_settings.format);
+	_startedAt = crl::now();
 	fillExportSteps();
 	exportNext();
 }
@@ -489,6 +491,7 @@ ProcessingState ControllerObject::prepareState(
 	result.substepsPassed = _substepsPassed;
 	result.substepsNow = substepsInStep(_lastProcessingStep);
 	result.substepsTotal = _substepsTotal;
+	result.startedAt = _startedAt;
 	return result;
 }
 
@@ -521,6 +524,7 @@ ProcessingState ControllerObject::stateUserpics(
 		}
 		result.bytesLoaded = progress.ready;
 		result.bytesCount = progress.total;
+		result.bytesPerSecond = progress.bytesPerSecond;
 	});
 }
 
@@ -571,6 +575,7 @@ void ControllerObject::fillMessagesState(
 	}
 	result.bytesLoaded = progress.ready;
 	result.bytesCount = progress.total;
+	result.bytesPerSecond = progress.bytesPerSecond;
 }
 
 int ControllerObject::substepsInStep(Step step) const {
@@ -36,6 +36,10 @@ struct MediaSettings {
 	Types types = DefaultTypes();
 	int sizeLimit = 8 * 1024 * 1024;
 
+	// Write each media file only once, in a shared folder keyed by its
+	// file location, instead of a copy per dialog for forwarded media.
+	bool contentAddressedStore = false;
+
 	static inline Types DefaultTypes() {
 		return Type::Photo;
 	}
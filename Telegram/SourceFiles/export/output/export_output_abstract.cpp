@@ -15,6 +15,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 #include <QtCore/QDir>
 #include <QtCore/QDate>
+#include <QtCore/QFile>
 
 namespace Export {
 namespace Output {
@@ -43,12 +44,21 @@ QString NormalizePath(const Settings &settings) {
 	};
 	auto index = 0;
 	while (QDir(result + add(index)).exists()) {
+		// An unfinished export left its journal in this folder, so
+		// continue there - the downloaded files will be reused.
+		if (QFile::exists(ResumeJournalPath(result + add(index) + '/'))) {
+			break;
+		}
 		++index;
 	}
 	result += add(index) + '/';
 	return result;
 }
 
+QString ResumeJournalPath(const QString &folder) {
+	return folder + "resume.journal";
+}
+
 std::unique_ptr<AbstractWriter> CreateWriter(Format format) {
 	switch (format) {
 	case Format::Html: return std::make_unique<HtmlWriter>();
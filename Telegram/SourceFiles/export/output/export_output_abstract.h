@@ -28,6 +28,7 @@ struct Environment;
 namespace Output {
 
 QString NormalizePath(const Settings &settings);
+QString ResumeJournalPath(const QString &folder);
 
 struct Result;
 class Stats;
@@ -20,6 +20,7 @@ namespace Output {
 namespace {
 
 constexpr auto kMessagesInFile = 1000;
+constexpr auto kFlushBufferSize = 64 * 1024;
 constexpr auto kPersonalUserpicSize = 90;
 constexpr auto kEntryUserpicSize = 48;
 constexpr auto kServiceMessagePhotoSize = 60;
@@ -591,6 +592,7 @@ public:
 
 private:
 	[[nodiscard]] QByteArray composeStart();
+	[[nodiscard]] Result flush();
 	[[nodiscard]] QByteArray pushGenericListEntry(
 		const QString &link,
 		const UserpicData &userpic,
@@ -633,6 +635,7 @@ private:
 
 	File _file;
 	QByteArray _composedStart;
+	QByteArray _buffer;
 	bool _closed = false;
 	QByteArray _base;
 	Context _context;
@@ -705,7 +708,7 @@ HtmlWriter::Wrap::Wrap(
 }
 
 bool HtmlWriter::Wrap::empty() const {
-	return _file.empty();
+	return _file.empty() && _buffer.isEmpty();
 }
 
 QByteArray HtmlWriter::Wrap::pushTag(
@@ -858,14 +861,27 @@ QByteArray HtmlWriter::Wrap::pushGenericListEntry(
 Result HtmlWriter::Wrap::writeBlock(const QByteArray &block) {
 	Expects(!_closed);
 
-	const auto result = [&] {
-		if (block.isEmpty()) {
-			return _file.writeBlock(block);
-		} else if (_file.empty()) {
-			return _file.writeBlock(_composedStart + block);
-		}
-		return _file.writeBlock(block);
-	}();
+	// Blocks accumulate in a fixed-size buffer that is written out
+	// whenever it overflows, so a large document never has to be
+	// composed in memory as a whole.
+	if (block.isEmpty()) {
+		return Result::Success();
+	}
+	if (empty()) {
+		_buffer.append(_composedStart);
+	}
+	_buffer.append(block);
+	return (_buffer.size() >= kFlushBufferSize)
+		? flush()
+		: Result::Success();
+}
+
+Result HtmlWriter::Wrap::flush() {
+	if (_buffer.isEmpty()) {
+		return Result::Success();
+	}
+	const auto result = _file.writeBlock(_buffer);
+	_buffer = QByteArray();
 	if (!result) {
 		_closed = true;
 	}
@@ -1775,12 +1791,13 @@ bool HtmlWriter::Wrap::forwardedNeedsWrap(
 }
 
 Result HtmlWriter::Wrap::close() {
-	if (!std::exchange(_closed, true) && !_file.empty()) {
-		auto block = QByteArray();
+	if (!std::exchange(_closed, true) && !empty()) {
 		while (!_context.empty()) {
-			block.append(_context.popTag());
+			_buffer.append(_context.popTag());
 		}
-		return _file.writeBlock(block);
+		const auto result = _file.writeBlock(_buffer);
+		_buffer = QByteArray();
+		return result;
 	}
 	return Result::Success();
 }
@@ -2371,21 +2388,17 @@ Result HtmlWriter::writeDialogSlice(const Data::MessagesSlice &data) {
 		: 0;
 	auto previous = _lastMessageInfo.get();
 	auto saved = std::optional<MessageInfo>();
-	auto block = QByteArray();
 	for (const auto &message : data.list) {
 		if (Data::SkipMessageByDate(message, _settings)) {
 			continue;
 		}
 		const auto newIndex = (_messagesCount / kMessagesInFile);
 		if (oldIndex != newIndex) {
-			if (const auto result = _chat->writeBlock(block); !result) {
-				return result;
-			} else if (const auto next = switchToNextChatFile(newIndex)) {
+			if (const auto next = switchToNextChatFile(newIndex)) {
 				Assert(saved.has_value() || _lastMessageInfo != nullptr);
 				_lastMessageIdsPerFile.push_back(saved
 					? saved->id
 					: _lastMessageInfo->id);
-				block = QByteArray();
 				_lastMessageInfo = nullptr;
 				previous = nullptr;
 				saved = std::nullopt;
@@ -2402,12 +2415,16 @@ Result HtmlWriter::writeDialogSlice(const Data::MessagesSlice &data) {
 		}
 		const auto date = message.date;
 		if (DisplayDate(date, previous ? previous->date : 0)) {
-			block.append(_chat->pushServiceMessage(
+			const auto result = _chat->writeBlock(_chat->pushServiceMessage(
 				--_dateMessageId,
 				_dialog,
 				_settings.path,
 				FormatDateText(date)));
+			if (!result) {
+				return result;
+			}
 		}
+		// Each message block is written out and released right away.
 		const auto [info, content] = _chat->pushMessage(
 			message,
 			previous,
@@ -2416,7 +2433,9 @@ Result HtmlWriter::writeDialogSlice(const Data::MessagesSlice &data) {
 			data.peers,
 			_environment.internalLinksDomain,
 			messageLinkWrapper);
-		block.append(content);
+		if (const auto result = _chat->writeBlock(content); !result) {
+			return result;
+		}
 
 		++_messagesCount;
 		saved = info;
@@ -2425,7 +2444,7 @@ Result HtmlWriter::writeDialogSlice(const Data::MessagesSlice &data) {
 	if (saved) {
 		_lastMessageInfo = std::make_unique<MessageInfo>(*saved);
 	}
-	return block.isEmpty() ? Result::Success() : _chat->writeBlock(block);
+	return Result::Success();
 }
 
 Result HtmlWriter::writeEmptySinglePeer() {
@@ -30,7 +30,7 @@ Content ContentFromState(
 		result.rows.push_back({ id, label, info, progress });
 	};
 	const auto pushMain = [&](const QString &label) {
-		const auto info = (state.entityCount > 0)
+		auto info = (state.entityCount > 0)
 			? (QString::number(state.entityIndex + 1)
 				+ " / "
 				+ QString::number(state.entityCount))
@@ -54,16 +54,34 @@ Content ContentFromState(
 			&& !state.entityIndex)
 			? addPart(state.itemIndex, state.itemCount)
 			: addPart(state.entityIndex, state.entityCount);
-		push("main", label, info, doneProgress + addProgress);
+		const auto fraction = doneProgress + addProgress;
+
+		// A rough whole-export estimate from the progress measured
+		// since the start, shown only when it is worth looking at.
+		if (state.startedAt > 0 && fraction >= 0.01) {
+			const auto elapsed = crl::now() - state.startedAt;
+			const auto left = crl::time(elapsed * (1. - fraction) / fraction);
+			if (left >= 60 * crl::time(1000)) {
+				const auto eta = tr::lng_export_eta(
+					tr::now,
+					lt_duration,
+					formatDurationWords(left / 1000));
+				info += (info.isEmpty() ? QString() : ", ") + eta;
+			}
+		}
+		push("main", label, info, fraction);
 	};
 	const auto pushBytes = [&](const QString &id, const QString &label) {
 		if (!state.bytesCount) {
 			return;
 		}
 		const auto progress = state.bytesLoaded / float64(state.bytesCount);
-		const auto info = formatDownloadText(
+		auto info = formatDownloadText(
 			state.bytesLoaded,
 			state.bytesCount);
+		if (state.bytesPerSecond > 0) {
+			info += ", " + formatSpeedText(state.bytesPerSecond);
+		}
 		push(id, label, info, progress);
 	};
 	switch (state.step) {
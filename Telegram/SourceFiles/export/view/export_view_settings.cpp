@@ -652,6 +652,7 @@ void SettingsWidget::addMediaOptions(
 		tr::lng_export_option_files(tr::now),
 		MediaType::File);
 	addSizeSlider(container);
+	addSharedMediaOption(container);
 }
 
 void SettingsWidget::addMediaOption(
@@ -718,6 +719,23 @@ void SettingsWidget::addSizeSlider(
 	}, label->lifetime());
 }
 
+void SettingsWidget::addSharedMediaOption(
+		not_null<Ui::VerticalLayout*> container) {
+	const auto checkbox = container->add(
+		object_ptr<Ui::Checkbox>(
+			container,
+			tr::lng_export_option_shared_media(tr::now),
+			readData().media.contentAddressedStore,
+			st::defaultBoxCheckbox),
+		st::exportSettingPadding);
+	checkbox->checkedChanges(
+	) | rpl::start_with_next([=](bool checked) {
+		changeData([&](Settings &data) {
+			data.media.contentAddressedStore = checked;
+		});
+	}, checkbox->lifetime());
+}
+
 void SettingsWidget::refreshButtons(
 		not_null<Ui::RpWidget*> container,
 		bool canStart) {
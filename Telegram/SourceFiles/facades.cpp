@@ -384,6 +384,7 @@ struct Data {
 	MTP::ProxyData SelectedProxy;
 	MTP::ProxyData::Settings ProxySettings = MTP::ProxyData::Settings::System;
 	bool UseProxyForCalls = false;
+	bool ProxyAutoSelect = false;
 	base::Observable<void> ConnectionTypeChanged;
 
 	int AutoLock = 3600;
@@ -502,6 +503,7 @@ DefineVar(Global, std::vector<MTP::ProxyData>, ProxiesList);
 DefineVar(Global, MTP::ProxyData, SelectedProxy);
 DefineVar(Global, MTP::ProxyData::Settings, ProxySettings);
 DefineVar(Global, bool, UseProxyForCalls);
+DefineVar(Global, bool, ProxyAutoSelect);
 DefineRefVar(Global, base::Observable<void>, ConnectionTypeChanged);
 
 DefineVar(Global, int, AutoLock);
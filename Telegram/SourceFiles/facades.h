@@ -224,6 +224,7 @@ DeclareVar(std::vector<MTP::ProxyData>, ProxiesList);
 DeclareVar(MTP::ProxyData, SelectedProxy);
 DeclareVar(MTP::ProxyData::Settings, ProxySettings);
 DeclareVar(bool, UseProxyForCalls);
+DeclareVar(bool, ProxyAutoSelect);
 DeclareRefVar(base::Observable<void>, ConnectionTypeChanged);
 
 DeclareVar(int, AutoLock);
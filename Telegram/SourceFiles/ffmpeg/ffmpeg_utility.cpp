@@ -82,6 +82,79 @@ void PremultiplyLine(uchar *dst, const uchar *src, int intsCount) {
 #endif // Qt >= 5.12
 }
 
+// Platform order of preference for hardware decoding devices.
+constexpr AVHWDeviceType kPreferredHardwareDevices[] = {
+#if defined Q_OS_WIN
+	AV_HWDEVICE_TYPE_DXVA2,
+	AV_HWDEVICE_TYPE_D3D11VA,
+#elif defined Q_OS_MAC // Q_OS_WIN
+	AV_HWDEVICE_TYPE_VIDEOTOOLBOX,
+#else // Q_OS_WIN || Q_OS_MAC
+	AV_HWDEVICE_TYPE_VAAPI,
+	AV_HWDEVICE_TYPE_VDPAU,
+#endif // !Q_OS_WIN && !Q_OS_MAC
+};
+
+enum AVPixelFormat ChooseHardwareFormat(
+		AVCodecContext *context,
+		const enum AVPixelFormat *formats) {
+	// The hardware format negotiated in InitHardwareAcceleration
+	// was saved in the opaque field of the codec context.
+	const auto chosen = static_cast<enum AVPixelFormat>(
+		reinterpret_cast<qintptr>(context->opaque));
+	for (auto i = formats; *i != AV_PIX_FMT_NONE; ++i) {
+		if (*i == chosen) {
+			return *i;
+		}
+	}
+	// The decoder doesn't offer the hardware format for this stream,
+	// let FFmpeg pick a software one as if no device was attached.
+	return avcodec_default_get_format(context, formats);
+}
+
+[[nodiscard]] bool InitHardwareAcceleration(
+		not_null<AVCodecContext*> context,
+		not_null<const AVCodec*> codec) {
+	for (const auto type : kPreferredHardwareDevices) {
+		const auto config = [&]() -> const AVCodecHWConfig* {
+			for (auto i = 0;; ++i) {
+				const auto config = avcodec_get_hw_config(codec, i);
+				if (!config) {
+					return nullptr;
+				} else if ((config->methods
+					& AV_CODEC_HW_CONFIG_METHOD_HW_DEVICE_CTX)
+					&& (config->device_type == type)) {
+					return config;
+				}
+			}
+		}();
+		if (!config) {
+			continue;
+		}
+		auto device = (AVBufferRef*)nullptr;
+		const auto error = AvErrorWrap(av_hwdevice_ctx_create(
+			&device,
+			type,
+			nullptr,
+			nullptr,
+			0));
+		if (error) {
+			LogError(qstr("av_hwdevice_ctx_create"), error);
+			continue;
+		}
+		context->hw_device_ctx = device;
+		context->opaque = reinterpret_cast<void*>(
+			qintptr(config->pix_fmt));
+		context->get_format = ChooseHardwareFormat;
+		LOG(("Streaming Info: "
+			"Using %1 hardware acceleration for %2 decoding."
+			).arg(av_hwdevice_get_type_name(type)
+			).arg(codec->name));
+		return true;
+	}
+	return false;
+}
+
 } // namespace
 
 IOPointer MakeIOPointer(
@@ -160,7 +233,9 @@ void FormatDeleter::operator()(AVFormatContext *value) {
 	}
 }
 
-CodecPointer MakeCodecPointer(not_null<AVStream*> stream) {
+CodecPointer MakeCodecPointer(
+		not_null<AVStream*> stream,
+		bool tryHardwareAcceleration) {
 	auto error = AvErrorWrap();
 
 	auto result = CodecPointer(avcodec_alloc_context3(nullptr));
@@ -181,8 +256,15 @@ CodecPointer MakeCodecPointer(not_null<AVStream*> stream) {
 	if (!codec) {
 		LogError(qstr("avcodec_find_decoder"), context->codec_id);
 		return {};
-	} else if ((error = avcodec_open2(context, codec, nullptr))) {
+	}
+	const auto hardware = tryHardwareAcceleration
+		&& InitHardwareAcceleration(context, codec);
+	if ((error = avcodec_open2(context, codec, nullptr))) {
 		LogError(qstr("avcodec_open2"), error);
+		if (hardware) {
+			// Fall back transparently to software decoding.
+			return MakeCodecPointer(stream, false);
+		}
 		return {};
 	}
 	return result;
@@ -245,7 +327,9 @@ SwscalePointer MakeSwscalePointer(
 		dstSize.width(),
 		dstSize.height(),
 		AVPixelFormat(dstFormat),
-		0,
+		// Conversion happens on every decoded frame, prefer speed
+		// over the scaling quality of the default bicubic filter.
+		SWS_FAST_BILINEAR,
 		nullptr,
 		nullptr,
 		nullptr);
@@ -17,6 +17,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 extern "C" {
 #include <libavcodec/avcodec.h>
 #include <libavformat/avformat.h>
+#include <libavutil/hwcontext.h>
 #include <libswscale/swscale.h>
 } // extern "C"
 
@@ -136,7 +137,9 @@ struct CodecDeleter {
 	void operator()(AVCodecContext *value);
 };
 using CodecPointer = std::unique_ptr<AVCodecContext, CodecDeleter>;
-[[nodiscard]] CodecPointer MakeCodecPointer(not_null<AVStream*> stream);
+[[nodiscard]] CodecPointer MakeCodecPointer(
+	not_null<AVStream*> stream,
+	bool tryHardwareAcceleration = false);
 
 struct FrameDeleter {
 	void operator()(AVFrame *value);
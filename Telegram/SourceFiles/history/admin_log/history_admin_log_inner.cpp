@@ -61,6 +61,8 @@ constexpr auto kScrollDateHideTimeout = 1000;
 constexpr auto kEventsFirstPage = 20;
 constexpr auto kEventsPerPage = 50;
 constexpr auto kClearUserpicsAfter = 50;
+constexpr auto kScrollLookaheadTime = crl::time(500);
+constexpr auto kScrollLookaheadMaxHeights = 10;
 
 } // namespace
 
@@ -310,6 +312,14 @@ void InnerWidget::visibleTopBottomUpdated(
 		int visibleTop,
 		int visibleBottom) {
 	auto scrolledUp = (visibleTop < _visibleTop);
+	const auto now = crl::now();
+	if (_visibleChangeTime && now > _visibleChangeTime) {
+		const auto speed = std::abs(visibleTop - _visibleTop)
+			/ float64(now - _visibleChangeTime);
+		// Smooth the estimate so a single jump doesn't count as a flick.
+		_scrollSpeed = (_scrollSpeed + speed) / 2.;
+	}
+	_visibleChangeTime = now;
 	_visibleTop = visibleTop;
 	_visibleBottom = visibleBottom;
 
@@ -391,10 +401,17 @@ void InnerWidget::repaintScrollDateCallback() {
 }
 
 void InnerWidget::checkPreloadMore() {
-	if (_visibleTop + PreloadHeightsCount * (_visibleBottom - _visibleTop) > height()) {
+	// Look further ahead while the list is scrolled fast, so that the
+	// next page is requested while the current one is still being read.
+	const auto visibleHeight = (_visibleBottom - _visibleTop);
+	const auto lookahead = PreloadHeightsCount * visibleHeight
+		+ std::min(
+			int(_scrollSpeed * kScrollLookaheadTime),
+			kScrollLookaheadMaxHeights * visibleHeight);
+	if (_visibleTop + lookahead > height()) {
 		preloadMore(Direction::Down);
 	}
-	if (_visibleTop < PreloadHeightsCount * (_visibleBottom - _visibleTop)) {
+	if (_visibleTop < lookahead) {
 		preloadMore(Direction::Up);
 	}
 }
@@ -246,6 +246,8 @@ private:
 	int _minHeight = 0;
 	int _visibleTop = 0;
 	int _visibleBottom = 0;
+	crl::time _visibleChangeTime = 0;
+	float64 _scrollSpeed = 0.; // Pixels per millisecond, smoothed.
 	Element *_visibleTopItem = nullptr;
 	int _visibleTopFromItem = 0;
 
@@ -628,6 +628,12 @@ HistoryItem *History::addNewMessage(
 	if (!item) {
 		return nullptr;
 	}
+	if (IsServerMsgId(item->id)) {
+		const auto &text = item->originalText().text;
+		if (!text.isEmpty()) {
+			session().storage().searchIndexAdd(peer->id, item->id, text);
+		}
+	}
 	if (type == NewMessageType::Existing || item->mainView()) {
 		return item;
 	}
@@ -646,6 +652,7 @@ not_null<HistoryItem*> History::insertItem(
 
 	const auto result = i->get();
 	owner().registerMessage(result);
+	addToDateIndex(result->date(), result->id);
 
 	Ensures(ok);
 	return result;
@@ -665,6 +672,8 @@ void History::destroyMessage(not_null<HistoryItem*> item) {
 					types,
 					item->id));
 			}
+			session().storage().searchIndexRemove(peerId, item->id);
+			removeFromDateIndex(item->date(), item->id);
 		} else {
 			session().api().cancelLocalItem(item);
 		}
@@ -840,7 +849,9 @@ void History::setUnreadMentionsCount(int count) {
 	_unreadMentionsCount = count;
 	const auto has = (count > 0);
 	if (has != had) {
-		owner().chatsFilters().refreshHistory(this);
+		owner().chatsFilters().refreshHistory(
+			this,
+			Data::ChatFilter::Input::Unread);
 		updateChatListEntry();
 	}
 }
@@ -1315,6 +1326,37 @@ void History::registerLocalMessage(not_null<HistoryItem*> item) {
 	}
 }
 
+void History::addToDateIndex(TimeId date, MsgId id) {
+	if (!date || !IsServerMsgId(id)) {
+		return;
+	}
+	const auto day = int(base::unixtime::parse(date).date().toJulianDay());
+	const auto i = _dateIndex.find(day);
+	if (i == end(_dateIndex)) {
+		_dateIndex.emplace(day, DateIndexEntry{ date, id });
+	} else if (id < i->second.id) {
+		i->second = DateIndexEntry{ date, id };
+	}
+}
+
+void History::removeFromDateIndex(TimeId date, MsgId id) {
+	if (!date || !IsServerMsgId(id)) {
+		return;
+	}
+	const auto day = int(base::unixtime::parse(date).date().toJulianDay());
+	const auto i = _dateIndex.find(day);
+	if (i != end(_dateIndex) && i->second.id == id) {
+		// The next message of that day gets indexed again
+		// when its range is loaded from the server.
+		_dateIndex.erase(i);
+	}
+}
+
+MsgId History::findDateIndexMessage(const QDate &date) const {
+	const auto i = _dateIndex.find(int(date.toJulianDay()));
+	return (i != end(_dateIndex)) ? i->second.id : MsgId(0);
+}
+
 void History::unregisterLocalMessage(not_null<HistoryItem*> item) {
 	const auto removed = _localMessages.remove(item);
 	Assert(removed);
@@ -1800,7 +1842,9 @@ void History::setUnreadCount(int newUnreadCount) {
 	const auto wasForBadge = (unreadCountForBadge() > 0);
 	const auto refresher = gsl::finally([&] {
 		if (wasForBadge != (unreadCountForBadge() > 0)) {
-			owner().chatsFilters().refreshHistory(this);
+			owner().chatsFilters().refreshHistory(
+				this,
+				Data::ChatFilter::Input::Unread);
 		}
 		Notify::peerUpdatedDelayed(
 			peer,
@@ -1838,7 +1882,9 @@ void History::setUnreadMark(bool unread) {
 	const auto noUnreadMessages = !unreadCount();
 	const auto refresher = gsl::finally([&] {
 		if (inChatList() && noUnreadMessages) {
-			owner().chatsFilters().refreshHistory(this);
+			owner().chatsFilters().refreshHistory(
+				this,
+				Data::ChatFilter::Input::Unread);
 			updateChatListEntry();
 		}
 		Notify::peerUpdatedDelayed(
@@ -1863,7 +1909,9 @@ void History::setFakeUnreadWhileOpened(bool enabled) {
 		return;
 	}
 	_fakeUnreadWhileOpened = enabled;
-	owner().chatsFilters().refreshHistory(this);
+	owner().chatsFilters().refreshHistory(
+		this,
+		Data::ChatFilter::Input::Unread);
 }
 
 [[nodiscard]] bool History::fakeUnreadWhileOpened() const {
@@ -1880,7 +1928,9 @@ bool History::changeMute(bool newMute) {
 	}
 	const auto refresher = gsl::finally([&] {
 		if (inChatList()) {
-			owner().chatsFilters().refreshHistory(this);
+			owner().chatsFilters().refreshHistory(
+				this,
+				Data::ChatFilter::Input::Muted);
 			updateChatListEntry();
 		}
 		Notify::peerUpdatedDelayed(
@@ -1972,7 +2022,9 @@ void History::setFolderPointer(Data::Folder *folder) {
 	if (wasInList) {
 		addToChatList(0, owner().chatsList(folder));
 
-		owner().chatsFilters().refreshHistory(this);
+		owner().chatsFilters().refreshHistory(
+			this,
+			Data::ChatFilter::Input::Archive);
 		updateChatListEntry();
 
 		owner().chatsListChanged(was);
@@ -3220,6 +3272,7 @@ void History::clear(ClearType type) {
 			item->destroy();
 		}
 		_notifications.clear();
+		_dateIndex.clear();
 		owner().notifyHistoryCleared(this);
 		if (unreadCountKnown()) {
 			setUnreadCount(0);
@@ -3279,6 +3332,13 @@ void History::clearUpTill(MsgId availableMinId) {
 	for (const auto item : remove) {
 		item->destroy();
 	}
+	for (auto i = begin(_dateIndex); i != end(_dateIndex);) {
+		if (i->second.id < availableMinId) {
+			i = _dateIndex.erase(i);
+		} else {
+			++i;
+		}
+	}
 	requestChatListMessage();
 }
 
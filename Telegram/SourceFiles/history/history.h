@@ -176,6 +176,10 @@ public:
 
 	void registerLocalMessage(not_null<HistoryItem*> item);
 	void unregisterLocalMessage(not_null<HistoryItem*> item);
+
+	void addToDateIndex(TimeId date, MsgId id);
+	void removeFromDateIndex(TimeId date, MsgId id);
+	[[nodiscard]] MsgId findDateIndexMessage(const QDate &date) const;
 	[[nodiscard]] HistoryItem *latestSendingMessage() const;
 
 	[[nodiscard]] bool readInboxTillNeedsRequest(MsgId tillId);
@@ -275,6 +279,9 @@ public:
 		int outerWidth,
 		style::color color,
 		crl::time now);
+	[[nodiscard]] bool sendActionPainting() const {
+		return bool(_sendActionAnimation);
+	}
 
 	// Interface for Histories
 	bool updateSendActionNeedsAnimating(
@@ -546,6 +553,14 @@ private:
 	base::flat_set<not_null<HistoryItem*>> _localMessages;
 	std::unordered_set<std::unique_ptr<HistoryItem>> _messages;
 
+	// Earliest seen server message for each local-time day,
+	// so that jump-to-date for already loaded periods skips the server.
+	struct DateIndexEntry {
+		TimeId date = 0;
+		MsgId id = 0;
+	};
+	base::flat_map<int, DateIndexEntry> _dateIndex; // QDate::toJulianDay().
+
 	// This almost always is equal to _lastMessage. The only difference is
 	// for a group that migrated to a supergroup. Then _lastMessage can
 	// be a migrate message, but _chatListMessage should be the one before.
@@ -10,6 +10,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include <rpl/merge.h>
 #include "core/file_utilities.h"
 #include "core/crash_reports.h"
+#include "core/frame_hud.h"
 #include "history/history.h"
 #include "history/history_message.h"
 #include "history/view/media/history_view_media.h"
@@ -573,6 +574,13 @@ void HistoryInner::paintEvent(QPaintEvent *e) {
 
 	Painter p(this);
 	auto clip = e->rect();
+	auto frameHud = Core::FrameHud::PaintScope(p, "history", clip, width());
+
+	// The clip rect above is only the bounding rect of the damage region,
+	// so when two animating items are far apart (a playing round video and
+	// the typing animation, say) it spans every bubble in between. Check
+	// the precise region per item and skip the ones that are not damaged.
+	const auto region = e->region();
 	auto ms = crl::now();
 
 	const auto historyDisplayedEmpty = _history->isDisplayedEmpty()
@@ -626,21 +634,22 @@ void HistoryInner::paintEvent(QPaintEvent *e) {
 			p.save();
 			p.translate(0, y);
 			if (clip.y() < y + view->height()) while (y < drawToY) {
-				const auto selection = itemRenderSelection(
-					view,
-					selfromy - mtop,
-					seltoy - mtop);
-				view->draw(p, clip.translated(0, -y), selection, ms);
-
-				if (item->hasViews()) {
-					App::main()->scheduleViewIncrement(item);
-				}
-				if (item->isUnreadMention() && !item->isUnreadMedia()) {
-					readMentions.insert(item);
-					_widget->enqueueMessageHighlight(view);
-				}
+				const auto h = view->height();
+				if (region.intersects(QRect(0, y, width(), h))) {
+					const auto selection = itemRenderSelection(
+						view,
+						selfromy - mtop,
+						seltoy - mtop);
+					view->draw(p, clip.translated(0, -y), selection, ms);
 
-				int32 h = view->height();
+					if (item->hasViews()) {
+						App::main()->scheduleViewIncrement(item);
+					}
+					if (item->isUnreadMention() && !item->isUnreadMedia()) {
+						readMentions.insert(item);
+						_widget->enqueueMessageHighlight(view);
+					}
+				}
 				p.translate(0, h);
 				y += h;
 
@@ -671,7 +680,9 @@ void HistoryInner::paintEvent(QPaintEvent *e) {
 			p.translate(0, y);
 			while (y < drawToY) {
 				const auto h = view->height();
-				if (hclip.y() < y + h && hdrawtop < y + h) {
+				if (hclip.y() < y + h
+					&& hdrawtop < y + h
+					&& region.intersects(QRect(0, y, width(), h))) {
 					const auto selection = itemRenderSelection(
 						view,
 						selfromy - htop,
@@ -730,8 +741,13 @@ void HistoryInner::paintEvent(QPaintEvent *e) {
 					return false;
 				}
 
-				// paint the userpic if it intersects the painted rect
-				if (userpicTop + st::msgPhotoSize > clip.top()) {
+				// paint the userpic if it intersects the damage region
+				if (userpicTop + st::msgPhotoSize > clip.top()
+					&& region.intersects(QRect(
+						0,
+						userpicTop,
+						width(),
+						st::msgPhotoSize))) {
 					const auto message = view->data()->toHistoryMessage();
 					if (const auto from = message->displayFrom()) {
 						from->paintUserpicLeft(
@@ -2402,29 +2418,17 @@ void HistoryInner::adjustCurrent(int32 y, History *history) const {
 	Expects(!history->isEmpty());
 
 	_curHistory = history;
-	if (_curBlock >= history->blocks.size()) {
-		_curBlock = history->blocks.size() - 1;
-		_curItem = 0;
-	}
-	while (history->blocks[_curBlock]->y() > y && _curBlock > 0) {
-		--_curBlock;
-		_curItem = 0;
-	}
-	while (history->blocks[_curBlock]->y() + history->blocks[_curBlock]->height() <= y && _curBlock + 1 < history->blocks.size()) {
-		++_curBlock;
-		_curItem = 0;
-	}
-	auto block = history->blocks[_curBlock].get();
-	if (_curItem >= block->messages.size()) {
-		_curItem = block->messages.size() - 1;
-	}
-	auto by = block->y();
-	while (block->messages[_curItem]->y() + by > y && _curItem > 0) {
-		--_curItem;
-	}
-	while (block->messages[_curItem]->y() + block->messages[_curItem]->height() + by <= y && _curItem + 1 < block->messages.size()) {
-		++_curItem;
-	}
+
+	// The y() offsets of blocks and items are prefix sums of heights,
+	// maintained by the resize, so the item under the given point is
+	// found by binary search, the same way the visible range is. The
+	// old linear walk from the last position was as long as the jump
+	// of the cursor, for example after a page scroll.
+	_curBlock = BinarySearchBlocksOrItems<true>(history->blocks, y);
+	const auto block = history->blocks[_curBlock].get();
+	_curItem = BinarySearchBlocksOrItems<true>(
+		block->messages,
+		y - block->y());
 }
 
 auto HistoryInner::prevItem(Element *view) -> Element* {
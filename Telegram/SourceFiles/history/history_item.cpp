@@ -482,6 +482,7 @@ void HistoryItem::setRealId(MsgId newId) {
 	_clientFlags &= ~MTPDmessage_ClientFlag::f_sending;
 	if (IsServerMsgId(id)) {
 		_history->unregisterLocalMessage(this);
+		_history->addToDateIndex(_date, id);
 	}
 	_history->owner().notifyItemIdChange({ this, oldId });
 
@@ -24,6 +24,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "ui/widgets/shadow.h"
 #include "ui/effects/ripple_animation.h"
 #include "ui/text/text_utilities.h" // Ui::Text::ToUpper
+#include "ui/ui_utility.h"
 #include "ui/image/image.h"
 #include "ui/special_buttons.h"
 #include "inline_bots/inline_bot_result.h"
@@ -115,6 +116,13 @@ namespace {
 constexpr auto kMessagesPerPageFirst = 30;
 constexpr auto kMessagesPerPage = 50;
 constexpr auto kPreloadHeightsCount = 3; // when 3 screens to scroll left make a preload request
+constexpr auto kPreloadHeightsCountFast = 6; // preload early when flinging
+constexpr auto kMessagesPerPageFast = 100; // server limit for getHistory
+
+// Scrolling faster than this many screen heights per second counts as
+// a fling, a sample older than the window doesn't count as one at all.
+constexpr auto kFastScrollThreshold = 2.;
+constexpr auto kScrollVelocityWindow = crl::time(500);
 constexpr auto kTabbedSelectorToggleTooltipTimeoutMs = 3000;
 constexpr auto kTabbedSelectorToggleTooltipCount = 3;
 constexpr auto kScrollToVoiceAfterScrolledMs = 1000;
@@ -489,7 +497,17 @@ HistoryWidget::HistoryWidget(
 	session().data().viewResizeRequest(
 	) | rpl::start_with_next([=](not_null<HistoryView::Element*> view) {
 		if (view->data()->mainView() == view) {
-			updateHistoryGeometry();
+			// Many previews and thumbnails may finish loading in one
+			// event loop cycle. The pending resize flag is already set
+			// on the view, so recount the geometry once for the whole
+			// batch instead of running a full pass per item.
+			if (!_pendingItemsResize) {
+				_pendingItemsResize = true;
+				Ui::PostponeCall(this, [=] {
+					_pendingItemsResize = false;
+					updateHistoryGeometry();
+				});
+			}
 		}
 	}, lifetime());
 
@@ -1464,7 +1482,9 @@ bool HistoryWidget::notify_switchInlineBotButtonReceived(const QString &query, U
 
 void HistoryWidget::notify_userIsBotChanged(UserData *user) {
 	if (const auto history = session().data().history(user)) {
-		session().data().chatsFilters().refreshHistory(history);
+		session().data().chatsFilters().refreshHistory(
+			history,
+			Data::ChatFilter::Input::PeerType);
 	}
 	if (_peer && _peer == user) {
 		_list->notifyIsBotChanged();
@@ -2647,9 +2667,11 @@ void HistoryWidget::loadMessages() {
 
 	auto offsetId = from->minMsgId();
 	auto addOffset = 0;
-	auto loadCount = offsetId
-		? kMessagesPerPage
-		: kMessagesPerPageFirst;
+	auto loadCount = !offsetId
+		? kMessagesPerPageFirst
+		: isScrollFlinging()
+		? kMessagesPerPageFast
+		: kMessagesPerPage;
 	auto offsetDate = 0;
 	auto maxId = 0;
 	auto minId = 0;
@@ -2693,7 +2715,9 @@ void HistoryWidget::loadMessagesDown() {
 		return;
 	}
 
-	auto loadCount = kMessagesPerPage;
+	auto loadCount = isScrollFlinging()
+		? kMessagesPerPageFast
+		: kMessagesPerPage;
 	auto addOffset = -loadCount;
 	auto offsetId = from->maxMsgId();
 	if (!offsetId) {
@@ -2837,16 +2861,31 @@ void HistoryWidget::preloadHistoryIfNeeded() {
 
 	updateHistoryDownVisibility();
 	updateUnreadMentionsVisibility();
+
+	const auto scrollTop = _scroll->scrollTop();
+	if (scrollTop != _lastScrollTop) {
+		const auto now = crl::now();
+		const auto delta = now - _lastScrolled;
+		const auto height = _scroll->height();
+		_scrollScreensPerSecond = (delta > 0
+			&& delta < kScrollVelocityWindow
+			&& height > 0)
+			? ((std::abs(scrollTop - _lastScrollTop) * 1000.)
+				/ (delta * height))
+			: 0.;
+		_lastScrolled = now;
+		_lastScrollTop = scrollTop;
+	}
+
 	if (!_scrollToAnimation.animating()) {
 		preloadHistoryByScroll();
 		checkReplyReturns();
 	}
+}
 
-	auto scrollTop = _scroll->scrollTop();
-	if (scrollTop != _lastScrollTop) {
-		_lastScrolled = crl::now();
-		_lastScrollTop = scrollTop;
-	}
+bool HistoryWidget::isScrollFlinging() const {
+	return (_scrollScreensPerSecond >= kFastScrollThreshold)
+		&& (_lastScrolled + kScrollVelocityWindow >= crl::now());
 }
 
 void HistoryWidget::preloadHistoryByScroll() {
@@ -2861,10 +2900,16 @@ void HistoryWidget::preloadHistoryByScroll() {
 	auto scrollTop = _scroll->scrollTop();
 	auto scrollTopMax = _scroll->scrollTopMax();
 	auto scrollHeight = _scroll->height();
-	if (scrollTop + kPreloadHeightsCount * scrollHeight >= scrollTopMax) {
+
+	// During a fling the margin widens (and the pages grow), so a fast
+	// scroll doesn't hit the unloaded edge and stall on the network.
+	const auto preloadHeights = isScrollFlinging()
+		? kPreloadHeightsCountFast
+		: kPreloadHeightsCount;
+	if (scrollTop + preloadHeights * scrollHeight >= scrollTopMax) {
 		loadMessagesDown();
 	}
-	if (scrollTop <= kPreloadHeightsCount * scrollHeight) {
+	if (scrollTop <= preloadHeights * scrollHeight) {
 		loadMessages();
 	}
 }
@@ -6468,7 +6513,7 @@ void HistoryWidget::handlePeerUpdate() {
 		if (!channel->mgInfo->botStatus) {
 			session().api().requestBots(channel);
 		}
-		if (channel->mgInfo->admins.empty()) {
+		if (!channel->mgInfo->adminsGeneration) {
 			session().api().requestAdmins(channel);
 		}
 	}
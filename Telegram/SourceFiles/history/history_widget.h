@@ -627,6 +627,7 @@ private:
 	int countInitialScrollTop();
 	int countAutomaticScrollTop();
 	void preloadHistoryByScroll();
+	[[nodiscard]] bool isScrollFlinging() const;
 	void checkReplyReturns();
 	void scrollToAnimationCallback(FullMsgId attachToId, int relativeTo);
 
@@ -709,10 +710,15 @@ private:
 	bool _historyInited = false;
 	// If updateListSize() was called without updateHistoryGeometry().
 	bool _updateHistoryGeometryRequired = false;
+	bool _pendingItemsResize = false;
 	int _addToScroll = 0;
 
 	int _lastScrollTop = 0; // gifs optimization
 	crl::time _lastScrolled = 0;
+
+	// Screen heights per second over the last scroll delta, used to
+	// widen the preload window while the user flings through history.
+	float64 _scrollScreensPerSecond = 0.;
 	QTimer _updateHistoryItems;
 
 	crl::time _lastUserScrolled = 0;
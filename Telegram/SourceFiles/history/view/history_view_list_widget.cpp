@@ -331,6 +331,7 @@ void ListWidget::refreshRows() {
 			_items.push_back(enforceViewForItem(item));
 		}
 	}
+	collectGarbageViews();
 	updateAroundPositionFromRows();
 
 	updateItemsGeometry();
@@ -1322,6 +1323,11 @@ void ListWidget::paintEvent(QPaintEvent *e) {
 	auto ms = crl::now();
 	auto clip = e->rect();
 
+	// The clip rect is only the bounding rect of the damage region, so
+	// items between two distant damaged ones fall inside it while not
+	// being damaged themselves - check the precise region per item.
+	const auto region = e->region();
+
 	auto from = std::lower_bound(begin(_items), end(_items), clip.top(), [this](auto &elem, int top) {
 		return this->itemTop(elem) + elem->height() <= top;
 	});
@@ -1333,12 +1339,14 @@ void ListWidget::paintEvent(QPaintEvent *e) {
 		p.translate(0, top);
 		for (auto i = from; i != to; ++i) {
 			const auto view = *i;
-			view->draw(
-				p,
-				clip.translated(0, -top),
-				itemRenderSelection(view),
-				ms);
 			const auto height = view->height();
+			if (region.intersects(QRect(0, top, width(), height))) {
+				view->draw(
+					p,
+					clip.translated(0, -top),
+					itemRenderSelection(view),
+					ms);
+			}
 			top += height;
 			p.translate(0, height);
 		}
@@ -2509,6 +2517,27 @@ void ListWidget::refreshItem(not_null<const Element*> view) {
 	}
 }
 
+void ListWidget::collectGarbageViews() {
+	// The slice is windowed around _aroundPosition, so while scrolling
+	// we keep creating views for newly exposed messages. Drop the views
+	// for messages that left the window, otherwise they accumulate for
+	// every message ever scrolled past. They are cheap to recreate from
+	// the item once the window moves back.
+	auto kept = base::flat_set<not_null<const HistoryItem*>>();
+	kept.reserve(_items.size());
+	for (const auto view : _items) {
+		kept.emplace(view->data());
+	}
+	for (auto i = begin(_views); i != end(_views);) {
+		if (kept.contains(i->first)) {
+			++i;
+		} else {
+			viewReplaced(i->second.get(), nullptr);
+			i = _views.erase(i);
+		}
+	}
+}
+
 void ListWidget::viewReplaced(not_null<const Element*> was, Element *now) {
 	if (_visibleTopItem == was) _visibleTopItem = now;
 	if (_scrollDateLastItem == was) _scrollDateLastItem = now;
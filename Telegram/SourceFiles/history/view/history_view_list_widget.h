@@ -315,6 +315,7 @@ private:
 	not_null<Element*> findItemByY(int y) const;
 	Element *strictFindItemByY(int y) const;
 	int findNearestItem(Data::MessagePosition position) const;
+	void collectGarbageViews();
 	void viewReplaced(not_null<const Element*> was, Element *now);
 	HistoryItemsList collectVisibleItems() const;
 
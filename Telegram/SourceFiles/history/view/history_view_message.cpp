@@ -282,7 +282,15 @@ QSize Message::performCountOptimalSize() {
 				maxWidth = media->maxWidth();
 				if (hasVisibleText() && maxWidth < plainMaxWidth()) {
 					minHeight -= item->_text.minHeight();
-					minHeight += item->_text.countHeight(maxWidth - st::msgPadding.left() - st::msgPadding.right());
+
+					// Remember the counted height, so that resizing
+					// to this exact width won't lay the text out again.
+					item->_textWidth = maxWidth
+						- st::msgPadding.left()
+						- st::msgPadding.right();
+					item->_textHeight = item->_text.countHeight(
+						item->_textWidth);
+					minHeight += item->_textHeight;
 				}
 			} else {
 				accumulate_max(maxWidth, media->maxWidth());
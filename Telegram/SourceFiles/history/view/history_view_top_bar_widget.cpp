@@ -177,9 +177,26 @@ void TopBarWidget::connectingAnimationCallback() {
 }
 
 void TopBarWidget::refreshLang() {
+	refreshCustomTitle();
 	InvokeQueued(this, [this] { updateControlsGeometry(); });
 }
 
+void TopBarWidget::refreshCustomTitle() {
+	// Cached so the paint doesn't look the translation up and format
+	// the title on every single frame.
+	const auto history = _activeChat.history();
+	const auto folder = _activeChat.folder();
+	_customTitleText = (_section == Section::Scheduled)
+		? ((history && history->peer->isSelf())
+			? tr::lng_reminder_messages(tr::now)
+			: tr::lng_scheduled_messages(tr::now))
+		: folder
+		? folder->chatListName()
+		: (history && history->peer->isSelf())
+		? tr::lng_saved_messages(tr::now)
+		: QString();
+}
+
 void TopBarWidget::onSearch() {
 	if (_activeChat) {
 		App::main()->searchInChat(_activeChat);
@@ -325,13 +342,7 @@ void TopBarWidget::paintTopBar(Painter &p) {
 		|| history->peer->isSelf()
 		|| (_section == Section::Scheduled)) {
 		// #TODO feed name emoji.
-		auto text = (_section == Section::Scheduled)
-			? ((history && history->peer->isSelf())
-				? tr::lng_reminder_messages(tr::now)
-				: tr::lng_scheduled_messages(tr::now))
-			: folder
-			? folder->chatListName()
-			: tr::lng_saved_messages(tr::now);
+		auto text = _customTitleText;
 		const auto textWidth = st::historySavedFont->width(text);
 		if (availableWidth < textWidth) {
 			text = st::historySavedFont->elided(text, availableWidth);
@@ -476,6 +487,7 @@ void TopBarWidget::setActiveChat(Dialogs::Key chat, Section section) {
 	}
 	_activeChat = chat;
 	_section = section;
+	refreshCustomTitle();
 	_back->clearState();
 	update();
 
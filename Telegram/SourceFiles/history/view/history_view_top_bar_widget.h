@@ -87,6 +87,7 @@ protected:
 private:
 	void refreshInfoButton();
 	void refreshLang();
+	void refreshCustomTitle();
 	void updateSearchVisibility();
 	void updateControlsGeometry();
 	void selectedShowCallback();
@@ -150,6 +151,7 @@ private:
 	rpl::event_stream<bool> _membersShowAreaActive;
 
 	Ui::Text::String _titlePeerText;
+	QString _customTitleText;
 	bool _titlePeerTextOnline = false;
 	int _leftTaken = 0;
 	int _rightTaken = 0;
@@ -166,7 +166,7 @@ PointState Media::pointState(QPoint point) const {
 		: PointState::Outside;
 }
 
-std::unique_ptr<Lottie::SinglePlayer> Media::stickerTakeLottie() {
+std::shared_ptr<Lottie::SinglePlayer> Media::stickerTakeLottie() {
 	return nullptr;
 }
 
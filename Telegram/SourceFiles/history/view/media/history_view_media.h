@@ -145,7 +145,7 @@ public:
 	}
 	virtual void stickerClearLoopPlayed() {
 	}
-	virtual std::unique_ptr<Lottie::SinglePlayer> stickerTakeLottie();
+	virtual std::shared_ptr<Lottie::SinglePlayer> stickerTakeLottie();
 	virtual void checkAnimation() {
 	}
 
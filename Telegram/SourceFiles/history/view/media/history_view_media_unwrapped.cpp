@@ -26,7 +26,7 @@ constexpr auto kMaxForwardedBarLines = 4;
 } // namespace
 
 auto UnwrappedMedia::Content::stickerTakeLottie()
--> std::unique_ptr<Lottie::SinglePlayer> {
+-> std::shared_ptr<Lottie::SinglePlayer> {
 	return nullptr;
 }
 
@@ -382,7 +382,7 @@ TextState UnwrappedMedia::textState(QPoint point, StateRequest request) const {
 	return result;
 }
 
-std::unique_ptr<Lottie::SinglePlayer> UnwrappedMedia::stickerTakeLottie() {
+std::shared_ptr<Lottie::SinglePlayer> UnwrappedMedia::stickerTakeLottie() {
 	return _content->stickerTakeLottie();
 }
 
@@ -34,7 +34,7 @@ public:
 		}
 		virtual void stickerClearLoopPlayed() {
 		}
-		virtual std::unique_ptr<Lottie::SinglePlayer> stickerTakeLottie();
+		virtual std::shared_ptr<Lottie::SinglePlayer> stickerTakeLottie();
 		virtual bool hasHeavyPart() const {
 			return false;
 		}
@@ -85,7 +85,7 @@ public:
 	void stickerClearLoopPlayed() override {
 		_content->stickerClearLoopPlayed();
 	}
-	std::unique_ptr<Lottie::SinglePlayer> stickerTakeLottie() override;
+	std::shared_ptr<Lottie::SinglePlayer> stickerTakeLottie() override;
 
 	bool hasHeavyPart() const override {
 		return _content->hasHeavyPart();
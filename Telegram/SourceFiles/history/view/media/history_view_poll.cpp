@@ -708,6 +708,12 @@ void Poll::draw(Painter &p, const QRect &r, TextSelection selection, crl::time m
 	auto paintx = 0, painty = 0, paintw = width(), painth = height();
 
 	checkSendingAnimation();
+	if (_pollVersion != _poll->version) {
+		// Vote-count-only changes come here through a repaint without
+		// a resize, apply them to the cached answers before painting.
+		// This also starts the filling animations for the new values.
+		const_cast<Poll*>(this)->updateTexts();
+	}
 	_poll->checkResultsReload(_parent->data(), ms);
 
 	const auto outbg = _parent->hasOutLayout();
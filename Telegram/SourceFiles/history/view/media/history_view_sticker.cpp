@@ -293,12 +293,25 @@ void Sticker::setDiceIndex(const QString &emoji, int index) {
 void Sticker::setupLottie() {
 	Expects(_dataMedia != nullptr);
 
-	_lottie = Stickers::LottiePlayerFromDocument(
-		_dataMedia.get(),
-		_replacements,
-		Stickers::LottieSize::MessageHistory,
-		_size * cIntRetinaFactor(),
-		Lottie::Quality::High);
+	const auto box = _size * cIntRetinaFactor();
+	if (!_replacements && _diceIndex < 0) {
+		// The same sticker repeated in the visible history shares one
+		// player, so each frame is rasterized only once per size.
+		_lottie = Stickers::LottieSharedPlayerFromDocument(
+			_dataMedia.get(),
+			Stickers::LottieSize::MessageHistory,
+			box,
+			Lottie::Quality::High);
+	} else {
+		// Dices and replaced-color stickers manage their own playback,
+		// so they keep a player of their own.
+		_lottie = Stickers::LottiePlayerFromDocument(
+			_dataMedia.get(),
+			_replacements,
+			Stickers::LottieSize::MessageHistory,
+			box,
+			Lottie::Quality::High);
+	}
 	lottieCreated();
 }
 
@@ -338,7 +351,7 @@ void Sticker::unloadLottie() {
 	_parent->checkHeavyPart();
 }
 
-std::unique_ptr< Lottie::SinglePlayer> Sticker::stickerTakeLottie() {
+std::shared_ptr<Lottie::SinglePlayer> Sticker::stickerTakeLottie() {
 	return std::move(_lottie);
 }
 
@@ -121,6 +121,8 @@ public:
 		QRect clip,
 		int outerWidth) const;
 
+	void prefetch(int from, int till) const;
+
 	static int MinItemHeight(Type type, int width);
 
 private:
@@ -423,6 +425,14 @@ void ListWidget::Section::paint(
 	}
 }
 
+void ListWidget::Section::prefetch(int from, int till) const {
+	const auto fromIt = findItemAfterTop(from);
+	const auto tillIt = findItemAfterBottom(fromIt, till);
+	for (auto it = fromIt; it != tillIt; ++it) {
+		it->second->prefetch();
+	}
+}
+
 TextSelection ListWidget::Section::itemSelection(
 		not_null<const BaseLayout*> item,
 		const Context &context) const {
@@ -1055,11 +1065,13 @@ auto ListWidget::foundItemInSection(
 void ListWidget::visibleTopBottomUpdated(
 		int visibleTop,
 		int visibleBottom) {
+	const auto scrollingDown = (visibleTop >= _visibleTop);
 	_visibleTop = visibleTop;
 	_visibleBottom = visibleBottom;
 
 	checkMoveToOtherViewer();
 	clearHeavyItems();
+	prefetchItems(scrollingDown);
 }
 
 void ListWidget::checkMoveToOtherViewer() {
@@ -1120,6 +1132,29 @@ void ListWidget::checkMoveToOtherViewer() {
 	}
 }
 
+void ListWidget::prefetchItems(bool down) {
+	const auto visibleHeight = _visibleBottom - _visibleTop;
+	if (visibleHeight <= 0 || _sections.empty()) {
+		return;
+	}
+
+	// One screen of thumbnails in the scroll direction, it stays
+	// inside the window that clearHeavyItems() keeps loaded.
+	const auto from = down ? _visibleBottom : (_visibleTop - visibleHeight);
+	const auto till = down ? (_visibleBottom + visibleHeight) : _visibleTop;
+	if (from >= till) {
+		return;
+	}
+	const auto fromSectionIt = findSectionAfterTop(from);
+	const auto tillSectionIt = findSectionAfterBottom(
+		fromSectionIt,
+		till);
+	for (auto it = fromSectionIt; it != tillSectionIt; ++it) {
+		const auto top = it->top();
+		it->prefetch(from - top, till - top);
+	}
+}
+
 void ListWidget::clearHeavyItems() {
 	const auto visibleHeight = _visibleBottom - _visibleTop;
 	if (!visibleHeight) {
@@ -276,6 +276,7 @@ private:
 	void validateTrippleClickStartTime();
 	void checkMoveToOtherViewer();
 	void clearHeavyItems();
+	void prefetchItems(bool down);
 
 	void setActionBoxWeak(QPointer<Ui::RpWidget> box);
 
@@ -154,6 +154,9 @@ void Gif::paint(Painter &p, const QRect &clip, const PaintContext *context) cons
 	if (loaded
 		&& !_gif
 		&& !_gif.isBad()
+		&& (!context
+			|| context->startAnimations
+			|| (_state & StateFlag::Over))
 		&& CanPlayInline(document)) {
 		auto that = const_cast<Gif*>(this);
 		that->_gif = preview.makeAnimation([=](
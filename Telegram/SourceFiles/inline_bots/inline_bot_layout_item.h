@@ -33,6 +33,9 @@ public:
 	}
 	bool paused, lastRow;
 
+	// Items that only show a static preview won't spin up clip readers.
+	bool startAnimations = true;
+
 };
 
 // this type used as a flag, we dynamic_cast<> to it
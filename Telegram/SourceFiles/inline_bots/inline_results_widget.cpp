@@ -45,6 +45,10 @@ namespace {
 
 constexpr auto kInlineBotRequestDelay = 400;
 
+// How many recent query results are kept with their built layouts,
+// so that editing the query back and forth does not re-request them.
+constexpr auto kInlineCacheQueriesLimit = 12;
+
 } // namespace
 
 Inner::Inner(
@@ -386,6 +390,12 @@ void Inner::deleteUnusedInlineLayouts() {
 	}
 }
 
+void Inner::deleteLayouts(const Results &results) {
+	for (const auto &result : results) {
+		_inlineLayouts.erase(result.get());
+	}
+}
+
 Inner::Row &Inner::layoutInlineRow(Row &row, int32 sumWidth) {
 	auto count = int(row.items.size());
 	Assert(count <= kInlineItemsMaxPerRow);
@@ -983,7 +993,10 @@ void Widget::showStarted() {
 
 void Widget::onScroll() {
 	auto st = _scroll->scrollTop();
-	if (st + _scroll->height() > _scroll->scrollTopMax()) {
+
+	// Request the next page while a whole screen of results is still
+	// ahead, so the scroll doesn't hit the end before they arrive.
+	if (st + 2 * _scroll->height() > _scroll->scrollTopMax()) {
 		onInlineRequest();
 	}
 	_inner->setVisibleTopBottom(st, st + _scroll->height());
@@ -1030,6 +1043,7 @@ void Widget::inlineBotChanged() {
 	_inlineQuery = _inlineNextQuery = _inlineNextOffset = QString();
 	_inlineBot = nullptr;
 	_inlineCache.clear();
+	_inlineCacheOrder.clear();
 	_inner->inlineBotChanged();
 	_inner->hideInlineRowsPanel();
 
@@ -1085,12 +1099,38 @@ void Widget::inlineResultsDone(const MTPmessages_BotResults &result) {
 		it->second->nextOffset = QString();
 	}
 
+	if (it != _inlineCache.cend()) {
+		touchInlineCache(_inlineQuery);
+	}
+
 	if (!showInlineRows(!adding)) {
 		it->second->nextOffset = QString();
 	}
 	onScroll();
 }
 
+void Widget::touchInlineCache(const QString &query) {
+	auto i = std::find(
+		_inlineCacheOrder.begin(),
+		_inlineCacheOrder.end(),
+		query);
+	if (i != _inlineCacheOrder.end()) {
+		_inlineCacheOrder.erase(i);
+	}
+	_inlineCacheOrder.push_back(query);
+	while (_inlineCacheOrder.size() > internal::kInlineCacheQueriesLimit) {
+		auto evicted = _inlineCacheOrder.front();
+		_inlineCacheOrder.erase(_inlineCacheOrder.begin());
+		auto it = _inlineCache.find(evicted);
+		if (it != _inlineCache.cend()) {
+			// The current query is always the most recently used one,
+			// so the evicted results can't be on the screen right now.
+			_inner->deleteLayouts(it->second->results);
+			_inlineCache.erase(it);
+		}
+	}
+}
+
 void Widget::queryInlineBot(UserData *bot, PeerData *peer, QString query) {
 	bool force = false;
 	_inlineQueryPeer = peer;
@@ -1109,6 +1149,7 @@ void Widget::queryInlineBot(UserData *bot, PeerData *peer, QString query) {
 		if (_inlineCache.find(query) != _inlineCache.cend()) {
 			_inlineRequestTimer.stop();
 			_inlineQuery = _inlineNextQuery = query;
+			touchInlineCache(query);
 			showInlineRows(true);
 		} else {
 			_inlineNextQuery = query;
@@ -69,6 +69,7 @@ public:
 	void inlineBotChanged();
 	void hideInlineRowsPanel();
 	void clearInlineRowsPanel();
+	void deleteLayouts(const Results &results);
 
 	void preloadImages();
 
@@ -245,6 +246,7 @@ private:
 	void recountContentMaxHeight();
 	bool refreshInlineRows(int *added = nullptr);
 	void inlineResultsDone(const MTPmessages_BotResults &result);
+	void touchInlineCache(const QString &query);
 
 	const not_null<Window::SessionController*> _controller;
 	MTP::Sender _api;
@@ -269,6 +271,9 @@ private:
 	QPointer<internal::Inner> _inner;
 
 	std::map<QString, std::unique_ptr<internal::CacheEntry>> _inlineCache;
+
+	// Least recently shown queries first, for bounding the cache.
+	std::vector<QString> _inlineCacheOrder;
 	QTimer _inlineRequestTimer;
 
 	UserData *_inlineBot = nullptr;
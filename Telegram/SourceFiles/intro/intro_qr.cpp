@@ -50,19 +50,23 @@ namespace {
 	return result;
 }
 
-[[nodiscard]] QImage TelegramQrExact(const Qr::Data &data, int pixel) {
-	return Qr::Generate(data, pixel, st::windowFg->c);
-}
-
-[[nodiscard]] QImage TelegramQr(const Qr::Data &data, int pixel, int max = 0) {
+[[nodiscard]] QImage TelegramQr(
+		const Qr::Data &data,
+		int pixel,
+		int max,
+		QColor fg,
+		QColor bg) {
 	Expects(data.size > 0);
 
 	if (max > 0 && data.size * pixel > max) {
 		pixel = std::max(max / data.size, 1);
 	}
-	const auto qr = TelegramQrExact(data, pixel * style::DevicePixelRatio());
+	const auto qr = Qr::Generate(
+		data,
+		pixel * style::DevicePixelRatio(),
+		fg);
 	auto result = QImage(qr.size(), QImage::Format_ARGB32_Premultiplied);
-	result.fill(st::windowBg->c);
+	result.fill(bg);
 	{
 		auto p = QPainter(&result);
 		p.drawImage(QRect(QPoint(), qr.size()), qr);
@@ -81,14 +85,13 @@ namespace {
 		QImage previous;
 		QImage qr;
 		QImage center;
+		int generation = 0;
 		Ui::Animations::Simple shown;
 		Ui::InfiniteRadialAnimation waiting;
 	};
 	auto qrs = std::move(
 		codes
-	) | rpl::map([](const QByteArray &code) {
-		return Qr::Encode(code, Qr::Redundancy::Quartile);
-	});
+	) | rpl::distinct_until_changed();
 	auto palettes = rpl::single(
 		rpl::empty_value()
 	) | rpl::then(
@@ -102,18 +105,34 @@ namespace {
 	rpl::combine(
 		std::move(qrs),
 		rpl::duplicate(palettes)
-	) | rpl::map([](const Qr::Data &code, const auto &) {
-		return TelegramQr(code, st::introQrPixel, st::introQrMaxSize);
-	}) | rpl::start_with_next([=](QImage &&image) {
-		state->previous = std::move(state->qr);
-		state->qr = std::move(image);
-		state->waiting.stop();
-		state->shown.stop();
-		state->shown.start(
-			[=] { result->update(); },
-			0.,
-			1.,
-			st::fadeWrapDuration);
+	) | rpl::start_with_next([=](const QByteArray &code, const auto &) {
+		// Encode and render on a worker thread, so the previous code
+		// stays on screen while the rotated token is being prepared.
+		const auto weak = Ui::MakeWeak(result);
+		const auto generation = ++state->generation;
+		const auto pixel = st::introQrPixel;
+		const auto max = st::introQrMaxSize;
+		const auto fg = st::windowFg->c;
+		const auto bg = st::windowBg->c;
+		crl::async([=] {
+			const auto data = Qr::Encode(code, Qr::Redundancy::Quartile);
+			auto image = TelegramQr(data, pixel, max, fg, bg);
+			crl::on_main([=, image = std::move(image)]() mutable {
+				const auto strong = weak.data();
+				if (!strong || state->generation != generation) {
+					return;
+				}
+				state->previous = std::move(state->qr);
+				state->qr = std::move(image);
+				state->waiting.stop();
+				state->shown.stop();
+				state->shown.start(
+					[=] { result->update(); },
+					0.,
+					1.,
+					st::fadeWrapDuration);
+			});
+		});
 	}, result->lifetime());
 	std::move(
 		palettes
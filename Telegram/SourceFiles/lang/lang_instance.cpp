@@ -258,6 +258,7 @@ void Instance::switchToId(const Language &data) {
 			value = PrepareTestValue(value, _id[5]);
 		}
 		if (!_derived) {
+			_fullUpdates.fire({});
 			_updated.notify();
 		}
 	}
@@ -278,6 +279,7 @@ void Instance::setBaseId(const QString &baseId, const QString &pluralId) {
 void Instance::switchToCustomFile(const QString &filePath) {
 	if (loadFromCustomFile(filePath)) {
 		Local::writeLangPack();
+		_fullUpdates.fire({});
 		_updated.notify();
 	}
 }
@@ -659,18 +661,34 @@ void Instance::applyDifferenceToMe(
 	Expects(difference.vfrom_version().v <= _version);
 
 	_version = difference.vversion().v;
+	auto changed = std::vector<ushort>();
+	changed.reserve(difference.vstrings().v.size());
+	const auto collect = [&](const QByteArray &key) {
+		const auto index = GetKeyIndex(QLatin1String(key));
+		if (index != kKeysCount) {
+			changed.push_back(index);
+		}
+	};
 	for (const auto &string : difference.vstrings().v) {
 		HandleString(string, [&](auto &&key, auto &&value) {
 			applyValue(key, value);
+			collect(key);
 		}, [&](auto &&key) {
 			resetValue(key);
+			collect(key);
 		});
 	}
-	if (!_derived) {
-		_updated.notify();
+	const auto notified = _derived ? _derived : this;
+	if (!difference.vfrom_version().v) {
+		// A full pack arrives on language switch, almost every key
+		// changes, so per-key notifications would only add overhead.
+		notified->_fullUpdates.fire({});
 	} else {
-		_derived->_updated.notify();
+		for (const auto index : changed) {
+			notified->_keyUpdates.fire_copy(index);
+		}
 	}
+	notified->_updated.notify();
 }
 
 std::map<ushort, QString> Instance::ParseStrings(
@@ -755,8 +773,13 @@ QString Current(ushort key) {
 rpl::producer<QString> Viewer(ushort key) {
 	return rpl::single(
 		Lang::Current().getValue(key)
-	) | then(base::ObservableViewer(
-		Lang::Current().updated()
+	) | then(rpl::merge(
+		Lang::Current().keyUpdates() | rpl::filter([=](ushort updated) {
+			return (updated == key);
+		}) | rpl::map([](ushort) {
+			return rpl::empty_value();
+		}),
+		Lang::Current().fullUpdates()
 	) | rpl::map([=] {
 		return Lang::Current().getValue(key);
 	}));
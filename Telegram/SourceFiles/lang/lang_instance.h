@@ -83,6 +83,17 @@ public:
 		return _updated;
 	}
 
+	// Fired with the index of every key changed by a cloud difference,
+	// so viewers of unchanged keys are not re-invoked.
+	rpl::producer<ushort> keyUpdates() const {
+		return _keyUpdates.events();
+	}
+
+	// Fired when the whole table changed (language switch, custom file).
+	rpl::producer<> fullUpdates() const {
+		return _fullUpdates.events();
+	}
+
 	QString getValue(ushort key) const {
 		Expects(key < _values.size());
 
@@ -130,6 +141,8 @@ private:
 	QByteArray _customFileContent;
 	int _version = 0;
 	base::Observable<void> _updated;
+	rpl::event_stream<ushort> _keyUpdates;
+	rpl::event_stream<> _fullUpdates;
 
 	mutable QString _systemLanguage;
 
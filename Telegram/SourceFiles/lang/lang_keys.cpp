@@ -8,6 +8,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "lang/lang_keys.h"
 
 #include "lang/lang_file_parser.h"
+#include "lang/lang_instance.h"
+#include "base/flat_map.h"
 
 namespace {
 
@@ -113,6 +115,23 @@ tr::phrase<> Weekday(int index) {
 	Unexpected("Index in Weekday.");
 }
 
+// Day-of-month strings repeat for every dialog row and message group
+// of the same date, so the formatted results are kept until the
+// language pack changes instead of re-running tag replacement each time.
+struct FormattedDatesCache {
+	base::flat_map<int, QString> dayOfMonth;
+	base::flat_map<int, QString> dayOfMonthFull;
+};
+
+FormattedDatesCache &DatesCache() {
+	static FormattedDatesCache result;
+	static auto subscription = Lang::Current().updated().add_subscription([] {
+		result.dayOfMonth.clear();
+		result.dayOfMonthFull.clear();
+	});
+	return result;
+}
+
 } // namespace
 
 bool langFirstNameGoesSecond() {
@@ -139,12 +158,18 @@ QString langDayOfMonth(const QDate &date) {
 			lt_year,
 			QString::number(year));
 	}, [day](int month, int year) {
-		return tr::lng_month_day(
+		auto &cache = DatesCache().dayOfMonth;
+		const auto key = month * 100 + day;
+		const auto i = cache.find(key);
+		if (i != cache.end()) {
+			return i->second;
+		}
+		return cache.emplace(key, tr::lng_month_day(
 			tr::now,
 			lt_month,
 			MonthSmall(month)(tr::now),
 			lt_day,
-			QString::number(day));
+			QString::number(day))).first->second;
 	});
 }
 
@@ -160,12 +185,18 @@ QString langDayOfMonthFull(const QDate &date) {
 			lt_year,
 			QString::number(year));
 	}, [day](int month, int year) {
-		return tr::lng_month_day(
+		auto &cache = DatesCache().dayOfMonthFull;
+		const auto key = month * 100 + day;
+		const auto i = cache.find(key);
+		if (i != cache.end()) {
+			return i->second;
+		}
+		return cache.emplace(key, tr::lng_month_day(
 			tr::now,
 			lt_month,
 			MonthDay(month)(tr::now),
 			lt_day,
-			QString::number(day));
+			QString::number(day))).first->second;
 	});
 }
 
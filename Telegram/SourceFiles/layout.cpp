@@ -52,6 +52,10 @@ QString formatDownloadText(qint64 ready, qint64 total) {
 	return tr::lng_save_downloaded(tr::now, lt_ready, readyStr, lt_total, totalStr, lt_mb, mb);
 }
 
+QString formatSpeedText(qint64 bytesPerSecond) {
+	return formatSizeText(bytesPerSecond) + qsl("/s");
+}
+
 QString formatDurationText(qint64 duration) {
 	qint64 hours = (duration / 3600), minutes = (duration % 3600) / 60, seconds = duration % 60;
 	return (hours ? QString::number(hours) + ':' : QString()) + (minutes >= 10 ? QString() : QString('0')) + QString::number(minutes) + ':' + (seconds >= 10 ? QString() : QString('0')) + QString::number(seconds);
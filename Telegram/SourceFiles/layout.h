@@ -58,6 +58,7 @@ static const int32 FileStatusSizeFailed = 0x7FFFFFF2;
 
 QString formatSizeText(qint64 size);
 QString formatDownloadText(qint64 ready, qint64 total);
+QString formatSpeedText(qint64 bytesPerSecond);
 QString formatDurationText(qint64 duration);
 QString formatDurationWords(qint64 duration);
 QString formatDurationAndSizeText(qint64 duration, qint64 size);
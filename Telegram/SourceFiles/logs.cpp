@@ -11,6 +11,10 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "core/crash_reports.h"
 #include "core/launcher.h"
 
+#include <atomic>
+#include <chrono>
+#include <thread>
+
 namespace {
 
 std::atomic<int> ThreadCounter/* = 0*/;
@@ -237,6 +241,108 @@ NEW LOGGING INSTANCE STARTED!!!\n\
 
 LogsDataFields *LogsData = 0;
 
+// Single-producer (the owning thread) single-consumer (the drain
+// thread) wait-free ring buffer, so DEBUG_LOG in hot paths neither
+// takes locks nor touches the file system.
+class ThreadLogBuffer {
+public:
+	bool push(LogDataType type, const QString &msg) {
+		const auto head = _head.load(std::memory_order_relaxed);
+		const auto tail = _tail.load(std::memory_order_acquire);
+		if (head - tail >= kBufferSize) {
+			return false;
+		}
+		auto &entry = _entries[head & (kBufferSize - 1)];
+		entry.type = type;
+		entry.msg = msg;
+		_head.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+	template <typename Callback>
+	void drain(Callback &&callback) {
+		auto tail = _tail.load(std::memory_order_relaxed);
+		const auto head = _head.load(std::memory_order_acquire);
+		for (; tail != head; ++tail) {
+			auto &entry = _entries[tail & (kBufferSize - 1)];
+			callback(entry.type, base::take(entry.msg));
+			_tail.store(tail + 1, std::memory_order_release);
+		}
+	}
+
+private:
+	static constexpr auto kBufferSize = uint32(256); // power of two
+
+	struct Entry {
+		LogDataType type = LogDataMain;
+		QString msg;
+	};
+	Entry _entries[kBufferSize];
+	std::atomic<uint32> _head/* = 0*/;
+	std::atomic<uint32> _tail/* = 0*/;
+
+};
+
+constexpr auto kDrainEach = std::chrono::milliseconds(50);
+
+QMutex BuffersMutex; // Taken on a thread's first log and on drain.
+std::vector<std::unique_ptr<ThreadLogBuffer>> Buffers;
+thread_local ThreadLogBuffer *ThreadBuffer = nullptr;
+std::thread DrainThread;
+std::atomic<bool> DrainRunning/* = false*/;
+QMutex DrainMutex; // Serializes the drain thread and crash flushing.
+
+void DrainBuffers() {
+	QMutexLocker lock(&DrainMutex);
+
+	QString batches[LogDataCount];
+	{
+		QMutexLocker list(&BuffersMutex);
+		for (const auto &buffer : Buffers) {
+			buffer->drain([&](LogDataType type, QString &&msg) {
+				batches[type] += msg;
+			});
+		}
+	}
+	for (auto i = 0; i != int(LogDataCount); ++i) {
+		if (!batches[i].isEmpty() && LogsData) {
+			LogsData->write(LogDataType(i), batches[i]);
+		}
+	}
+}
+
+void StartDrainThread() {
+	DrainRunning = true;
+	DrainThread = std::thread([] {
+		while (DrainRunning.load(std::memory_order_relaxed)) {
+			std::this_thread::sleep_for(kDrainEach);
+			DrainBuffers();
+		}
+		DrainBuffers();
+	});
+}
+
+void StopDrainThread() {
+	if (DrainRunning.exchange(false)) {
+		DrainThread.join();
+	}
+}
+
+// Entries of a full buffer fall back to the direct locked write, so
+// they can overtake the buffered ones - each entry carries its own
+// timestamp, so the order can be restored when reading.
+bool PushBuffered(LogDataType type, const QString &msg) {
+	if (!ThreadBuffer) {
+		QMutexLocker lock(&BuffersMutex);
+		Buffers.push_back(std::make_unique<ThreadLogBuffer>());
+		ThreadBuffer = Buffers.back().get();
+		if (!DrainRunning.load(std::memory_order_relaxed)) {
+			StartDrainThread();
+		}
+	}
+	return ThreadBuffer->push(type, msg);
+}
+
 using LogsInMemoryList = QList<QPair<LogDataType, QString>>;
 LogsInMemoryList *LogsInMemory = 0;
 LogsInMemoryList *DeletedLogsInMemory = SharedMemoryLocation<LogsInMemoryList, 0>();
@@ -245,8 +351,14 @@ QString LogsBeforeSingleInstanceChecked; // LogsInMemory already dumped in LogsD
 
 void _logsWrite(LogDataType type, const QString &msg) {
 	if (LogsData && (type == LogDataMain || LogsStartIndexChosen < 0)) {
-		if (type == LogDataMain || Logs::DebugEnabled()) {
+		if (type == LogDataMain) {
+			// The main log is rare and read back for crash reports,
+			// so it stays synchronous.
 			LogsData->write(type, msg);
+		} else if (Logs::DebugEnabled()) {
+			if (!PushBuffered(type, msg)) {
+				LogsData->write(type, msg);
+			}
 		}
 	} else if (LogsInMemory != DeletedLogsInMemory) {
 		if (!LogsInMemory) {
@@ -458,6 +570,8 @@ void start(not_null<Core::Launcher*> launcher) {
 }
 
 void finish() {
+	StopDrainThread();
+
 	delete LogsData;
 	LogsData = 0;
 
@@ -527,6 +641,13 @@ void closeMain() {
 	}
 }
 
+void flushBufferedForCrash() {
+	// Best effort from the crash handler: pull whatever the threads
+	// managed to queue to the files, so the debug logs end at the
+	// moment of the crash and not at the last drain tick.
+	DrainBuffers();
+}
+
 void writeMain(const QString &v) {
 	time_t t = time(NULL);
 	struct tm tm;
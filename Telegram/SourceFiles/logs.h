@@ -30,6 +30,10 @@ void multipleInstances();
 
 void closeMain();
 
+// Pulls the buffered debug log entries to the files, called from the
+// crash handler so the logs end at the moment of the crash.
+void flushBufferedForCrash();
+
 void writeMain(const QString &v);
 
 void writeDebug(const char *file, int32 line, const QString &v);
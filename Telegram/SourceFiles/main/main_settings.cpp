@@ -123,6 +123,7 @@ QByteArray Settings::serialize() const {
 			stream << quint64(i);
 		}
 		stream << qint32(_variables.autoDownloadDictionaries.current() ? 1 : 0);
+		stream << qint32(_variables.autoplayGifs ? 1 : 0);
 	}
 	return result;
 }
@@ -177,6 +178,7 @@ void Settings::constructFromSerialized(const QByteArray &serialized) {
 	QByteArray videoPipGeometry = _variables.videoPipGeometry;
 	std::vector<int> dictionariesEnabled;
 	qint32 autoDownloadDictionaries = _variables.autoDownloadDictionaries.current() ? 1 : 0;
+	qint32 autoplayGifsEnabled = _variables.autoplayGifs ? 1 : 0;
 
 	stream >> versionTag;
 	if (versionTag == kVersionTag) {
@@ -317,6 +319,9 @@ void Settings::constructFromSerialized(const QByteArray &serialized) {
 	if (!stream.atEnd()) {
 		stream >> autoDownloadDictionaries;
 	}
+	if (!stream.atEnd()) {
+		stream >> autoplayGifsEnabled;
+	}
 	if (stream.status() != QDataStream::Ok) {
 		LOG(("App Error: "
 			"Bad data for Main::Settings::constructFromSerialized()"));
@@ -408,6 +413,7 @@ void Settings::constructFromSerialized(const QByteArray &serialized) {
 	_variables.videoPipGeometry = videoPipGeometry;
 	_variables.dictionariesEnabled = std::move(dictionariesEnabled);
 	_variables.autoDownloadDictionaries = (autoDownloadDictionaries == 1);
+	_variables.autoplayGifs = (autoplayGifsEnabled == 1);
 }
 
 void Settings::setSupportChatsTimeSlice(int slice) {
@@ -207,6 +207,12 @@ public:
 	void setLoopAnimatedStickers(bool value) {
 		_variables.loopAnimatedStickers = value;
 	}
+	[[nodiscard]] bool autoplayGifs() const {
+		return _variables.autoplayGifs;
+	}
+	void setAutoplayGifs(bool value) {
+		_variables.autoplayGifs = value;
+	}
 	void setLargeEmoji(bool value);
 	[[nodiscard]] bool largeEmoji() const;
 	[[nodiscard]] rpl::producer<bool> largeEmojiValue() const;
@@ -315,6 +321,7 @@ private:
 		rpl::variable<bool> notifyAboutPinned = true;
 		rpl::variable<bool> skipArchiveInSearch = false;
 		bool loopAnimatedStickers = true;
+		bool autoplayGifs = true;
 		rpl::variable<bool> largeEmoji = true;
 		rpl::variable<bool> replaceEmoji = true;
 		bool suggestEmoji = true;
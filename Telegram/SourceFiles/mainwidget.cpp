@@ -129,6 +129,21 @@ constexpr auto kSendViewsTimeout = crl::time(1000);
 // Cache background scaled image after 3s.
 constexpr auto kCacheBackgroundTimeout = 3000;
 
+// Apply a getDifference result at most this long without returning
+// to the event loop, so that the interface stays responsive.
+constexpr auto kDifferenceApplySliceDuration = crl::time(8);
+
+// Difference messages are indexed in batches of this size.
+constexpr auto kDifferenceApplyMessagesBatch = 16;
+
+// During an interactive window resize the full relayout cascade runs
+// at most once per this interval, roughly once per frame.
+constexpr auto kThrottledRelayoutInterval = crl::time(16);
+
+// Keep this many of the most recent stacked sections alive and hidden,
+// the deeper ones are converted to mementos as before.
+constexpr auto kMaxCachedStackSections = 3;
+
 enum class DataIsLoadedResult {
 	NotLoaded = 0,
 	FromNotLoaded = 1,
@@ -336,16 +351,29 @@ public:
 class StackItemSection : public StackItem {
 public:
 	StackItemSection(
-		std::unique_ptr<Window::SectionMemento> &&memento);
+		object_ptr<Window::SectionWidget> widget,
+		QSize mainWidgetSize);
 
 	StackItemType type() const override {
 		return SectionStackItem;
 	}
+	Window::SectionWidget *widget() const {
+		return _widget.data();
+	}
+	object_ptr<Window::SectionWidget> takeWidget() {
+		return std::move(_widget);
+	}
+	QSize mainWidgetSize() const {
+		return _mainWidgetSize;
+	}
+	bool demoteToMemento();
 	Window::SectionMemento *memento() const {
 		return _memento.get();
 	}
 
 private:
+	object_ptr<Window::SectionWidget> _widget;
+	QSize _mainWidgetSize;
 	std::unique_ptr<Window::SectionMemento> _memento;
 
 };
@@ -356,9 +384,23 @@ void StackItem::setThirdSectionMemento(
 }
 
 StackItemSection::StackItemSection(
-	std::unique_ptr<Window::SectionMemento> &&memento)
+	object_ptr<Window::SectionWidget> widget,
+	QSize mainWidgetSize)
 : StackItem(nullptr)
-, _memento(std::move(memento)) {
+, _widget(std::move(widget))
+, _mainWidgetSize(mainWidgetSize) {
+}
+
+bool StackItemSection::demoteToMemento() {
+	if (!_widget) {
+		return (_memento != nullptr);
+	}
+	if (auto memento = _widget->createMemento()) {
+		_memento = std::move(memento);
+		_widget.destroy();
+		return true;
+	}
+	return false;
 }
 
 struct MainWidget::SettingBackground {
@@ -374,6 +416,19 @@ MainWidget::SettingBackground::SettingBackground(
 : data(data) {
 }
 
+struct MainWidget::DifferenceApplying {
+	QVector<MTPUser> users;
+	QVector<MTPChat> chats;
+	QVector<MTPMessage> messages;
+	QVector<MTPUpdate> otherUpdates;
+	Fn<void()> finish;
+	int usersApplied = 0;
+	int chatsApplied = 0;
+	int messagesApplied = 0;
+	int updatesApplied = 0;
+	bool messageIdsApplied = false;
+};
+
 MainWidget::MainWidget(
 	QWidget *parent,
 	not_null<Window::SessionController*> controller)
@@ -392,8 +447,13 @@ MainWidget::MainWidget(
 , _onlineTimer([=] { updateOnline(); })
 , _idleFinishTimer([=] { checkIdleFinish(); })
 , _failDifferenceTimer([=] { getDifferenceAfterFail(); })
+, _differenceApplyTimer([=] { applyDifferenceSlice(); })
 , _cacheBackgroundTimer([=] { cacheBackground(); })
-, _viewsIncrementTimer([=] { viewsIncrement(); }) {
+, _viewsIncrementTimer([=] { viewsIncrement(); })
+, _relayoutTimer([=] {
+	_lastRelayoutTime = crl::now();
+	updateControlsGeometry();
+}) {
 	_controller->setDefaultFloatPlayerDelegate(floatPlayerDelegate());
 	_controller->floatPlayerClosed(
 	) | rpl::start_with_next([=](FullMsgId itemId) {
@@ -1648,7 +1708,7 @@ void MainWidget::ui_showPeerHistory(
 	auto animationParams = animatedShow() ? prepareHistoryAnimation(peerId) : Window::SectionSlideParams();
 
 	if (!back && (way != Way::ClearStack)) {
-		// This may modify the current section, for example remove its contents.
+		// This may take the current section widget into the stack.
 		saveSectionInStack();
 	}
 
@@ -1729,11 +1789,16 @@ PeerData *MainWidget::peer() {
 
 void MainWidget::saveSectionInStack() {
 	if (_mainSection) {
-		if (auto memento = _mainSection->createMemento()) {
-			_stack.push_back(std::make_unique<StackItemSection>(
-				std::move(memento)));
-			_stack.back()->setThirdSectionWeak(_thirdSection.data());
-		}
+		// The widget goes to the stack alive and hidden instead of being
+		// serialized to a memento right away, so that going back shows it
+		// again in one frame, with the scroll position and the loaded
+		// slices intact.
+		_mainSection->hide();
+		_stack.push_back(std::make_unique<StackItemSection>(
+			std::move(_mainSection),
+			size()));
+		_stack.back()->setThirdSectionWeak(_thirdSection.data());
+		trimCachedSections();
 	} else if (const auto history = _history->history()) {
 		_stack.push_back(std::make_unique<StackItemHistory>(
 			history,
@@ -1743,6 +1808,25 @@ void MainWidget::saveSectionInStack() {
 	}
 }
 
+void MainWidget::trimCachedSections() {
+	auto alive = 0;
+	for (auto i = int(_stack.size()); i != 0;) {
+		const auto item = _stack[--i].get();
+		if (item->type() != SectionStackItem) {
+			continue;
+		}
+		const auto section = static_cast<StackItemSection*>(item);
+		if (!section->widget() || (++alive <= kMaxCachedStackSections)) {
+			continue;
+		}
+		if (!section->demoteToMemento()) {
+			// The section could not provide a memento, so before the
+			// widgets were cached it would not have been saved at all.
+			_stack.erase(_stack.begin() + i);
+		}
+	}
+}
+
 void MainWidget::showSection(
 		Window::SectionMemento &&memento,
 		const SectionShow &params) {
@@ -1943,7 +2027,7 @@ void MainWidget::showNewSection(
 	setFocus(); // otherwise dialogs widget could be focused.
 
 	if (saveInStack) {
-		// This may modify the current section, for example remove its contents.
+		// This may take the current section widget into the stack.
 		saveSectionInStack();
 	}
 	auto &settingSection = newThirdSection
@@ -1989,6 +2073,58 @@ void MainWidget::showNewSection(
 	orderWidgets();
 }
 
+void MainWidget::showCachedSection(
+		object_ptr<Window::SectionWidget> section,
+		const SectionShow &params) {
+	Expects(section != nullptr);
+
+	if (params.activation != anim::activation::background) {
+		Ui::hideSettingsAndLayer();
+	}
+
+	_controller->dialogsListFocused().set(false, true);
+	_a_dialogsWidth.stop();
+
+	auto animatedShow = [&] {
+		if (_a_show.animating()
+			|| Core::App().locked()
+			|| (params.animated == anim::type::instant)) {
+			return false;
+		}
+		return Adaptive::OneColumn() || isMainSectionShown();
+	}();
+	auto animationParams = animatedShow
+		? prepareMainSectionAnimation(section.data())
+		: Window::SectionSlideParams();
+
+	setFocus(); // otherwise dialogs widget could be focused.
+
+	_mainSection = std::move(section);
+	updateControlsGeometry();
+	_history->finishAnimating();
+	_history->showHistory(0, 0);
+	_history->hide();
+	if (Adaptive::OneColumn()) _dialogs->hide();
+
+	if (animationParams) {
+		if (Adaptive::OneColumn()) {
+			_controller->removeLayerBlackout();
+		}
+		_mainSection->showAnimated(
+			Window::SlideDirection::FromLeft,
+			animationParams);
+	} else {
+		_mainSection->showFast();
+	}
+
+	if (const auto entry = _mainSection->activeChat(); entry.key) {
+		_controller->setActiveChatEntry(entry);
+	}
+
+	floatPlayerCheckVisibility();
+	orderWidgets();
+}
+
 void MainWidget::checkMainSectionToLayer() {
 	if (!_mainSection) {
 		return;
@@ -2052,9 +2188,22 @@ void MainWidget::showBackFromStack(
 		_history->setReplyReturns(historyItem->peer()->id, historyItem->replyReturns);
 	} else if (item->type() == SectionStackItem) {
 		auto sectionItem = static_cast<StackItemSection*>(item.get());
-		showNewSection(
-			std::move(*sectionItem->memento()),
-			params.withWay(SectionShow::Way::Backward));
+		if (sectionItem->widget()
+			&& (size() != sectionItem->mainWidgetSize())) {
+			// The window was resized while the section was cached, so
+			// the layer-vs-section choice should be made from scratch,
+			// which only the memento path does.
+			sectionItem->demoteToMemento();
+		}
+		if (auto widget = sectionItem->takeWidget()) {
+			showCachedSection(
+				std::move(widget),
+				params.withWay(SectionShow::Way::Backward));
+		} else if (const auto memento = sectionItem->memento()) {
+			showNewSection(
+				std::move(*memento),
+				params.withWay(SectionShow::Way::Backward));
+		}
 	}
 	if (_thirdSectionFromStack && _thirdSection) {
 		_controller->showSection(
@@ -2340,7 +2489,21 @@ void MainWidget::showAll() {
 }
 
 void MainWidget::resizeEvent(QResizeEvent *e) {
-	updateControlsGeometry();
+	// Drag-resizing delivers an event for every mouse move and each one
+	// used to relayout all the sections synchronously. The cascade is
+	// throttled to once per frame: in between the sections keep their
+	// last computed geometry and just repaint anchored to the top left,
+	// and the trailing timer always runs a final relayout at the size
+	// the drag was released on.
+	const auto now = crl::now();
+	const auto passed = now - _lastRelayoutTime;
+	if (passed >= kThrottledRelayoutInterval) {
+		_relayoutTimer.cancel();
+		_lastRelayoutTime = now;
+		updateControlsGeometry();
+	} else if (!_relayoutTimer.isActive()) {
+		_relayoutTimer.callOnce(kThrottledRelayoutInterval - passed);
+	}
 }
 
 void MainWidget::updateControlsGeometry() {
@@ -2957,21 +3120,25 @@ void MainWidget::gotDifference(const MTPupdates_Difference &difference) {
 	} break;
 	case mtpc_updates_differenceSlice: {
 		auto &d = difference.c_updates_differenceSlice();
-		feedDifference(d.vusers(), d.vchats(), d.vnew_messages(), d.vother_updates());
+		const auto &s = d.vintermediate_state().c_updates_state();
+		const auto pts = s.vpts().v;
+		const auto date = s.vdate().v;
+		const auto qts = s.vqts().v;
+		const auto seq = s.vseq().v;
+		feedDifference(d.vusers(), d.vchats(), d.vnew_messages(), d.vother_updates(), [=] {
+			updSetState(pts, date, qts, seq);
 
-		auto &s = d.vintermediate_state().c_updates_state();
-		updSetState(s.vpts().v, s.vdate().v, s.vqts().v, s.vseq().v);
-
-		_ptsWaiter.setRequesting(false);
+			_ptsWaiter.setRequesting(false);
 
-		MTP_LOG(0, ("getDifference { good - after a slice of difference was received }%1").arg(cTestMode() ? " TESTMODE" : ""));
-		getDifference();
+			MTP_LOG(0, ("getDifference { good - after a slice of difference was received }%1").arg(cTestMode() ? " TESTMODE" : ""));
+			getDifference();
+		});
 	} break;
 	case mtpc_updates_difference: {
 		auto &d = difference.c_updates_difference();
-		feedDifference(d.vusers(), d.vchats(), d.vnew_messages(), d.vother_updates());
-
-		gotState(d.vstate());
+		feedDifference(d.vusers(), d.vchats(), d.vnew_messages(), d.vother_updates(), [=, state = d.vstate()] {
+			gotState(state);
+		});
 	} break;
 	case mtpc_updates_differenceTooLong: {
 		auto &d = difference.c_updates_differenceTooLong();
@@ -3059,13 +3226,86 @@ void MainWidget::feedDifference(
 		const MTPVector<MTPUser> &users,
 		const MTPVector<MTPChat> &chats,
 		const MTPVector<MTPMessage> &msgs,
-		const MTPVector<MTPUpdate> &other) {
+		const MTPVector<MTPUpdate> &other,
+		Fn<void()> &&finish) {
+	auto applying = std::make_unique<DifferenceApplying>();
+	applying->users = users.v;
+	applying->chats = chats.v;
+	applying->messages = msgs.v;
+	applying->otherUpdates = other.v;
+	applying->finish = std::move(finish);
+	_differenceApplying = std::move(applying);
+	applyDifferenceSlice();
+}
+
+void MainWidget::applyDifferenceSlice() {
+	Expects(_differenceApplying != nullptr);
+
 	session().checkAutoLock();
-	session().data().processUsers(users);
-	session().data().processChats(chats);
-	feedMessageIds(other);
-	session().data().processMessages(msgs, NewMessageType::Unread);
-	feedUpdateVector(other, true);
+
+	auto &state = *_differenceApplying;
+	auto &owner = session().data();
+	const auto deadline = crl::now() + kDifferenceApplySliceDuration;
+	const auto overdue = [&] {
+		return (crl::now() >= deadline);
+	};
+	while (state.usersApplied != state.users.size()) {
+		owner.processUser(state.users[state.usersApplied++]);
+		if (overdue()) {
+			return scheduleNextDifferenceSlice();
+		}
+	}
+	while (state.chatsApplied != state.chats.size()) {
+		owner.processChat(state.chats[state.chatsApplied++]);
+		if (overdue()) {
+			return scheduleNextDifferenceSlice();
+		}
+	}
+	if (!state.messageIdsApplied) {
+		// Map the random ids of messages we sent ourselves before the
+		// messages from the difference can be indexed over them.
+		for (const auto &update : state.otherUpdates) {
+			if (update.type() == mtpc_updateMessageID) {
+				feedUpdate(update);
+			}
+		}
+		state.messageIdsApplied = true;
+		if (overdue()) {
+			return scheduleNextDifferenceSlice();
+		}
+	}
+	while (state.messagesApplied != state.messages.size()) {
+		const auto count = std::min(
+			kDifferenceApplyMessagesBatch,
+			state.messages.size() - state.messagesApplied);
+		owner.processMessages(
+			state.messages.mid(state.messagesApplied, count),
+			NewMessageType::Unread);
+		state.messagesApplied += count;
+		if (overdue()) {
+			return scheduleNextDifferenceSlice();
+		}
+	}
+	while (state.updatesApplied != state.otherUpdates.size()) {
+		const auto &update = state.otherUpdates[state.updatesApplied++];
+		if (update.type() != mtpc_updateMessageID) {
+			feedUpdate(update);
+		}
+		if (overdue()) {
+			return scheduleNextDifferenceSlice();
+		}
+	}
+	owner.sendHistoryChangeNotifications();
+
+	const auto finish = base::take(_differenceApplying)->finish;
+	finish();
+}
+
+void MainWidget::scheduleNextDifferenceSlice() {
+	// Flushing the notifications per slice lets the chats list fill
+	// in visibly while a long catch-up is still being applied.
+	session().data().sendHistoryChangeNotifications();
+	_differenceApplyTimer.callOnce(1);
 }
 
 bool MainWidget::failDifference(const RPCError &error) {
@@ -3208,6 +3448,10 @@ void MainWidget::start() {
 	Local::readRecentStickers();
 	Local::readFavedStickers();
 	Local::readSavedGifs();
+	Local::readSharedMediaCounts();
+	Local::readDialogsSnapshot();
+	Local::readSearchIndex();
+	session().api().replaySendOutbox();
 	if (const auto availableAt = Local::ReadExportSettings().availableAt) {
 		session().data().suggestStartExport(availableAt);
 	}
@@ -3757,7 +4001,7 @@ void MainWidget::feedUpdates(const MTPUpdates &updates, uint64 randomId) {
 			|| (fwd && !ForwardedInfoDataLoaded(&session(), *fwd))) {
 			MTP_LOG(0, ("getDifference { good - getting user for updateShortChatMessage }%1").arg(cTestMode() ? " TESTMODE" : ""));
 			if (chat && noFrom) {
-				session().api().requestFullPeer(chat);
+				session().api().invalidateFullPeer(chat);
 			}
 			return getDifference();
 		}
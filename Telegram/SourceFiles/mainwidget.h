@@ -370,6 +370,9 @@ private:
 	void showNewSection(
 		Window::SectionMemento &&memento,
 		const SectionShow &params);
+	void showCachedSection(
+		object_ptr<Window::SectionWidget> section,
+		const SectionShow &params);
 	void dropMainSection(Window::SectionWidget *widget);
 
 	Window::SectionSlideParams prepareThirdSectionAnimation(Window::SectionWidget *section);
@@ -380,11 +383,14 @@ private:
 	Window::SectionSlideParams prepareDialogsAnimation();
 
 	void saveSectionInStack();
+	void trimCachedSections();
 
 	void getChannelDifference(ChannelData *channel, ChannelDifferenceRequest from = ChannelDifferenceRequest::Unknown);
 	void gotDifference(const MTPupdates_Difference &diff);
 	bool failDifference(const RPCError &e);
-	void feedDifference(const MTPVector<MTPUser> &users, const MTPVector<MTPChat> &chats, const MTPVector<MTPMessage> &msgs, const MTPVector<MTPUpdate> &other);
+	void feedDifference(const MTPVector<MTPUser> &users, const MTPVector<MTPChat> &chats, const MTPVector<MTPMessage> &msgs, const MTPVector<MTPUpdate> &other, Fn<void()> &&finish);
+	void applyDifferenceSlice();
+	void scheduleNextDifferenceSlice();
 	void gotState(const MTPupdates_State &state);
 	void updSetState(int32 pts, int32 date, int32 qts, int32 seq);
 	void gotChannelDifference(ChannelData *channel, const MTPupdates_ChannelDifference &diff);
@@ -525,6 +531,12 @@ private:
 	QMap<ChannelData*, int32> _channelFailDifferenceTimeout; // growing timeout for getChannelDifference calls, if it fails
 	base::Timer _failDifferenceTimer;
 
+	// A getDifference result is applied in bounded time slices, so that
+	// a long catch-up after hours offline keeps the interface responsive.
+	struct DifferenceApplying;
+	std::unique_ptr<DifferenceApplying> _differenceApplying;
+	base::Timer _differenceApplyTimer;
+
 	crl::time _lastUpdateTime = 0;
 	bool _handlingChannelDifference = false;
 
@@ -548,6 +560,10 @@ private:
 	bool _firstColumnResizing = false;
 	int _firstColumnResizingShift = 0;
 
+	// Throttles the relayout cascade during interactive window resize.
+	crl::time _lastRelayoutTime = 0;
+	base::Timer _relayoutTimer;
+
 };
 
 namespace App {
@@ -25,6 +25,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "core/shortcuts.h"
 #include "core/sandbox.h"
 #include "core/application.h"
+#include "core/startup_profiler.h"
 #include "main/main_session.h"
 #include "intro/intro_widget.h"
 #include "main/main_account.h" // Account::sessionValue.
@@ -108,6 +109,12 @@ MainWindow::MainWindow(not_null<Window::Controller*> controller)
 		updateGlobalMenu();
 	}, lifetime());
 
+	// The startup trace ends when the window paints for the first time.
+	paintRequest(
+	) | rpl::take(1) | rpl::start_with_next([] {
+		Core::StartupProfiler::Finish();
+	}, lifetime());
+
 	Ui::Emoji::Updated(
 	) | rpl::start_with_next([=] {
 		Ui::ForceFullRepaint(this);
@@ -29,6 +29,13 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 #include <numeric>
 
+#ifdef Q_PROCESSOR_X86
+#include <emmintrin.h>
+#endif // Q_PROCESSOR_X86
+#if defined Q_PROCESSOR_ARM && defined __ARM_NEON
+#include <arm_neon.h>
+#endif // Q_PROCESSOR_ARM && __ARM_NEON
+
 Q_DECLARE_METATYPE(AudioMsgId);
 Q_DECLARE_METATYPE(VoiceWaveform);
 
@@ -1646,6 +1653,45 @@ FileMediaInformation::Song PrepareForSending(const QString &fname, const QByteAr
 
 } // namespace Player
 
+namespace Audio {
+
+uint16 FindPeak16(const int16 *data, int64 count) {
+	auto result = uint16(0);
+#ifdef Q_PROCESSOR_X86
+	const auto zero = _mm_setzero_si128();
+	auto peaks = zero;
+	for (; count >= 8; data += 8, count -= 8) {
+		const auto samples = _mm_loadu_si128(
+			reinterpret_cast<const __m128i*>(data));
+		// Negate with saturation, so that -0x8000 maps to 0x7FFF and
+		// both the sample and its negation fit a signed 16 bit lane.
+		const auto negated = _mm_subs_epi16(zero, samples);
+		peaks = _mm_max_epi16(peaks, _mm_max_epi16(samples, negated));
+	}
+	alignas(16) int16 lanes[8];
+	_mm_store_si128(reinterpret_cast<__m128i*>(lanes), peaks);
+	for (const auto lane : lanes) {
+		accumulate_max(result, uint16(lane));
+	}
+#elif defined Q_PROCESSOR_ARM && defined __ARM_NEON // Q_PROCESSOR_X86
+	auto peaks = vdupq_n_s16(0);
+	for (; count >= 8; data += 8, count -= 8) {
+		peaks = vmaxq_s16(peaks, vqabsq_s16(vld1q_s16(data)));
+	}
+	int16 lanes[8];
+	vst1q_s16(lanes, peaks);
+	for (const auto lane : lanes) {
+		accumulate_max(result, uint16(lane));
+	}
+#endif // Q_PROCESSOR_ARM && __ARM_NEON
+	for (; count > 0; ++data, --count) {
+		accumulate_max(result, ReadOneSample(*data));
+	}
+	return result;
+}
+
+} // namespace Audio
+
 class FFMpegWaveformCounter : public FFMpegLoader {
 public:
 	FFMpegWaveformCounter(const FileLocation &file, const QByteArray &data) : FFMpegLoader(file, data, bytes::vector()) {
@@ -1679,6 +1725,30 @@ public:
 				peak = 0;
 			}
 		};
+
+		// Same as iterating the callback above sample-by-sample, but
+		// takes the peak over each whole run that falls into a single
+		// waveform entry at once, with a vectorized maximum.
+		auto callback16 = [&](bytes::const_span bytes) {
+			auto samples = reinterpret_cast<const int16*>(bytes.data());
+			auto count = int64(bytes.size() / sizeof(int16));
+			while (count > 0) {
+				const auto left = (countbytes
+					- sumbytes
+					+ Media::Player::kWaveformSamplesCount
+					- 1) / Media::Player::kWaveformSamplesCount;
+				const auto take = std::min(count, left);
+				accumulate_max(peak, Audio::FindPeak16(samples, take));
+				sumbytes += take * int64(Media::Player::kWaveformSamplesCount);
+				samples += take;
+				count -= take;
+				if (sumbytes >= countbytes) {
+					sumbytes -= countbytes;
+					peaks.push_back(peak);
+					peak = 0;
+				}
+			}
+		};
 		while (processed < countbytes) {
 			buffer.resize(0);
 
@@ -1695,7 +1765,7 @@ public:
 			if (fmt == AL_FORMAT_MONO8 || fmt == AL_FORMAT_STEREO8) {
 				Media::Audio::IterateSamples<uchar>(sampleBytes, callback);
 			} else if (fmt == AL_FORMAT_MONO16 || fmt == AL_FORMAT_STEREO16) {
-				Media::Audio::IterateSamples<int16>(sampleBytes, callback);
+				callback16(sampleBytes);
 			}
 			processed += sampleSize() * samples;
 		}
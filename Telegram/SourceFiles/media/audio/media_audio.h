@@ -393,5 +393,8 @@ void IterateSamples(bytes::const_span bytes, Callback &&callback) {
 	}
 }
 
+// Peak over a contiguous run of 16-bit samples, vectorized when possible.
+[[nodiscard]] uint16 FindPeak16(const int16 *data, int64 count);
+
 } // namespace Audio
 } // namespace Media
@@ -128,7 +128,17 @@ struct Instance::Inner::Private {
 		auto l = reinterpret_cast<Private*>(opaque);
 
 		if (buf_size <= 0) return 0;
-		if (l->dataPos + buf_size > l->data.size()) l->data.resize(l->dataPos + buf_size);
+		if (l->dataPos + buf_size > l->data.size()) {
+			// Grow in slices, the muxer appends in many small writes and
+			// exact-size reallocations get quadratic on long recordings.
+			const auto size = l->dataPos + buf_size;
+			if (size > l->data.capacity()) {
+				l->data.reserve(
+					((size / kCaptureBufferSlice) + 1)
+						* kCaptureBufferSlice);
+			}
+			l->data.resize(size);
+		}
 		memcpy(l->data.data() + l->dataPos, buf, buf_size);
 		l->dataPos += buf_size;
 		return buf_size;
@@ -499,7 +509,12 @@ void Instance::Inner::onTimeout() {
 		auto skipSamples = kCaptureSkipDuration * kCaptureFrequency / 1000;
 		auto fadeSamples = kCaptureFadeInDuration * kCaptureFrequency / 1000;
 		auto levelindex = d->fullSamples + static_cast<int>(s / sizeof(short));
-		for (auto ptr = (const short*)(_captured.constData() + s), end = (const short*)(_captured.constData() + news); ptr < end; ++ptr, ++levelindex) {
+		auto ptr = (const short*)(_captured.constData() + s);
+		auto end = (const short*)(_captured.constData() + news);
+		if (levelindex >= skipSamples + fadeSamples) {
+			// Past the fade-in the level is just the peak of the chunk.
+			accumulate_max(d->levelMax, Audio::FindPeak16(ptr, end - ptr));
+		} else for (; ptr < end; ++ptr, ++levelindex) {
 			if (levelindex > skipSamples) {
 				uint16 value = qAbs(*ptr);
 				if (levelindex < skipSamples + fadeSamples) {
@@ -567,12 +582,16 @@ void Instance::Inner::processFrame(int32 offset, int32 framesize) {
 	}
 
 	d->waveform.reserve(d->waveform.size() + (samplesCnt / d->waveformEach) + 1);
-	for (short *ptr = srcSamplesDataChannel, *end = ptr + samplesCnt; ptr != end; ++ptr) {
-		uint16 value = qAbs(*ptr);
-		if (d->waveformPeak < value) {
-			d->waveformPeak = value;
-		}
-		if (++d->waveformMod == d->waveformEach) {
+	auto waveformSamples = srcSamplesDataChannel;
+	for (auto left = int64(samplesCnt); left > 0;) {
+		const auto take = std::min(left, d->waveformEach - d->waveformMod);
+		accumulate_max(
+			d->waveformPeak,
+			Audio::FindPeak16(waveformSamples, take));
+		d->waveformMod += take;
+		waveformSamples += take;
+		left -= take;
+		if (d->waveformMod == d->waveformEach) {
 			d->waveformMod -= d->waveformEach;
 			d->waveform.push_back(uchar(d->waveformPeak / 256));
 			d->waveformPeak = 0;
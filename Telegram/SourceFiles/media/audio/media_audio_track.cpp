@@ -75,6 +75,31 @@ void Track::fillFromData(bytes::vector &&data) {
 			peakValue = 0;
 		}
 	};
+
+	// Same as iterating peakCallback sample-by-sample, but takes the peak
+	// over each whole run inside one peak interval with a vectorized maximum.
+	auto peakCallback16 = [&](bytes::const_span sampleBytes) {
+		auto samples = reinterpret_cast<const int16*>(sampleBytes.data());
+		auto count = int64(sampleBytes.size() / sizeof(int16));
+		while (count > 0) {
+			const auto take = std::min(
+				count,
+				int64(peakEachSample - peakSamples));
+			accumulate_max(
+				peakValue,
+				Media::Audio::FindPeak16(samples, take));
+			peakSamples += take;
+			samples += take;
+			count -= take;
+			if (peakSamples >= peakEachSample) {
+				peakSamples -= peakEachSample;
+				_peaks.push_back(peakValue);
+				accumulate_max(_peakValueMax, peakValue);
+				accumulate_min(_peakValueMin, peakValue);
+				peakValue = 0;
+			}
+		}
+	};
 	do {
 		auto buffer = QByteArray();
 		auto samplesAdded = int64(0);
@@ -87,7 +112,7 @@ void Track::fillFromData(bytes::vector &&data) {
 				if (format == AL_FORMAT_MONO8 || format == AL_FORMAT_STEREO8) {
 					Media::Audio::IterateSamples<uchar>(sampleBytes, peakCallback);
 				} else if (format == AL_FORMAT_MONO16 || format == AL_FORMAT_STEREO16) {
-					Media::Audio::IterateSamples<int16>(sampleBytes, peakCallback);
+					peakCallback16(sampleBytes);
 				}
 			}
 		}
@@ -151,8 +176,15 @@ void Track::playWithLooping(bool looping) {
 	ensureSourceCreated();
 	alSourceStop(_alSource);
 	_looping = looping;
-	alSourcei(_alSource, AL_LOOPING, _looping ? 1 : 0);
-	alSourcef(_alSource, AL_GAIN, _volume);
+	const auto loopingState = _looping ? 1 : 0;
+	if (_alLooping != loopingState) {
+		_alLooping = loopingState;
+		alSourcei(_alSource, AL_LOOPING, loopingState);
+	}
+	if (_alGain != _volume) {
+		_alGain = _volume;
+		alSourcef(_alSource, AL_GAIN, _volume);
+	}
 	alSourcePlay(_alSource);
 	_instance->trackStarted(this);
 }
@@ -180,6 +212,8 @@ void Track::ensureSourceCreated() {
 
 	_alSource = CreateSource();
 	_alBuffer = CreateBuffer();
+	_alLooping = 0;
+	_alGain = 1.;
 
 	alBufferData(_alBuffer, _alFormat, _samples.data(), _samples.size(), _sampleRate);
 	alSourcei(_alSource, AL_BUFFER, _alBuffer);
@@ -228,12 +262,22 @@ void Track::detachFromDevice() {
 }
 
 void Track::reattachToDevice() {
-	if (!isActive() || alIsSource(_alSource)) {
+	if (alIsSource(_alSource) || failed()) {
+		return;
+	} else if (!isActive() && _samples.empty()) {
 		return;
 	}
+
+	// Stage the sources and buffers of all the filled tracks while the
+	// device is being created anyway, so that playing one of them later
+	// is a single play call instead of a buffer upload under the mutex.
 	ensureSourceCreated();
+	if (!isActive()) {
+		return;
+	}
 
-	alSourcei(_alSource, AL_LOOPING, _looping ? 1 : 0);
+	_alLooping = _looping ? 1 : 0;
+	alSourcei(_alSource, AL_LOOPING, _alLooping);
 	alSourcei(_alSource, AL_SAMPLE_OFFSET, static_cast<ALint>(_alPosition));
 	alSourcePlay(_alSource);
 }
@@ -82,6 +82,8 @@ private:
 	int64 _alPosition = 0;
 	uint32 _alSource = 0;
 	uint32 _alBuffer = 0;
+	int _alLooping = 0;
+	float64 _alGain = 1.;
 
 };
 
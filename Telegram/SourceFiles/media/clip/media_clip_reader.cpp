@@ -33,6 +33,17 @@ namespace {
 QVector<QThread*> threads;
 QVector<Manager*> managers;
 
+[[nodiscard]] int ThreadsLimit() {
+	// All the clips share a fixed pool of up to ClipThreadsCount worker
+	// threads, but spawning more workers than the hardware runs in
+	// parallel only adds context switching on top of the decoding work.
+	static const auto result = std::clamp(
+		QThread::idealThreadCount() - 2,
+		2,
+		int(ClipThreadsCount));
+	return result;
+}
+
 QImage PrepareFrameImage(const FrameRequest &request, const QImage &original, bool hasAlpha, QImage &cache) {
 	auto needResize = (original.width() != request.framew) || (original.height() != request.frameh);
 	auto needOuterFill = (request.outerw != request.framew) || (request.outerh != request.frameh);
@@ -116,7 +127,7 @@ Reader::Reader(const QByteArray &data, Callback &&callback, Mode mode, crl::time
 }
 
 void Reader::init(const FileLocation &location, const QByteArray &data) {
-	if (threads.size() < ClipThreadsCount) {
+	if (threads.size() < ThreadsLimit()) {
 		_threadIndex = threads.size();
 		threads.push_back(new QThread());
 		managers.push_back(new Manager(threads.back()));
@@ -30,6 +30,12 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 namespace Media {
 namespace Player {
+namespace {
+
+// Repaint the progress arc only when it moved at least half a degree.
+constexpr auto kProgressRepaintStep = 1. / 360;
+
+} // namespace
 
 Float::Float(
 	QWidget *parent,
@@ -54,6 +60,7 @@ Float::Float(
 	resize(size, size);
 
 	prepareShadow();
+	prepareMask();
 
 	_controller->session().data().itemRepaintRequest(
 	) | rpl::start_with_next([this](auto item) {
@@ -165,6 +172,22 @@ void Float::prepareShadow() {
 	_shadow = App::pixmapFromImageInPlace(Images::prepareBlur(std::move(shadow)));
 }
 
+void Float::prepareMask() {
+	auto mask = QImage(
+		getInnerRect().size() * cIntRetinaFactor(),
+		QImage::Format_ARGB32_Premultiplied);
+	mask.fill(Qt::transparent);
+	mask.setDevicePixelRatio(cRetinaFactor());
+	{
+		Painter p(&mask);
+		PainterHighQualityEnabler hq(p);
+		p.setPen(Qt::NoPen);
+		p.setBrush(Qt::white);
+		p.drawEllipse(QRect(QPoint(), getInnerRect().size()));
+	}
+	_mask = std::move(mask);
+}
+
 QRect Float::getInnerRect() const {
 	auto margin = st::mediaPlayerFloatMargin;
 	return rect().marginsRemoved(QMargins(margin, margin, margin, margin));
@@ -185,6 +208,8 @@ void Float::paintEvent(QPaintEvent *e) {
 
 	const auto playback = getPlayback();
 	const auto progress = playback ? playback->value() : 1.;
+	_frameChanged = false;
+	_paintedProgress = progress;
 	if (progress > 0.) {
 		auto pen = st::historyVideoMessageProgressFg->p;
 		auto was = p.pen();
@@ -232,18 +257,27 @@ bool Float::fillFrame() {
 	if (const auto streamed = getStreamed()) {
 		auto request = Streaming::FrameRequest::NonStrict();
 		request.outer = request.resize = _frame.size();
-		request.radius = ImageRoundRadius::Ellipse;
 		auto frame = streamed->frame(request);
 		if (!frame.isNull()) {
-			_frame.fill(Qt::transparent);
-
-			Painter p(&_frame);
-			PainterHighQualityEnabler hq(p);
-			p.drawImage(frameInner(), frame);
+			if (frame.cacheKey() != _frameKey) {
+				_frameKey = frame.cacheKey();
+				_frameChanged = true;
+				_frame.fill(Qt::transparent);
+
+				Painter p(&_frame);
+				p.drawImage(frameInner(), frame);
+
+				// Rounding through the cached mask is cheaper than
+				// an antialiased ellipse clip on every new frame.
+				p.setCompositionMode(
+					QPainter::CompositionMode_DestinationIn);
+				p.drawImage(0, 0, _mask);
+			}
 			return true;
 		}
 	}
 	if (creating) {
+		_frameChanged = true;
 		_frame.fill(Qt::transparent);
 
 		Painter p(&_frame);
@@ -256,7 +290,17 @@ bool Float::fillFrame() {
 }
 
 void Float::repaintItem() {
-	update();
+	// Item repaint requests fire for unrelated history widget
+	// invalidations too, so composite the frame here and repaint the
+	// float only when its own content actually changed.
+	fillFrame();
+	const auto playback = getPlayback();
+	const auto progress = playback ? playback->value() : 1.;
+	if (_frameChanged
+		|| (std::abs(progress - _paintedProgress)
+			>= kProgressRepaintStep)) {
+		update();
+	}
 	if (hasFrame() && _toggleCallback) {
 		_toggleCallback(true);
 	}
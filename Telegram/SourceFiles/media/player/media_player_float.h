@@ -84,6 +84,7 @@ private:
 	[[nodiscard]] View::PlaybackProgress *getPlayback() const;
 	void repaintItem();
 	void prepareShadow();
+	void prepareMask();
 	bool hasFrame() const;
 	bool fillFrame();
 	[[nodiscard]] QRect getInnerRect() const;
@@ -97,7 +98,11 @@ private:
 	float64 _opacity = 1.;
 
 	QPixmap _shadow;
+	QImage _mask;
 	QImage _frame;
+	qint64 _frameKey = 0;
+	bool _frameChanged = false;
+	float64 _paintedProgress = 0.;
 	bool _down = false;
 	QPoint _downPoint;
 
@@ -44,6 +44,9 @@ constexpr auto kIdsPreloadAfter = 28;
 
 constexpr auto kMinLengthForSavePosition = 20 * TimeId(60); // 20 minutes.
 
+// Start warming the next playlist track when that little is left to play.
+constexpr auto kPreloadNextTailSeconds = 30;
+
 } // namespace
 
 struct Instance::Streamed {
@@ -173,6 +176,12 @@ void Instance::setCurrent(const AudioMsgId &audioId) {
 			&& changed(data->streamed->id)) {
 			clearStreamed(data);
 		}
+		if (data->preloadedId == audioId.contextId()) {
+			data->preloaded = nullptr;
+			data->preloadedId = FullMsgId();
+		} else {
+			cancelPreload(data);
+		}
 		data->current = audioId;
 		data->isPlaying = false;
 
@@ -335,6 +344,54 @@ bool Instance::moveInPlaylist(
 	return false;
 }
 
+void Instance::preloadNext(not_null<Data*> data) {
+	if (!data->current || !data->playlistIndex) {
+		return;
+	}
+	const auto item = itemByIndex(data, *data->playlistIndex + 1);
+	if (!item || item->fullId() == data->preloadedId) {
+		return;
+	}
+	const auto media = item->media();
+	const auto document = media ? media->document() : nullptr;
+	if (!document
+		|| !(document->isAudioFile()
+			|| document->isVoiceMessage()
+			|| document->isVideoMessage())) {
+		return;
+	}
+	cancelPreload(data);
+	data->preloadedId = item->fullId();
+
+	// Keeping the shared document alive pulls the header and the first
+	// audio slices from the media cache, so the switch starts instantly.
+	if (auto shared = document->owner().streaming().sharedDocument(
+			document,
+			item->fullId())) {
+		data->preloaded = std::move(shared);
+	}
+
+	if (!document->loading()
+		&& !document->loadedInMediaCache()
+		&& document->filepath(true).isEmpty()) {
+		document->save(item->fullId(), QString(), LoadFromCloudOrLocal, true);
+	}
+}
+
+void Instance::cancelPreload(not_null<Data*> data) {
+	data->preloaded = nullptr;
+	if (const auto id = base::take(data->preloadedId)) {
+		const auto item = Auth().data().message(id);
+		const auto media = item ? item->media() : nullptr;
+		const auto document = media ? media->document() : nullptr;
+		if (document
+			&& document->loading()
+			&& !document->displayLoading()) {
+			document->cancel();
+		}
+	}
+}
+
 bool Instance::previousAvailable(AudioMsgId::Type type) const {
 	const auto data = getData(type);
 	Assert(data != nullptr);
@@ -660,6 +717,15 @@ void Instance::emitUpdate(AudioMsgId::Type type, CheckCallback check) {
 			}
 		}
 		_updatedNotifier.fire_copy({state});
+		if (data->isPlaying
+			&& !IsStoppedOrStopping(state.state)
+			&& !data->repeatEnabled
+			&& (state.frequency > 0)
+			&& (state.length > 0)
+			&& (state.length - state.position
+				< kPreloadNextTailSeconds * state.frequency)) {
+			preloadNext(data);
+		}
 		if (data->isPlaying && state.state == State::StoppedAtEnd) {
 			if (data->repeatEnabled) {
 				play(data->current);
@@ -187,6 +187,8 @@ private:
 		bool isPlaying = false;
 		bool resumeOnCallEnd = false;
 		std::unique_ptr<Streamed> streamed;
+		std::shared_ptr<Streaming::Document> preloaded;
+		FullMsgId preloadedId;
 	};
 
 	Instance();
@@ -217,6 +219,8 @@ private:
 	void playlistUpdated(not_null<Data*> data);
 	bool moveInPlaylist(not_null<Data*> data, int delta, bool autonext);
 	HistoryItem *itemByIndex(not_null<Data*> data, int index);
+	void preloadNext(not_null<Data*> data);
+	void cancelPreload(not_null<Data*> data);
 
 	void handleStreamingUpdate(
 		not_null<Data*> data,
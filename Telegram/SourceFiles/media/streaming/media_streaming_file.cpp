@@ -11,12 +11,16 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "media/streaming/media_streaming_file_delegate.h"
 #include "ffmpeg/ffmpeg_utility.h"
 
+#include <QtCore/QDataStream>
+
 namespace Media {
 namespace Streaming {
 namespace {
 
 constexpr auto kMaxSingleReadAmount = 8 * 1024 * 1024;
 constexpr auto kMaxQueuedPackets = 1024;
+constexpr auto kKeyframeIndexVersion = 1;
+constexpr auto kMaxKeyframeIndexEntries = 64 * 1024;
 
 } // namespace
 
@@ -144,7 +148,9 @@ Stream File::Context::initStream(
 		}
 	}
 
-	result.codec = FFmpeg::MakeCodecPointer(info);
+	result.codec = FFmpeg::MakeCodecPointer(
+		info,
+		(type == AVMEDIA_TYPE_VIDEO) && _hardwareAcceleration);
 	if (!result.codec) {
 		if (info->codecpar->codec_id == AV_CODEC_ID_MJPEG) {
 			// mp3 files contain such "video stream", just ignore it.
@@ -158,6 +164,14 @@ Stream File::Context::initStream(
 		result.codec = nullptr;
 		return result;
 	}
+	if (type == AVMEDIA_TYPE_VIDEO) {
+		result.hardwareAcceleration
+			= (result.codec->hw_device_ctx != nullptr);
+		LOG(("Streaming Info: Video stream will use %1 decoding."
+			).arg(result.hardwareAcceleration
+				? qstr("hardware")
+				: qstr("software")));
+	}
 	result.timeBase = info->time_base;
 	result.duration = (info->duration != AV_NOPTS_VALUE)
 		? FFmpeg::PtsToTime(info->duration, result.timeBase)
@@ -176,6 +190,80 @@ Stream File::Context::initStream(
 	return result;
 }
 
+void File::Context::restoreKeyframeIndex(not_null<AVStream*> stream) {
+	_indexedStreamId = stream->index;
+	if (stream->nb_index_entries > 0) {
+		// The container (like MP4) provides its own index, use that one
+		// and don't waste cache space on a copy of it.
+		_indexFromContainer = true;
+		return;
+	}
+	const auto serialized = _reader->keyframeIndex();
+	if (serialized.isEmpty()) {
+		return;
+	}
+	QDataStream data(serialized);
+	auto version = qint32(0);
+	auto count = qint32(0);
+	data >> version >> count;
+	if (data.status() != QDataStream::Ok
+		|| version != kKeyframeIndexVersion
+		|| count <= 0
+		|| count > kMaxKeyframeIndexEntries) {
+		return;
+	}
+	for (auto i = 0; i != count; ++i) {
+		auto timestamp = qint64(0);
+		auto bytePosition = qint64(0);
+		data >> timestamp >> bytePosition;
+		if (data.status() != QDataStream::Ok) {
+			return;
+		}
+		av_add_index_entry(
+			stream,
+			bytePosition,
+			timestamp,
+			0, // size
+			0, // distance
+			AVINDEX_KEYFRAME);
+	}
+	_restoredIndexEntries = stream->nb_index_entries;
+	DEBUG_LOG(("Streaming Info: "
+		"Restored %1 keyframe index entries from cache."
+		).arg(_restoredIndexEntries));
+}
+
+void File::Context::saveKeyframeIndex() {
+	if (!_format || _indexFromContainer || _indexedStreamId < 0) {
+		return;
+	}
+	const auto stream = _format->streams[_indexedStreamId];
+	const auto count = stream->nb_index_entries;
+	if (count <= _restoredIndexEntries || count > kMaxKeyframeIndexEntries) {
+		return;
+	}
+	auto keyframes = qint32(0);
+	for (auto i = 0; i != count; ++i) {
+		if (stream->index_entries[i].flags & AVINDEX_KEYFRAME) {
+			++keyframes;
+		}
+	}
+	if (!keyframes) {
+		return;
+	}
+	auto result = QByteArray();
+	result.reserve(2 * sizeof(qint32) + keyframes * 2 * sizeof(qint64));
+	QDataStream data(&result, QIODevice::WriteOnly);
+	data << qint32(kKeyframeIndexVersion) << keyframes;
+	for (auto i = 0; i != count; ++i) {
+		const auto &entry = stream->index_entries[i];
+		if (entry.flags & AVINDEX_KEYFRAME) {
+			data << qint64(entry.timestamp) << qint64(entry.pos);
+		}
+	}
+	_reader->saveKeyframeIndex(std::move(result));
+}
+
 void File::Context::seekToPosition(
 		not_null<AVFormatContext*> format,
 		const Stream &stream,
@@ -230,12 +318,13 @@ base::variant<FFmpeg::Packet, FFmpeg::AvErrorWrap> File::Context::readPacket() {
 	return error;
 }
 
-void File::Context::start(crl::time position) {
+void File::Context::start(crl::time position, bool hardwareAcceleration) {
 	auto error = FFmpeg::AvErrorWrap();
 
 	if (unroll()) {
 		return;
 	}
+	_hardwareAcceleration = hardwareAcceleration;
 	auto format = FFmpeg::MakeFormatPointer(
 		static_cast<void *>(this),
 		&Context::Read,
@@ -263,6 +352,9 @@ void File::Context::start(crl::time position) {
 	if (_reader->isRemoteLoader()) {
 		sendFullInCache(true);
 	}
+	if (video.codec) {
+		restoreKeyframeIndex(format->streams[video.index]);
+	}
 	if (video.codec || audio.codec) {
 		seekToPosition(format.get(), video.codec ? video : audio, position);
 	}
@@ -394,16 +486,24 @@ File::File(std::shared_ptr<Reader> reader)
 : _reader(std::move(reader)) {
 }
 
-void File::start(not_null<FileDelegate*> delegate, crl::time position) {
+void File::start(
+		not_null<FileDelegate*> delegate,
+		crl::time position,
+		bool hardwareAcceleration) {
 	stop(true);
 
 	_reader->startStreaming();
 	_context.emplace(delegate, _reader.get());
 	_thread = std::thread([=, context = &*_context] {
-		context->start(position);
+		context->start(position, hardwareAcceleration);
 		while (!context->finished()) {
 			context->readNextPacket();
 		}
+		if (!context->failed()) {
+			// Persist keyframes gathered while demuxing, so that the
+			// following seeks could jump to the exact target slices.
+			context->saveKeyframeIndex();
+		}
 		if (!context->interrupted()) {
 			context->stopStreamingAsync();
 		}
@@ -28,7 +28,10 @@ public:
 	File(const File &other) = delete;
 	File &operator=(const File &other) = delete;
 
-	void start(not_null<FileDelegate*> delegate, crl::time position);
+	void start(
+		not_null<FileDelegate*> delegate,
+		crl::time position,
+		bool hardwareAcceleration = false);
 	void wake();
 	void stop(bool stillActive = false);
 
@@ -43,7 +46,7 @@ private:
 		Context(not_null<FileDelegate*> delegate, not_null<Reader*> reader);
 		~Context();
 
-		void start(crl::time position);
+		void start(crl::time position, bool hardwareAcceleration);
 		void readNextPacket();
 
 		void interrupt();
@@ -53,6 +56,7 @@ private:
 		[[nodiscard]] bool finished() const;
 
 		void stopStreamingAsync();
+		void saveKeyframeIndex();
 
 	private:
 		enum class SleepPolicy {
@@ -75,6 +79,7 @@ private:
 		Stream initStream(
 			not_null<AVFormatContext *> format,
 			AVMediaType type);
+		void restoreKeyframeIndex(not_null<AVStream*> stream);
 		void seekToPosition(
 			not_null<AVFormatContext *> format,
 			const Stream &stream,
@@ -96,6 +101,13 @@ private:
 		int _size = 0;
 		bool _failed = false;
 		bool _readTillEnd = false;
+		bool _hardwareAcceleration = false;
+
+		// Keyframe index for instant seeking in containers that don't
+		// provide their own index, see restoreKeyframeIndex.
+		int _indexedStreamId = -1;
+		int _restoredIndexEntries = 0;
+		bool _indexFromContainer = false;
 		std::optional<bool> _fullInCache;
 		crl::semaphore _semaphore;
 		std::atomic<bool> _interrupted = false;
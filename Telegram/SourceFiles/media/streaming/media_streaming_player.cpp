@@ -13,6 +13,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "media/streaming/media_streaming_video_track.h"
 #include "media/audio/media_audio.h" // for SupportsSpeedControl()
 #include "data/data_document.h" // for DocumentData::duration()
+#include "core/application.h" // for Core::App().settings()
+#include "core/dispatch_tracer.h"
 
 namespace Media {
 namespace Streaming {
@@ -238,13 +240,13 @@ bool Player::fileReady(int headerSize, Stream &&video, Stream &&audio) {
 
 	const auto weak = base::make_weak(&_sessionGuard);
 	const auto ready = [=](const Information &data) {
-		crl::on_main(weak, [=, data = data]() mutable {
+		Core::DispatchTracer::OnMain("streaming ready", weak, [=, data = data]() mutable {
 			data.headerSize = headerSize;
 			streamReady(std::move(data));
 		});
 	};
 	const auto error = [=](Error error) {
-		crl::on_main(weak, [=] {
+		Core::DispatchTracer::OnMain("streaming ready", weak, [=] {
 			streamFailed(error);
 		});
 	};
@@ -318,13 +320,13 @@ bool Player::fileReady(int headerSize, Stream &&video, Stream &&audio) {
 void Player::fileError(Error error) {
 	_waitingForData = false;
 
-	crl::on_main(&_sessionGuard, [=] {
+	Core::DispatchTracer::OnMain("streaming state", &_sessionGuard, [=] {
 		fail(error);
 	});
 }
 
 void Player::fileFullInCache(bool fullInCache) {
-	crl::on_main(&_sessionGuard, [=] {
+	Core::DispatchTracer::OnMain("streaming state", &_sessionGuard, [=] {
 		if (!_fullInCacheSinceStart.has_value()) {
 			_fullInCacheSinceStart = fullInCache;
 		}
@@ -370,7 +372,7 @@ bool Player::fileProcessPackets(
 					_audio->streamTimeBase()),
 				crl::time(0),
 				computeAudioDuration() - 1);
-			crl::on_main(&_sessionGuard, [=] {
+			Core::DispatchTracer::OnMain("streaming progress", &_sessionGuard, [=] {
 				audioReceivedTill(till);
 			});
 			_audio->process(base::take(list));
@@ -390,7 +392,7 @@ bool Player::fileProcessPackets(
 					_video->streamTimeBase()),
 				crl::time(0),
 				computeVideoDuration() - 1);
-			crl::on_main(&_sessionGuard, [=] {
+			Core::DispatchTracer::OnMain("streaming progress", &_sessionGuard, [=] {
 				videoReceivedTill(till);
 			});
 			_video->process(base::take(list));
@@ -412,14 +414,14 @@ void Player::fileProcessEndOfFile() {
 	};
 	if (_audio) {
 		const auto till = _loopingShift + computeAudioDuration();
-		crl::on_main(&_sessionGuard, [=] {
+		Core::DispatchTracer::OnMain("streaming progress", &_sessionGuard, [=] {
 			audioReceivedTill(till);
 		});
 		_audio->process(generateEmptyQueue());
 	}
 	if (_video) {
 		const auto till = _loopingShift + computeVideoDuration();
-		crl::on_main(&_sessionGuard, [=] {
+		Core::DispatchTracer::OnMain("streaming progress", &_sessionGuard, [=] {
 			videoReceivedTill(till);
 		});
 		_video->process(generateEmptyQueue());
@@ -541,7 +543,10 @@ void Player::play(const PlaybackOptions &options) {
 		_options.speed = 1.;
 	}
 	_stage = Stage::Initializing;
-	_file->start(delegate(), _options.position);
+	_file->start(
+		delegate(),
+		_options.position,
+		Core::App().settings().hardwareAcceleratedVideo());
 }
 
 void Player::savePreviousReceivedTill(
@@ -9,7 +9,9 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 #include "media/streaming/media_streaming_common.h"
 #include "media/streaming/media_streaming_loader.h"
+#include "core/dispatch_tracer.h"
 #include "storage/cache/storage_cache_database.h"
+#include "storage/cache_statistics.h"
 
 namespace Media {
 namespace Streaming {
@@ -25,10 +27,42 @@ constexpr auto kSlicesInMemory = 2;
 
 // 1 MB of parts are requested from cloud ahead of reading demand.
 constexpr auto kPreloadPartsAhead = 8;
+
+// Warm up the next slice when the reads will get there in less than
+// this time, so that its cache query doesn't stall them at the edge.
+constexpr auto kSliceReadaheadTime = crl::time(2000);
 constexpr auto kDownloaderRequestsLimit = 4;
 
+// The keyframe index is stored in the cache next to the file slices,
+// at a slice number no real slice can reach (the maximum file size
+// divided by the slice size stays way below that).
+constexpr auto kKeyframeIndexCacheNumber = 0xFFFF;
+
 using PartsMap = base::flat_map<int, QByteArray>;
 
+// Process-wide slice parts accounting for the memory stats report,
+// updated from the streaming threads on every parts change.
+std::atomic<int64> AllSlicesBytes/* = 0*/;
+std::atomic<int64> AllSlicesParts/* = 0*/;
+
+void AccountPartsAdded(int64 bytes, int count) {
+	AllSlicesBytes += bytes;
+	AllSlicesParts += count;
+}
+
+void AccountPartsRemoved(int64 bytes, int count) {
+	AllSlicesBytes -= bytes;
+	AllSlicesParts -= count;
+}
+
+[[nodiscard]] int64 PartsMapBytes(const PartsMap &parts) {
+	auto result = int64(0);
+	for (const auto &[offset, bytes] : parts) {
+		result += bytes.size();
+	}
+	return result;
+}
+
 struct ParsedCacheEntry {
 	PartsMap parts;
 	std::optional<PartsMap> included;
@@ -223,6 +257,7 @@ struct Reader::CacheHelper {
 	const Storage::Cache::Key baseKey;
 
 	QMutex mutex;
+	QByteArray keyframeIndex;
 	base::flat_map<int, PartsMap> results;
 	std::vector<int> sizes;
 	std::atomic<crl::semaphore*> waiting = nullptr;
@@ -245,10 +280,14 @@ void Reader::Slice::processCacheData(PartsMap &&data) {
 		flags &= ~Flag::LoadingFromCache;
 	});
 	if (parts.empty()) {
+		AccountPartsAdded(PartsMapBytes(data), data.size());
 		parts = std::move(data);
 	} else {
 		for (auto &[offset, bytes] : data) {
-			parts.emplace(offset, std::move(bytes));
+			const auto size = bytes.size();
+			if (parts.emplace(offset, std::move(bytes)).second) {
+				AccountPartsAdded(size, 1);
+			}
 		}
 	}
 }
@@ -256,6 +295,7 @@ void Reader::Slice::processCacheData(PartsMap &&data) {
 void Reader::Slice::addPart(int offset, QByteArray bytes) {
 	Expects(!parts.contains(offset));
 
+	AccountPartsAdded(bytes.size(), 1);
 	parts.emplace(offset, std::move(bytes));
 	if (flags & Flag::LoadedFromCache) {
 		flags |= Flag::ChangedSinceCache;
@@ -346,6 +386,17 @@ Reader::Slices::Slices(int size, bool useCache)
 	}
 }
 
+Reader::Slices::~Slices() {
+	AccountPartsRemoved(
+		PartsMapBytes(_header.parts),
+		_header.parts.size());
+	for (const auto &slice : _data) {
+		AccountPartsRemoved(
+			PartsMapBytes(slice.parts),
+			slice.parts.size());
+	}
+}
+
 bool Reader::Slices::headerModeUnknown() const {
 	return (_headerMode == HeaderMode::Unknown);
 }
@@ -571,6 +622,21 @@ auto Reader::Slices::fill(int offset, bytes::span buffer) -> FillResult {
 			&& (_headerMode != HeaderMode::Unknown)
 			&& !(_data[sliceIndex].flags & Flag::LoadedFromCache);
 	};
+	if (_lastFillSlice >= 0 && fromSlice == _lastFillSlice + 1) {
+		// Count how often the readahead got the slice ready in time.
+		if (cacheNotLoaded(fromSlice)) {
+			++_readaheadMisses;
+			DEBUG_LOG(("Streaming Info: "
+				"Reading slice %1 before its cache query has finished, "
+				"readahead missed %2 of %3 slice edge(s)."
+				).arg(fromSlice + 1
+				).arg(_readaheadMisses
+				).arg(_readaheadHits + _readaheadMisses));
+		} else {
+			++_readaheadHits;
+		}
+	}
+	_lastFillSlice = fromSlice;
 	const auto handlePrepareResult = [&](
 			int sliceIndex,
 			const Slice::PrepareFillResult &prepared) {
@@ -620,6 +686,7 @@ auto Reader::Slices::fill(int offset, bytes::span buffer) -> FillResult {
 		}
 		result.toCache = serializeAndUnloadUnused();
 		result.filled = true;
+		checkSliceReadahead(offset, till, result);
 	} else {
 		handleReadFromCache(fromSlice);
 		if (fromSlice + 1 < tillSlice) {
@@ -629,6 +696,58 @@ auto Reader::Slices::fill(int offset, bytes::span buffer) -> FillResult {
 	return result;
 }
 
+void Reader::Slices::checkSliceReadahead(
+		int offset,
+		int till,
+		FillResult &result) {
+	using Flag = Slice::Flag;
+
+	const auto now = crl::now();
+	if (_fillTime && offset >= _fillOffset) {
+		if (const auto elapsed = now - _fillTime) {
+			const auto speed = (till - _fillOffset) / float64(elapsed);
+			_fillSpeed = (_fillSpeed > 0.)
+				? ((_fillSpeed + speed) / 2.)
+				: speed;
+		}
+	} else {
+		// Looks like a seek, gather the pace at the new position anew.
+		_fillSpeed = 0.;
+	}
+	_fillOffset = till;
+	_fillTime = now;
+
+	const auto next = (till + kInSlice - 1) / kInSlice;
+	if (next != (offset / kInSlice) + 1
+		|| next >= _data.size()
+		|| next * kInSlice - till > _fillSpeed * kSliceReadaheadTime) {
+		return;
+	}
+	auto &slice = _data[next];
+	const auto cacheNotLoaded = (_headerMode != HeaderMode::NoCache)
+		&& (_headerMode != HeaderMode::Unknown)
+		&& !(slice.flags & Flag::LoadedFromCache);
+	if (cacheNotLoaded) {
+		if (!(slice.flags & Flag::LoadingFromCache)) {
+			slice.flags |= Flag::LoadingFromCache;
+			result.sliceNumbersFromCache.add(next + 1);
+
+			// Track it in the LRU so that it gets unloaded normally
+			// in case the reads never actually come to this slice.
+			markSliceUsed(next);
+		}
+	} else {
+		for (const auto partOffset : slice.offsetsFromLoader(
+				0,
+				kPreloadPartsAhead * kPartSize).values()) {
+			const auto full = partOffset + next * kInSlice;
+			if (full < _size) {
+				result.offsetsFromLoader.add(full);
+			}
+		}
+	}
+}
+
 auto Reader::Slices::fillFromHeader(int offset, bytes::span buffer)
 -> FillResult {
 	auto result = FillResult();
@@ -790,6 +909,7 @@ Reader::SerializedSlice Reader::Slices::serializeAndUnloadSlice(
 
 void Reader::Slices::unloadSlice(Slice &slice) const {
 	const auto full = (slice.flags & Slice::Flag::FullInCache);
+	AccountPartsRemoved(PartsMapBytes(slice.parts), slice.parts.size());
 	slice = Slice();
 	if (full) {
 		slice.flags |= Slice::Flag::FullInCache;
@@ -821,7 +941,11 @@ QByteArray Reader::Slices::serializeAndUnloadFirstSliceNoHeader() {
 
 	auto &slice = _data[0];
 	for (const auto &[offset, part] : _header.parts) {
-		slice.parts.erase(offset);
+		const auto i = slice.parts.find(offset);
+		if (i != end(slice.parts)) {
+			AccountPartsRemoved(i->second.size(), 1);
+			slice.parts.erase(i);
+		}
 	}
 	auto result = serializeComplexSlice(slice);
 	unloadSlice(slice);
@@ -870,6 +994,10 @@ Reader::Reader(
 	}
 }
 
+int Reader::playbackLoadingCount() const {
+	return _playbackLoadingCount.load(std::memory_order_relaxed);
+}
+
 void Reader::startSleep(not_null<crl::semaphore*> wake) {
 	_sleeping.store(wake, std::memory_order_release);
 	processDownloaderRequests();
@@ -901,6 +1029,9 @@ void Reader::tryRemoveLoaderAsync() {
 
 void Reader::startStreaming() {
 	_streamingActive = true;
+	if (_cache && _cacheHelper) {
+		readKeyframeIndex();
+	}
 	refreshLoaderPriority();
 }
 
@@ -913,6 +1044,7 @@ void Reader::stopStreaming(bool stillActive) {
 		_streamingActive = false;
 		refreshLoaderPriority();
 		_loadingOffsets.clear();
+		_playbackLoadingCount.store(0, std::memory_order_relaxed);
 		processDownloaderRequests();
 	}
 }
@@ -1056,9 +1188,14 @@ void Reader::pruneDoneDownloaderRequests() {
 }
 
 void Reader::sendDownloaderRequests() {
+	// Playback-critical loads have the priority, the sequential fill
+	// of the downloader goes only into the spare request slots.
+	const auto spare = std::max(
+		kDownloaderRequestsLimit - playbackLoadingCount(),
+		0);
 	auto &&offsets = ranges::view::all(
 		_offsetsForDownloader
-	) | ranges::view::take(kDownloaderRequestsLimit);
+	) | ranges::view::take(spare);
 	for (const auto offset : offsets) {
 		if ((!_cacheHelper || !downloaderWaitForCachedSlice(offset))
 			&& _downloaderOffsetsRequested.emplace(offset).second) {
@@ -1136,7 +1273,11 @@ void Reader::readFromCache(int sliceNumber) {
 	const auto ready = [=](
 			QByteArray &&result,
 			std::vector<int> &&sizes = {}) {
-		crl::async([
+		Storage::CacheStats::RecordGet(
+			Storage::CacheStats::Class::VideoSlices,
+			key,
+			result.size());
+		Core::DispatchTracer::Async("streaming cache parse", [
 			=,
 			result = std::move(result),
 			sizes = std::move(sizes)
@@ -1182,11 +1323,57 @@ bool Reader::readFromCacheForDownloader(int sliceNumber) {
 	return true;
 }
 
+void Reader::readKeyframeIndex() {
+	Expects(_cache != nullptr);
+	Expects(_cacheHelper != nullptr);
+
+	if (_keyframeIndexRead) {
+		return;
+	}
+	_keyframeIndexRead = true;
+	const auto cache = std::weak_ptr<CacheHelper>(_cacheHelper);
+	_cache->get(_cacheHelper->key(kKeyframeIndexCacheNumber), [=](
+			QByteArray &&result) {
+		if (const auto strong = cache.lock()) {
+			QMutexLocker lock(&strong->mutex);
+			strong->keyframeIndex = std::move(result);
+		}
+	});
+}
+
+QByteArray Reader::keyframeIndex() const {
+	if (!_cacheHelper) {
+		return QByteArray();
+	}
+	QMutexLocker lock(&_cacheHelper->mutex);
+	return _cacheHelper->keyframeIndex;
+}
+
+void Reader::saveKeyframeIndex(QByteArray &&serialized) {
+	if (!_cache || !_cacheHelper || serialized.isEmpty()) {
+		return;
+	}
+	{
+		QMutexLocker lock(&_cacheHelper->mutex);
+		if (_cacheHelper->keyframeIndex == serialized) {
+			return;
+		}
+		_cacheHelper->keyframeIndex = serialized;
+	}
+	_cache->put(
+		_cacheHelper->key(kKeyframeIndexCacheNumber),
+		std::move(serialized));
+}
+
 void Reader::putToCache(SerializedSlice &&slice) {
 	Expects(_cache != nullptr);
 	Expects(_cacheHelper != nullptr);
 	Expects(slice.number >= 0);
 
+	Storage::CacheStats::RecordPut(
+		Storage::CacheStats::Class::VideoSlices,
+		_cacheHelper->key(slice.number),
+		slice.data.size());
 	_cache->put(_cacheHelper->key(slice.number), std::move(slice.data));
 }
 
@@ -1251,6 +1438,14 @@ bool Reader::fill(
 		startWaiting();
 	} while (checkForSomethingMoreReceived());
 
+	if (!_streamingError && !_downloaderOffsetsRequested.empty()) {
+		++_starvedPlaybackReads;
+		DEBUG_LOG(("Streaming Info: "
+			"Playback read at %1 waits while downloader fill is in flight, "
+			"starved %2 time(s)."
+			).arg(offset
+			).arg(_starvedPlaybackReads));
+	}
 	return _streamingError ? failed() : false;
 }
 
@@ -1290,7 +1485,11 @@ bool Reader::fillFromSlices(int offset, bytes::span buffer) {
 void Reader::cancelLoadInRange(int from, int till) {
 	Expects(from < till);
 
-	for (const auto offset : _loadingOffsets.takeInRange(from, till)) {
+	const auto taken = _loadingOffsets.takeInRange(from, till);
+	_playbackLoadingCount.fetch_sub(
+		int(taken.size()),
+		std::memory_order_relaxed);
+	for (const auto offset : taken) {
 		if (!_downloaderOffsetsRequested.contains(offset)) {
 			_loader->cancel(offset);
 		}
@@ -1354,6 +1553,7 @@ bool Reader::processLoadedParts() {
 		} else if (!_loadingOffsets.remove(part.offset)) {
 			continue;
 		}
+		_playbackLoadingCount.fetch_sub(1, std::memory_order_relaxed);
 		_slices.processPart(
 			part.offset,
 			std::move(part.bytes));
@@ -1369,6 +1569,7 @@ bool Reader::checkForSomethingMoreReceived() {
 
 void Reader::loadAtOffset(int offset) {
 	if (_loadingOffsets.add(offset)) {
+		_playbackLoadingCount.fetch_add(1, std::memory_order_relaxed);
 		_loader->load(offset);
 	}
 }
@@ -1394,5 +1595,9 @@ Reader::~Reader() {
 	finalizeCache();
 }
 
+SlicesMemoryUsage CurrentSlicesMemoryUsage() {
+	return { AllSlicesBytes.load(), AllSlicesParts.load() };
+}
+
 } // namespace Streaming
 } // namespace Media
@@ -42,6 +42,8 @@ public:
 	// Any thread.
 	[[nodiscard]] int size() const;
 	[[nodiscard]] bool isRemoteLoader() const;
+	[[nodiscard]] QByteArray keyframeIndex() const;
+	void saveKeyframeIndex(QByteArray &&serialized);
 
 	// Single thread.
 	[[nodiscard]] bool fill(
@@ -54,6 +56,7 @@ public:
 	[[nodiscard]] bool fullInCache() const;
 
 	// Thread safe.
+	[[nodiscard]] int playbackLoadingCount() const;
 	void startSleep(not_null<crl::semaphore*> wake);
 	void wakeFromSleep();
 	void stopSleep();
@@ -138,6 +141,7 @@ private:
 	class Slices {
 	public:
 		Slices(int size, bool useCache);
+		~Slices();
 
 		void headerDone(bool fromCache);
 		[[nodiscard]] int headerSize() const;
@@ -182,6 +186,7 @@ private:
 		[[nodiscard]] FillResult fillFromHeader(
 			int offset,
 			bytes::span buffer);
+		void checkSliceReadahead(int offset, int till, FillResult &result);
 		void unloadSlice(Slice &slice) const;
 		void checkSliceFullLoaded(int sliceNumber);
 		[[nodiscard]] bool checkFullInCache() const;
@@ -189,6 +194,12 @@ private:
 		std::vector<Slice> _data;
 		Slice _header;
 		std::deque<int> _usedSlices;
+		int _lastFillSlice = -1;
+		int _fillOffset = 0;
+		crl::time _fillTime = 0;
+		float64 _fillSpeed = 0.; // Bytes per millisecond, smoothed.
+		int _readaheadHits = 0;
+		int _readaheadMisses = 0;
 		int _size = 0;
 		HeaderMode _headerMode = HeaderMode::Unknown;
 		bool _fullInCache = false;
@@ -198,6 +209,7 @@ private:
 	// 0 is for headerData, slice index = sliceNumber - 1.
 	// returns false if asked for a known-empty downloader slice cache.
 	void readFromCache(int sliceNumber);
+	void readKeyframeIndex();
 	[[nodiscard]] bool readFromCacheForDownloader(int sliceNumber);
 	bool processCacheResults();
 	void putToCache(SerializedSlice &&data);
@@ -240,6 +252,10 @@ private:
 	std::atomic<bool> _stopStreamingAsync = false;
 	PriorityQueue _loadingOffsets;
 
+	// Mirrors _loadingOffsets size, so that the downloader fill can see
+	// how many playback-critical loads are in flight from any thread.
+	std::atomic<int> _playbackLoadingCount = 0;
+
 	Slices _slices;
 
 	// Even if streaming had failed, the Reader can work for the downloader.
@@ -253,11 +269,13 @@ private:
 	rpl::event_stream<LoadedPart> _partsForDownloader;
 	int _realPriority = 1;
 	bool _streamingActive = false;
+	bool _keyframeIndexRead = false;
 
 	// Streaming thread.
 	std::deque<int> _offsetsForDownloader;
 	base::flat_set<int> _downloaderOffsetsRequested;
 	base::flat_map<int, std::optional<PartsMap>> _downloaderReadCache;
+	int _starvedPlaybackReads = 0;
 
 	// Communication from main thread to streaming thread.
 	// Streaming thread to main thread communicates using crl::on_main.
@@ -268,5 +286,14 @@ private:
 
 };
 
+struct SlicesMemoryUsage {
+	int64 bytes = 0;
+	int64 parts = 0;
+};
+
+// Total parts currently held in memory by all streaming readers,
+// maintained incrementally by the streaming threads.
+[[nodiscard]] SlicesMemoryUsage CurrentSlicesMemoryUsage();
+
 } // namespace Streaming
 } // namespace Media
@@ -17,6 +17,30 @@ namespace {
 
 constexpr auto kSkipInvalidDataPackets = 10;
 
+// Hardware decoders return frames that live in GPU / interop memory,
+// move the data to a software frame before handing it to rasterizing.
+[[nodiscard]] FFmpeg::AvErrorWrap TransferFromHardware(Stream &stream) {
+	auto error = FFmpeg::AvErrorWrap();
+
+	if (!stream.transferredFrame) {
+		stream.transferredFrame = FFmpeg::MakeFramePointer();
+		if (!stream.transferredFrame) {
+			return FFmpeg::AvErrorWrap(AVERROR(ENOMEM));
+		}
+	}
+	const auto hardware = stream.frame.get();
+	const auto software = stream.transferredFrame.get();
+	error = av_hwframe_transfer_data(software, hardware, 0);
+	if (error) {
+		LogError(qstr("av_hwframe_transfer_data"), error);
+		return error;
+	}
+	av_frame_copy_props(software, hardware);
+	av_frame_unref(hardware);
+	std::swap(stream.frame, stream.transferredFrame);
+	return error;
+}
+
 } // namespace
 
 crl::time FramePosition(const Stream &stream) {
@@ -72,8 +96,12 @@ FFmpeg::AvErrorWrap ReadNextFrame(Stream &stream) {
 		error = avcodec_receive_frame(
 			stream.codec.get(),
 			stream.frame.get());
-		if (!error
-			|| error.code() != AVERROR(EAGAIN)
+		if (!error) {
+			if (stream.frame->hw_frames_ctx) {
+				error = TransferFromHardware(stream);
+			}
+			return error;
+		} else if (error.code() != AVERROR(EAGAIN)
 			|| stream.queue.empty()) {
 			return error;
 		}
@@ -236,6 +264,14 @@ void PaintFrameInner(
 		Unexpected("Rotation in PaintFrameInner.");
 	};
 
+	if (!rotation && to.size() == original.size()) {
+		// Plain blit, don't pay for the smooth transform machinery.
+		if (alpha) {
+			p.fillRect(to, Qt::white);
+		}
+		p.drawImage(to.topLeft(), original);
+		return;
+	}
 	PainterHighQualityEnabler hq(p);
 	if (rotation) {
 		p.rotate(rotation);
@@ -41,6 +41,8 @@ struct Stream {
 	int rotation = 0;
 	AVRational aspect = FFmpeg::kNormalAspect;
 	FFmpeg::SwscalePointer swscale;
+	FFmpeg::FramePointer transferredFrame; // For hardware decoding.
+	bool hardwareAcceleration = false;
 };
 
 [[nodiscard]] crl::time FramePosition(const Stream &stream);
@@ -19,6 +19,29 @@ constexpr auto kDisplaySkipped = crl::time(-1);
 constexpr auto kFinishedPosition = std::numeric_limits<crl::time>::max();
 static_assert(kDisplaySkipped != kTimeUnknown);
 
+constexpr auto kRecycledStorageLimit = 4;
+
+// Dropped frame buffers are collected here instead of being freed,
+// so that the steady state playback could reuse them without a new
+// multi-megabyte allocation for each decoded frame.
+void RecycleFrameStorage(std::vector<QImage> &pool, QImage &&storage) {
+	if (storage.isNull()
+		|| !storage.isDetached()
+		|| pool.size() >= kRecycledStorageLimit) {
+		return;
+	}
+	pool.push_back(std::move(storage));
+}
+
+[[nodiscard]] QImage TakeRecycledStorage(std::vector<QImage> &pool) {
+	if (pool.empty()) {
+		return QImage();
+	}
+	auto result = std::move(pool.back());
+	pool.pop_back();
+	return result;
+}
+
 } // namespace
 
 class VideoTrackObject final {
@@ -73,7 +96,7 @@ private:
 	void readFrames();
 	[[nodiscard]] ReadEnoughState readEnoughFrames(crl::time trackTime);
 	[[nodiscard]] FrameResult readFrame(not_null<Frame*> frame);
-	void fillRequests(not_null<Frame*> frame) const;
+	void fillRequests(not_null<Frame*> frame);
 	[[nodiscard]] QSize chooseOriginalResize() const;
 	void presentFrameIfNeeded();
 	void callReady();
@@ -106,6 +129,7 @@ private:
 	rpl::event_stream<> _checkNextFrame;
 	rpl::event_stream<> _waitingForData;
 	base::flat_map<const Instance*, FrameRequest> _requests;
+	std::vector<QImage> _recycledFrameStorage;
 
 	bool _queued = false;
 	base::ConcurrentTimer _readFramesTimer;
@@ -321,10 +345,13 @@ auto VideoTrackObject::readFrame(not_null<Frame*> frame) -> FrameResult {
 	return FrameResult::Done;
 }
 
-void VideoTrackObject::fillRequests(not_null<Frame*> frame) const {
+void VideoTrackObject::fillRequests(not_null<Frame*> frame) {
 	auto i = frame->prepared.begin();
 	for (const auto &[instance, request] : _requests) {
 		while (i != frame->prepared.end() && i->first < instance) {
+			RecycleFrameStorage(
+				_recycledFrameStorage,
+				std::move(i->second.image));
 			i = frame->prepared.erase(i);
 		}
 		if (i == frame->prepared.end() || i->first > instance) {
@@ -333,6 +360,9 @@ void VideoTrackObject::fillRequests(not_null<Frame*> frame) const {
 		++i;
 	}
 	while (i != frame->prepared.end()) {
+		RecycleFrameStorage(
+			_recycledFrameStorage,
+			std::move(i->second.image));
 		i = frame->prepared.erase(i);
 	}
 }
@@ -363,18 +393,27 @@ void VideoTrackObject::presentFrameIfNeeded() {
 
 		fillRequests(frame);
 		frame->alpha = (frame->decoded->format == AV_PIX_FMT_BGRA);
+		auto storage = std::move(frame->original);
+		if (storage.isNull() || !storage.isDetached()) {
+			// The last painted image is still referenced somewhere,
+			// don't detach-copy it, take a recycled buffer instead.
+			storage = TakeRecycledStorage(_recycledFrameStorage);
+		}
 		frame->original = ConvertFrame(
 			_stream,
 			frame->decoded.get(),
 			chooseOriginalResize(),
-			std::move(frame->original));
+			std::move(storage));
 		if (frame->original.isNull()) {
 			frame->prepared.clear();
 			fail(Error::InvalidData);
 			return;
 		}
 
-		VideoTrack::PrepareFrameByRequests(frame, _stream.rotation);
+		VideoTrack::PrepareFrameByRequests(
+			frame,
+			_stream.rotation,
+			&_recycledFrameStorage);
 
 		Ensures(VideoTrack::IsRasterized(frame));
 	};
@@ -1025,7 +1064,8 @@ void VideoTrack::unregisterInstance(not_null<const Instance*> instance) {
 
 void VideoTrack::PrepareFrameByRequests(
 		not_null<Frame*> frame,
-		int rotation) {
+		int rotation,
+		std::vector<QImage> *recycledStorage) {
 	Expects(!frame->original.isNull());
 
 	const auto begin = frame->prepared.begin();
@@ -1037,11 +1077,21 @@ void VideoTrack::PrepareFrameByRequests(
 			auto j = begin;
 			for (; j != i; ++j) {
 				if (j->second.request == prepared.request) {
+					if (recycledStorage) {
+						RecycleFrameStorage(
+							*recycledStorage,
+							std::move(prepared.image));
+					}
 					prepared.image = QImage();
 					break;
 				}
 			}
 			if (j == i) {
+				if (recycledStorage
+					&& (prepared.image.isNull()
+						|| !prepared.image.isDetached())) {
+					prepared.image = TakeRecycledStorage(*recycledStorage);
+				}
 				prepared.image = PrepareByRequest(
 					frame->original,
 					frame->alpha,
@@ -142,7 +142,10 @@ private:
 
 	};
 
-	static void PrepareFrameByRequests(not_null<Frame*> frame, int rotation);
+	static void PrepareFrameByRequests(
+		not_null<Frame*> frame,
+		int rotation,
+		std::vector<QImage> *recycledStorage = nullptr);
 	[[nodiscard]] static bool IsDecoded(not_null<const Frame*> frame);
 	[[nodiscard]] static bool IsRasterized(not_null<const Frame*> frame);
 	[[nodiscard]] static bool IsStale(
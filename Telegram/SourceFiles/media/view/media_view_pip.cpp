@@ -585,7 +585,9 @@ void PipPanel::paintEvent(QPaintEvent *e) {
 			? RectPart(0)
 			: RectPart::BottomLeft);
 	request.radius = ImageRoundRadius::Large;
-	if (_useTransparency) {
+	if (_useTransparency && !inner.contains(e->rect())) {
+		// The shadow lies in the padding around the video, don't repaint
+		// it when only the frame area is invalidated by the next frame.
 		const auto sides = RectPart::AllSides & ~_attached;
 		Ui::Shadow::paint(p, inner, width(), st::callShadow);
 	}
@@ -1317,7 +1319,7 @@ void Pip::handleStreamingUpdate(Streaming::Update &&update) {
 	}, [&](const PreloadedVideo &update) {
 		updatePlaybackState();
 	}, [&](const UpdateVideo &update) {
-		_panel.update();
+		_panel.update(_panel.inner());
 		Core::App().updateNonIdle();
 		updatePlaybackState();
 	}, [&](const PreloadedAudio &update) {
@@ -12,6 +12,9 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "mtproto/connection_tcp.h"
 #include "storage/serialize_common.h"
 
+#include <QtCore/QCryptographicHash>
+#include <QtNetwork/QNetworkInterface>
+
 namespace MTP {
 namespace {
 
@@ -98,6 +101,32 @@ m+ZH1sadZspQCEPPrtbkQBlvHb4OLiIWPGHKSMeRFvp3IWcmdJqXahxLCUS1Eh6M\n\
 AQIDAQAB\n\
 -----END PUBLIC KEY-----" };
 
+// A rough fingerprint of the network environment: the active network
+// interfaces with their hardware and IP addresses. Used only to drop
+// the last working endpoints cache when we find ourselves on another
+// network, so false mismatches just cost us one full transport race.
+[[nodiscard]] quint64 NetworkFingerprint() {
+	auto data = QString();
+	for (const auto &iface : QNetworkInterface::allInterfaces()) {
+		const auto flags = iface.flags();
+		if (!(flags & QNetworkInterface::IsUp)
+			|| !(flags & QNetworkInterface::IsRunning)
+			|| (flags & QNetworkInterface::IsLoopBack)) {
+			continue;
+		}
+		data += iface.name() + iface.hardwareAddress();
+		for (const auto &entry : iface.addressEntries()) {
+			data += entry.ip().toString();
+		}
+	}
+	const auto hash = QCryptographicHash::hash(
+		data.toUtf8(),
+		QCryptographicHash::Sha256);
+	auto result = quint64(0);
+	memcpy(&result, hash.constData(), sizeof(result));
+	return result;
+}
+
 } // namespace
 
 class DcOptions::WriteLocker {
@@ -438,7 +467,13 @@ QByteArray DcOptions::serialize() const {
 		}
 	}
 
-	constexpr auto kVersion = 1;
+	// Last working endpoints.
+	size += sizeof(quint64) + sizeof(qint32);
+	for (const auto &item : _lastWorking) {
+		size += 5 * sizeof(qint32) + item.second.ip.size();
+	}
+
+	constexpr auto kVersion = 2;
 
 	auto result = QByteArray();
 	result.reserve(size);
@@ -473,6 +508,19 @@ QByteArray DcOptions::serialize() const {
 				<< Serialize::bytes(key.n)
 				<< Serialize::bytes(key.e);
 		}
+
+		// Last working endpoints.
+		stream << quint64(_lastWorkingNetworkId)
+			<< qint32(_lastWorking.size());
+		for (const auto &item : _lastWorking) {
+			const auto &endpoint = item.second;
+			stream << qint32(item.first)
+				<< qint32(endpoint.port)
+				<< qint32(endpoint.protocol)
+				<< qint32(endpoint.pingTime)
+				<< qint32(endpoint.ip.size());
+			stream.writeRawData(endpoint.ip.data(), endpoint.ip.size());
+		}
 	}
 	return result;
 }
@@ -567,6 +615,47 @@ void DcOptions::constructFromSerialized(const QByteArray &serialized) {
 			}
 		}
 	}
+
+	// Read last working endpoints.
+	if (version > 1 && !stream.atEnd()) {
+		auto networkId = quint64(0);
+		auto count = qint32(0);
+		stream >> networkId >> count;
+		if (stream.status() != QDataStream::Ok) {
+			LOG(("MTP Error: Bad last working endpoints data in "
+				"DcOptions::constructFromSerialized()"));
+			return;
+		}
+		auto lastWorking = std::map<DcId, LastWorking>();
+		for (auto i = 0; i != count; ++i) {
+			qint32 dcId = 0, port = 0, protocol = 0, pingTime = 0;
+			qint32 ipSize = 0;
+			stream >> dcId >> port >> protocol >> pingTime >> ipSize;
+
+			constexpr auto kMaxIpSize = 45;
+			if (ipSize <= 0 || ipSize > kMaxIpSize) {
+				LOG(("MTP Error: Bad last working endpoints data in "
+					"DcOptions::constructFromSerialized()"));
+				return;
+			}
+			auto endpoint = LastWorking();
+			endpoint.ip = std::string(ipSize, ' ');
+			stream.readRawData(endpoint.ip.data(), ipSize);
+			endpoint.port = port;
+			endpoint.protocol = protocol;
+			endpoint.pingTime = pingTime;
+			if (stream.status() != QDataStream::Ok) {
+				LOG(("MTP Error: Bad last working endpoints data in "
+					"DcOptions::constructFromSerialized()"));
+				return;
+			}
+			lastWorking.emplace(DcId(dcId), std::move(endpoint));
+		}
+		if (networkId == NetworkFingerprint()) {
+			_lastWorkingNetworkId = networkId;
+			_lastWorking = std::move(lastWorking);
+		}
+	}
 }
 
 rpl::producer<DcId> DcOptions::changed() const {
@@ -610,6 +699,32 @@ DcType DcOptions::dcType(ShiftedDcId shiftedDcId) const {
 	return DcType::Regular;
 }
 
+std::optional<DcOptions::LastWorking> DcOptions::lastWorking(
+		DcId dcId) const {
+	ReadLocker lock(this);
+	if (!_lastWorkingNetworkId
+		|| _lastWorkingNetworkId != NetworkFingerprint()) {
+		return std::nullopt;
+	}
+	const auto i = _lastWorking.find(dcId);
+	return (i != end(_lastWorking))
+		? std::make_optional(i->second)
+		: std::nullopt;
+}
+
+void DcOptions::reportLastWorking(DcId dcId, LastWorking endpoint) {
+	if (endpoint.ip.empty() || isTemporaryDcId(dcId)) {
+		return;
+	}
+	WriteLocker lock(this);
+	const auto networkId = NetworkFingerprint();
+	if (_lastWorkingNetworkId != networkId) {
+		_lastWorking.clear();
+		_lastWorkingNetworkId = networkId;
+	}
+	_lastWorking[dcId] = std::move(endpoint);
+}
+
 void DcOptions::setCDNConfig(const MTPDcdnConfig &config) {
 	WriteLocker lock(this);
 	_cdnPublicKeys.clear();
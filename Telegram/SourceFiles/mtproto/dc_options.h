@@ -15,6 +15,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include <vector>
 #include <map>
 #include <set>
+#include <optional>
 
 namespace MTP {
 namespace details {
@@ -96,6 +97,19 @@ public:
 		bool throughProxy) const;
 	[[nodiscard]] DcType dcType(ShiftedDcId shiftedDcId) const;
 
+	// The endpoint that won the transport race for a DC the last time,
+	// remembered per network fingerprint, so that a reconnect after
+	// restart prefers the endpoint that is known to work on this
+	// network. Thread-safe.
+	struct LastWorking {
+		std::string ip;
+		int port = 0;
+		int protocol = 0; // Variants::Protocol.
+		qint32 pingTime = 0;
+	};
+	[[nodiscard]] std::optional<LastWorking> lastWorking(DcId dcId) const;
+	void reportLastWorking(DcId dcId, LastWorking endpoint);
+
 	void setCDNConfig(const MTPDcdnConfig &config);
 	[[nodiscard]] bool hasCDNKeysForDc(DcId dcId) const;
 	[[nodiscard]] details::RSAPublicKey getDcRSAKey(
@@ -139,6 +153,8 @@ private:
 	friend class ReadLocker;
 
 	std::map<DcId, std::vector<Endpoint>> _data;
+	std::map<DcId, LastWorking> _lastWorking;
+	quint64 _lastWorkingNetworkId = 0;
 	std::set<DcId> _cdnDcIds;
 	std::map<uint64, details::RSAPublicKey> _publicKeys;
 	std::map<DcId, std::map<uint64, details::RSAPublicKey>> _cdnPublicKeys;
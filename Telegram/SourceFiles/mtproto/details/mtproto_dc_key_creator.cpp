@@ -10,6 +10,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "mtproto/details/mtproto_rsa_public_key.h"
 #include "mtproto/connection_abstract.h"
 #include "mtproto/mtproto_dh_utils.h"
+#include "base/invoke_queued.h"
 #include "base/openssl_help.h"
 #include "base/unixtime.h"
 #include "scheme.h"
@@ -176,7 +177,8 @@ DcKeyCreator::DcKeyCreator(
 , _dcId(dcId)
 , _protocolDcId(protocolDcId)
 , _request(request)
-, _delegate(std::move(delegate)) {
+, _delegate(std::move(delegate))
+, _sentinel(std::make_shared<QObject>()) {
 	Expects(_request.temporaryExpiresIn > 0);
 	Expects(_delegate.done != nullptr);
 
@@ -448,12 +450,6 @@ void DcKeyCreator::dhParamsAnswered(
 		}
 		base::unixtime::update(dh_inner_data.vserver_time().v);
 
-		// check that dhPrime and (dhPrime - 1) / 2 are really prime
-		if (!IsPrimeAndGood(bytes::make_span(dh_inner_data.vdh_prime().v), dh_inner_data.vg().v)) {
-			LOG(("AuthKey Error: bad dh_prime primality!"));
-			return failed();
-		}
-
 		attempt->dhPrime = bytes::make_vector(
 			dh_inner_data.vdh_prime().v);
 		attempt->data.g = dh_inner_data.vg().v;
@@ -485,21 +481,63 @@ void DcKeyCreator::dhClientParamsSend(not_null<Attempt*> attempt) {
 		return failed();
 	}
 
-	// gen rand 'b'
-	auto randomSeed = bytes::vector(ModExpFirst::kRandomPowerSize);
-	bytes::set_random(randomSeed);
-	auto g_b_data = CreateModExp(attempt->data.g, attempt->dhPrime, randomSeed);
-	if (g_b_data.modexp.empty()) {
+	// The primality check and the modular exponentiations take long,
+	// so run them on a worker instead of the session thread - this way
+	// handshakes for several DCs overlap even when their sessions
+	// share one thread, and the thread keeps handling network events.
+	const auto g = attempt->data.g;
+	const auto checkPrime = (attempt->retries == 1);
+	const auto weak = std::weak_ptr<QObject>(_sentinel);
+	crl::async([
+		=,
+		prime = attempt->dhPrime,
+		g_a = attempt->g_a,
+		guard = _guard.make_guard()]() mutable {
+		auto computed = ComputedAuthKey();
+		computed.primeGood = !checkPrime || IsPrimeAndGood(prime, g);
+		if (computed.primeGood) {
+			// gen rand 'b'
+			auto randomSeed = bytes::vector(ModExpFirst::kRandomPowerSize);
+			bytes::set_random(randomSeed);
+			auto g_b_data = CreateModExp(g, prime, randomSeed);
+			if (!g_b_data.modexp.empty()) {
+				computed.authKey = CreateAuthKey(
+					g_a,
+					g_b_data.randomPower,
+					prime);
+				computed.modexp = std::move(g_b_data.modexp);
+			}
+			OPENSSL_cleanse(
+				g_b_data.randomPower.data(),
+				g_b_data.randomPower.size());
+		}
+		const auto strong = weak.lock();
+		if (!strong) {
+			return;
+		}
+		InvokeQueued(strong.get(), crl::guard(std::move(guard), [
+			=,
+			computed = std::move(computed)]() mutable {
+			dhClientParamsComputed(attempt, std::move(computed));
+		}));
+	});
+}
+
+void DcKeyCreator::dhClientParamsComputed(
+		not_null<Attempt*> attempt,
+		ComputedAuthKey &&computed) {
+	if (!computed.primeGood) {
+		// dhPrime and (dhPrime - 1) / 2 must really be prime.
+		LOG(("AuthKey Error: bad dh_prime primality!"));
+		return failed();
+	} else if (computed.modexp.empty()) {
 		LOG(("AuthKey Error: could not generate good g_b."));
 		return failed();
-	}
-
-	auto computedAuthKey = CreateAuthKey(attempt->g_a, g_b_data.randomPower, attempt->dhPrime);
-	if (computedAuthKey.empty()) {
+	} else if (computed.authKey.empty()) {
 		LOG(("AuthKey Error: could not generate auth_key."));
 		return failed();
 	}
-	AuthKey::FillData(attempt->authKey, computedAuthKey);
+	AuthKey::FillData(attempt->authKey, computed.authKey);
 
 	auto auth_key_sha = openssl::Sha1(attempt->authKey);
 	memcpy(&attempt->data.auth_key_aux_hash, auth_key_sha.data(), 8);
@@ -509,7 +547,7 @@ void DcKeyCreator::dhClientParamsSend(not_null<Attempt*> attempt) {
 		attempt->data.nonce,
 		attempt->data.server_nonce,
 		attempt->data.retry_id,
-		MTP_bytes(g_b_data.modexp));
+		MTP_bytes(computed.modexp));
 
 	auto sdhEncString = EncryptClientDHInner(
 		client_dh_inner,
@@ -631,6 +669,7 @@ void DcKeyCreator::done() {
 }
 
 void DcKeyCreator::stopReceiving() {
+	_guard = base::binary_guard();
 	QObject::disconnect(
 		_connection,
 		&AbstractConnection::receivedData,
@@ -11,6 +11,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "mtproto/mtproto_auth_key.h"
 #include "mtproto/connection_abstract.h"
 #include "base/basic_types.h"
+#include "base/binary_guard.h"
 #include "base/expected.h"
 
 namespace MTP {
@@ -94,6 +95,11 @@ private:
 		uint32 retries = 0;
 		Stage stage = Stage::None;
 	};
+	struct ComputedAuthKey {
+		bytes::vector modexp;
+		bytes::vector authKey;
+		bool primeGood = false;
+	};
 
 	template <typename RequestType>
 	void sendNotSecureRequest(const RequestType &request);
@@ -116,6 +122,9 @@ private:
 		not_null<Attempt*> attempt,
 		const MTPserver_DH_Params &data);
 	void dhClientParamsSend(not_null<Attempt*> attempt);
+	void dhClientParamsComputed(
+		not_null<Attempt*> attempt,
+		ComputedAuthKey &&computed);
 	void dhClientParamsAnswered(
 		not_null<Attempt*> attempt,
 		const MTPset_client_DH_params_answer &data);
@@ -134,6 +143,11 @@ private:
 	Attempt _temporary;
 	Attempt _persistent;
 
+	// Workers post computation results through this object, holding it
+	// weakly, so that nothing is posted to a destroyed session thread.
+	std::shared_ptr<QObject> _sentinel;
+	base::binary_guard _guard;
+
 };
 
 } // namespace MTP::details
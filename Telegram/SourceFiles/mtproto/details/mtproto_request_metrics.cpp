@@ -0,0 +1,117 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "mtproto/details/mtproto_request_metrics.h"
+
+namespace MTP::details {
+namespace {
+
+[[nodiscard]] int Percentile(std::vector<int> &sorted, int percent) {
+	Expects(!sorted.empty());
+
+	const auto index = (int(sorted.size()) - 1) * percent / 100;
+	return sorted[index];
+}
+
+} // namespace
+
+RequestMetrics &RequestMetrics::Instance() {
+	static auto result = RequestMetrics();
+	return result;
+}
+
+void RequestMetrics::sent(
+		mtpRequestId requestId,
+		mtpTypeId type,
+		ShiftedDcId dcId,
+		crl::time enqueued) {
+	const auto now = crl::now();
+
+	QMutexLocker lock(&_mutex);
+	if (int(_pending.size()) >= kMaxPending) {
+		// Requests that never got answered shouldn't accumulate.
+		_pending.erase(_pending.begin());
+	}
+	auto &pending = _pending[requestId];
+	pending.type = type;
+	pending.dcId = dcId;
+	pending.enqueued = enqueued ? enqueued : now;
+	pending.sentAt = now;
+	pending.ackedAt = 0;
+}
+
+void RequestMetrics::acked(mtpRequestId requestId) {
+	QMutexLocker lock(&_mutex);
+	const auto i = _pending.find(requestId);
+	if (i != _pending.end() && !i->second.ackedAt) {
+		i->second.ackedAt = crl::now();
+	}
+}
+
+void RequestMetrics::responded(mtpRequestId requestId) {
+	const auto now = crl::now();
+
+	QMutexLocker lock(&_mutex);
+	const auto i = _pending.find(requestId);
+	if (i == _pending.end()) {
+		return;
+	}
+	const auto &pending = i->second;
+	auto &sample = _ring[_ringIndex];
+	sample.type = pending.type;
+	sample.dcId = pending.dcId;
+	sample.queued = int(pending.sentAt - pending.enqueued);
+	sample.acked = pending.ackedAt ? int(pending.ackedAt - pending.sentAt) : 0;
+	sample.responded = int(now - pending.sentAt);
+	_ringIndex = (_ringIndex + 1) % kRingSize;
+	_ringCount = std::min(_ringCount + 1, kRingSize);
+	_pending.erase(i);
+}
+
+QString RequestMetrics::report() const {
+	auto grouped = base::flat_map<
+		std::pair<ShiftedDcId, mtpTypeId>,
+		std::vector<Sample>>();
+	{
+		QMutexLocker lock(&_mutex);
+		for (auto i = 0; i != _ringCount; ++i) {
+			const auto &sample = _ring[i];
+			grouped[{ sample.dcId, sample.type }].push_back(sample);
+		}
+	}
+	auto result = QString();
+	for (auto &[key, samples] : grouped) {
+		auto queued = std::vector<int>();
+		auto acked = std::vector<int>();
+		auto responded = std::vector<int>();
+		for (const auto &sample : samples) {
+			queued.push_back(sample.queued);
+			if (sample.acked > 0) {
+				acked.push_back(sample.acked);
+			}
+			responded.push_back(sample.responded);
+		}
+		std::sort(begin(queued), end(queued));
+		std::sort(begin(acked), end(acked));
+		std::sort(begin(responded), end(responded));
+		result += QString("dc=%1 type=0x%2 count=%3 queued50=%4"
+			).arg(key.first
+			).arg(key.second, 0, 16
+			).arg(samples.size()
+			).arg(Percentile(queued, 50));
+		if (!acked.empty()) {
+			result += QString(" acked50=%1").arg(Percentile(acked, 50));
+		}
+		result += QString(" responded50=%1 responded95=%2 responded99=%3\n"
+			).arg(Percentile(responded, 50)
+			).arg(Percentile(responded, 95)
+			).arg(Percentile(responded, 99));
+	}
+	return result;
+}
+
+} // namespace MTP::details
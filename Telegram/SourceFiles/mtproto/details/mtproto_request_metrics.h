@@ -0,0 +1,67 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include "mtproto/core_types.h"
+#include "base/flat_map.h"
+
+#include <crl/crl_time.h>
+#include <QtCore/QMutex>
+
+namespace MTP::details {
+
+// Records per-request sent / acked / responded timings into a fixed
+// ring, aggregated into p50/p95/p99 per request type and DC on demand.
+// All methods are thread safe, sessions report from their own threads.
+class RequestMetrics final {
+public:
+	[[nodiscard]] static RequestMetrics &Instance();
+
+	void sent(
+		mtpRequestId requestId,
+		mtpTypeId type,
+		ShiftedDcId dcId,
+		crl::time enqueued);
+	void acked(mtpRequestId requestId);
+	void responded(mtpRequestId requestId);
+
+	// One line per (dc, type): "dc=2 type=0x... count=... queued50=..
+	// acked50=.. responded50=.. responded95=.. responded99=..", both
+	// grep-able by humans and trivially machine-parseable.
+	[[nodiscard]] QString report() const;
+
+private:
+	static constexpr auto kRingSize = 4096;
+	static constexpr auto kMaxPending = 4096;
+
+	struct Sample {
+		mtpTypeId type = 0;
+		ShiftedDcId dcId = 0;
+		int queued = 0; // enqueue -> sent, ms.
+		int acked = 0; // sent -> acked, ms.
+		int responded = 0; // sent -> responded, ms.
+	};
+	struct Pending {
+		mtpTypeId type = 0;
+		ShiftedDcId dcId = 0;
+		crl::time enqueued = 0;
+		crl::time sentAt = 0;
+		crl::time ackedAt = 0;
+	};
+
+	RequestMetrics() = default;
+
+	mutable QMutex _mutex;
+	base::flat_map<mtpRequestId, Pending> _pending;
+	std::array<Sample, kRingSize> _ring;
+	int _ringIndex = 0;
+	int _ringCount = 0;
+
+};
+
+} // namespace MTP::details
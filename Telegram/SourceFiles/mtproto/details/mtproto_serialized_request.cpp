@@ -9,9 +9,65 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 #include "base/openssl_help.h"
 
+#include <QtCore/QMutex>
+
 namespace MTP::details {
 namespace {
 
+// Request buffers are recycled when the last reference to them is
+// dropped, which normally happens on acknowledgment. Don't keep more
+// than this count and don't keep unusually large payload allocations.
+constexpr auto kPoolLimit = 64;
+constexpr auto kPoolMaxCapacityInts = 16 * 1024;
+
+class RequestDataPool {
+public:
+	[[nodiscard]] static RequestDataPool &Instance() {
+		// Leaked intentionally, requests may outlive static destruction.
+		static const auto result = new RequestDataPool();
+		return *result;
+	}
+
+	[[nodiscard]] std::shared_ptr<RequestData> take(
+			const RequestConstructHider::Tag &tag) {
+		auto data = std::unique_ptr<RequestData>();
+		{
+			QMutexLocker lock(&_mutex);
+			if (!_recycled.empty()) {
+				data = std::move(_recycled.back());
+				_recycled.pop_back();
+			}
+		}
+		if (!data) {
+			data = std::make_unique<RequestData>(tag);
+		}
+		return std::shared_ptr<RequestData>(
+			data.release(),
+			[](RequestData *request) { Instance().recycle(request); });
+	}
+
+private:
+	void recycle(RequestData *request) {
+		auto owned = std::unique_ptr<RequestData>(request);
+		owned->after = SerializedRequest();
+		owned->lastSentTime = 0;
+		owned->requestId = 0;
+		owned->needsLayer = false;
+		owned->forceSendInContainer = false;
+		owned->resize(0); // Keeps the allocation for the next request.
+
+		QMutexLocker lock(&_mutex);
+		if (_recycled.size() < kPoolLimit
+			&& owned->capacity() <= kPoolMaxCapacityInts) {
+			_recycled.push_back(std::move(owned));
+		}
+	}
+
+	QMutex _mutex;
+	std::vector<std::unique_ptr<RequestData>> _recycled;
+
+};
+
 uint32 CountPaddingPrimesCount(uint32 requestSize, bool extended, bool old) {
 	if (old) {
 		return ((8 + requestSize) & 0x03)
@@ -38,7 +94,7 @@ uint32 CountPaddingPrimesCount(uint32 requestSize, bool extended, bool old) {
 } // namespace
 
 SerializedRequest::SerializedRequest(const RequestConstructHider::Tag &tag)
-: _data(std::make_shared<RequestData>(tag)) {
+: _data(RequestDataPool::Instance().take(tag)) {
 }
 
 SerializedRequest SerializedRequest::Prepare(
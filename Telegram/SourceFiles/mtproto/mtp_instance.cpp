@@ -11,6 +11,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "mtproto/details/mtproto_rsa_public_key.h"
 #include "mtproto/special_config_request.h"
 #include "mtproto/session.h"
+#include "mtproto/network_health.h"
 #include "mtproto/dc_options.h"
 #include "mtproto/config_loader.h"
 #include "mtproto/sender.h"
@@ -1271,6 +1272,11 @@ bool Instance::Private::onErrorDefault(mtpRequestId requestId, const RPCError &e
 			}
 		} else {
 			secs = m.captured(1).toInt();
+			if (const auto shiftedDcId = queryRequestByDc(requestId)) {
+				NetworkHealth::RecordFloodWait(
+					BareDcId(qAbs(*shiftedDcId)),
+					secs);
+			}
 //			if (secs >= 60) return false;
 		}
 		auto sendAt = crl::now() + secs * 1000 + 10;
@@ -1718,6 +1724,10 @@ QString Instance::dctransport(ShiftedDcId shiftedDcId) {
 	return _private->dctransport(shiftedDcId);
 }
 
+QString Instance::requestMetricsReport() const {
+	return details::RequestMetrics::Instance().report();
+}
+
 void Instance::ping() {
 	_private->ping();
 }
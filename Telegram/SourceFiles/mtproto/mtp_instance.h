@@ -79,6 +79,10 @@ public:
 	void restart(ShiftedDcId shiftedDcId);
 	int32 dcstate(ShiftedDcId shiftedDcId = 0);
 	QString dctransport(ShiftedDcId shiftedDcId = 0);
+
+	// Aggregated request timings per DC and request type, for debugging
+	// slow sending. See details::RequestMetrics for the line format.
+	[[nodiscard]] QString requestMetricsReport() const;
 	void ping();
 	void cancel(mtpRequestId requestId);
 	int32 state(mtpRequestId requestId); // < 0 means waiting for such count of ms
@@ -10,8 +10,94 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "base/openssl_help.h"
 
 #include <QtCore/QDataStream>
+#include <openssl/evp.h>
 
 namespace MTP {
+namespace {
+
+constexpr auto kAesBlockSize = 16;
+
+// AES_ige_encrypt() always runs the portable software AES. Keeping the
+// IGE chaining here and running the block cipher through EVP AES-ECB
+// lets OpenSSL dispatch to AES-NI / ARMv8 crypto extensions at runtime.
+bool aesIgeThroughEvp(
+		const void *src,
+		void *dst,
+		uint32 len,
+		const void *key,
+		const void *iv,
+		bool encrypt) {
+	Expects((len & 0x0F) == 0);
+
+	const auto context = EVP_CIPHER_CTX_new();
+	if (!context) {
+		return false;
+	}
+	const auto guard = gsl::finally([&] {
+		EVP_CIPHER_CTX_free(context);
+	});
+	const auto initialized = encrypt
+		? EVP_EncryptInit_ex(
+			context,
+			EVP_aes_256_ecb(),
+			nullptr,
+			static_cast<const uchar*>(key),
+			nullptr)
+		: EVP_DecryptInit_ex(
+			context,
+			EVP_aes_256_ecb(),
+			nullptr,
+			static_cast<const uchar*>(key),
+			nullptr);
+	if (initialized != 1) {
+		return false;
+	}
+	EVP_CIPHER_CTX_set_padding(context, 0);
+
+	// chain[0..1] is the ciphertext chain, chain[2..3] the plaintext one,
+	// laid out exactly like the 32-byte ivec of AES_ige_encrypt().
+	auto chain = std::array<uint64, 4>();
+	memcpy(chain.data(), iv, 32);
+
+	auto in = static_cast<const uchar*>(src);
+	auto out = static_cast<uchar*>(dst);
+	auto block = std::array<uint64, 2>();
+	auto written = 0;
+	for (const auto till = in + len; in != till;) {
+		memcpy(block.data(), in, kAesBlockSize);
+		const auto saved = block;
+		block[0] ^= chain[encrypt ? 0 : 2];
+		block[1] ^= chain[encrypt ? 1 : 3];
+		const auto processed = encrypt
+			? EVP_EncryptUpdate(
+				context,
+				reinterpret_cast<uchar*>(block.data()),
+				&written,
+				reinterpret_cast<const uchar*>(block.data()),
+				kAesBlockSize)
+			: EVP_DecryptUpdate(
+				context,
+				reinterpret_cast<uchar*>(block.data()),
+				&written,
+				reinterpret_cast<const uchar*>(block.data()),
+				kAesBlockSize);
+		if (processed != 1 || written != kAesBlockSize) {
+			return false;
+		}
+		block[0] ^= chain[encrypt ? 2 : 0];
+		block[1] ^= chain[encrypt ? 3 : 1];
+		memcpy(out, block.data(), kAesBlockSize);
+		chain[0] = encrypt ? block[0] : saved[0];
+		chain[1] = encrypt ? block[1] : saved[1];
+		chain[2] = encrypt ? saved[0] : block[0];
+		chain[3] = encrypt ? saved[1] : block[1];
+		in += kAesBlockSize;
+		out += kAesBlockSize;
+	}
+	return true;
+}
+
+} // namespace
 
 AuthKey::AuthKey(Type type, DcId dcId, const Data &data)
 : _type(type)
@@ -149,6 +235,9 @@ void AuthKey::countKeyId() {
 }
 
 void aesIgeEncryptRaw(const void *src, void *dst, uint32 len, const void *key, const void *iv) {
+	if (aesIgeThroughEvp(src, dst, len, key, iv, true)) {
+		return;
+	}
 	uchar aes_key[32], aes_iv[32];
 	memcpy(aes_key, key, 32);
 	memcpy(aes_iv, iv, 32);
@@ -159,6 +248,9 @@ void aesIgeEncryptRaw(const void *src, void *dst, uint32 len, const void *key, c
 }
 
 void aesIgeDecryptRaw(const void *src, void *dst, uint32 len, const void *key, const void *iv) {
+	if (aesIgeThroughEvp(src, dst, len, key, iv, false)) {
+		return;
+	}
 	uchar aes_key[32], aes_iv[32];
 	memcpy(aes_key, key, 32);
 	memcpy(aes_iv, iv, 32);
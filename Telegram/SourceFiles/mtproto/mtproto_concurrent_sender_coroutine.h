@@ -0,0 +1,139 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include "mtproto/mtproto_concurrent_sender.h"
+#include "mtproto/mtproto_rpc_sender.h"
+
+// An opt-in coroutine layer over ConcurrentSender for toolchains built
+// with coroutine support. The request is sent eagerly when the future
+// is created and only the co_await suspends, so several futures can be
+// created first and awaited after — dependent multi-step flows pipeline
+// their requests naturally without hand-rolled callback chains.
+//
+// Everything here must be used from the thread of the sender's runner,
+// the coroutine is resumed by the response handler on that same thread.
+//
+//	CoroutineHandle MyFlow(not_null<ConcurrentSender*> sender) {
+//		auto first = CoSend(sender, MTPsome_Request(...));
+//		auto second = CoSend(sender, MTPother_Request(...));
+//		if (const auto result = co_await first) {
+//			use(*result.response);
+//		}
+//		co_await second;
+//	}
+
+#if __has_include(<coroutine>)
+#include <coroutine>
+#define MTP_SENDER_COROUTINES_SUPPORTED
+namespace MTP::details {
+namespace coro = std;
+} // namespace MTP::details
+#elif __has_include(<experimental/coroutine>)
+#include <experimental/coroutine>
+#define MTP_SENDER_COROUTINES_SUPPORTED
+namespace MTP::details {
+namespace coro = std::experimental;
+} // namespace MTP::details
+#endif
+
+#ifdef MTP_SENDER_COROUTINES_SUPPORTED
+
+namespace MTP {
+
+template <typename Response>
+struct ResponseResult {
+	std::optional<Response> response;
+	std::optional<RPCError> error;
+
+	explicit operator bool() const {
+		return response.has_value();
+	}
+};
+
+// The result of CoSend(), await it to get a ResponseResult.
+template <typename Response>
+class FutureResponse {
+public:
+	[[nodiscard]] bool await_ready() const noexcept {
+		return _state->result.response.has_value()
+			|| _state->result.error.has_value();
+	}
+	void await_suspend(details::coro::coroutine_handle<> handle) noexcept {
+		_state->waiting = handle;
+	}
+	[[nodiscard]] ResponseResult<Response> await_resume() noexcept {
+		return std::move(_state->result);
+	}
+
+private:
+	struct State {
+		ResponseResult<Response> result;
+		details::coro::coroutine_handle<> waiting;
+	};
+
+	FutureResponse() : _state(std::make_shared<State>()) {
+	}
+
+	template <typename Request>
+	friend auto CoSend(
+		not_null<ConcurrentSender*> sender,
+		Request &&request);
+
+	std::shared_ptr<State> _state;
+
+};
+
+// Return type for fire-and-forget coroutines doing request flows. The
+// coroutine starts right away and cleans itself up when it finishes.
+struct CoroutineHandle {
+	struct promise_type {
+		CoroutineHandle get_return_object() noexcept {
+			return {};
+		}
+		details::coro::suspend_never initial_suspend() noexcept {
+			return {};
+		}
+		details::coro::suspend_never final_suspend() noexcept {
+			return {};
+		}
+		void return_void() noexcept {
+		}
+		void unhandled_exception() {
+			Unexpected("Exception in MTP::CoroutineHandle coroutine.");
+		}
+	};
+};
+
+template <typename Request>
+[[nodiscard]] auto CoSend(
+		not_null<ConcurrentSender*> sender,
+		Request &&request) {
+	using Response = typename Request::ResponseType;
+
+	auto result = FutureResponse<Response>();
+	const auto state = result._state;
+	sender->request(
+		std::move(request)
+	).done([state](Response &&response) {
+		state->result.response = std::move(response);
+		if (const auto waiting = base::take(state->waiting)) {
+			waiting.resume();
+		}
+	}).fail([state](RPCError &&error) {
+		state->result.error = std::move(error);
+		if (const auto waiting = base::take(state->waiting)) {
+			waiting.resume();
+		}
+	}).send();
+	return result;
+}
+
+} // namespace MTP
+
+#endif // MTP_SENDER_COROUTINES_SUPPORTED
@@ -0,0 +1,209 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "mtproto/network_health.h"
+
+#include "settings.h"
+
+#include <QtCore/QFile>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QMutex>
+
+namespace MTP {
+namespace NetworkHealth {
+namespace {
+
+constexpr auto kSecondsWindow = 180; // Depth of the per-second graphs.
+constexpr auto kRoundTripsKept = 512;
+constexpr auto kRecentWindow = 60; // Seconds averaged for the summary.
+
+struct SecondSample {
+	int64 second = 0;
+	int64 received = 0;
+	int64 sent = 0;
+};
+
+struct DcStats {
+	int64 totalReceived = 0;
+	int64 totalSent = 0;
+	SecondSample perSecond[kSecondsWindow];
+	crl::time roundTrips[kRoundTripsKept] = { 0 };
+	int roundTripsNext = 0;
+	int roundTripsCount = 0;
+	int reconnects = 0;
+	crl::time lastReconnect = 0;
+	int floodWaits = 0;
+	int64 floodWaitSeconds = 0;
+	crl::time lastFloodWait = 0;
+};
+
+QMutex Mutex;
+base::flat_map<DcId, DcStats> Stats;
+
+[[nodiscard]] SecondSample &CurrentSecond(DcStats &stats) {
+	const auto second = int64(crl::now() / 1000);
+	auto &sample = stats.perSecond[second % kSecondsWindow];
+	if (sample.second != second) {
+		sample = SecondSample{ second };
+	}
+	return sample;
+}
+
+[[nodiscard]] crl::time Percentile(
+		const std::vector<crl::time> &sorted,
+		int percent) {
+	Expects(!sorted.empty());
+
+	const auto index = (int(sorted.size()) - 1) * percent / 100;
+	return sorted[index];
+}
+
+[[nodiscard]] QString FormatBytes(int64 bytes) {
+	if (bytes >= int64(1024 * 1024)) {
+		return qsl("%1 MB").arg(bytes / int64(1024 * 1024));
+	} else if (bytes >= 1024) {
+		return qsl("%1 KB").arg(bytes / 1024);
+	}
+	return qsl("%1 B").arg(bytes);
+}
+
+} // namespace
+
+void RecordReceived(DcId dcId, int64 bytes) {
+	QMutexLocker lock(&Mutex);
+	auto &stats = Stats[dcId];
+	stats.totalReceived += bytes;
+	CurrentSecond(stats).received += bytes;
+}
+
+void RecordSent(DcId dcId, int64 bytes) {
+	QMutexLocker lock(&Mutex);
+	auto &stats = Stats[dcId];
+	stats.totalSent += bytes;
+	CurrentSecond(stats).sent += bytes;
+}
+
+void RecordRoundTrip(DcId dcId, crl::time duration) {
+	QMutexLocker lock(&Mutex);
+	auto &stats = Stats[dcId];
+	stats.roundTrips[stats.roundTripsNext] = duration;
+	stats.roundTripsNext = (stats.roundTripsNext + 1) % kRoundTripsKept;
+	stats.roundTripsCount = std::min(
+		stats.roundTripsCount + 1,
+		kRoundTripsKept);
+}
+
+void RecordReconnect(DcId dcId) {
+	QMutexLocker lock(&Mutex);
+	auto &stats = Stats[dcId];
+	++stats.reconnects;
+	stats.lastReconnect = crl::now();
+}
+
+void RecordFloodWait(DcId dcId, int seconds) {
+	QMutexLocker lock(&Mutex);
+	auto &stats = Stats[dcId];
+	++stats.floodWaits;
+	stats.floodWaitSeconds += seconds;
+	stats.lastFloodWait = crl::now();
+}
+
+QString ReportString() {
+	auto copy = base::flat_map<DcId, DcStats>();
+	{
+		QMutexLocker lock(&Mutex);
+		copy = Stats;
+	}
+
+	const auto nowSecond = int64(crl::now() / 1000);
+	auto list = QJsonArray();
+	auto summary = qsl("Network health:");
+	for (const auto &[dcId, stats] : copy) {
+		auto series = QJsonArray();
+		auto recentReceived = int64(0);
+		auto recentSent = int64(0);
+		for (auto offset = kSecondsWindow; offset != 0; --offset) {
+			const auto second = nowSecond - offset + 1;
+			const auto &sample = stats.perSecond[second % kSecondsWindow];
+			if (sample.second != second) {
+				continue;
+			}
+			auto point = QJsonObject();
+			point["t"] = sample.second;
+			point["in"] = sample.received;
+			point["out"] = sample.sent;
+			series.append(point);
+			if (offset <= kRecentWindow) {
+				recentReceived += sample.received;
+				recentSent += sample.sent;
+			}
+		}
+
+		auto sorted = std::vector<crl::time>(
+			stats.roundTrips,
+			stats.roundTrips + stats.roundTripsCount);
+		ranges::sort(sorted);
+
+		auto entry = QJsonObject();
+		entry["dc_id"] = dcId;
+		entry["total_in"] = stats.totalReceived;
+		entry["total_out"] = stats.totalSent;
+		entry["series"] = series;
+		entry["reconnects"] = stats.reconnects;
+		entry["last_reconnect"] = stats.lastReconnect;
+		entry["flood_waits"] = stats.floodWaits;
+		entry["flood_wait_seconds"] = stats.floodWaitSeconds;
+		entry["last_flood_wait"] = stats.lastFloodWait;
+		if (!sorted.empty()) {
+			entry["rtt_p50"] = Percentile(sorted, 50);
+			entry["rtt_p95"] = Percentile(sorted, 95);
+			entry["rtt_p99"] = Percentile(sorted, 99);
+		}
+		list.append(entry);
+
+		summary += qsl("\ndc %1: in %2 (%3/s), out %4 (%5/s)"
+		).arg(dcId
+		).arg(FormatBytes(stats.totalReceived)
+		).arg(FormatBytes(recentReceived / kRecentWindow)
+		).arg(FormatBytes(stats.totalSent)
+		).arg(FormatBytes(recentSent / kRecentWindow));
+		if (!sorted.empty()) {
+			summary += qsl(", rtt %1/%2/%3 ms"
+			).arg(Percentile(sorted, 50)
+			).arg(Percentile(sorted, 95)
+			).arg(Percentile(sorted, 99));
+		}
+		if (stats.reconnects) {
+			summary += qsl(", reconnects %1").arg(stats.reconnects);
+		}
+		if (stats.floodWaits) {
+			summary += qsl(", flood waits %1 (%2 s)"
+			).arg(stats.floodWaits
+			).arg(stats.floodWaitSeconds);
+		}
+	}
+	if (copy.empty()) {
+		summary += qsl("\nno traffic recorded yet");
+	}
+
+	auto root = QJsonObject();
+	root["window_seconds"] = kSecondsWindow;
+	root["dcs"] = list;
+
+	const auto path = cWorkingDir() + qsl("network_health.json");
+	auto file = QFile(path);
+	if (file.open(QIODevice::WriteOnly)) {
+		file.write(QJsonDocument(root).toJson(QJsonDocument::Indented));
+		summary += qsl("\n\nSaved to %1").arg(path);
+	}
+	return summary;
+}
+
+} // namespace NetworkHealth
+} // namespace MTP
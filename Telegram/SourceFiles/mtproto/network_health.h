@@ -0,0 +1,30 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include "mtproto/core_types.h"
+
+namespace MTP {
+namespace NetworkHealth {
+
+// Recorders are cheap ring buffer writes guarded by a mutex, they are
+// called from the sessions threads on the hot network paths, so they
+// must never log or allocate per call.
+void RecordReceived(DcId dcId, int64 bytes);
+void RecordSent(DcId dcId, int64 bytes);
+void RecordRoundTrip(DcId dcId, crl::time duration);
+void RecordReconnect(DcId dcId);
+void RecordFloodWait(DcId dcId, int seconds);
+
+// Builds a per-DC summary (throughput, round trip percentiles,
+// reconnects, flood waits) and writes the full per-second series to
+// network_health.json in the working directory for graphing.
+[[nodiscard]] QString ReportString();
+
+} // namespace NetworkHealth
+} // namespace MTP
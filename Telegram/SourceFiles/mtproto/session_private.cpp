@@ -10,9 +10,11 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "mtproto/details/mtproto_bound_key_creator.h"
 #include "mtproto/details/mtproto_dcenter.h"
 #include "mtproto/details/mtproto_dump_to_text.h"
+#include "mtproto/details/mtproto_request_metrics.h"
 #include "mtproto/details/mtproto_rsa_public_key.h"
 #include "mtproto/session.h"
 #include "mtproto/mtproto_rpc_sender.h"
+#include "mtproto/network_health.h"
 #include "mtproto/dc_options.h"
 #include "mtproto/connection_abstract.h"
 #include "base/openssl_help.h"
@@ -152,12 +154,17 @@ void SessionPrivate::appendTestConnection(
 		DcOptions::Variants::Protocol protocol,
 		const QString &ip,
 		int port,
-		const bytes::vector &protocolSecret) {
+		const bytes::vector &protocolSecret,
+		bool lastWorking) {
 	QWriteLocker lock(&_stateMutex);
 
+	// The endpoint that won the race on this network the last time is
+	// preferred over everything else, so when it connects we don't wait
+	// for a better one.
 	const auto priority = (qthelp::is_ipv6(ip) ? 0 : 1)
 		+ (protocol == DcOptions::Variants::Tcp ? 1 : 0)
-		+ (protocolSecret.empty() ? 0 : 1);
+		+ (protocolSecret.empty() ? 0 : 1)
+		+ (lastWorking ? 4 : 0);
 	_testConnections.push_back({
 		AbstractConnection::Create(
 			_instance,
@@ -165,7 +172,10 @@ void SessionPrivate::appendTestConnection(
 			thread(),
 			protocolSecret,
 			_options->proxy),
-		priority
+		priority,
+		ip,
+		port,
+		protocol
 	});
 	const auto weak = _testConnections.back().data.get();
 	connect(weak, &AbstractConnection::error, [=](int errorCode) {
@@ -277,6 +287,7 @@ void SessionPrivate::destroyAllConnections() {
 	_waitForConnectedTimer.cancel();
 	_testConnections.clear();
 	_connection = nullptr;
+	_standbyConnection = nullptr;
 }
 
 void SessionPrivate::cdnConfigChanged() {
@@ -951,6 +962,8 @@ void SessionPrivate::connectToServer(bool afterConfig) {
 			bareDc,
 			_currentDcType,
 			_options->proxy.type != ProxyData::Type::None);
+		const auto lastWorking = _instance->dcOptions()->lastWorking(
+			bareDc);
 		const auto useIPv4 = special ? true : _options->useIPv4;
 		const auto useIPv6 = special ? false : _options->useIPv6;
 		const auto useTcp = special ? true : _options->useTcp;
@@ -974,11 +987,16 @@ void SessionPrivate::connectToServer(bool afterConfig) {
 					continue;
 				}
 				for (const auto &endpoint : variants.data[address][protocol]) {
+					const auto matchesLastWorking = lastWorking
+						&& (lastWorking->protocol == protocol)
+						&& (lastWorking->port == endpoint.port)
+						&& (lastWorking->ip == endpoint.ip);
 					appendTestConnection(
 						static_cast<Variants::Protocol>(protocol),
 						QString::fromStdString(endpoint.ip),
 						endpoint.port,
-						endpoint.secret);
+						endpoint.secret,
+						matchesLastWorking);
 				}
 			}
 		}
@@ -1025,6 +1043,8 @@ void SessionPrivate::connectToServer(bool afterConfig) {
 void SessionPrivate::restart() {
 	DEBUG_LOG(("MTP Info: restarting Connection"));
 
+	NetworkHealth::RecordReconnect(BareDcId(_shiftedDcId));
+
 	_waitForReceivedTimer.cancel();
 	_waitForConnectedTimer.cancel();
 
@@ -1058,6 +1078,7 @@ void SessionPrivate::onSentSome(uint64 size) {
 		}
 		_waitForReceivedTimer.callOnce(remain);
 	}
+	NetworkHealth::RecordSent(BareDcId(_shiftedDcId), size);
 	if (!_firstSentAt) {
 		_firstSentAt = crl::now();
 	}
@@ -1075,6 +1096,7 @@ void SessionPrivate::onReceivedSome() {
 		DEBUG_LOG(("MTP Info: response in %1ms, _waitForReceived: %2ms"
 			).arg(ms
 			).arg(_waitForReceived));
+		NetworkHealth::RecordRoundTrip(BareDcId(_shiftedDcId), ms);
 
 		if (ms > 0 && ms * 2 < _waitForReceived) {
 			_waitForReceived = qMax(ms * 2, kMinReceiveTimeout);
@@ -1125,6 +1147,14 @@ void SessionPrivate::waitReceivedFailed() {
 	if (_waitForReceived < kMaxReceiveTimeout) {
 		_waitForReceived *= 2;
 	}
+	if (promoteStandbyConnection()) {
+		const auto instance = _instance;
+		const auto shiftedDcId = _shiftedDcId;
+		InvokeQueued(instance, [=] {
+			instance->restartedByTimeout(shiftedDcId);
+		});
+		return;
+	}
 	doDisconnect();
 	if (_retryTimer.isActive()) {
 		return;
@@ -1193,6 +1223,9 @@ void SessionPrivate::handleReceived() {
 		constexpr auto kMinimalIntsCount = kExternalHeaderIntsCount + kMinimalEncryptedIntsCount;
 		auto intsCount = uint32(intsBuffer.size());
 		auto ints = intsBuffer.constData();
+		NetworkHealth::RecordReceived(
+			BareDcId(_shiftedDcId),
+			int64(intsCount) * kIntSize);
 		if ((intsCount < kMinimalIntsCount) || (intsCount > kMaxMessageLength / kIntSize)) {
 			LOG(("TCP Error: bad message received, len %1").arg(intsCount * kIntSize));
 			TCP_LOG(("TCP Error: bad message %1").arg(Logs::mb(ints, intsCount * kIntSize).str()));
@@ -1562,7 +1595,9 @@ SessionPrivate::HandleResult SessionPrivate::handleOneReceived(
 
 				// Save rpc_error for processing in the main thread.
 				QWriteLocker locker(_sessionData->haveReceivedMutex());
-				_sessionData->haveReceivedResponses().emplace(requestId, response);
+				_sessionData->haveReceivedResponses().emplace(
+					requestId,
+					std::move(response));
 			} else {
 				DEBUG_LOG(("Message Error: "
 					"such message was not sent recently %1").arg(badMsgId));
@@ -1774,9 +1809,13 @@ SessionPrivate::HandleResult SessionPrivate::handleOneReceived(
 		}
 		const auto requestId = wasSent(requestMsgId);
 		if (requestId && requestId != mtpRequestId(0xFFFFFFFF)) {
+			RequestMetrics::Instance().responded(requestId);
+
 			// Save rpc_result for processing in the main thread.
 			QWriteLocker locker(_sessionData->haveReceivedMutex());
-			_sessionData->haveReceivedResponses().emplace(requestId, response);
+			_sessionData->haveReceivedResponses().emplace(
+				requestId,
+				std::move(response));
 		} else {
 			DEBUG_LOG(("RPC Info: requestId not found for msgId %1").arg(requestMsgId));
 		}
@@ -1825,7 +1864,7 @@ SessionPrivate::HandleResult SessionPrivate::handleOneReceived(
 
 		// Notify main process about new session - need to get difference.
 		QWriteLocker locker(_sessionData->haveReceivedMutex());
-		_sessionData->haveReceivedUpdates().push_back(mtpBuffer(update));
+		_sessionData->haveReceivedUpdates().push_back(std::move(update));
 	} return HandleResult::Success;
 
 	case mtpc_pong: {
@@ -1872,7 +1911,7 @@ SessionPrivate::HandleResult SessionPrivate::handleOneReceived(
 
 		// Notify main process about the new updates.
 		QWriteLocker locker(_sessionData->haveReceivedMutex());
-		_sessionData->haveReceivedUpdates().push_back(mtpBuffer(update));
+		_sessionData->haveReceivedUpdates().push_back(std::move(update));
 	} else {
 		LOG(("Message Error: unexpected updates in dcType: %1"
 			).arg(static_cast<int>(_currentDcType)));
@@ -2041,6 +2080,7 @@ void SessionPrivate::requestsAcked(const QVector<MTPlong> &ids, bool byResponse)
 				}
 				haveSent.erase(i);
 
+				RequestMetrics::Instance().acked(requestId);
 				_ackedIds.emplace(msgId, requestId);
 				continue;
 			}
@@ -2231,7 +2271,9 @@ void SessionPrivate::onConnected(
 	} else {
 		DEBUG_LOG(("MTP Info: connection through IPv4 succeed."));
 		_waitForBetterTimer.cancel();
+		rememberLastWorking(*i);
 		_connection = std::move(i->data);
+		retainStandbyConnection();
 		_testConnections.clear();
 		checkAuthKey();
 	}
@@ -2242,6 +2284,9 @@ void SessionPrivate::onDisconnected(
 	removeTestConnection(connection);
 
 	if (_testConnections.empty()) {
+		if (promoteStandbyConnection()) {
+			return;
+		}
 		destroyAllConnections();
 		restart();
 	} else {
@@ -2267,12 +2312,94 @@ void SessionPrivate::confirmBestConnection() {
 	DEBUG_LOG(("MTP Info: can't connect through better, using %1."
 		).arg(i->data->tag()));
 
+	rememberLastWorking(*i);
 	_connection = std::move(i->data);
+	retainStandbyConnection();
 	_testConnections.clear();
 
 	checkAuthKey();
 }
 
+void SessionPrivate::rememberLastWorking(const TestConnection &test) {
+	if (test.ip.isEmpty()) {
+		// An mtproto-proxy connection has no endpoint of its own.
+		return;
+	}
+	auto endpoint = DcOptions::LastWorking();
+	endpoint.ip = test.ip.toStdString();
+	endpoint.port = test.port;
+	endpoint.protocol = test.protocol;
+	endpoint.pingTime = qint32(test.data->pingTime());
+	_instance->dcOptions()->reportLastWorking(
+		BareDcId(_shiftedDcId),
+		std::move(endpoint));
+}
+
+void SessionPrivate::retainStandbyConnection() {
+	const auto i = ranges::max_element(
+		_testConnections,
+		std::less<>(),
+		[](const TestConnection &test) {
+			return (test.data && test.data->isConnected())
+				? test.priority
+				: -1;
+		});
+	if (i == end(_testConnections)
+		|| !i->data
+		|| !i->data->isConnected()) {
+		return;
+	}
+	_standbyConnection = std::move(i->data);
+	const auto weak = _standbyConnection.get();
+	disconnect(weak, nullptr, nullptr, nullptr);
+	connect(weak, &AbstractConnection::disconnected, [=] {
+		dropStandbyConnection(weak);
+	});
+	connect(weak, &AbstractConnection::error, [=](int) {
+		dropStandbyConnection(weak);
+	});
+	DEBUG_LOG(("MTP Info: keeping connection %1 as a warm standby."
+		).arg(weak->tag()));
+}
+
+bool SessionPrivate::promoteStandbyConnection() {
+	if (!_standbyConnection || !_standbyConnection->isConnected()) {
+		return false;
+	}
+	DEBUG_LOG(("MTP Info: rotating to standby connection %1."
+		).arg(_standbyConnection->tag()));
+
+	_connection = std::move(_standbyConnection);
+	const auto weak = _connection.get();
+	disconnect(weak, nullptr, nullptr, nullptr);
+	connect(weak, &AbstractConnection::error, [=](int errorCode) {
+		onError(weak, errorCode);
+	});
+	connect(weak, &AbstractConnection::receivedSome, [=] {
+		onReceivedSome();
+	});
+	connect(weak, &AbstractConnection::disconnected, [=] {
+		onDisconnected(weak);
+	});
+	connect(weak, &AbstractConnection::syncTimeRequest, [=] {
+		InvokeQueued(_instance, [instance = _instance] {
+			instance->syncHttpUnixtime();
+		});
+	});
+	_testConnections.clear();
+	checkAuthKey();
+	return true;
+}
+
+void SessionPrivate::dropStandbyConnection(
+		not_null<AbstractConnection*> connection) {
+	if (_standbyConnection.get() == connection) {
+		DEBUG_LOG(("MTP Info: standby connection %1 died."
+			).arg(connection->tag()));
+		_standbyConnection = nullptr;
+	}
+}
+
 void SessionPrivate::removeTestConnection(
 		not_null<AbstractConnection*> connection) {
 	_testConnections.erase(
@@ -2618,6 +2745,14 @@ bool SessionPrivate::sendSecureRequest(
 	_connection->setSentEncryptedWithKeyId(_keyId);
 	_connection->sendData(std::move(packet));
 
+	if (request->requestId) {
+		RequestMetrics::Instance().sent(
+			request->requestId,
+			mtpTypeId((*request)[SerializedRequest::kMessageBodyPosition]),
+			_shiftedDcId,
+			request->lastSentTime);
+	}
+
 	if (needAnyResponse) {
 		onSentSome((prefix + fullSize) * sizeof(mtpPrime));
 	}
@@ -57,6 +57,9 @@ private:
 	struct TestConnection {
 		ConnectionPointer data;
 		int priority = 0;
+		QString ip;
+		int port = 0;
+		int protocol = 0; // DcOptions::Variants::Protocol.
 	};
 	struct SentContainer {
 		crl::time sent = 0;
@@ -96,6 +99,9 @@ private:
 	void destroyAllConnections();
 
 	void confirmBestConnection();
+	void retainStandbyConnection();
+	bool promoteStandbyConnection();
+	void dropStandbyConnection(not_null<AbstractConnection*> connection);
 	void removeTestConnection(not_null<AbstractConnection*> connection);
 	[[nodiscard]] int16 getProtocolDcId() const;
 
@@ -134,7 +140,9 @@ private:
 		DcOptions::Variants::Protocol protocol,
 		const QString &ip,
 		int port,
-		const bytes::vector &protocolSecret);
+		const bytes::vector &protocolSecret,
+		bool lastWorking = false);
+	void rememberLastWorking(const TestConnection &test);
 
 	// if badTime received - search for ids in sessionData->haveSent and sessionData->wereAcked and sync time/salt, return true if found
 	bool requestsFixTimeSalt(const QVector<MTPlong> &ids, int32 serverTime, uint64 serverSalt);
@@ -185,6 +193,11 @@ private:
 	bool _needSessionReset = false;
 
 	ConnectionPointer _connection;
+
+	// A connected runner-up is kept warm, so that when the main
+	// transport dies we can rotate to it without a full reconnect.
+	ConnectionPointer _standbyConnection;
+
 	std::vector<TestConnection> _testConnections;
 	crl::time _startedConnectingAt = 0;
 
@@ -8,16 +8,24 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "observer_peer.h"
 
 #include "base/observer.h"
+#include "base/call_delayed.h"
 #include "facades.h"
 
 namespace Notify {
 namespace {
 
+// One 60 Hz display frame. Deltas arriving within the frame merge into
+// a single coalesced update per peer before subscribers see them.
+constexpr auto kFlushPerFrameInterval = crl::time(16);
+
 using SmallUpdatesList = QVector<PeerUpdate>;
 NeverFreedPointer<SmallUpdatesList> SmallUpdates;
 using AllUpdatesList = QMap<PeerData*, PeerUpdate>;
 NeverFreedPointer<AllUpdatesList> AllUpdates;
 
+crl::time LastDelayedFlushTime = 0;
+bool DelayedFlushScheduled = false;
+
 void StartCallback() {
 	SmallUpdates.createIfNull();
 	AllUpdates.createIfNull();
@@ -71,9 +79,24 @@ void peerUpdatedDelayed(const PeerUpdate &update) {
 	}
 }
 
+void peerUpdatedSendDelayedAligned() {
+	const auto now = crl::now();
+	const auto passed = now - LastDelayedFlushTime;
+	if (passed >= kFlushPerFrameInterval) {
+		peerUpdatedSendDelayed();
+	} else if (!DelayedFlushScheduled) {
+		DelayedFlushScheduled = true;
+		base::call_delayed(kFlushPerFrameInterval - passed, [] {
+			DelayedFlushScheduled = false;
+			peerUpdatedSendDelayed();
+		});
+	}
+}
+
 void peerUpdatedSendDelayed() {
 	if (!SmallUpdates || !AllUpdates || SmallUpdates->empty()) return;
 
+	LastDelayedFlushTime = crl::now();
 	auto smallList = base::take(*SmallUpdates);
 	auto allList = base::take(*AllUpdates);
 	for (auto &update : smallList) {
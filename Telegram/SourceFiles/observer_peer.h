@@ -90,6 +90,11 @@ inline void peerUpdatedDelayed(PeerData *peer, PeerUpdate::Flags events) {
 }
 void peerUpdatedSendDelayed();
 
+// Used by the queued invokation: flushes right away if a frame already
+// passed since the last flush, otherwise waits out the rest of the
+// frame so overlapping deltas coalesce into one update per peer.
+void peerUpdatedSendDelayedAligned();
+
 class PeerUpdatedHandler {
 public:
 	template <typename Lambda>
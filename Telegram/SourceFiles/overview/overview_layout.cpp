@@ -44,6 +44,102 @@ namespace {
 
 using TextState = HistoryView::TextState;
 
+// The grid thumbnails are scaled and blurred on background threads
+// with a cap on the in-flight count, so a fling through a large media
+// tab doesn't pile work onto the main thread. Queued jobs whose cell
+// left the viewport are dropped before they are dispatched.
+constexpr auto kMaxPixPreparesInFlight = 4;
+
+auto PixPreparesInFlight = 0;
+auto PixPrepareQueue = std::deque<FnMut<void()>>();
+
+void DispatchPixPrepares() {
+	while (PixPreparesInFlight < kMaxPixPreparesInFlight
+		&& !PixPrepareQueue.empty()) {
+		auto job = std::move(PixPrepareQueue.front());
+		PixPrepareQueue.pop_front();
+
+		// Either skips right away or increments the in-flight count.
+		job();
+	}
+}
+
+void FinishPixPrepare() {
+	--PixPreparesInFlight;
+	DispatchPixPrepares();
+}
+
+// Crops the image to a square cell of the given size, optionally
+// blurring it, just as the cells were prepared synchronously before.
+[[nodiscard]] QImage PrepareGridPix(QImage img, int size, bool blur) {
+	// Blur at whichever of the two sizes is smaller, the kernel cost
+	// is proportional to the area while the blurred look of the small
+	// square is the same.
+	const auto blurBeforeScale = blur
+		&& (std::min(img.width(), img.height()) <= size);
+	if (blurBeforeScale) {
+		img = Images::prepareBlur(std::move(img));
+	}
+	if (img.width() == img.height()) {
+		if (img.width() != size) {
+			img = img.scaled(size, size, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
+		}
+	} else if (img.width() > img.height()) {
+		img = img.copy((img.width() - img.height()) / 2, 0, img.height(), img.height()).scaled(size, size, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
+	} else {
+		img = img.copy(0, (img.height() - img.width()) / 2, img.width(), img.width()).scaled(size, size, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
+	}
+	if (blur && !blurBeforeScale) {
+		img = Images::prepareBlur(std::move(img));
+	}
+	img.setDevicePixelRatio(cRetinaFactor());
+	return img;
+}
+
+void EnqueuePixPrepare(
+		std::weak_ptr<bool> guard,
+		QImage image,
+		int size,
+		bool blur,
+		Fn<void(QImage&&)> done) {
+	PixPrepareQueue.push_back([=, img = std::move(image)]() mutable {
+		if (guard.expired()) {
+			// The cell left the viewport before the work started.
+			return;
+		}
+		++PixPreparesInFlight;
+		crl::async([=, img = std::move(img)]() mutable {
+			auto ready = PrepareGridPix(std::move(img), size, blur);
+			crl::on_main([=, ready = std::move(ready)]() mutable {
+				FinishPixPrepare();
+				if (!guard.expired()) {
+					done(std::move(ready));
+				}
+			});
+		});
+	});
+	DispatchPixPrepares();
+}
+
+// Many items in these lists share their short strings - dates, file
+// sizes, durations - so the measured widths are interned in one cache
+// instead of being remeasured for every item on each relayout.
+constexpr auto kInternedWidthsLimit = 4096;
+
+[[nodiscard]] int InternedStatusWidth(const QString &text) {
+	static auto Widths = base::flat_map<QString, int>();
+	if (Widths.size() >= kInternedWidthsLimit) {
+		Widths.clear();
+	}
+	const auto i = Widths.find(text);
+	if (i != Widths.end()) {
+		return i->second;
+	}
+	const auto result = st::normalFont->width(text);
+	Widths.emplace(text, result);
+	return result;
+}
+
 TextParseOptions _documentNameOptions = {
 	TextParseMultiline | TextParseRichText | TextParseLinks | TextParseMarkdown, // flags
 	0, // maxw
@@ -285,6 +381,7 @@ void StatusText::update(int newSize, int fullSize, int duration, crl::time realD
 	} else {
 		_text = formatPlayedText(-_size - 1, realDuration);
 	}
+	_textWidth = InternedStatusWidth(_text);
 }
 
 void StatusText::setSize(int newSize) {
@@ -321,26 +418,7 @@ int32 Photo::resizeGetHeight(int32 width) {
 
 void Photo::paint(Painter &p, const QRect &clip, TextSelection selection, const PaintContext *context) {
 	const auto selected = (selection == FullSelection);
-	const auto widthChanged = _pix.width() != _width * cIntRetinaFactor();
-	if (!_goodLoaded || widthChanged) {
-		ensureDataMediaCreated();
-		const auto good = _dataMedia->loaded()
-			|| (_dataMedia->image(Data::PhotoSize::Thumbnail) != nullptr);
-		if ((good && !_goodLoaded) || widthChanged) {
-			_goodLoaded = good;
-			_pix = QPixmap();
-			if (_goodLoaded) {
-				setPixFrom(_dataMedia->image(Data::PhotoSize::Large)
-					? _dataMedia->image(Data::PhotoSize::Large)
-					: _dataMedia->image(Data::PhotoSize::Thumbnail));
-			} else if (const auto small = _dataMedia->image(
-					Data::PhotoSize::Small)) {
-				setPixFrom(small);
-			} else if (const auto blurred = _dataMedia->thumbnailInline()) {
-				setPixFrom(blurred);
-			}
-		}
-	}
+	validatePix();
 
 	if (_pix.isNull()) {
 		p.fillRect(0, 0, _width, _height, st::overviewPhotoBg);
@@ -357,31 +435,68 @@ void Photo::paint(Painter &p, const QRect &clip, TextSelection selection, const
 	paintCheckbox(p, { checkLeft, checkTop }, selected, context);
 }
 
-void Photo::setPixFrom(not_null<Image*> image) {
-	const auto size = _width * cIntRetinaFactor();
-	auto img = image->original();
-	if (!_goodLoaded) {
-		img = Images::prepareBlur(std::move(img));
+void Photo::validatePix() {
+	if (!_width) {
+		return;
 	}
-	if (img.width() == img.height()) {
-		if (img.width() != size) {
-			img = img.scaled(size, size, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
+	const auto widthChanged = _pix.width() != _width * cIntRetinaFactor();
+	if (!_goodLoaded || widthChanged) {
+		ensureDataMediaCreated();
+		const auto good = _dataMedia->loaded()
+			|| (_dataMedia->image(Data::PhotoSize::Thumbnail) != nullptr);
+		if ((good && !_goodLoaded) || widthChanged) {
+			const auto image = good
+				? (_dataMedia->image(Data::PhotoSize::Large)
+					? _dataMedia->image(Data::PhotoSize::Large)
+					: _dataMedia->image(Data::PhotoSize::Thumbnail))
+				: (_dataMedia->image(Data::PhotoSize::Small)
+					? _dataMedia->image(Data::PhotoSize::Small)
+					: _dataMedia->thumbnailInline());
+			if (image) {
+				startPixPrepare(image, good);
+			}
 		}
-	} else if (img.width() > img.height()) {
-		img = img.copy((img.width() - img.height()) / 2, 0, img.height(), img.height()).scaled(size, size, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
-	} else {
-		img = img.copy(0, (img.height() - img.width()) / 2, img.width(), img.width()).scaled(size, size, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
 	}
-	img.setDevicePixelRatio(cRetinaFactor());
+}
 
-	// In case we have inline thumbnail we can unload all images and we still
-	// won't get a blank image in the media viewer when the photo is opened.
-	if (!_data->inlineThumbnailBytes().isEmpty()) {
-		_dataMedia = nullptr;
-		delegate()->unregisterHeavyItem(this);
+void Photo::startPixPrepare(not_null<Image*> image, bool good) {
+	const auto size = _width * cIntRetinaFactor();
+	if (_pixRequestedSize == size && _pixRequestedGood == good) {
+		return;
 	}
+	_pixRequestedSize = size;
+	_pixRequestedGood = good;
+	if (!_pixGuard) {
+		_pixGuard = std::make_shared<bool>(true);
+	}
+	const auto that = this;
+	EnqueuePixPrepare(
+		_pixGuard,
+		image->original(),
+		size,
+		!good,
+		[=](QImage &&ready) { that->pixPrepared(std::move(ready), size, good); });
+}
+
+void Photo::pixPrepared(QImage &&image, int size, bool good) {
+	_pixRequestedSize = 0;
+	if (size == _width * cIntRetinaFactor()) {
+		_pix = App::pixmapFromImageInPlace(std::move(image));
+		_goodLoaded = good;
+
+		// In case we have inline thumbnail we can unload all images
+		// and we still won't get a blank image in the media viewer
+		// when the photo is opened.
+		if (!_data->inlineThumbnailBytes().isEmpty()) {
+			_dataMedia = nullptr;
+			delegate()->unregisterHeavyItem(this);
+		}
+	}
+	parent()->history()->session().data().requestItemRepaint(parent());
+}
 
-	_pix = App::pixmapFromImageInPlace(std::move(img));
+void Photo::prefetch() {
+	validatePix();
 }
 
 void Photo::ensureDataMediaCreated() const {
@@ -398,6 +513,10 @@ void Photo::ensureDataMediaCreated() const {
 
 void Photo::clearHeavyPart() {
 	_dataMedia = nullptr;
+
+	// Cancels the queued and in-flight pix prepares for this cell.
+	_pixGuard = nullptr;
+	_pixRequestedSize = 0;
 }
 
 TextState Photo::getState(
@@ -415,7 +534,8 @@ Video::Video(
 	not_null<DocumentData*> video)
 : RadialProgressItem(delegate, parent)
 , _data(video)
-, _duration(formatDurationText(_data->getDuration())) {
+, _duration(formatDurationText(_data->getDuration()))
+, _durationw(InternedStatusWidth(_duration)) {
 	setDocumentLinks(_data);
 	_data->loadThumbnail(parent->fullId());
 }
@@ -437,9 +557,6 @@ void Video::paint(Painter &p, const QRect &clip, TextSelection selection, const
 	ensureDataMediaCreated();
 
 	const auto selected = (selection == FullSelection);
-	const auto blurred = _dataMedia->thumbnailInline();
-	const auto thumbnail = _dataMedia->thumbnail();
-	const auto good = _dataMedia->goodThumbnail();
 
 	bool loaded = dataLoaded(), displayLoading = _data->displayLoading();
 	if (displayLoading) {
@@ -452,29 +569,7 @@ void Video::paint(Painter &p, const QRect &clip, TextSelection selection, const
 	const auto radial = isRadialAnimation();
 	const auto radialOpacity = radial ? _radial->opacity() : 0.;
 
-	if ((blurred || thumbnail || good)
-		&& ((_pix.width() != _width * cIntRetinaFactor())
-			|| (_pixBlurred && (thumbnail || good)))) {
-		auto size = _width * cIntRetinaFactor();
-		auto img = good
-			? good->original()
-			: thumbnail
-			? thumbnail->original()
-			: Images::prepareBlur(blurred->original());
-		if (img.width() == img.height()) {
-			if (img.width() != size) {
-				img = img.scaled(size, size, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
-			}
-		} else if (img.width() > img.height()) {
-			img = img.copy((img.width() - img.height()) / 2, 0, img.height(), img.height()).scaled(size, size, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
-		} else {
-			img = img.copy(0, (img.height() - img.width()) / 2, img.width(), img.width()).scaled(size, size, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
-		}
-		img.setDevicePixelRatio(cRetinaFactor());
-
-		_pix = App::pixmapFromImageInPlace(std::move(img));
-		_pixBlurred = !(thumbnail || good);
-	}
+	validatePix();
 
 	if (_pix.isNull()) {
 		p.fillRect(0, 0, _width, _height, st::overviewPhotoBg);
@@ -496,7 +591,8 @@ void Video::paint(Painter &p, const QRect &clip, TextSelection selection, const
 			const auto margin = st::overviewVideoStatusMargin;
 			const auto padding = st::overviewVideoStatusPadding;
 			const auto statusX = margin + padding.x(), statusY = _height - margin - padding.y() - st::normalFont->height;
-			const auto statusW = icon.width() + padding.x() + st::normalFont->width(text) + 2 * padding.x();
+			const auto textW = download ? _status.textWidth() : _durationw;
+			const auto statusW = icon.width() + padding.x() + textW + 2 * padding.x();
 			const auto statusH = st::normalFont->height + 2 * padding.y();
 			p.setOpacity(1. - radialOpacity);
 			App::roundRect(p, statusX - padding.x(), statusY - padding.y(), statusW, statusH, selected ? st::msgDateImgBgSelected : st::msgDateImgBg, selected ? OverviewVideoSelectedCorners : OverviewVideoCorners);
@@ -551,8 +647,60 @@ void Video::ensureDataMediaCreated() const {
 	delegate()->registerHeavyItem(this);
 }
 
+void Video::validatePix() {
+	if (!_width) {
+		return;
+	}
+	ensureDataMediaCreated();
+	const auto blurred = _dataMedia->thumbnailInline();
+	const auto thumbnail = _dataMedia->thumbnail();
+	const auto good = _dataMedia->goodThumbnail();
+	if ((blurred || thumbnail || good)
+		&& ((_pix.width() != _width * cIntRetinaFactor())
+			|| (_pixBlurred && (thumbnail || good)))) {
+		const auto image = good ? good : thumbnail ? thumbnail : blurred;
+		startPixPrepare(image, !(thumbnail || good));
+	}
+}
+
+void Video::startPixPrepare(not_null<Image*> image, bool blur) {
+	const auto size = _width * cIntRetinaFactor();
+	if (_pixRequestedSize == size && _pixRequestedBlur == blur) {
+		return;
+	}
+	_pixRequestedSize = size;
+	_pixRequestedBlur = blur;
+	if (!_pixGuard) {
+		_pixGuard = std::make_shared<bool>(true);
+	}
+	const auto that = this;
+	EnqueuePixPrepare(
+		_pixGuard,
+		image->original(),
+		size,
+		blur,
+		[=](QImage &&ready) { that->pixPrepared(std::move(ready), size, blur); });
+}
+
+void Video::pixPrepared(QImage &&image, int size, bool blur) {
+	_pixRequestedSize = 0;
+	if (size == _width * cIntRetinaFactor()) {
+		_pix = App::pixmapFromImageInPlace(std::move(image));
+		_pixBlurred = blur;
+	}
+	parent()->history()->session().data().requestItemRepaint(parent());
+}
+
+void Video::prefetch() {
+	validatePix();
+}
+
 void Video::clearHeavyPart() {
 	_dataMedia = nullptr;
+
+	// Cancels the queued and in-flight pix prepares for this cell.
+	_pixGuard = nullptr;
+	_pixRequestedSize = 0;
 }
 
 float64 Video::dataProgress() const {
@@ -755,7 +903,7 @@ void Voice::paint(Painter &p, const QRect &clip, TextSelection selection, const
 			p.restoreTextPalette();
 			unreadx += _details.maxWidth();
 		} else {
-			int32 statusw = st::normalFont->width(_status.text());
+			int32 statusw = _status.textWidth();
 			p.drawTextLeft(nameleft, statustop, _width, _status.text(), statusw);
 			unreadx += statusw;
 		}
@@ -926,7 +1074,7 @@ Document::Document(
 , _namel(std::make_shared<DocumentOpenClickHandler>(_data, parent->fullId()))
 , _st(st)
 , _date(langDateTime(base::unixtime::parse(_data->date)))
-, _datew(st::normalFont->width(_date))
+, _datew(InternedStatusWidth(_date))
 , _colorIndex(documentColorIndex(_data, _ext)) {
 	_name.setMarkedText(st::defaultTextStyle, ComposeNameWithEntities(_data), _documentNameOptions);
 
@@ -1128,7 +1276,12 @@ void Document::paint(Painter &p, const QRect &clip, TextSelection selection, con
 	if (clip.intersects(style::rtlrect(nameleft, statustop, availwidth, st::normalFont->height, _width))) {
 		p.setFont(st::normalFont);
 		p.setPen((isSong && selected) ? st::mediaInFgSelected : st::mediaInFg);
-		p.drawTextLeft(nameleft, statustop, _width, _status.text());
+		p.drawTextLeft(
+			nameleft,
+			statustop,
+			_width,
+			_status.text(),
+			_status.textWidth());
 	}
 	if (datetop >= 0 && clip.intersects(style::rtlrect(nameleft, datetop, _datew, st::normalFont->height, _width))) {
 		p.setFont(ClickHandler::showAsActive(_msgl) ? st::normalFont->underline() : st::normalFont);
@@ -1740,7 +1893,7 @@ const style::RoundCheckbox &Link::checkboxStyle() const {
 
 Link::LinkEntry::LinkEntry(const QString &url, const QString &text)
 : text(text)
-, width(st::normalFont->width(text))
+, width(InternedStatusWidth(text))
 , lnk(UrlClickHandler::IsSuspicious(url)
 	? std::make_shared<HiddenUrlClickHandler>(url)
 	: std::make_shared<UrlClickHandler>(url)) {
@@ -69,6 +69,11 @@ public:
 
 	void invalidateCache();
 
+	// Starts preparing the cell thumbnail before the cell gets on the
+	// screen, so scrolling lands on ready pixmaps.
+	virtual void prefetch() {
+	}
+
 	virtual void clearHeavyPart() {
 	}
 
@@ -158,6 +163,11 @@ public:
 		return _text;
 	}
 
+	// Measured when the text is composed, so the paints don't have to.
+	int textWidth() const {
+		return _textWidth;
+	}
+
 private:
 	// >= 0 will contain download / upload string, _size = loaded bytes
 	// < 0 will contain played string, _size = -(seconds + 1) played
@@ -165,6 +175,7 @@ private:
 	// 0x7FFFFFF1 will contain status for already downloaded file
 	// 0x7FFFFFF2 will contain status for failed to download / upload file
 	int _size = 0;
+	int _textWidth = 0;
 	QString _text;
 
 };
@@ -187,17 +198,23 @@ public:
 		QPoint point,
 		StateRequest request) const override;
 
+	void prefetch() override;
 	void clearHeavyPart() override;
 
 private:
 	void ensureDataMediaCreated() const;
-	void setPixFrom(not_null<Image*> image);
+	void validatePix();
+	void startPixPrepare(not_null<Image*> image, bool good);
+	void pixPrepared(QImage &&image, int size, bool good);
 
 	const not_null<PhotoData*> _data;
 	mutable std::shared_ptr<Data::PhotoMedia> _dataMedia;
 	ClickHandlerPtr _link;
 
 	QPixmap _pix;
+	std::shared_ptr<bool> _pixGuard;
+	int _pixRequestedSize = 0;
+	bool _pixRequestedGood = false;
 	bool _goodLoaded = false;
 
 };
@@ -217,6 +234,7 @@ public:
 		QPoint point,
 		StateRequest request) const override;
 
+	void prefetch() override;
 	void clearHeavyPart() override;
 
 protected:
@@ -228,13 +246,20 @@ protected:
 private:
 	void ensureDataMediaCreated() const;
 	void updateStatusText();
+	void validatePix();
+	void startPixPrepare(not_null<Image*> image, bool blur);
+	void pixPrepared(QImage &&image, int size, bool blur);
 
 	const not_null<DocumentData*> _data;
 	mutable std::shared_ptr<Data::DocumentMedia> _dataMedia;
 	StatusText _status;
 
 	QString _duration;
+	int _durationw = 0;
 	QPixmap _pix;
+	std::shared_ptr<bool> _pixGuard;
+	int _pixRequestedSize = 0;
+	bool _pixRequestedBlur = false;
 	bool _pixBlurred = true;
 
 };
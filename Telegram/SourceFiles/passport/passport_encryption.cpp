@@ -87,6 +87,33 @@ bytes::vector Encrypt(
 	return EncryptOrDecrypt(decrypted, std::move(params), AES_ENCRYPT);
 }
 
+// AES_cbc_encrypt allows equal input and output buffers, so the data
+// is encrypted without allocating a second full-size copy of the file.
+void EncryptInPlace(bytes::span data, AesParams &&params) {
+	Expects((data.size() & 0x0F) == 0);
+	Expects(params.key.size() == kAesKeyLength);
+	Expects(params.iv.size() == kAesIvLength);
+
+	auto aesKey = AES_KEY();
+	const auto error = AES_set_encrypt_key(
+		reinterpret_cast<const uchar*>(params.key.data()),
+		params.key.size() * CHAR_BIT,
+		&aesKey);
+	if (error != 0) {
+		LOG(("App Error: Could not AES_set_encrypt_key, result %1"
+			).arg(error));
+		bytes::set_with_const(data, gsl::byte());
+		return;
+	}
+	AES_cbc_encrypt(
+		reinterpret_cast<const uchar*>(data.data()),
+		reinterpret_cast<uchar*>(data.data()),
+		data.size(),
+		&aesKey,
+		reinterpret_cast<uchar*>(params.iv.data()),
+		AES_ENCRYPT);
+}
+
 bytes::vector Decrypt(
 		bytes::const_span encrypted,
 		AesParams &&params) {
@@ -353,10 +380,11 @@ EncryptedData EncryptData(
 		dataHash);
 
 	auto params = PrepareAesParams(bytesForEncryptionKey);
+	EncryptInPlace(unencrypted, std::move(params));
 	return {
 		{ dataSecret.begin(), dataSecret.end() },
 		{ dataHash.begin(), dataHash.end() },
-		Encrypt(unencrypted, std::move(params))
+		std::move(unencrypted)
 	};
 }
 
@@ -1432,10 +1432,11 @@ void FormController::encryptFile(
 		fileId = file.fields.id,
 		bytes = std::move(content),
 		fileSecret = file.fields.secret
-	] {
+	]() mutable {
 		auto data = EncryptData(
 			bytes::make_span(bytes),
 			fileSecret);
+		bytes = QByteArray();
 		auto result = UploadScanData();
 		result.fileId = fileId;
 		result.hash = std::move(data.hash);
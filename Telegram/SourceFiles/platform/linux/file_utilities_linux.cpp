@@ -283,16 +283,16 @@ GtkDialog *QGtkDialog::gtkDialog() const {
 }
 
 void QGtkDialog::exec() {
-	if (modality() == Qt::ApplicationModal) {
-		// block input to the whole app, including other GTK dialogs
-		Libs::gtk_dialog_run(gtkDialog());
-	} else {
-		// block input to the window, allow input to other GTK dialogs
-		QEventLoop loop;
-		connect(this, SIGNAL(accept()), &loop, SLOT(quit()));
-		connect(this, SIGNAL(reject()), &loop, SLOT(quit()));
-		loop.exec();
-	}
+	// Input is already blocked according to the modality by show():
+	// the Qt side through showModalWindow() and the X side through the
+	// modal hint. gtk_dialog_run() is not used even for the application
+	// modal case because it spins the GTK main loop and starves our
+	// timers and sockets, freezing MTP and animations for as long as
+	// the dialog stays up.
+	QEventLoop loop;
+	connect(this, SIGNAL(accept()), &loop, SLOT(quit()));
+	connect(this, SIGNAL(reject()), &loop, SLOT(quit()));
+	loop.exec();
 }
 
 void QGtkDialog::show(Qt::WindowFlags flags, Qt::WindowModality modality, QWindow *parent) {
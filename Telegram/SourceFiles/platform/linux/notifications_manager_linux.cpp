@@ -538,26 +538,40 @@ void Manager::Private::showNotification(
 		hideReplyButton);
 
 	if (!hideNameAndPhoto) {
+		// The userpic file is prepared on a worker thread, the DBus
+		// handoff happens back on the main thread when it is ready.
 		const auto key = peer->userpicUniqueKey(userpicView);
-		notification->setImage(_cachedUserpics.get(key, peer, userpicView));
+		const auto peerId = peer->id;
+		_cachedUserpics.getAsync(key, peer, userpicView, [=](
+				const QString &path) {
+			notification->setImage(path);
+			performShow(notification, peerId, msgId);
+		});
+	} else {
+		performShow(notification, peer->id, msgId);
 	}
+}
 
-	auto i = _notifications.find(peer->id);
+void Manager::Private::performShow(
+		Notification notification,
+		PeerId peerId,
+		MsgId msgId) {
+	auto i = _notifications.find(peerId);
 	if (i != _notifications.cend()) {
 		auto j = i->find(msgId);
 		if (j != i->cend()) {
 			auto oldNotification = j.value();
 			i->erase(j);
 			oldNotification->close();
-			i = _notifications.find(peer->id);
+			i = _notifications.find(peerId);
 		}
 	}
 	if (i == _notifications.cend()) {
-		i = _notifications.insert(peer->id, QMap<MsgId, Notification>());
+		i = _notifications.insert(peerId, QMap<MsgId, Notification>());
 	}
-	_notifications[peer->id].insert(msgId, notification);
+	_notifications[peerId].insert(msgId, notification);
 	if (!notification->show()) {
-		i = _notifications.find(peer->id);
+		i = _notifications.find(peerId);
 		if (i != _notifications.cend()) {
 			i->remove(msgId);
 			if (i->isEmpty()) _notifications.erase(i);
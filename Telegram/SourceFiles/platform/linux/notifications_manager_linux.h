@@ -127,6 +127,11 @@ public:
 	~Private();
 
 private:
+	void performShow(
+		Notification notification,
+		PeerId peerId,
+		MsgId msgId);
+
 	using Notifications = QMap<PeerId, QMap<MsgId, Notification>>;
 	Notifications _notifications;
 
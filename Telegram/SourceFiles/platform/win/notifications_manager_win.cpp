@@ -359,6 +359,14 @@ public:
 	~Private();
 
 private:
+	bool performShow(
+		not_null<PeerData*> peer,
+		MsgId msgId,
+		const QString &title,
+		const QString &subtitle,
+		const QString &msg,
+		const QString &userpicPath);
+
 	Window::Notifications::CachedUserpics _cachedUserpics;
 
 	std::shared_ptr<Manager*> _guarded;
@@ -467,6 +475,25 @@ bool Manager::Private::showNotification(
 		return false;
 	}
 
+	// The userpic file is prepared on a worker thread, the WinRT toast
+	// handoff happens back on the main thread when it is ready.
+	const auto key = hideNameAndPhoto
+		? InMemoryKey()
+		: peer->userpicUniqueKey(userpicView);
+	_cachedUserpics.getAsync(key, peer, userpicView, [=](
+			const QString &userpicPath) {
+		performShow(peer, msgId, title, subtitle, msg, userpicPath);
+	});
+	return true;
+}
+
+bool Manager::Private::performShow(
+		not_null<PeerData*> peer,
+		MsgId msgId,
+		const QString &title,
+		const QString &subtitle,
+		const QString &msg,
+		const QString &userpicPath) {
 	ComPtr<IXmlDocument> toastXml;
 	bool withSubtitle = !subtitle.isEmpty();
 
@@ -480,10 +507,6 @@ bool Manager::Private::showNotification(
 	hr = SetAudioSilent(toastXml.Get());
 	if (!SUCCEEDED(hr)) return false;
 
-	const auto key = hideNameAndPhoto
-		? InMemoryKey()
-		: peer->userpicUniqueKey(userpicView);
-	const auto userpicPath = _cachedUserpics.get(key, peer, userpicView);
 	const auto userpicPathWide = QDir::toNativeSeparators(userpicPath).toStdWString();
 
 	hr = SetImageSrc(userpicPathWide.c_str(), toastXml.Get());
@@ -502,10 +502,27 @@ void SetupAnimations(not_null<Ui::VerticalLayout*> container) {
 	}, container->lifetime());
 }
 
+void SetupHardwareAcceleration(not_null<Ui::VerticalLayout*> container) {
+	AddButton(
+		container,
+		tr::lng_settings_enable_hwaccel(),
+		st::settingsButton
+	)->toggleOn(
+		rpl::single(Core::App().settings().hardwareAcceleratedVideo())
+	)->toggledValue(
+	) | rpl::filter([](bool enabled) {
+		return (enabled != Core::App().settings().hardwareAcceleratedVideo());
+	}) | rpl::start_with_next([](bool enabled) {
+		Core::App().settings().setHardwareAcceleratedVideo(enabled);
+		Core::App().saveSettingsDelayed();
+	}, container->lifetime());
+}
+
 void SetupPerformance(
 		not_null<Window::SessionController*> controller,
 		not_null<Ui::VerticalLayout*> container) {
 	SetupAnimations(container);
+	SetupHardwareAcceleration(container);
 }
 
 void SetupSystemIntegration(
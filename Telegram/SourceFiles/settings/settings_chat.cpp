@@ -721,6 +721,14 @@ void SetupStickersEmoji(
 			session->saveSettingsDelayed();
 		});
 
+	add(
+		tr::lng_settings_autoplay_gifs(tr::now),
+		session->settings().autoplayGifs(),
+		[=](bool checked) {
+			session->settings().setAutoplayGifs(checked);
+			session->saveSettingsDelayed();
+		});
+
 	AddButton(
 		container,
 		tr::lng_stickers_you_have(),
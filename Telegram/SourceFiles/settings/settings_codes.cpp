@@ -13,13 +13,23 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "mainwindow.h"
 #include "data/data_session.h"
 #include "storage/localstorage.h"
+#include "storage/cache_benchmark.h"
+#include "storage/cache_statistics.h"
 #include "boxes/confirm_box.h"
+#include "boxes/debug_console_box.h"
 #include "lang/lang_cloud_manager.h"
 #include "lang/lang_instance.h"
 #include "core/application.h"
 #include "mtproto/mtp_instance.h"
+#include "mtproto/network_health.h"
 #include "mtproto/dc_options.h"
+#include "core/alloc_stats.h"
+#include "core/dispatch_tracer.h"
 #include "core/file_utilities.h"
+#include "core/layout_benchmark.h"
+#include "core/memory_stats.h"
+#include "core/replay_script.h"
+#include "core/trace_events.h"
 #include "core/update_checker.h"
 #include "window/themes/window_theme.h"
 #include "window/themes/window_theme_editor.h"
@@ -47,6 +57,50 @@ auto GenerateCodes() {
 	codes.emplace(qsl("viewlogs"), [](SessionController *window) {
 		File::ShowInFolder(cWorkingDir() + "log.txt");
 	});
+	codes.emplace(qsl("dispatchtrace"), [](SessionController *window) {
+		Ui::show(Box<InformBox>(Core::DispatchTracer::ReportString()));
+	});
+	codes.emplace(qsl("tracestart"), [](SessionController *window) {
+		Core::TraceEvents::Start();
+		Ui::Toast::Show("Trace capture started.");
+	});
+	codes.emplace(qsl("tracestop"), [](SessionController *window) {
+		Ui::show(Box<InformBox>(Core::TraceEvents::Finish()));
+	});
+	codes.emplace(qsl("layoutbench"), [](SessionController *window) {
+		Ui::show(Box<InformBox>(Core::LayoutBenchmark::Run()));
+	});
+	codes.emplace(qsl("cachebench"), [](SessionController *window) {
+		Storage::CacheBenchmark::Run([](const QString &text) {
+			Ui::show(Box<InformBox>(text));
+		});
+	});
+	codes.emplace(qsl("console"), [](SessionController *window) {
+		if (window) {
+			Ui::show(Box<DebugConsoleBox>(window));
+		}
+	});
+	codes.emplace(qsl("cachestats"), [](SessionController *window) {
+		Ui::show(Box<InformBox>(Storage::CacheStats::ReportString()));
+	});
+	codes.emplace(qsl("replayscript"), [](SessionController *window) {
+		if (!window) {
+			return;
+		} else if (Core::ReplayScript::Run(window)) {
+			Ui::Toast::Show("Replay started.");
+		} else {
+			Ui::Toast::Show("Could not start replay, see 'log.txt'.");
+		}
+	});
+	codes.emplace(qsl("netstats"), [](SessionController *window) {
+		Ui::show(Box<InformBox>(MTP::NetworkHealth::ReportString()));
+	});
+	codes.emplace(qsl("memstats"), [](SessionController *window) {
+		Ui::show(Box<InformBox>(Core::MemoryStats::ReportString()));
+	});
+	codes.emplace(qsl("allocstats"), [](SessionController *window) {
+		Ui::show(Box<InformBox>(Core::AllocStats::ReportString()));
+	});
 	codes.emplace(qsl("testmode"), [](SessionController *window) {
 		auto text = cTestMode() ? qsl("Do you want to disable TEST mode?") : qsl("Do you want to enable TEST mode?\n\nYou will be switched to test cloud.");
 		Ui::show(Box<ConfirmBox>(text, [] {
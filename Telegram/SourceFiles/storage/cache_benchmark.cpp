@@ -0,0 +1,193 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "storage/cache_benchmark.h"
+
+#include "core/application.h"
+#include "storage/storage_databases.h"
+#include "storage/cache/storage_cache_database.h"
+#include "storage/localstorage.h"
+#include "settings.h"
+
+#include <QtCore/QFile>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+
+namespace Storage {
+namespace CacheBenchmark {
+namespace {
+
+constexpr auto kKeyHigh = quint64(0xBE4CBE4CBE4CBE4CULL);
+constexpr auto kKeys = 2048;
+constexpr auto kReadOps = 2048;
+constexpr auto kPresenceSample = 256;
+
+// Small enough that the write phase overflows it several times over,
+// so the soak exercises compaction and eviction, not just appends.
+constexpr auto kSoakSizeLimit = qint64(16 * 1024 * 1024);
+constexpr auto kMaxValueSize = 64 * 1024;
+
+struct State {
+	std::shared_ptr<Cache::Database> db;
+	std::vector<qint64> issued;
+	std::vector<qint64> latencies;
+	quint64 seed = 1;
+	qint64 writeStart = 0;
+	qint64 writeTime = 0;
+	qint64 readsTime = 0;
+	int remaining = 0;
+	int present = 0;
+	Fn<void(QString)> done;
+};
+
+[[nodiscard]] int ValueSize(int index) {
+	switch (index % 3) {
+	case 0: return 1024;
+	case 1: return 16 * 1024;
+	}
+	return kMaxValueSize;
+}
+
+[[nodiscard]] QByteArray MakeValue(int index) {
+	auto result = QByteArray(ValueSize(index), Qt::Uninitialized);
+	for (auto i = 0, size = result.size(); i != size; ++i) {
+		result[i] = char((index + i) & 0xFF);
+	}
+	return result;
+}
+
+[[nodiscard]] quint64 Next(not_null<State*> state) {
+	state->seed = state->seed * 6364136223846793005ULL
+		+ 1442695040888963407ULL;
+	return state->seed;
+}
+
+[[nodiscard]] qint64 Percentile(
+		const std::vector<qint64> &sorted,
+		int percent) {
+	Expects(!sorted.empty());
+
+	const auto index = (int(sorted.size()) - 1) * percent / 100;
+	return sorted[index];
+}
+
+void Finish(std::shared_ptr<State> state) {
+	auto sorted = state->latencies;
+	ranges::sort(sorted);
+
+	auto root = QJsonObject();
+	root["keys"] = kKeys;
+	root["read_ops"] = kReadOps;
+	root["size_limit"] = kSoakSizeLimit;
+	root["write_drain_profile_units"] = state->writeTime;
+	root["reads_profile_units"] = state->readsTime;
+	root["read_p50"] = Percentile(sorted, 50);
+	root["read_p95"] = Percentile(sorted, 95);
+	root["read_p99"] = Percentile(sorted, 99);
+	root["read_max"] = sorted.back();
+	root["present_of_sample"] = state->present;
+	root["presence_sample"] = kPresenceSample;
+
+	const auto path = cWorkingDir() + qsl("cache_benchmark.json");
+	auto file = QFile(path);
+	if (file.open(QIODevice::WriteOnly)) {
+		file.write(QJsonDocument(root).toJson(QJsonDocument::Indented));
+	}
+
+	const auto summary = qsl(
+		"Cache benchmark:\n"
+		"write+drain %1, reads %2\n"
+		"read p50 %3 / p95 %4 / p99 %5 / max %6\n"
+		"evicted %7 of %8 sampled keys\n\nSaved to %9"
+	).arg(state->writeTime
+	).arg(state->readsTime
+	).arg(Percentile(sorted, 50)
+	).arg(Percentile(sorted, 95)
+	).arg(Percentile(sorted, 99)
+	).arg(sorted.back()
+	).arg(kPresenceSample - state->present
+	).arg(kPresenceSample
+	).arg(path);
+
+	state->db->clear();
+	state->done(summary);
+}
+
+// Counts how many of a key sample survived the soak: the write phase
+// overflows the size limit, so a healthy database must have evicted
+// most of the older entries by now.
+void ProbePresence(std::shared_ptr<State> state) {
+	state->remaining = kPresenceSample;
+	for (auto i = 0; i != kPresenceSample; ++i) {
+		const auto index = quint64(i) * kKeys / kPresenceSample;
+		state->db->get(Cache::Key{ kKeyHigh, index }, [=](QByteArray value) {
+			if (!value.isEmpty()) {
+				++state->present;
+			}
+			if (!--state->remaining) {
+				Finish(state);
+			}
+		});
+	}
+}
+
+void RunReads(std::shared_ptr<State> state) {
+	const auto readsStart = qint64(crl::profile());
+	state->remaining = kReadOps;
+	state->issued.resize(kReadOps);
+	state->latencies.reserve(kReadOps);
+	for (auto i = 0; i != kReadOps; ++i) {
+		const auto index = Next(state.get()) % kKeys;
+		state->issued[i] = qint64(crl::profile());
+		state->db->get(Cache::Key{ kKeyHigh, index }, [=](QByteArray) {
+			state->latencies.push_back(
+				qint64(crl::profile()) - state->issued[i]);
+			if (!--state->remaining) {
+				state->readsTime = qint64(crl::profile()) - readsStart;
+				ProbePresence(state);
+			}
+		});
+	}
+}
+
+void RunWrites(std::shared_ptr<State> state) {
+	state->writeStart = qint64(crl::profile());
+	for (auto i = 0; i != kKeys; ++i) {
+		state->db->put(
+			Cache::Key{ kKeyHigh, quint64(i) },
+			Cache::Database::TaggedValue(MakeValue(i), 1));
+	}
+	// The database processes requests in order, so a get queued after
+	// all the puts completes only once the write queue drained.
+	state->db->get(
+		Cache::Key{ kKeyHigh, quint64(kKeys - 1) },
+		[=](QByteArray) {
+			state->writeTime = qint64(crl::profile()) - state->writeStart;
+			RunReads(state);
+		});
+}
+
+} // namespace
+
+void Run(Fn<void(QString)> done) {
+	auto settings = Cache::Database::Settings();
+	settings.clearOnWrongKey = true;
+	settings.totalSizeLimit = kSoakSizeLimit;
+	settings.maxDataSize = kMaxValueSize;
+
+	const auto state = std::make_shared<State>();
+	state->done = std::move(done);
+	state->db = Core::App().databases().get(
+		cWorkingDir() + qsl("cache_bench"),
+		settings);
+	state->db->open(Local::cacheKey());
+	state->db->clear();
+	RunWrites(state);
+}
+
+} // namespace CacheBenchmark
+} // namespace Storage
@@ -0,0 +1,20 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+namespace Storage {
+namespace CacheBenchmark {
+
+// Runs a write / read / eviction soak against a dedicated cache
+// database in the working directory (the user caches are untouched),
+// writes the timings as JSON to cache_benchmark.json and reports a
+// short summary through |done| on the main thread.
+void Run(Fn<void(QString)> done);
+
+} // namespace CacheBenchmark
+} // namespace Storage
@@ -0,0 +1,190 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "storage/cache_statistics.h"
+
+#include "storage/cache/storage_cache_types.h"
+#include "data/data_types.h"
+#include "base/timer.h"
+#include "settings.h"
+
+#include <QtCore/QFile>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+
+#include <atomic>
+
+namespace Storage {
+namespace CacheStats {
+namespace {
+
+constexpr auto kClassCount = 7; // Keep in sync with the Class enum.
+
+// One summary line per day is enough to size cache limits from logs.
+constexpr auto kSummaryEach = 24 * 60 * 60 * crl::time(1000);
+
+// Remembering more keys than this stops the eviction tracking instead
+// of growing without a bound, a video-heavy day stays under the limit.
+constexpr auto kKnownKeysLimit = 64 * 1024;
+
+struct Counters {
+	std::atomic<int64> hits = 0;
+	std::atomic<int64> hitBytes = 0;
+	std::atomic<int64> misses = 0;
+	std::atomic<int64> evictions = 0;
+	std::atomic<int64> puts = 0;
+	std::atomic<int64> putBytes = 0;
+};
+
+Counters ByClass[kClassCount];
+
+QMutex KnownKeysMutex;
+base::flat_set<uint64> KnownKeys;
+
+[[nodiscard]] const char *ClassName(Class which) {
+	switch (which) {
+	case Class::Images: return "images";
+	case Class::Stickers: return "stickers";
+	case Class::Voice: return "voice";
+	case Class::RoundVideo: return "round_video";
+	case Class::Animations: return "animations";
+	case Class::VideoSlices: return "video_slices";
+	case Class::Other: return "other";
+	}
+	Unexpected("Class in Storage::CacheStats::ClassName.");
+}
+
+[[nodiscard]] Counters &For(Class which) {
+	return ByClass[static_cast<int>(which)];
+}
+
+[[nodiscard]] uint64 HashKey(const Cache::Key &key) {
+	return key.high ^ (key.low * 0x9E3779B97F4A7C15ULL);
+}
+
+void RememberKey(const Cache::Key &key) {
+	QMutexLocker lock(&KnownKeysMutex);
+	if (KnownKeys.size() < kKnownKeysLimit) {
+		KnownKeys.emplace(HashKey(key));
+	}
+}
+
+[[nodiscard]] bool ForgetKnownKey(const Cache::Key &key) {
+	QMutexLocker lock(&KnownKeysMutex);
+	return KnownKeys.remove(HashKey(key));
+}
+
+[[nodiscard]] QString SummaryLine() {
+	auto result = qsl("Cache Stats:");
+	for (auto i = 0; i != kClassCount; ++i) {
+		const auto &counters = ByClass[i];
+		const auto hits = counters.hits.load();
+		const auto misses = counters.misses.load();
+		if (!hits && !misses && !counters.puts.load()) {
+			continue;
+		}
+		result += qsl(" %1 %2/%3/%4 (hit/miss/evicted) %5 MB read;"
+		).arg(ClassName(static_cast<Class>(i))
+		).arg(hits
+		).arg(misses
+		).arg(counters.evictions.load()
+		).arg(counters.hitBytes.load() / int64(1024 * 1024));
+	}
+	return result;
+}
+
+} // namespace
+
+Class ClassByTag(uint8 tag) {
+	switch (tag) {
+	case Data::kImageCacheTag: return Class::Images;
+	case Data::kStickerCacheTag: return Class::Stickers;
+	case Data::kVoiceMessageCacheTag: return Class::Voice;
+	case Data::kVideoMessageCacheTag: return Class::RoundVideo;
+	case Data::kAnimationCacheTag: return Class::Animations;
+	}
+	return Class::Other;
+}
+
+void RecordGet(Class which, const Cache::Key &key, int64 resultSize) {
+	auto &counters = For(which);
+	if (resultSize > 0) {
+		++counters.hits;
+		counters.hitBytes += resultSize;
+		RememberKey(key);
+	} else {
+		++counters.misses;
+		if (ForgetKnownKey(key)) {
+			++counters.evictions;
+		}
+	}
+}
+
+void RecordPut(Class which, const Cache::Key &key, int64 valueSize) {
+	auto &counters = For(which);
+	++counters.puts;
+	counters.putBytes += valueSize;
+	RememberKey(key);
+}
+
+QString ReportString() {
+	auto classes = QJsonArray();
+	auto summary = qsl("Cache usage since launch:");
+	for (auto i = 0; i != kClassCount; ++i) {
+		const auto &counters = ByClass[i];
+		const auto name = QString(ClassName(static_cast<Class>(i)));
+		const auto hits = counters.hits.load();
+		const auto misses = counters.misses.load();
+		const auto lookups = hits + misses;
+
+		auto object = QJsonObject();
+		object["class"] = name;
+		object["hits"] = hits;
+		object["misses"] = misses;
+		object["evictions_observed"] = counters.evictions.load();
+		object["puts"] = counters.puts.load();
+		object["read_bytes"] = counters.hitBytes.load();
+		object["written_bytes"] = counters.putBytes.load();
+		classes.append(object);
+
+		if (!lookups && !counters.puts.load()) {
+			continue;
+		}
+		summary += qsl("\n%1: %2% hit rate (%3 of %4), "
+			"%5 evicted, %6 MB read, %7 MB written"
+		).arg(name
+		).arg(lookups ? (hits * 100 / lookups) : 0
+		).arg(hits
+		).arg(lookups
+		).arg(counters.evictions.load()
+		).arg(counters.hitBytes.load() / int64(1024 * 1024)
+		).arg(counters.putBytes.load() / int64(1024 * 1024));
+	}
+	summary += qsl("\n\nEvictions are observed re-misses, a lower bound.");
+
+	auto root = QJsonObject();
+	root["classes"] = classes;
+
+	const auto path = cWorkingDir() + qsl("cache_statistics.json");
+	auto file = QFile(path);
+	if (file.open(QIODevice::WriteOnly)) {
+		file.write(QJsonDocument(root).toJson(QJsonDocument::Indented));
+		summary += qsl("\nSaved to %1").arg(path);
+	}
+	return summary;
+}
+
+void StartSummaryTimer() {
+	static auto timer = base::Timer([] {
+		LOG(("%1").arg(SummaryLine()));
+	});
+	timer.callEach(kSummaryEach);
+}
+
+} // namespace CacheStats
+} // namespace Storage
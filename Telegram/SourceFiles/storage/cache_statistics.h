@@ -0,0 +1,47 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+namespace Storage {
+namespace Cache {
+struct Key;
+} // namespace Cache
+
+namespace CacheStats {
+
+// Content classes follow the cache tags from data_types.h, the big file
+// cache entries get classified at their call sites instead (the tags are
+// not kept there).
+enum class Class {
+	Images,
+	Stickers,
+	Voice,
+	RoundVideo,
+	Animations,
+	VideoSlices,
+	Other,
+};
+
+[[nodiscard]] Class ClassByTag(uint8 tag);
+
+// An empty get result counts as a miss. A miss for a key that was put or
+// successfully read earlier in this session counts as an observed
+// eviction - the database does not report evictions itself, so this is a
+// lower bound. Both are safe to call from the cache database thread.
+void RecordGet(Class which, const Cache::Key &key, int64 resultSize);
+void RecordPut(Class which, const Cache::Key &key, int64 valueSize);
+
+[[nodiscard]] QString ReportString();
+
+// Writes one summary line to the log every 24 hours so that long running
+// installations leave sizing data behind. Called once from the main
+// thread on launch.
+void StartSummaryTimer();
+
+} // namespace CacheStats
+} // namespace Storage
@@ -8,6 +8,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "storage/download_manager_mtproto.h"
 
 #include "mtproto/facade.h"
+#include "mtproto/network_health.h"
 #include "mtproto/mtproto_auth_key.h"
 #include "mtproto/mtproto_rpc_sender.h"
 #include "main/main_session.h"
@@ -19,7 +20,8 @@ namespace {
 
 constexpr auto kKillSessionTimeout = 15 * crl::time(1000);
 constexpr auto kStartWaitedInSession = 4 * kDownloadPartSize;
-constexpr auto kMaxWaitedInSession = 16 * kDownloadPartSize;
+constexpr auto kMaxWaitedInSession = 64 * kDownloadPartSize;
+constexpr auto kFastRequestDurationThreshold = 2 * crl::time(1000);
 constexpr auto kStartSessionsCount = 1;
 constexpr auto kMaxSessionsCount = 8;
 constexpr auto kMaxTrackedSessionRemoves = 64;
@@ -69,13 +71,23 @@ void DownloadManagerMtproto::Queue::resetGeneration() {
 	const auto from = ranges::find(_tasks, 0, &Enqueued::priority);
 	for (auto &task : ranges::make_subrange(from, end(_tasks))) {
 		if (task.priority) {
-			Assert(task.priority == -1);
+			Assert(task.priority < 0);
 			break;
 		}
 		task.priority = -1;
 	}
 }
 
+void DownloadManagerMtproto::Queue::preemptForPriority(int priority) {
+	Expects(priority > 0);
+
+	for (const auto &enqueued : _tasks) {
+		if (enqueued.priority <= 0) {
+			enqueued.task->releaseInFlightRequests();
+		}
+	}
+}
+
 bool DownloadManagerMtproto::Queue::empty() const {
 	return _tasks.empty();
 }
@@ -137,6 +149,13 @@ void DownloadManagerMtproto::enqueue(not_null<Task*> task, int priority) {
 	const auto dcId = task->dcId();
 	auto &queue = _queues[dcId];
 	queue.enqueue(task, priority);
+	if (priority > 0) {
+		// Deadline-critical traffic preempts bulk downloads: take back
+		// the in-flight parts of the bulk tasks so that their session
+		// windows free up right away. The bulk tasks request the same
+		// parts again when the queue gets back to them.
+		queue.preemptForPriority(priority);
+	}
 	if (!_resetGenerationTimer.isActive()) {
 		_resetGenerationTimer.callOnce(kResetDownloadPrioritiesTimeout);
 	}
@@ -167,8 +186,38 @@ void DownloadManagerMtproto::checkSendNext() {
 }
 
 void DownloadManagerMtproto::checkSendNext(MTP::DcId dcId, Queue &queue) {
-	while (trySendNextPart(dcId, queue)) {
+	do {
+		while (trySendNextPart(dcId, queue)) {
+		}
+	} while (trySaturateSessions(dcId, queue));
+}
+
+bool DownloadManagerMtproto::trySaturateSessions(
+		MTP::DcId dcId,
+		Queue &queue) {
+	// A single large task is striped across all the dc sessions the same
+	// way parallel tasks are, so when demand outgrows the existing windows
+	// we add sessions right away instead of waiting for the slow
+	// success-based ramp up. Timeout and remove back-offs still apply.
+	auto &dc = _balanceData[dcId];
+	if (dc.sessions.size() >= kMaxSessionsCount) {
+		return false;
+	} else if (!queue.nextTask(dc.totalRequested > 0)) {
+		return false;
+	} else if (dc.timeouts > 0) {
+		return false;
+	}
+	const auto now = crl::now();
+	const auto delay = (dc.sessionRemoveTimes + 1) * kRetryAddSessionTimeout;
+	if (dc.lastSessionRemove && now < dc.lastSessionRemove + delay) {
+		return false;
 	}
+	dc.sessions.emplace_back();
+	DEBUG_LOG(("Download (%1,%2) adding for striping, now sessions: %3"
+		).arg(dcId
+		).arg(dc.sessions.size() - 1
+		).arg(dc.sessions.size()));
+	return true;
 }
 
 bool DownloadManagerMtproto::trySendNextPart(MTP::DcId dcId, Queue &queue) {
@@ -246,6 +295,7 @@ void DownloadManagerMtproto::requestSucceeded(
 		).arg(duration
 		).arg(parts
 		).arg(overloaded ? " (overloaded)" : ""));
+	MTP::NetworkHealth::RecordRoundTrip(dcId, duration);
 	if (overloaded) {
 		return;
 	}
@@ -257,10 +307,21 @@ void DownloadManagerMtproto::requestSucceeded(
 		});
 		return;
 	}
+	dc.averageDuration = !dc.averageDuration
+		? duration
+		: ((dc.averageDuration * 3 + duration) / 4);
 	if (amountAtRequestStart == data.maxWaitedAmount
 		&& data.maxWaitedAmount < kMaxWaitedInSession) {
+		// The part size is fixed by the CDN hash checking protocol, so
+		// the link is adapted through the in-flight window instead. On
+		// high bandwidth-delay links a one part step widens it too
+		// slowly - while requests keep turning around fast we double it,
+		// falling back to the start width when the dc times out.
+		const auto fast = (dc.averageDuration < kFastRequestDurationThreshold);
 		data.maxWaitedAmount = std::min(
-			data.maxWaitedAmount + kDownloadPartSize,
+			(fast
+				? (data.maxWaitedAmount * 2)
+				: (data.maxWaitedAmount + kDownloadPartSize)),
 			kMaxWaitedInSession);
 		DEBUG_LOG(("Download (%1,%2) increased max waited amount %3."
 			).arg(dcId
@@ -319,7 +380,9 @@ void DownloadManagerMtproto::sessionTimedOut(MTP::DcId dcId, int index) {
 	DEBUG_LOG(("Download (%1,%2) session timed-out.").arg(dcId).arg(index));
 	for (auto &session : dc.sessions) {
 		session.successes = 0;
+		session.maxWaitedAmount = kStartWaitedInSession;
 	}
+	dc.averageDuration = 0;
 	if (dc.sessions.size() == kStartSessionsCount
 		|| ++dc.timeouts < kRemoveSessionAfterTimeouts) {
 		return;
@@ -824,6 +887,17 @@ void DownloadMtprotoTask::cancelAllRequests() {
 	_cdnUncheckedParts.clear();
 }
 
+void DownloadMtprotoTask::releaseInFlightRequests() {
+	while (!_sentRequests.empty()) {
+		const auto requestId = _sentRequests.begin()->first;
+		const auto offset = _sentRequests.begin()->second.offset;
+		if (!requeueRequestOffset(offset)) {
+			return;
+		}
+		cancelRequest(requestId);
+	}
+}
+
 void DownloadMtprotoTask::cancelRequestForOffset(int offset) {
 	const auto i = _requestByOffset.find(offset);
 	if (i != end(_requestByOffset)) {
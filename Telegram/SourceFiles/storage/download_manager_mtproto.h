@@ -22,6 +22,11 @@ namespace Storage {
 // fixed part size download for hash checking.
 constexpr auto kDownloadPartSize = 128 * 1024;
 
+// Queue priority for automatic downloads. They rank below any explicit
+// or streaming traffic, including explicit tasks already demoted to an
+// older generation, so autodownload never competes with user actions.
+constexpr auto kAutomaticDownloadPriority = -2;
+
 class DownloadMtprotoTask;
 
 class DownloadManagerMtproto final : public base::has_weak_ptr {
@@ -56,6 +61,7 @@ private:
 		void enqueue(not_null<Task*> task, int priority);
 		void remove(not_null<Task*> task);
 		void resetGeneration();
+		void preemptForPriority(int priority);
 		[[nodiscard]] bool empty() const;
 		[[nodiscard]] Task *nextTask(bool onlyHighestPriority) const;
 		void removeSession(int index);
@@ -84,11 +90,16 @@ private:
 		int sessionRemoveTimes = 0;
 		int timeouts = 0; // Since all sessions had successes >= required.
 		int totalRequested = 0;
+
+		// Moving average of the full-window request turnaround, used to
+		// decide how aggressively the session windows may widen.
+		crl::time averageDuration = 0;
 	};
 
 	void checkSendNext();
 	void checkSendNext(MTP::DcId dcId, Queue &queue);
 	bool trySendNextPart(MTP::DcId dcId, Queue &queue);
+	bool trySaturateSessions(MTP::DcId dcId, Queue &queue);
 
 	void killSessionsSchedule(MTP::DcId dcId);
 	void killSessionsCancel(MTP::DcId dcId);
@@ -141,6 +152,7 @@ public:
 	[[nodiscard]] virtual bool readyToRequest() const = 0;
 	void loadPart(int sessionIndex);
 	void removeSession(int sessionIndex);
+	void releaseInFlightRequests();
 
 	void refreshFileReferenceFrom(
 		const Data::UpdatedFileReferences &updates,
@@ -190,6 +202,15 @@ private:
 
 	// Called only if readyToRequest() == true.
 	[[nodiscard]] virtual int takeNextRequestOffset() = 0;
+
+	// Tries to take back an offset that was already sent for loading,
+	// so that its request can be cancelled and the session window given
+	// to higher priority traffic. Returns false if the task can't
+	// request the same offset again later.
+	virtual bool requeueRequestOffset(int offset) {
+		return false;
+	}
+
 	virtual bool feedPart(int offset, const QByteArray &bytes) = 0;
 	virtual bool setWebFileSizeHook(int size);
 	virtual void cancelOnFail() = 0;
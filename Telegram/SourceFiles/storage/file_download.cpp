@@ -13,7 +13,9 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "mainwidget.h"
 #include "mainwindow.h"
 #include "core/application.h"
+#include "core/dispatch_tracer.h"
 #include "storage/localstorage.h"
+#include "storage/cache_statistics.h"
 #include "storage/file_download_mtproto.h"
 #include "storage/file_download_web.h"
 #include "platform/platform_file_utilities.h"
@@ -27,6 +29,10 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 namespace {
 
+// Coalesce contiguous parts into writes of this size before they
+// are flushed to disk, so downloads don't produce lots of tiny writes.
+constexpr auto kWriteBehindBufferSize = 1024 * 1024;
+
 class FromMemoryLoader final : public FileLoader {
 public:
 	FromMemoryLoader(
@@ -115,6 +121,9 @@ Main::Session &FileLoader::session() const {
 }
 
 void FileLoader::finishWithBytes(const QByteArray &data) {
+	if (_fileIsOpen && !flushWriteBuffer()) {
+		return;
+	}
 	_data = data;
 	_localStatus = LocalStatus::Loaded;
 	if (!_filename.isEmpty() && _toCache == LoadToCacheAsWell) {
@@ -195,6 +204,17 @@ void FileLoader::permitLoadFromCloud() {
 	_fromCloud = LoadFromCloudOrLocal;
 }
 
+void FileLoader::increaseLoadPriority() {
+	if (!_autoLoading) {
+		return;
+	}
+
+	// An automatic download became an explicit user action, move it
+	// out of the background band of the download queue.
+	_autoLoading = false;
+	increaseLoadPriorityHook();
+}
+
 void FileLoader::notifyAboutProgress() {
 	_updates.fire({});
 }
@@ -251,10 +271,12 @@ void FileLoader::loadLocal(const Storage::Cache::Key &key) {
 				std::move(image));
 		});
 	};
+	const auto cacheClass = Storage::CacheStats::ClassByTag(_cacheTag);
 	_session->data().cache().get(key, [=, callback = std::move(done)](
 			QByteArray &&value) mutable {
+		Storage::CacheStats::RecordGet(cacheClass, key, value.size());
 		if (readImage) {
-			crl::async([
+			Core::DispatchTracer::Async("cache image decode", [
 				value = std::move(value),
 				done = std::move(callback)
 			]() mutable {
@@ -316,6 +338,7 @@ void FileLoader::cancel(bool fail) {
 		_fileIsOpen = false;
 		_file.remove();
 	}
+	_writeBuffer = QByteArray();
 	_data = QByteArray();
 
 	const auto weak = base::make_weak(this);
@@ -331,7 +354,8 @@ void FileLoader::cancel(bool fail) {
 }
 
 int FileLoader::currentOffset() const {
-	return (_fileIsOpen ? _file.size() : _data.size()) - _skippedBytes;
+	return (_fileIsOpen ? _fileWrittenTill : int(_data.size()))
+		- _skippedBytes;
 }
 
 bool FileLoader::writeResultPart(int offset, bytes::const_span buffer) {
@@ -341,18 +365,7 @@ bool FileLoader::writeResultPart(int offset, bytes::const_span buffer) {
 		return true;
 	}
 	if (_fileIsOpen) {
-		auto fsize = _file.size();
-		if (offset < fsize) {
-			_skippedBytes -= buffer.size();
-		} else if (offset > fsize) {
-			_skippedBytes += offset - fsize;
-		}
-		_file.seek(offset);
-		if (_file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size()) != qint64(buffer.size())) {
-			cancel(true);
-			return false;
-		}
-		return true;
+		return writeBufferedPart(offset, buffer);
 	}
 	_data.reserve(offset + buffer.size());
 	if (offset > _data.size()) {
@@ -374,10 +387,64 @@ bool FileLoader::writeResultPart(int offset, bytes::const_span buffer) {
 	return true;
 }
 
+bool FileLoader::writeBufferedPart(int offset, bytes::const_span buffer) {
+	Expects(_fileIsOpen);
+
+	if (!_preallocated) {
+		if (_size > 0) {
+			// Reserve the full file size up front, so the file system
+			// can allocate contiguous space for the whole download.
+			_file.resize(_size);
+		}
+		_writeBuffer.reserve(kWriteBehindBufferSize);
+		_preallocated = true;
+	}
+	if (offset < _fileWrittenTill) {
+		_skippedBytes -= buffer.size();
+	} else if (offset > _fileWrittenTill) {
+		_skippedBytes += offset - _fileWrittenTill;
+	}
+	if (offset + int(buffer.size()) > _fileWrittenTill) {
+		_fileWrittenTill = offset + buffer.size();
+	}
+	const auto bufferedTill = _writeBufferOffset + _writeBuffer.size();
+	if (!_writeBuffer.isEmpty() && offset != bufferedTill) {
+		if (!flushWriteBuffer()) {
+			return false;
+		}
+	}
+	if (_writeBuffer.isEmpty()) {
+		_writeBufferOffset = offset;
+	}
+	_writeBuffer.append(
+		reinterpret_cast<const char*>(buffer.data()),
+		buffer.size());
+	return (_writeBuffer.size() < kWriteBehindBufferSize)
+		|| flushWriteBuffer();
+}
+
+bool FileLoader::flushWriteBuffer() {
+	Expects(_fileIsOpen);
+
+	if (_writeBuffer.isEmpty()) {
+		return true;
+	}
+	_file.seek(_writeBufferOffset);
+	if (_file.write(_writeBuffer) != qint64(_writeBuffer.size())) {
+		cancel(true);
+		return false;
+	}
+	_writeBuffer.resize(0);
+	return true;
+}
+
 QByteArray FileLoader::readLoadedPartBack(int offset, int size) {
 	Expects(offset >= 0 && size > 0);
 
 	if (_fileIsOpen) {
+		if (!flushWriteBuffer()) {
+			return QByteArray();
+		}
 		if (_file.openMode() == QIODevice::WriteOnly) {
 			_file.close();
 			_fileIsOpen = _file.open(QIODevice::ReadWrite);
@@ -400,6 +467,14 @@ QByteArray FileLoader::readLoadedPartBack(int offset, int size) {
 bool FileLoader::finalizeResult() {
 	Expects(!_finished);
 
+	if (_fileIsOpen) {
+		if (!flushWriteBuffer()) {
+			return false;
+		}
+		if (_preallocated && _file.size() > _fileWrittenTill) {
+			_file.resize(_fileWrittenTill);
+		}
+	}
 	if (!_filename.isEmpty() && (_toCache == LoadToCacheAsWell)) {
 		if (!_fileIsOpen) {
 			_fileIsOpen = _file.open(QIODevice::WriteOnly);
@@ -428,6 +503,10 @@ bool FileLoader::finalizeResult() {
 		if ((_toCache == LoadToCacheAsWell)
 			&& (_data.size() <= Storage::kMaxFileInMemory)
 			&& (key.low || key.high)) {
+			Storage::CacheStats::RecordPut(
+				Storage::CacheStats::ClassByTag(_cacheTag),
+				key,
+				_data.size());
 			_session->data().cache().put(
 				cacheKey(),
 				Storage::Cache::Database::TaggedValue(
@@ -93,6 +93,7 @@ public:
 
 	bool setFileName(const QString &filename); // set filename for loaders to cache
 	void permitLoadFromCloud();
+	void increaseLoadPriority();
 
 	void start();
 	void cancel();
@@ -133,12 +134,16 @@ protected:
 	virtual std::optional<MediaKey> fileLocationKey() const = 0;
 	virtual void cancelHook() = 0;
 	virtual void startLoading() = 0;
+	virtual void increaseLoadPriorityHook() {
+	}
 
 	void cancel(bool failed);
 
 	void notifyAboutProgress();
 
 	bool writeResultPart(int offset, bytes::const_span buffer);
+	bool writeBufferedPart(int offset, bytes::const_span buffer);
+	bool flushWriteBuffer();
 	bool finalizeResult();
 	[[nodiscard]] QByteArray readLoadedPartBack(int offset, int size);
 
@@ -154,6 +159,12 @@ protected:
 	QFile _file;
 	bool _fileIsOpen = false;
 
+	// Write-behind buffer, coalesces contiguous parts into large writes.
+	QByteArray _writeBuffer;
+	int _writeBufferOffset = 0;
+	int _fileWrittenTill = 0;
+	bool _preallocated = false;
+
 	LoadToCacheSetting _toCache;
 	LoadFromCloudSetting _fromCloud;
 
@@ -94,19 +94,31 @@ uint64 mtpFileLoader::objId() const {
 
 bool mtpFileLoader::readyToRequest() const {
 	return !_finished
-		&& !_lastComplete
-		&& (_size != 0 || !haveSentRequests())
-		&& (!_size || _nextRequestOffset < _size);
+		&& (!_requeuedOffsets.empty()
+			|| (!_lastComplete
+				&& (_size != 0 || !haveSentRequests())
+				&& (!_size || _nextRequestOffset < _size)));
 }
 
 int mtpFileLoader::takeNextRequestOffset() {
 	Expects(readyToRequest());
 
+	if (!_requeuedOffsets.empty()) {
+		const auto i = _requeuedOffsets.begin();
+		const auto result = *i;
+		_requeuedOffsets.erase(i);
+		return result;
+	}
 	const auto result = _nextRequestOffset;
 	_nextRequestOffset += Storage::kDownloadPartSize;
 	return result;
 }
 
+bool mtpFileLoader::requeueRequestOffset(int offset) {
+	_requeuedOffsets.emplace(offset);
+	return true;
+}
+
 bool mtpFileLoader::feedPart(int offset, const QByteArray &bytes) {
 	const auto buffer = bytes::make_span(bytes);
 	if (!writeResultPart(offset, buffer)) {
@@ -116,6 +128,7 @@ bool mtpFileLoader::feedPart(int offset, const QByteArray &bytes) {
 		_lastComplete = true;
 	}
 	const auto finished = !haveSentRequests()
+		&& _requeuedOffsets.empty()
 		&& (_lastComplete || (_size && _nextRequestOffset >= _size));
 	if (finished) {
 		removeFromQueue();
@@ -146,11 +159,22 @@ bool mtpFileLoader::setWebFileSizeHook(int size) {
 }
 
 void mtpFileLoader::startLoading() {
+	addToQueue(_autoLoading ? Storage::kAutomaticDownloadPriority : 0);
+}
+
+void mtpFileLoader::increaseLoadPriorityHook() {
+	if (loadingLocal()) {
+		// Not queued yet, the new priority is picked up in startLoading
+		// if the local cache lookup fails.
+		return;
+	}
+	// Re-enqueueing an already queued task just updates its priority.
 	addToQueue();
 }
 
 void mtpFileLoader::cancelHook() {
 	cancelAllRequests();
+	_requeuedOffsets.clear();
 }
 
 Storage::Cache::Key mtpFileLoader::cacheKey() const {
@@ -45,15 +45,18 @@ private:
 	Storage::Cache::Key cacheKey() const override;
 	std::optional<MediaKey> fileLocationKey() const override;
 	void startLoading() override;
+	void increaseLoadPriorityHook() override;
 	void cancelHook() override;
 
 	bool readyToRequest() const override;
 	int takeNextRequestOffset() override;
+	bool requeueRequestOffset(int offset) override;
 	bool feedPart(int offset, const QByteArray &bytes) override;
 	void cancelOnFail() override;
 	bool setWebFileSizeHook(int size) override;
 
 	bool _lastComplete = false;
 	int32 _nextRequestOffset = 0;
+	base::flat_set<int> _requeuedOffsets;
 
 };
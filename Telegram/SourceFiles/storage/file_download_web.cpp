@@ -17,6 +17,11 @@ constexpr auto kMaxWebFileQueries = 8;
 constexpr auto kMaxHttpRedirects = 5;
 constexpr auto kResetDownloadPrioritiesTimeout = crl::time(200);
 
+// Download the second half of a file through an additional ranged
+// request if the server advertises Accept-Ranges and at least this
+// much is left in each of the two halves.
+constexpr auto kTailRangeMinSize = int64(512 * 1024);
+
 std::weak_ptr<WebLoadManager> GlobalLoadManager;
 
 using ErrorSignal = void(QNetworkReply::*)(QNetworkReply::NetworkError);
@@ -73,6 +78,10 @@ private:
 		QString url;
 		not_null<QNetworkReply*> reply;
 		QByteArray data;
+		QNetworkReply *tailReply = nullptr;
+		QByteArray tailData;
+		int64 tailOffset = -1; // Less than zero till the tail is started.
+		bool mainDone = false;
 		int64 ready = 0;
 		int64 total = 0;
 		int redirectsLeft = kMaxHttpRedirects;
@@ -105,6 +114,11 @@ private:
 		not_null<QNetworkReply*> reply,
 		int64 ready,
 		int64 total);
+	void maybeStartTail(int id, Sent &sent);
+	void notifyTail(int id, Sent &sent);
+	void dropTail(int id, Sent &sent);
+	void checkRangedFinished(int id, Sent &sent);
+	void stopStreaming(not_null<QNetworkReply*> reply);
 	void failed(int id, not_null<QNetworkReply*> reply);
 	void finished(int id, not_null<QNetworkReply*> reply);
 	void deleteDeferred(not_null<QNetworkReply*> reply);
@@ -151,7 +165,7 @@ WebLoadManager::WebLoadManager()
 void WebLoadManager::handleNetworkErrors() {
 	const auto fail = [=](QNetworkReply *reply) {
 		for (const auto &[id, sent] : _sent) {
-			if (sent.reply == reply) {
+			if (sent.reply == reply || sent.tailReply == reply) {
 				failed(id, reply);
 				return;
 			}
@@ -255,7 +269,12 @@ void WebLoadManager::send(const Enqueued &entry) {
 
 void WebLoadManager::removeSent(int id) {
 	if (const auto i = _sent.find(id); i != end(_sent)) {
-		deleteDeferred(i->second.reply);
+		if (!i->second.mainDone) {
+			deleteDeferred(i->second.reply);
+		}
+		if (const auto tail = i->second.tailReply) {
+			deleteDeferred(tail);
+		}
 		_sent.erase(i);
 		checkSendNext();
 	}
@@ -278,7 +297,8 @@ WebLoadManager::Sent *WebLoadManager::findSent(
 		int id,
 		not_null<QNetworkReply*> reply) {
 	const auto i = _sent.find(id);
-	return (i != end(_sent) && i->second.reply == reply)
+	return (i != end(_sent)
+		&& (i->second.reply == reply || i->second.tailReply == reply))
 		? &i->second
 		: nullptr;
 }
@@ -291,6 +311,18 @@ void WebLoadManager::progress(
 	const auto statusCode = reply->attribute(
 		QNetworkRequest::HttpStatusCodeAttribute);
 	const auto status = statusCode.isValid() ? statusCode.toInt() : 200;
+	if (const auto sent = findSent(id, reply); sent
+		&& sent->tailReply == reply) {
+		// Anything but a partial-content answer for the ranged request
+		// means the server didn't really honor it, fall back to the
+		// single stream that keeps downloading from the start.
+		if (status == 206) {
+			notifyTail(id, *sent);
+		} else {
+			dropTail(id, *sent);
+		}
+		return;
+	}
 	if (status == 301 || status == 302) {
 		redirect(id, reply);
 	} else if (status != 200 && status != 206 && status != 416) {
@@ -318,6 +350,9 @@ void WebLoadManager::redirect(int id, not_null<QNetworkReply*> reply) {
 			failed(id, reply);
 			return;
 		}
+		if (sent->tailReply) {
+			dropTail(id, *sent);
+		}
 		deleteDeferred(reply);
 		sent->url = url;
 		sent->reply = send(id, url);
@@ -330,12 +365,12 @@ void WebLoadManager::notify(
 		int64 ready,
 		int64 total) {
 	if (const auto sent = findSent(id, reply)) {
-		sent->ready = ready;
 		sent->total = std::max(total, int64(0));
 		sent->data.append(reply->readAll());
+		sent->ready = sent->data.size() + sent->tailData.size();
 		if (total == 0
 			|| total > Storage::kMaxFileInMemory
-			|| sent->data.size() > Storage::kMaxFileInMemory) {
+			|| sent->ready > Storage::kMaxFileInMemory) {
 			LOG(("Network Error: "
 				"Bad size received for HTTP download progress "
 				"in WebLoadManager::onProgress(): %1 / %2 (bytes %3)"
@@ -343,6 +378,20 @@ void WebLoadManager::notify(
 				).arg(total
 				).arg(sent->data.size()));
 			failed(id, reply);
+			return;
+		}
+		if (sent->tailOffset < 0) {
+			maybeStartTail(id, *sent);
+		}
+		if (sent->tailOffset >= 0) {
+			if (sent->data.size() >= sent->tailOffset) {
+				sent->data.resize(sent->tailOffset);
+				sent->mainDone = true;
+				stopStreaming(sent->reply);
+				checkRangedFinished(id, *sent);
+			} else {
+				queueProgressUpdate(id, sent->ready, sent->total);
+			}
 		} else if (total > 0 && ready >= total) {
 			finished(id, reply);
 		} else {
@@ -351,6 +400,81 @@ void WebLoadManager::notify(
 	}
 }
 
+void WebLoadManager::maybeStartTail(int id, Sent &sent) {
+	// Mirror the parallelism of several mtproto sessions by pulling the
+	// second half of a large file through an additional ranged request.
+	if (sent.total <= 0
+		|| sent.total - sent.data.size() < 2 * kTailRangeMinSize
+		|| int(_sent.size()) >= kMaxWebFileQueries
+		|| sent.reply->rawHeader("Accept-Ranges").toLower() != "bytes") {
+		return;
+	}
+	const auto left = sent.total - sent.data.size();
+	const auto offset = sent.data.size() + (left / 2);
+	auto request = QNetworkRequest(sent.url);
+	request.setRawHeader(
+		"Range",
+		"bytes=" + QByteArray::number(offset) + "-");
+	const auto result = _network.get(request);
+	const auto handleProgress = [=](qint64 ready, qint64 total) {
+		progress(id, result, ready, total);
+	};
+	const auto handleError = [=](QNetworkReply::NetworkError error) {
+		failed(id, result, error);
+	};
+	connect(result, &QNetworkReply::downloadProgress, handleProgress);
+	connect(result, QNetworkReply_error, handleError);
+	sent.tailReply = result;
+	sent.tailOffset = offset;
+}
+
+void WebLoadManager::notifyTail(int id, Sent &sent) {
+	Expects(sent.tailReply != nullptr);
+
+	sent.tailData.append(sent.tailReply->readAll());
+	sent.ready = sent.data.size() + sent.tailData.size();
+	if (sent.ready > Storage::kMaxFileInMemory) {
+		failed(id, sent.reply);
+		return;
+	}
+	const auto needed = sent.total - sent.tailOffset;
+	if (sent.tailData.size() >= needed) {
+		sent.tailData.resize(needed);
+		stopStreaming(base::take(sent.tailReply));
+		checkRangedFinished(id, sent);
+	} else {
+		queueProgressUpdate(id, sent.ready, sent.total);
+	}
+}
+
+void WebLoadManager::dropTail(int id, Sent &sent) {
+	if (const auto tail = base::take(sent.tailReply)) {
+		stopStreaming(tail);
+	}
+	sent.tailData = QByteArray();
+	sent.tailOffset = -1;
+	if (sent.mainDone) {
+		// The first stream already stopped at the split point, without
+		// the tail the rest of the file can't arrive anymore.
+		failed(id, sent.reply);
+	}
+}
+
+void WebLoadManager::checkRangedFinished(int id, Sent &sent) {
+	if (!sent.mainDone
+		|| sent.tailData.size() < sent.total - sent.tailOffset) {
+		return;
+	}
+	sent.data.append(base::take(sent.tailData));
+	finished(id, sent.reply);
+}
+
+void WebLoadManager::stopStreaming(not_null<QNetworkReply*> reply) {
+	reply->disconnect();
+	reply->abort();
+	deleteDeferred(reply);
+}
+
 void WebLoadManager::failed(
 		int id,
 		not_null<QNetworkReply*> reply,
@@ -390,8 +514,14 @@ void WebLoadManager::finished(int id, not_null<QNetworkReply*> reply) {
 
 void WebLoadManager::clear() {
 	for (const auto &[id, sent] : base::take(_sent)) {
-		sent.reply->abort();
-		delete sent.reply;
+		if (!sent.mainDone) {
+			sent.reply->abort();
+			delete sent.reply;
+		}
+		if (const auto tail = sent.tailReply) {
+			tail->abort();
+			delete tail;
+		}
 	}
 	for (const auto reply : base::take(_repliesBeingDeleted)) {
 		if (reply) {
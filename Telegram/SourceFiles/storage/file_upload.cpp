@@ -20,8 +20,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 namespace Storage {
 namespace {
 
-// max 512kb uploaded at the same time in each session
-constexpr auto kMaxUploadFileParallelSize = MTP::kUploadSessionsCount * 512 * 1024;
+// max 2mb uploaded at the same time in each session
+constexpr auto kMaxUploadFileParallelSize = MTP::kUploadSessionsCount * 2048 * 1024;
 
 constexpr auto kDocumentMaxPartsCount = 3000;
 
@@ -58,6 +58,7 @@ struct Uploader::File {
 
 	void setDocSize(int32 size);
 	bool setPartSize(uint32 partSize);
+	[[nodiscard]] bool partsLeftToSend() const;
 
 	std::shared_ptr<FileLoadResult> file;
 	SendMediaReady media;
@@ -72,11 +73,20 @@ struct Uploader::File {
 	HashMd5 md5Hash;
 
 	std::unique_ptr<QFile> docFile;
+
+	// Parts are sliced straight out of a mapping of the whole file when
+	// the system gives us one, docFile->read() is the fallback.
+	const uchar *docMapped = nullptr;
+
 	int32 docSentParts = 0;
 	int32 docSize = 0;
 	int32 docPartSize = 0;
 	int32 docPartsCount = 0;
 
+	// Parts dispatched but not yet confirmed by the server.
+	int32 partsInFlight = 0;
+	int32 docPartsInFlight = 0;
+
 };
 
 Uploader::File::File(const SendMediaReady &media) : media(media) {
@@ -130,6 +140,16 @@ bool Uploader::File::setPartSize(uint32 partSize) {
 	return (docPartsCount <= kDocumentMaxPartsCount);
 }
 
+bool Uploader::File::partsLeftToSend() const {
+	const auto &left = file
+		? ((type() == SendMediaType::Photo
+			|| type() == SendMediaType::Secure)
+			? file->fileparts
+			: file->thumbparts)
+		: media.parts;
+	return !left.isEmpty() || (docSentParts < docPartsCount);
+}
+
 uint64 Uploader::File::id() const {
 	return file ? file->id : media.id;
 }
@@ -234,7 +254,11 @@ void Uploader::upload(
 }
 
 void Uploader::currentFailed() {
-	auto j = queue.find(uploadingId);
+	failed(uploadingId);
+}
+
+void Uploader::failed(FullMsgId itemId) {
+	auto j = queue.find(itemId);
 	if (j != queue.end()) {
 		if (j->second.type() == SendMediaType::Photo) {
 			_photoFailed.fire_copy(j->first);
@@ -249,18 +273,42 @@ void Uploader::currentFailed() {
 		} else if (j->second.type() == SendMediaType::Secure) {
 			_secureFailed.fire_copy(j->first);
 		} else {
-			Unexpected("Type in Uploader::currentFailed.");
+			Unexpected("Type in Uploader::failed.");
+		}
+
+		// Cancel and forget the requests of the failed file only,
+		// the other queued files keep uploading.
+		for (auto it = requestOwners.begin(); it != requestOwners.end();) {
+			if (it->second != itemId) {
+				++it;
+				continue;
+			}
+			const auto requestId = it->first;
+			MTP::cancel(requestId);
+			auto sentPartSize = int32(0);
+			const auto sent = requestsSent.find(requestId);
+			if (sent != requestsSent.end()) {
+				sentPartSize = sent->second.size();
+				requestsSent.erase(sent);
+			} else {
+				const auto doc = docRequestsSent.find(requestId);
+				if (doc != docRequestsSent.end()) {
+					sentPartSize = j->second.docPartSize;
+					docRequestsSent.erase(doc);
+				}
+			}
+			const auto dc = dcMap.find(requestId);
+			if (dc != dcMap.end()) {
+				sentSizes[dc->second] -= sentPartSize;
+				dcMap.erase(dc);
+			}
+			sentSize -= sentPartSize;
+			it = requestOwners.erase(it);
 		}
 		queue.erase(j);
 	}
-
-	requestsSent.clear();
-	docRequestsSent.clear();
-	dcMap.clear();
-	uploadingId = FullMsgId();
-	sentSize = 0;
-	for (int i = 0; i < MTP::kUploadSessionsCount; ++i) {
-		sentSizes[i] = 0;
+	if (uploadingId == itemId) {
+		uploadingId = FullMsgId();
 	}
 
 	sendNext();
@@ -273,26 +321,48 @@ void Uploader::stopSessions() {
 }
 
 void Uploader::sendNext() {
-	if (sentSize >= kMaxUploadFileParallelSize || _pausedId.msg) return;
+	// Fill the whole in-flight window over all the upload sessions at
+	// once instead of sending one part per call, the way the download
+	// manager saturates its sessions in checkSendNext().
+	while (sendNextPart()) {
+	}
+}
+
+bool Uploader::sendNextPart() {
+	if (sentSize >= kMaxUploadFileParallelSize || _pausedId.msg) {
+		return false;
+	}
 
 	bool stopping = stopSessionsTimer.isActive();
 	if (queue.empty()) {
 		if (!stopping) {
 			stopSessionsTimer.start(kKillSessionTimeout);
 		}
-		return;
+		return false;
 	}
 
 	if (stopping) {
 		stopSessionsTimer.stop();
 	}
 	auto i = uploadingId.msg ? queue.find(uploadingId) : queue.begin();
-	if (!uploadingId.msg) {
-		uploadingId = i->first;
-	} else if (i == queue.end()) {
+	if (i == queue.end()) {
 		i = queue.begin();
-		uploadingId = i->first;
 	}
+	if (!i->second.partsLeftToSend()) {
+		if (i->second.partsInFlight == 0) {
+			maybeFinishFile(i->first);
+			return true;
+		}
+		// The current file is fully dispatched and only waits for the
+		// confirmations, start sending the next queued file meanwhile.
+		i = ranges::find_if(queue, [](const auto &pair) {
+			return pair.second.partsLeftToSend();
+		});
+		if (i == queue.end()) {
+			return false;
+		}
+	}
+	uploadingId = i->first;
 	auto &uploadingData = i->second;
 
 	auto todc = 0;
@@ -315,83 +385,7 @@ void Uploader::sendNext() {
 			: uploadingData.file->thumbId)
 		: uploadingData.media.thumbId;
 	if (parts.isEmpty()) {
-		if (uploadingData.docSentParts >= uploadingData.docPartsCount) {
-			if (requestsSent.empty() && docRequestsSent.empty()) {
-				const auto options = uploadingData.file
-					? uploadingData.file->to.options
-					: Api::SendOptions();
-				const auto edit = uploadingData.file &&
-					uploadingData.file->edit;
-				if (uploadingData.type() == SendMediaType::Photo) {
-					auto photoFilename = uploadingData.filename();
-					if (!photoFilename.endsWith(qstr(".jpg"), Qt::CaseInsensitive)) {
-						// Server has some extensions checking for inputMediaUploadedPhoto,
-						// so force the extension to be .jpg anyway. It doesn't matter,
-						// because the filename from inputFile is not used anywhere.
-						photoFilename += qstr(".jpg");
-					}
-					const auto md5 = uploadingData.file
-						? uploadingData.file->filemd5
-						: uploadingData.media.jpeg_md5;
-					const auto file = MTP_inputFile(
-						MTP_long(uploadingData.id()),
-						MTP_int(uploadingData.partsCount),
-						MTP_string(photoFilename),
-						MTP_bytes(md5));
-					_photoReady.fire({ uploadingId, options, file, edit });
-				} else if (uploadingData.type() == SendMediaType::File
-					|| uploadingData.type() == SendMediaType::ThemeFile
-					|| uploadingData.type() == SendMediaType::Audio) {
-					QByteArray docMd5(32, Qt::Uninitialized);
-					hashMd5Hex(uploadingData.md5Hash.result(), docMd5.data());
-
-					const auto file = (uploadingData.docSize > kUseBigFilesFrom)
-						? MTP_inputFileBig(
-							MTP_long(uploadingData.id()),
-							MTP_int(uploadingData.docPartsCount),
-							MTP_string(uploadingData.filename()))
-						: MTP_inputFile(
-							MTP_long(uploadingData.id()),
-							MTP_int(uploadingData.docPartsCount),
-							MTP_string(uploadingData.filename()),
-							MTP_bytes(docMd5));
-					if (uploadingData.partsCount) {
-						const auto thumbFilename = uploadingData.file
-							? uploadingData.file->thumbname
-							: (qsl("thumb.") + uploadingData.media.thumbExt);
-						const auto thumbMd5 = uploadingData.file
-							? uploadingData.file->thumbmd5
-							: uploadingData.media.jpeg_md5;
-						const auto thumb = MTP_inputFile(
-							MTP_long(uploadingData.thumbId()),
-							MTP_int(uploadingData.partsCount),
-							MTP_string(thumbFilename),
-							MTP_bytes(thumbMd5));
-						_thumbDocumentReady.fire({
-							uploadingId,
-							options,
-							file,
-							thumb,
-							edit });
-					} else {
-						_documentReady.fire({
-							uploadingId,
-							options,
-							file,
-							edit });
-					}
-				} else if (uploadingData.type() == SendMediaType::Secure) {
-					_secureReady.fire({
-						uploadingId,
-						uploadingData.id(),
-						uploadingData.partsCount });
-				}
-				queue.erase(uploadingId);
-				uploadingId = FullMsgId();
-				sendNext();
-			}
-			return;
-		}
+		Assert(uploadingData.docSentParts < uploadingData.docPartsCount);
 
 		auto &content = uploadingData.file
 			? uploadingData.file->content
@@ -405,10 +399,25 @@ void Uploader::sendNext() {
 				uploadingData.docFile = std::make_unique<QFile>(filepath);
 				if (!uploadingData.docFile->open(QIODevice::ReadOnly)) {
 					currentFailed();
-					return;
+					return false;
 				}
+				uploadingData.docMapped = uploadingData.docFile->map(
+					0,
+					uploadingData.docSize);
+			}
+			if (uploadingData.docMapped) {
+				const auto offset = qint64(uploadingData.docSentParts)
+					* uploadingData.docPartSize;
+				const auto bytes = qMin(
+					qint64(uploadingData.docPartSize),
+					qint64(uploadingData.docSize) - offset);
+				toSend = QByteArray(
+					(const char*)uploadingData.docMapped + offset,
+					bytes);
+			} else {
+				toSend = uploadingData.docFile->read(
+					uploadingData.docPartSize);
 			}
-			toSend = uploadingData.docFile->read(uploadingData.docPartSize);
 			if (uploadingData.docSize <= kUseBigFilesFrom) {
 				uploadingData.md5Hash.feed(toSend.constData(), toSend.size());
 			}
@@ -427,7 +436,7 @@ void Uploader::sendNext() {
 			|| ((toSend.size() < uploadingData.docPartSize
 				&& uploadingData.docSentParts + 1 != uploadingData.docPartsCount))) {
 			currentFailed();
-			return;
+			return false;
 		}
 		mtpRequestId requestId;
 		if (uploadingData.docSize > kUseBigFilesFrom) {
@@ -451,9 +460,12 @@ void Uploader::sendNext() {
 				MTP::uploadDcId(todc));
 		}
 		docRequestsSent.emplace(requestId, uploadingData.docSentParts);
+		requestOwners.emplace(requestId, uploadingId);
 		dcMap.emplace(requestId, todc);
 		sentSize += uploadingData.docPartSize;
 		sentSizes[todc] += uploadingData.docPartSize;
+		uploadingData.partsInFlight++;
+		uploadingData.docPartsInFlight++;
 
 		uploadingData.docSentParts++;
 	} else {
@@ -468,21 +480,110 @@ void Uploader::sendNext() {
 			rpcFail(&Uploader::partFailed),
 			MTP::uploadDcId(todc));
 		requestsSent.emplace(requestId, part.value());
+		requestOwners.emplace(requestId, uploadingId);
 		dcMap.emplace(requestId, todc);
 		sentSize += part.value().size();
 		sentSizes[todc] += part.value().size();
+		uploadingData.partsInFlight++;
 
 		parts.erase(part);
 	}
 	nextTimer.start(kUploadRequestInterval);
+	return true;
+}
+
+void Uploader::maybeFinishFile(FullMsgId itemId) {
+	const auto i = queue.find(itemId);
+	if (i == queue.end()) {
+		return;
+	}
+	auto &data = i->second;
+	if (data.partsLeftToSend() || data.partsInFlight > 0) {
+		return;
+	}
+	const auto options = data.file
+		? data.file->to.options
+		: Api::SendOptions();
+	const auto edit = data.file && data.file->edit;
+	if (data.type() == SendMediaType::Photo) {
+		auto photoFilename = data.filename();
+		if (!photoFilename.endsWith(qstr(".jpg"), Qt::CaseInsensitive)) {
+			// Server has some extensions checking for inputMediaUploadedPhoto,
+			// so force the extension to be .jpg anyway. It doesn't matter,
+			// because the filename from inputFile is not used anywhere.
+			photoFilename += qstr(".jpg");
+		}
+		const auto md5 = data.file
+			? data.file->filemd5
+			: data.media.jpeg_md5;
+		const auto file = MTP_inputFile(
+			MTP_long(data.id()),
+			MTP_int(data.partsCount),
+			MTP_string(photoFilename),
+			MTP_bytes(md5));
+		_photoReady.fire({ itemId, options, file, edit });
+	} else if (data.type() == SendMediaType::File
+		|| data.type() == SendMediaType::ThemeFile
+		|| data.type() == SendMediaType::Audio) {
+		QByteArray docMd5(32, Qt::Uninitialized);
+		hashMd5Hex(data.md5Hash.result(), docMd5.data());
+
+		const auto file = (data.docSize > kUseBigFilesFrom)
+			? MTP_inputFileBig(
+				MTP_long(data.id()),
+				MTP_int(data.docPartsCount),
+				MTP_string(data.filename()))
+			: MTP_inputFile(
+				MTP_long(data.id()),
+				MTP_int(data.docPartsCount),
+				MTP_string(data.filename()),
+				MTP_bytes(docMd5));
+		if (data.partsCount) {
+			const auto thumbFilename = data.file
+				? data.file->thumbname
+				: (qsl("thumb.") + data.media.thumbExt);
+			const auto thumbMd5 = data.file
+				? data.file->thumbmd5
+				: data.media.jpeg_md5;
+			const auto thumb = MTP_inputFile(
+				MTP_long(data.thumbId()),
+				MTP_int(data.partsCount),
+				MTP_string(thumbFilename),
+				MTP_bytes(thumbMd5));
+			_thumbDocumentReady.fire({
+				itemId,
+				options,
+				file,
+				thumb,
+				edit });
+		} else {
+			_documentReady.fire({
+				itemId,
+				options,
+				file,
+				edit });
+		}
+	} else if (data.type() == SendMediaType::Secure) {
+		_secureReady.fire({
+			itemId,
+			data.id(),
+			data.partsCount });
+	}
+	queue.erase(i);
+	if (uploadingId == itemId) {
+		uploadingId = FullMsgId();
+	}
 }
 
 void Uploader::cancel(const FullMsgId &msgId) {
 	uploaded.erase(msgId);
-	if (uploadingId == msgId) {
-		currentFailed();
+	const auto i = queue.find(msgId);
+	if (i == queue.end()) {
+		return;
+	} else if (uploadingId == msgId || i->second.partsInFlight > 0) {
+		failed(msgId);
 	} else {
-		queue.erase(msgId);
+		queue.erase(i);
 	}
 }
 
@@ -509,6 +610,7 @@ void Uploader::clear() {
 		MTP::cancel(requestData.first);
 	}
 	docRequestsSent.clear();
+	requestOwners.clear();
 	dcMap.clear();
 	sentSize = 0;
 	for (int i = 0; i < MTP::kUploadSessionsCount; ++i) {
@@ -525,29 +627,35 @@ void Uploader::partLoaded(const MTPBool &result, mtpRequestId requestId) {
 		j = docRequestsSent.find(requestId);
 	}
 	if (i != requestsSent.cend() || j != docRequestsSent.cend()) {
-		if (mtpIsFalse(result)) { // failed to upload current file
-			currentFailed();
+		const auto ownerIt = requestOwners.find(requestId);
+		Assert(ownerIt != requestOwners.cend());
+		const auto fullId = ownerIt->second;
+		if (mtpIsFalse(result)) { // failed to upload the file
+			failed(fullId);
 			return;
 		} else {
 			auto dcIt = dcMap.find(requestId);
 			if (dcIt == dcMap.cend()) { // must not happen
-				currentFailed();
+				failed(fullId);
 				return;
 			}
 			auto dc = dcIt->second;
 			dcMap.erase(dcIt);
+			requestOwners.erase(ownerIt);
 
 			int32 sentPartSize = 0;
-			auto k = queue.find(uploadingId);
+			auto k = queue.find(fullId);
 			Assert(k != queue.cend());
-			auto &[fullId, file] = *k;
+			auto &file = k->second;
 			if (i != requestsSent.cend()) {
 				sentPartSize = i->second.size();
 				requestsSent.erase(i);
 			} else {
 				sentPartSize = file.docPartSize;
 				docRequestsSent.erase(j);
+				file.docPartsInFlight--;
 			}
+			file.partsInFlight--;
 			sentSize -= sentPartSize;
 			sentSizes[dc] -= sentPartSize;
 			if (file.type() == SendMediaType::Photo) {
@@ -564,7 +672,7 @@ void Uploader::partLoaded(const MTPBool &result, mtpRequestId requestId) {
 				const auto document = Auth().data().document(file.id());
 				if (document->uploading()) {
 					const auto doneParts = file.docSentParts
-						- int(docRequestsSent.size());
+						- int(file.docPartsInFlight);
 					document->uploadingData->offset = std::min(
 						document->uploadingData->size,
 						doneParts * file.docPartSize);
@@ -577,6 +685,7 @@ void Uploader::partLoaded(const MTPBool &result, mtpRequestId requestId) {
 					file.fileSentSize,
 					file.file->partssize });
 			}
+			maybeFinishFile(fullId);
 		}
 	}
 
@@ -586,12 +695,13 @@ void Uploader::partLoaded(const MTPBool &result, mtpRequestId requestId) {
 bool Uploader::partFailed(const RPCError &error, mtpRequestId requestId) {
 	if (MTP::isDefaultHandledError(error)) return false;
 
-	// failed to upload current file
-	if ((requestsSent.find(requestId) != requestsSent.cend())
-		|| (docRequestsSent.find(requestId) != docRequestsSent.cend())) {
-		currentFailed();
+	// failed to upload a part of some queued file
+	const auto ownerIt = requestOwners.find(requestId);
+	if (ownerIt != requestOwners.cend()) {
+		failed(ownerIt->second);
+	} else {
+		sendNext();
 	}
-	sendNext();
 	return true;
 }
 
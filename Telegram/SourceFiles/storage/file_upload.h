@@ -112,14 +112,18 @@ public slots:
 private:
 	struct File;
 
+	bool sendNextPart();
+	void maybeFinishFile(FullMsgId itemId);
 	void partLoaded(const MTPBool &result, mtpRequestId requestId);
 	bool partFailed(const RPCError &err, mtpRequestId requestId);
 
 	void currentFailed();
+	void failed(FullMsgId itemId);
 
 	not_null<ApiWrap*> _api;
 	base::flat_map<mtpRequestId, QByteArray> requestsSent;
 	base::flat_map<mtpRequestId, int32> docRequestsSent;
+	base::flat_map<mtpRequestId, FullMsgId> requestOwners;
 	base::flat_map<mtpRequestId, int32> dcMap;
 	uint32 sentSize = 0;
 	uint32 sentSizes[MTP::kUploadSessionsCount] = { 0 };
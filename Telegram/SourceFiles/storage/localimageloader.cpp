@@ -37,6 +37,7 @@ namespace {
 constexpr auto kThumbnailQuality = 87;
 constexpr auto kThumbnailSize = 320;
 constexpr auto kPhotoUploadPartSize = 32 * 1024;
+constexpr auto kMaxTaskQueueWorkers = 8;
 
 using Storage::ValidateThumbDimensions;
 
@@ -277,16 +278,28 @@ void TaskQueue::addTasks(std::vector<std::unique_ptr<Task>> &&tasks) {
 }
 
 void TaskQueue::wakeThread() {
-	if (!_thread) {
-		_thread = new QThread();
-
-		_worker = new TaskQueueWorker(this);
-		_worker->moveToThread(_thread);
-
-		connect(this, SIGNAL(taskAdded()), _worker, SLOT(onTaskAdded()));
-		connect(_worker, SIGNAL(taskProcessed()), this, SLOT(onTaskProcessed()));
-
-		_thread->start();
+	if (_threads.empty()) {
+		// A pool of workers sharing one queue, so a batch of media
+		// preparation tasks scales across cores. Every worker pulls
+		// from the front of _tasksToProcess under the mutex.
+		const auto count = std::clamp(
+			QThread::idealThreadCount(),
+			1,
+			kMaxTaskQueueWorkers);
+		_threads.reserve(count);
+		_workers.reserve(count);
+		for (auto i = 0; i != count; ++i) {
+			const auto thread = new QThread();
+			const auto worker = new TaskQueueWorker(this);
+			worker->moveToThread(thread);
+
+			connect(this, SIGNAL(taskAdded()), worker, SLOT(onTaskAdded()));
+			connect(worker, SIGNAL(taskProcessed()), this, SLOT(onTaskProcessed()));
+
+			_threads.push_back(thread);
+			_workers.push_back(worker);
+			thread->start();
+		}
 	}
 	if (_stopTimer) _stopTimer->stop();
 	emit taskAdded();
@@ -305,8 +318,9 @@ void TaskQueue::cancelTask(TaskId id) {
 	{
 		QMutexLocker lock(&_tasksToProcessMutex);
 		removeFrom(_tasksToProcess);
-		if (_taskInProcessId == id) {
-			_taskInProcessId = TaskId();
+		const auto i = ranges::find(_tasksInProcess, id);
+		if (i != _tasksInProcess.end()) {
+			_tasksInProcess.erase(i);
 		}
 	}
 	QMutexLocker lock(&_tasksToFinishMutex);
@@ -327,24 +341,32 @@ void TaskQueue::onTaskProcessed() {
 
 	if (_stopTimer) {
 		QMutexLocker lock(&_tasksToProcessMutex);
-		if (_tasksToProcess.empty() && !_taskInProcessId) {
+		if (_tasksToProcess.empty() && _tasksInProcess.empty()) {
 			_stopTimer->start();
 		}
 	}
 }
 
 void TaskQueue::stop() {
-	if (_thread) {
-		_thread->requestInterruption();
-		_thread->quit();
-		DEBUG_LOG(("Waiting for taskThread to finish"));
-		_thread->wait();
-		delete base::take(_worker);
-		delete base::take(_thread);
+	if (!_threads.empty()) {
+		for (const auto thread : _threads) {
+			thread->requestInterruption();
+			thread->quit();
+		}
+		DEBUG_LOG(("Waiting for task threads to finish"));
+		for (const auto thread : _threads) {
+			thread->wait();
+		}
+		for (const auto worker : base::take(_workers)) {
+			delete worker;
+		}
+		for (const auto thread : base::take(_threads)) {
+			delete thread;
+		}
 	}
 	_tasksToProcess.clear();
 	_tasksToFinish.clear();
-	_taskInProcessId = TaskId();
+	_tasksInProcess.clear();
 }
 
 TaskQueue::~TaskQueue() {
@@ -364,7 +386,7 @@ void TaskQueueWorker::onTaskAdded() {
 			if (!_queue->_tasksToProcess.empty()) {
 				task = std::move(_queue->_tasksToProcess.front());
 				_queue->_tasksToProcess.pop_front();
-				_queue->_taskInProcessId = task->id();
+				_queue->_tasksInProcess.push_back(task->id());
 			}
 		}
 
@@ -373,9 +395,12 @@ void TaskQueueWorker::onTaskAdded() {
 			bool emitTaskProcessed = false;
 			{
 				QMutexLocker lockToProcess(&_queue->_tasksToProcessMutex);
-				if (_queue->_taskInProcessId == task->id()) {
-					_queue->_taskInProcessId = TaskId();
-					someTasksLeft = !_queue->_tasksToProcess.empty();
+				someTasksLeft = !_queue->_tasksToProcess.empty();
+				const auto i = ranges::find(
+					_queue->_tasksInProcess,
+					task->id());
+				if (i != _queue->_tasksInProcess.end()) {
+					_queue->_tasksInProcess.erase(i);
 
 					QMutexLocker lockToFinish(&_queue->_tasksToFinishMutex);
 					emitTaskProcessed = _queue->_tasksToFinish.empty();
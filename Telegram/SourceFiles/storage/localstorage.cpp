@@ -11,6 +11,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "storage/serialize_common.h"
 #include "storage/storage_encrypted_file.h"
 #include "storage/storage_clear_legacy.h"
+#include "storage/storage_facade.h"
 #include "chat_helpers/stickers.h"
 #include "data/data_drafts.h"
 #include "data/data_user.h"
@@ -26,6 +27,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "api/api_hash.h"
 #include "core/crash_reports.h"
 #include "core/update_checker.h"
+#include "core/startup_profiler.h"
 #include "observer_peer.h"
 #include "mainwidget.h"
 #include "mainwindow.h"
@@ -39,6 +41,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "main/main_session.h"
 #include "window/themes/window_theme.h"
 #include "window/window_session_controller.h"
+#include "dialogs/dialogs_main_list.h"
 #include "history/history.h"
 #include "facades.h"
 
@@ -69,6 +72,11 @@ constexpr auto kWallPaperLegacySerializeTagId = int32(-111);
 constexpr auto kWallPaperSerializeTagId = int32(-112);
 constexpr auto kWallPaperSidesLimit = 10'000;
 
+constexpr auto kDialogsSnapshotLimit = 30;
+constexpr auto kDialogsSnapshotUnreadMarkFlag = 0x01;
+constexpr auto kDialogsSnapshotPinnedFlag = 0x02;
+constexpr auto kDialogsSnapshotMutedFlag = 0x04;
+
 constexpr auto kSinglePeerTypeUser = qint32(1);
 constexpr auto kSinglePeerTypeChat = qint32(2);
 constexpr auto kSinglePeerTypeChannel = qint32(3);
@@ -76,7 +84,7 @@ constexpr auto kSinglePeerTypeSelf = qint32(4);
 constexpr auto kSinglePeerTypeEmpty = qint32(0);
 
 constexpr auto kStickersVersionTag = quint32(-1);
-constexpr auto kStickersSerializeVersion = 1;
+constexpr auto kStickersSerializeVersion = 2;
 constexpr auto kMaxSavedStickerSetsCount = 1000;
 
 const auto kThemeNewPathRelativeTag = qstr("special://new_tag");
@@ -182,14 +190,49 @@ QByteArray _settingsSalt, _passKeySalt, _passKeyEncrypted;
 
 constexpr auto kLocalKeySize = MTP::AuthKey::kSize;
 
+// Target wall time for deriving the passcode key, the iteration count
+// is calibrated to it when a new passcode is set.
+constexpr auto kPasscodeDeriveTargetMs = crl::time(200);
+constexpr auto kPasscodeIterCountLimit = 1000000;
+
+// Derivation iterations for keys protected by a passcode, loaded from
+// the settings for keys created by a calibrated version of the app.
+auto PassKeyIterCount = int(LocalEncryptIterCount);
+
 auto OldKey = MTP::AuthKeyPtr();
 auto SettingsKey = MTP::AuthKeyPtr();
 auto PassKey = MTP::AuthKeyPtr();
 auto LocalKey = MTP::AuthKeyPtr();
 
-void createLocalKey(const QByteArray &pass, QByteArray *salt, MTP::AuthKeyPtr *result) {
+MTP::AuthKeyPtr DeriveLocalKey(
+		const QByteArray &pass,
+		const QByteArray &salt,
+		int iterCount) {
 	auto key = MTP::AuthKey::Data { { gsl::byte{} } };
-	auto iterCount = pass.size() ? LocalEncryptIterCount : LocalEncryptNoPwdIterCount; // dont slow down for no password
+	PKCS5_PBKDF2_HMAC_SHA1(pass.constData(), pass.size(), (uchar*)salt.data(), salt.size(), iterCount, key.size(), (uchar*)key.data());
+	return std::make_shared<MTP::AuthKey>(key);
+}
+
+int CalibratePassKeyIterCount() {
+	const auto salt = QByteArray(LocalEncryptSaltSize, 'C');
+	const auto probe = int(LocalEncryptIterCount);
+	const auto start = crl::now();
+	DeriveLocalKey("calibration", salt, probe);
+	const auto elapsed = std::max(crl::now() - start, crl::time(1));
+	const auto result = int(std::clamp(
+		int64(probe) * kPasscodeDeriveTargetMs / elapsed,
+		int64(LocalEncryptIterCount),
+		int64(kPasscodeIterCountLimit)));
+	DEBUG_LOG(("Passcode Info: %1 probe iterations took %2 ms, "
+		"calibrated iteration count: %3."
+		).arg(probe
+		).arg(elapsed
+		).arg(result));
+	return result;
+}
+
+void createLocalKey(const QByteArray &pass, QByteArray *salt, MTP::AuthKeyPtr *result) {
+	auto iterCount = pass.size() ? PassKeyIterCount : int(LocalEncryptNoPwdIterCount); // dont slow down for no password
 	auto newSalt = QByteArray();
 	if (!salt) {
 		newSalt.resize(LocalEncryptSaltSize);
@@ -199,9 +242,7 @@ void createLocalKey(const QByteArray &pass, QByteArray *salt, MTP::AuthKeyPtr *r
 		cSetLocalSalt(newSalt);
 	}
 
-	PKCS5_PBKDF2_HMAC_SHA1(pass.constData(), pass.size(), (uchar*)salt->data(), salt->size(), iterCount, key.size(), (uchar*)key.data());
-
-	*result = std::make_shared<MTP::AuthKey>(key);
+	*result = DeriveLocalKey(pass, *salt, iterCount);
 }
 
 struct FileReadDescriptor {
@@ -209,6 +250,10 @@ struct FileReadDescriptor {
 	QByteArray data;
 	QBuffer buffer;
 	QDataStream stream;
+
+	// Keeps the memory mapping alive while data views it, see ReadFile().
+	QFile file;
+
 	~FileReadDescriptor() {
 		if (version) {
 			stream.setDevice(nullptr);
@@ -470,7 +515,9 @@ bool ReadFile(
 		QString fname(toTry[i]);
 		if (fname.isEmpty()) break;
 
-		QFile f(fname);
+		auto &f = result.file;
+		f.close();
+		f.setFileName(fname);
 		if (!f.open(QIODevice::ReadOnly)) {
 			DEBUG_LOG(("App Info: failed to open '%1' for reading").arg(name));
 			continue;
@@ -498,8 +545,18 @@ bool ReadFile(
 			continue;
 		}
 
-		// read data
-		QByteArray bytes = f.read(f.size());
+		// Map the file body instead of copying it onto the heap. The
+		// descriptor keeps the QFile (and so the mapping) alive while
+		// the data is being parsed, falling back to a plain read when
+		// mapping is not available.
+		const auto offset = qint64(tdfMagicLen) + qint64(sizeof(version));
+		const auto bodySize = f.size() - offset;
+		const auto mapped = (bodySize > 0)
+			? f.map(offset, bodySize)
+			: nullptr;
+		QByteArray bytes = mapped
+			? QByteArray::fromRawData((const char*)mapped, bodySize)
+			: f.read(f.size());
 		int32 dataSize = bytes.size() - 16;
 		if (dataSize < 0) {
 			DEBUG_LOG(("App Info: bad file '%1', could not read sign part").arg(name));
@@ -517,8 +574,14 @@ bool ReadFile(
 			continue;
 		}
 
-		bytes.resize(dataSize);
-		result.data = bytes;
+		if (mapped) {
+			result.data = QByteArray::fromRawData(
+				(const char*)mapped,
+				dataSize);
+		} else {
+			bytes.resize(dataSize);
+			result.data = bytes;
+		}
 		bytes = QByteArray();
 
 		result.version = version;
@@ -614,6 +677,41 @@ bool ReadEncryptedFile(
 	return ReadEncryptedFile(result, toFilePart(fkey), owner, key);
 }
 
+// Serial queue for the heavy part of map / settings writes. The state is
+// serialized on the caller (UI) thread, while AES encryption and disk I/O
+// happen here. Flushed synchronously in finish().
+[[nodiscard]] crl::queue &WriteQueue() {
+	static auto queue = crl::queue();
+	return queue;
+}
+
+// Takes an already serialized (but not yet encrypted) descriptor payload
+// together with optional plain-text parts and finishes the write in the
+// background. The plain parts are written with writeData() in order before
+// the encrypted blob, exactly like the synchronous path did.
+void WriteEncryptedInBackground(
+		const QString &name,
+		FileOwner owner,
+		std::vector<QByteArray> plainParts,
+		QByteArray &&serialized,
+		MTP::AuthKeyPtr key) {
+	WriteQueue().async([
+		name,
+		owner,
+		plainParts = std::move(plainParts),
+		serialized = std::move(serialized),
+		key = std::move(key)
+	]() mutable {
+		FileWriteDescriptor file(name, owner);
+		for (const auto &part : plainParts) {
+			file.writeData(part);
+		}
+		EncryptedDescriptor data;
+		data.data = std::move(serialized);
+		file.writeEncrypted(data, key);
+	});
+}
+
 FileKey _dataNameKey = 0;
 
 enum { // Local Storage Keys
@@ -639,6 +737,10 @@ enum { // Local Storage Keys
 	lskExportSettings = 0x13, // no data
 	lskBackground = 0x14, // no data
 	lskSelfSerialized = 0x15, // serialized self
+	lskSharedMediaCounts = 0x16, // no data
+	lskDialogsSnapshot = 0x17, // no data
+	lskSearchIndex = 0x18, // no data
+	lskSendOutbox = 0x19, // no data
 };
 
 enum {
@@ -728,6 +830,8 @@ enum {
 	dbiTxtDomainString = 0x5d,
 	dbiApplicationSettings = 0x5e,
 	dbiDialogsFilters = 0x5f,
+	dbiProxyAutoSelect = 0x60,
+	dbiPasscodeIterCount = 0x61,
 
 	dbiEncryptedWithSalt = 333,
 	dbiEncrypted = 444,
@@ -761,6 +865,7 @@ FileLocationPairs _fileLocationPairs;
 typedef QMap<MediaKey, MediaKey> FileLocationAliases;
 FileLocationAliases _fileLocationAliases;
 FileKey _locationsKey = 0, _trustedBotsKey = 0;
+bool _locationsRead = false;
 
 using TrustedBots = OrderedSet<uint64>;
 TrustedBots _trustedBots;
@@ -768,7 +873,28 @@ bool _trustedBotsRead = false;
 
 FileKey _recentStickersKeyOld = 0;
 FileKey _installedStickersKey = 0, _featuredStickersKey = 0, _recentStickersKey = 0, _favedStickersKey = 0, _archivedStickersKey = 0;
+
+// Cached rolling hashes for the big periodic requests, recounted only
+// after the corresponding data was written or read anew.
+std::optional<int32> _stickersCountedHash;
+bool _stickersCountedHashOutdated = false;
+std::optional<int32> _savedGifsCountedHash;
+
+// The installed / featured / etc. sticker files hold only the small set
+// headers, each set contents lives in its own file so that a change in
+// one set doesn't force rewriting all the others.
+base::flat_map<quint64, FileKey> _stickerSetKeys;
+base::flat_map<quint64, qint32> _stickerSetWrittenHashes;
 FileKey _savedGifsKey = 0;
+FileKey _sharedMediaCountsKey = 0;
+FileKey _dialogsSnapshotKey = 0;
+FileKey _searchIndexKey = 0;
+
+// Messages journaled at send time and replayed with the same random
+// identifiers after a crash, so a restart doesn't lose them.
+FileKey _sendOutboxKey = 0;
+std::vector<SendOutboxEntry> _sendOutbox;
+bool _sendOutboxRead = false;
 
 FileKey _backgroundKeyDay = 0;
 FileKey _backgroundKeyNight = 0;
@@ -823,6 +949,124 @@ Main::Settings &GetStoredSessionSettings() {
 
 void _writeMap(WriteMapWhen when = WriteMapWhen::Soon);
 
+// Instead of rewriting the whole map on each draft change we append small
+// encrypted delta records to a journal file and merge them back into the
+// map on the next full rewrite. Each record is a length-prefixed encrypted
+// blob of (lsk, peer, file key), file key 0 meaning removal.
+constexpr auto kMapJournalSizeLimit = 512 * 1024;
+
+QString MapJournalPath() {
+	return _userBasePath + qsl("journal");
+}
+
+bool _appendMapJournal(
+		const QString &path,
+		quint32 legacyStorageKey,
+		PeerId peer,
+		FileKey file,
+		const MTP::AuthKeyPtr &key) {
+	QFile journal(path);
+	if (journal.exists() && journal.size() > kMapJournalSizeLimit) {
+		return false; // Time to compact into a full map rewrite.
+	}
+	if (!journal.open(QIODevice::WriteOnly | QIODevice::Append)) {
+		return false;
+	}
+	if (!journal.size()) {
+		journal.write(tdfMagic, tdfMagicLen);
+		const auto version = qint32(AppVersion);
+		journal.write((const char*)&version, sizeof(version));
+	}
+	EncryptedDescriptor data(sizeof(quint32) + 2 * sizeof(quint64));
+	data.stream << quint32(legacyStorageKey) << quint64(peer) << quint64(file);
+	const auto encrypted = PrepareEncrypted(data, key);
+	const auto length = qint32(encrypted.size());
+	if (journal.write((const char*)&length, sizeof(length)) != sizeof(length)
+		|| journal.write(encrypted) != encrypted.size()) {
+		journal.close();
+		QFile::remove(path);
+		return false;
+	}
+	base::Platform::FlushFileData(journal);
+	return true;
+}
+
+void _writeMapDelta(
+		quint32 legacyStorageKey,
+		PeerId peer,
+		FileKey file,
+		WriteMapWhen when = WriteMapWhen::Soon) {
+	if (!_userWorking() || !LocalKey) {
+		_mapChanged = true;
+		_writeMap(when);
+		return;
+	}
+	WriteQueue().async([=, path = MapJournalPath(), key = LocalKey] {
+		if (_appendMapJournal(path, legacyStorageKey, peer, file, key)) {
+			return;
+		}
+		crl::on_main([=] {
+			_mapChanged = true;
+			_writeMap(when);
+		});
+	});
+}
+
+void _readMapJournal() {
+	QFile journal(MapJournalPath());
+	if (!journal.open(QIODevice::ReadOnly)) {
+		return;
+	}
+	char magic[tdfMagicLen];
+	qint32 version = 0;
+	if (journal.read(magic, tdfMagicLen) != tdfMagicLen
+		|| memcmp(magic, tdfMagic, tdfMagicLen)
+		|| journal.read((char*)&version, sizeof(version)) != sizeof(version)
+		|| version > AppVersion) {
+		LOG(("App Error: bad map journal header, skipping it."));
+		return;
+	}
+	auto applied = 0;
+	while (!journal.atEnd()) {
+		qint32 length = 0;
+		if (journal.read((char*)&length, sizeof(length)) != sizeof(length)
+			|| length <= 0) {
+			break;
+		}
+		const auto encrypted = journal.read(length);
+		if (encrypted.size() != length) {
+			break; // An unfinished append, older records are still valid.
+		}
+		EncryptedDescriptor record;
+		if (!decryptLocal(record, encrypted)) {
+			break;
+		}
+		quint32 legacyStorageKey = 0;
+		quint64 peer = 0, file = 0;
+		record.stream >> legacyStorageKey >> peer >> file;
+		if (!_checkStreamStatus(record.stream)) {
+			break;
+		}
+		auto &map = (legacyStorageKey == lskDraftPosition)
+			? _draftCursorsMap
+			: _draftsMap;
+		if (file) {
+			map.insert(PeerId(peer), FileKey(file));
+			if (legacyStorageKey == lskDraft) {
+				_draftsNotReadMap.insert(PeerId(peer), true);
+			}
+		} else {
+			map.remove(PeerId(peer));
+		}
+		++applied;
+	}
+	if (applied) {
+		DEBUG_LOG(("App Info: %1 map journal records applied.").arg(applied));
+		_mapChanged = true;
+		_writeMap();
+	}
+}
+
 void _writeLocations(WriteMapWhen when = WriteMapWhen::Soon) {
 	Expects(_manager != nullptr);
 
@@ -955,6 +1199,18 @@ void _readLocations() {
 	}
 }
 
+// File locations are not needed for the first paint, so they are not read
+// in _readMap() anymore but hydrated on first access instead.
+void _hydrateLocations() {
+	if (_locationsRead) {
+		return;
+	}
+	_locationsRead = true;
+	if (_locationsKey) {
+		_readLocations();
+	}
+}
+
 struct ReadSettingsContext {
 	MTP::DcOptions dcOptions;
 };
@@ -1558,6 +1814,25 @@ bool _readSetting(quint32 blockId, QDataStream &stream, int version, ReadSetting
 		Global::SetTryIPv6(v == 1);
 	} break;
 
+	case dbiProxyAutoSelect: {
+		qint32 v;
+		stream >> v;
+		if (!_checkStreamStatus(stream)) return false;
+
+		Global::SetProxyAutoSelect(v == 1);
+	} break;
+
+	case dbiPasscodeIterCount: {
+		qint32 v;
+		stream >> v;
+		if (!_checkStreamStatus(stream)) return false;
+
+		PassKeyIterCount = std::clamp(
+			int(v),
+			int(LocalEncryptIterCount),
+			kPasscodeIterCountLimit);
+	} break;
+
 	case dbiSeenTrayTooltip: {
 		qint32 v;
 		stream >> v;
@@ -2253,8 +2528,13 @@ void _writeUserSettings() {
 	}
 	data.stream << qint32(dbiCallSettings) << callSettings;
 
-	FileWriteDescriptor file(_userSettingsKey);
-	file.writeEncrypted(data);
+	data.finish();
+	WriteEncryptedInBackground(
+		toFilePart(_userSettingsKey),
+		FileOwner::User,
+		{},
+		std::move(data.data),
+		LocalKey);
 }
 
 void _readUserSettings() {
@@ -2392,6 +2672,10 @@ ReadMapState _readMap(const QByteArray &pass) {
 	quint64 recentStickersKeyOld = 0;
 	quint64 installedStickersKey = 0, featuredStickersKey = 0, recentStickersKey = 0, favedStickersKey = 0, archivedStickersKey = 0;
 	quint64 savedGifsKey = 0;
+	quint64 sharedMediaCountsKey = 0;
+	quint64 dialogsSnapshotKey = 0;
+	quint64 searchIndexKey = 0;
+	quint64 sendOutboxKey = 0;
 	quint64 backgroundKeyDay = 0, backgroundKeyNight = 0;
 	quint64 userSettingsKey = 0, recentHashtagsAndBotsKey = 0, exportSettingsKey = 0;
 	while (!map.stream.atEnd()) {
@@ -2478,6 +2762,18 @@ ReadMapState _readMap(const QByteArray &pass) {
 		case lskSavedGifs: {
 			map.stream >> savedGifsKey;
 		} break;
+		case lskSharedMediaCounts: {
+			map.stream >> sharedMediaCountsKey;
+		} break;
+		case lskDialogsSnapshot: {
+			map.stream >> dialogsSnapshotKey;
+		} break;
+		case lskSearchIndex: {
+			map.stream >> searchIndexKey;
+		} break;
+		case lskSendOutbox: {
+			map.stream >> sendOutboxKey;
+		} break;
 		case lskSavedPeersOld: {
 			quint64 key;
 			map.stream >> key;
@@ -2507,6 +2803,10 @@ ReadMapState _readMap(const QByteArray &pass) {
 	_favedStickersKey = favedStickersKey;
 	_archivedStickersKey = archivedStickersKey;
 	_savedGifsKey = savedGifsKey;
+	_sharedMediaCountsKey = sharedMediaCountsKey;
+	_dialogsSnapshotKey = dialogsSnapshotKey;
+	_searchIndexKey = searchIndexKey;
+	_sendOutboxKey = sendOutboxKey;
 	_backgroundKeyDay = backgroundKeyDay;
 	_backgroundKeyNight = backgroundKeyNight;
 	_userSettingsKey = userSettingsKey;
@@ -2519,10 +2819,8 @@ ReadMapState _readMap(const QByteArray &pass) {
 	} else {
 		_mapChanged = false;
 	}
-
-	if (_locationsKey) {
-		_readLocations();
-	}
+	_readMapJournal();
+	_locationsRead = false;
 
 	_readUserSettings();
 	_readMtpData();
@@ -2556,7 +2854,6 @@ void _writeMap(WriteMapWhen when) {
 
 	if (!QDir().exists(_userBasePath)) QDir().mkpath(_userBasePath);
 
-	FileWriteDescriptor map(qsl("map"));
 	if (_passKeySalt.isEmpty() || _passKeyEncrypted.isEmpty()) {
 		QByteArray pass(kLocalKeySize, Qt::Uninitialized), salt(LocalEncryptSaltSize, Qt::Uninitialized);
 		memset_rand(pass.data(), pass.size());
@@ -2571,8 +2868,6 @@ void _writeMap(WriteMapWhen when) {
 		LocalKey->write(passKeyData.stream);
 		_passKeyEncrypted = PrepareEncrypted(passKeyData, PassKey);
 	}
-	map.writeData(_passKeySalt);
-	map.writeData(_passKeyEncrypted);
 
 	uint32 mapSize = 0;
 	const auto self = [] {
@@ -2608,6 +2903,10 @@ void _writeMap(WriteMapWhen when) {
 	}
 	if (_favedStickersKey) mapSize += sizeof(quint32) + sizeof(quint64);
 	if (_savedGifsKey) mapSize += sizeof(quint32) + sizeof(quint64);
+	if (_sharedMediaCountsKey) mapSize += sizeof(quint32) + sizeof(quint64);
+	if (_dialogsSnapshotKey) mapSize += sizeof(quint32) + sizeof(quint64);
+	if (_searchIndexKey) mapSize += sizeof(quint32) + sizeof(quint64);
+	if (_sendOutboxKey) mapSize += sizeof(quint32) + sizeof(quint64);
 	if (_backgroundKeyDay || _backgroundKeyNight) mapSize += sizeof(quint32) + sizeof(quint64) + sizeof(quint64);
 	if (_userSettingsKey) mapSize += sizeof(quint32) + sizeof(quint64);
 	if (_recentHashtagsAndBotsKey) mapSize += sizeof(quint32) + sizeof(quint64);
@@ -2648,6 +2947,18 @@ void _writeMap(WriteMapWhen when) {
 	if (_savedGifsKey) {
 		mapData.stream << quint32(lskSavedGifs) << quint64(_savedGifsKey);
 	}
+	if (_sharedMediaCountsKey) {
+		mapData.stream << quint32(lskSharedMediaCounts) << quint64(_sharedMediaCountsKey);
+	}
+	if (_dialogsSnapshotKey) {
+		mapData.stream << quint32(lskDialogsSnapshot) << quint64(_dialogsSnapshotKey);
+	}
+	if (_searchIndexKey) {
+		mapData.stream << quint32(lskSearchIndex) << quint64(_searchIndexKey);
+	}
+	if (_sendOutboxKey) {
+		mapData.stream << quint32(lskSendOutbox) << quint64(_sendOutboxKey);
+	}
 	if (_backgroundKeyDay || _backgroundKeyNight) {
 		mapData.stream
 			<< quint32(lskBackground)
@@ -2663,7 +2974,16 @@ void _writeMap(WriteMapWhen when) {
 	if (_exportSettingsKey) {
 		mapData.stream << quint32(lskExportSettings) << quint64(_exportSettingsKey);
 	}
-	map.writeEncrypted(mapData);
+	mapData.finish();
+	WriteEncryptedInBackground(
+		qsl("map"),
+		FileOwner::User,
+		{ _passKeySalt, _passKeyEncrypted },
+		std::move(mapData.data),
+		LocalKey);
+	WriteQueue().async([path = MapJournalPath()] {
+		QFile::remove(path);
+	});
 
 	_mapChanged = false;
 }
@@ -2677,6 +2997,9 @@ void finish() {
 		_manager->deleteLater();
 		_manager = nullptr;
 		delete base::take(_localLoader);
+
+		// Make sure all the background encryption and writes are on disk.
+		WriteQueue().sync([] {});
 	}
 }
 
@@ -2756,15 +3079,11 @@ void writeSettings() {
 
 	if (!QDir().exists(_basePath)) QDir().mkpath(_basePath);
 
-	FileWriteDescriptor settings(
-		cTestMode() ? qsl("settings_test") : qsl("settings"),
-		FileOwner::Global);
 	if (_settingsSalt.isEmpty() || !SettingsKey) {
 		_settingsSalt.resize(LocalEncryptSaltSize);
 		memset_rand(_settingsSalt.data(), _settingsSalt.size());
 		createLocalKey(QByteArray(), &_settingsSalt, &SettingsKey);
 	}
-	settings.writeData(_settingsSalt);
 
 	const auto dcOptionsSerialized = Core::App().dcOptions()->serialize();
 	const auto applicationSettings = Core::App().settings().serialize();
@@ -2826,6 +3145,8 @@ void writeSettings() {
 	}
 
 	data.stream << quint32(dbiTryIPv6) << qint32(Global::TryIPv6());
+	data.stream << quint32(dbiProxyAutoSelect) << qint32(Global::ProxyAutoSelect() ? 1 : 0);
+	data.stream << quint32(dbiPasscodeIterCount) << qint32(PassKeyIterCount);
 	data.stream
 		<< quint32(dbiThemeKey)
 		<< quint64(_themeKeyDay)
@@ -2844,7 +3165,13 @@ void writeSettings() {
 
 	DEBUG_LOG(("Window Pos: Writing to storage %1, %2, %3, %4 (maximized %5)").arg(position.x).arg(position.y).arg(position.w).arg(position.h).arg(Logs::b(position.maximized)));
 
-	settings.writeEncrypted(data, SettingsKey);
+	data.finish();
+	WriteEncryptedInBackground(
+		cTestMode() ? qsl("settings_test") : qsl("settings"),
+		FileOwner::Global,
+		{ _settingsSalt },
+		std::move(data.data),
+		SettingsKey);
 }
 
 void writeUserSettings() {
@@ -2926,11 +3253,22 @@ void reset() {
 	_fileLocations.clear();
 	_fileLocationPairs.clear();
 	_fileLocationAliases.clear();
+	_locationsRead = false;
 	_draftsNotReadMap.clear();
 	_locationsKey = _trustedBotsKey = 0;
 	_recentStickersKeyOld = 0;
 	_installedStickersKey = _featuredStickersKey = _recentStickersKey = _favedStickersKey = _archivedStickersKey = 0;
+	_stickerSetKeys.clear();
+	_stickerSetWrittenHashes.clear();
+	_stickersCountedHash = std::nullopt;
+	_savedGifsCountedHash = std::nullopt;
 	_savedGifsKey = 0;
+	_sharedMediaCountsKey = 0;
+	_dialogsSnapshotKey = 0;
+	_searchIndexKey = 0;
+	_sendOutboxKey = 0;
+	_sendOutbox.clear();
+	_sendOutboxRead = false;
 	_backgroundKeyDay = _backgroundKeyNight = 0;
 	Window::Theme::Background()->reset();
 	_userSettingsKey = _recentHashtagsAndBotsKey = _exportSettingsKey = 0;
@@ -2952,9 +3290,24 @@ bool checkPasscode(const QByteArray &passcode) {
 	return checkKey->equals(PassKey);
 }
 
-void setPasscode(const QByteArray &passcode) {
-	createLocalKey(passcode, &_passKeySalt, &PassKey);
+void checkPasscodeAsync(const QByteArray &passcode, Fn<void(bool)> done) {
+	const auto iterCount = passcode.size()
+		? PassKeyIterCount
+		: int(LocalEncryptNoPwdIterCount);
+	crl::async([
+		passcode,
+		salt = _passKeySalt,
+		iterCount,
+		done = std::move(done)
+	]() mutable {
+		auto key = DeriveLocalKey(passcode, salt, iterCount);
+		crl::on_main([key = std::move(key), done = std::move(done)] {
+			done(key->equals(PassKey));
+		});
+	});
+}
 
+void applyPassKeyChange(bool hasPasscode) {
 	EncryptedDescriptor passKeyData(kLocalKeySize);
 	LocalKey->write(passKeyData.stream);
 	_passKeyEncrypted = PrepareEncrypted(passKeyData, PassKey);
@@ -2962,10 +3315,48 @@ void setPasscode(const QByteArray &passcode) {
 	_mapChanged = true;
 	_writeMap(WriteMapWhen::Now);
 
-	Global::SetLocalPasscode(!passcode.isEmpty());
+	Global::SetLocalPasscode(hasPasscode);
 	Global::RefLocalPasscodeChanged().notify();
 }
 
+void setPasscode(const QByteArray &passcode) {
+	createLocalKey(passcode, &_passKeySalt, &PassKey);
+	applyPassKeyChange(!passcode.isEmpty());
+}
+
+void setPasscodeAsync(const QByteArray &passcode, Fn<void()> done) {
+	if (passcode.isEmpty()) {
+		// The no-passcode key uses a few iterations only, no need
+		// to calibrate or leave the main thread for it.
+		setPasscode(passcode);
+		done();
+		return;
+	}
+	crl::async([
+		passcode,
+		salt = _passKeySalt,
+		done = std::move(done)
+	]() mutable {
+		const auto iterCount = CalibratePassKeyIterCount();
+		auto key = DeriveLocalKey(passcode, salt, iterCount);
+		crl::on_main([
+			key = std::move(key),
+			iterCount,
+			done = std::move(done)
+		] {
+			PassKeyIterCount = iterCount;
+			PassKey = std::move(key);
+			applyPassKeyChange(true);
+
+			// Persist the calibrated iteration count right away, the
+			// pass key can't be checked without it after a restart.
+			writeSettings();
+
+			done();
+		});
+	});
+}
+
 base::flat_set<QString> CollectGoodNames() {
 	const auto keys = {
 		_locationsKey,
@@ -2977,13 +3368,17 @@ base::flat_set<QString> CollectGoodNames() {
 		_archivedStickersKey,
 		_recentStickersKeyOld,
 		_savedGifsKey,
+		_sharedMediaCountsKey,
+		_dialogsSnapshotKey,
+		_searchIndexKey,
+		_sendOutboxKey,
 		_backgroundKeyNight,
 		_backgroundKeyDay,
 		_recentHashtagsAndBotsKey,
 		_exportSettingsKey,
 		_trustedBotsKey
 	};
-	auto result = base::flat_set<QString>{ "map0", "map1", "maps" };
+	auto result = base::flat_set<QString>{ "map0", "map1", "maps", "journal" };
 	const auto push = [&](FileKey key) {
 		if (!key) {
 			return;
@@ -3001,6 +3396,9 @@ base::flat_set<QString> CollectGoodNames() {
 	for (const auto &value : _draftCursorsMap) {
 		push(value);
 	}
+	for (const auto &[id, key] : _stickerSetKeys) {
+		push(key);
+	}
 	for (const auto &value : keys) {
 		push(value);
 	}
@@ -3014,7 +3412,9 @@ void FilterLegacyFiles(FnMut<void(base::flat_set<QString>&&)> then) {
 }
 
 ReadMapState readMap(const QByteArray &pass) {
+	Core::StartupProfiler::Begin("read map");
 	ReadMapState result = _readMap(pass);
+	Core::StartupProfiler::End("read map");
 	if (result == ReadMapFailed) {
 		_mapChanged = true;
 		_writeMap(WriteMapWhen::Now);
@@ -3039,10 +3439,12 @@ void writeDrafts(const PeerId &peer, const MessageDraft &localDraft, const Messa
 	if (localDraft.msgId <= 0 && localDraft.textWithTags.text.isEmpty() && editDraft.msgId <= 0) {
 		auto i = _draftsMap.find(peer);
 		if (i != _draftsMap.cend()) {
-			ClearKey(i.value());
+			// Ordered after any still queued write to the same file.
+			WriteQueue().async([key = i.value()] {
+				ClearKey(key);
+			});
 			_draftsMap.erase(i);
-			_mapChanged = true;
-			_writeMap();
+			_writeMapDelta(lskDraft, peer, 0);
 		}
 
 		_draftsNotReadMap.remove(peer);
@@ -3050,8 +3452,7 @@ void writeDrafts(const PeerId &peer, const MessageDraft &localDraft, const Messa
 		auto i = _draftsMap.constFind(peer);
 		if (i == _draftsMap.cend()) {
 			i = _draftsMap.insert(peer, GenerateKey());
-			_mapChanged = true;
-			_writeMap(WriteMapWhen::Fast);
+			_writeMapDelta(lskDraft, peer, i.value(), WriteMapWhen::Fast);
 		}
 
 		auto msgTags = TextUtilities::SerializeTags(
@@ -3070,8 +3471,16 @@ void writeDrafts(const PeerId &peer, const MessageDraft &localDraft, const Messa
 		data.stream << editDraft.textWithTags.text << editTags;
 		data.stream << qint32(editDraft.msgId) << qint32(editDraft.previewCancelled ? 1 : 0);
 
-		FileWriteDescriptor file(i.value());
-		file.writeEncrypted(data);
+		// A burst of draft saves (fast typing, switching between several
+		// dialogs with edited drafts) encrypts and hits the disk on the
+		// write queue, the UI thread only serializes the small payload.
+		data.finish();
+		WriteEncryptedInBackground(
+			toFilePart(i.value()),
+			FileOwner::User,
+			{},
+			std::move(data.data),
+			LocalKey);
 
 		_draftsNotReadMap.remove(peer);
 	}
@@ -3080,10 +3489,12 @@ void writeDrafts(const PeerId &peer, const MessageDraft &localDraft, const Messa
 void clearDraftCursors(const PeerId &peer) {
 	DraftsMap::iterator i = _draftCursorsMap.find(peer);
 	if (i != _draftCursorsMap.cend()) {
-		ClearKey(i.value());
+		// Ordered after any still queued write to the same file.
+		WriteQueue().async([key = i.value()] {
+			ClearKey(key);
+		});
 		_draftCursorsMap.erase(i);
-		_mapChanged = true;
-		_writeMap();
+		_writeMapDelta(lskDraftPosition, peer, 0);
 	}
 }
 
@@ -3204,16 +3615,20 @@ void writeDraftCursors(const PeerId &peer, const MessageCursor &msgCursor, const
 		DraftsMap::const_iterator i = _draftCursorsMap.constFind(peer);
 		if (i == _draftCursorsMap.cend()) {
 			i = _draftCursorsMap.insert(peer, GenerateKey());
-			_mapChanged = true;
-			_writeMap(WriteMapWhen::Fast);
+			_writeMapDelta(lskDraftPosition, peer, i.value(), WriteMapWhen::Fast);
 		}
 
-		EncryptedDescriptor data(sizeof(quint64) + sizeof(qint32) * 3);
+		EncryptedDescriptor data(sizeof(quint64) + sizeof(qint32) * 6);
 		data.stream << quint64(peer) << qint32(msgCursor.position) << qint32(msgCursor.anchor) << qint32(msgCursor.scroll);
 		data.stream << qint32(editCursor.position) << qint32(editCursor.anchor) << qint32(editCursor.scroll);
 
-		FileWriteDescriptor file(i.value());
-		file.writeEncrypted(data);
+		data.finish();
+		WriteEncryptedInBackground(
+			toFilePart(i.value()),
+			FileOwner::User,
+			{},
+			std::move(data.data),
+			LocalKey);
 	}
 }
 
@@ -3229,6 +3644,7 @@ void writeFileLocation(MediaKey location, const FileLocation &local) {
 	if (local.fname.isEmpty()) {
 		return;
 	}
+	_hydrateLocations();
 	if (!local.inMediaCache()) {
 		FileLocationAliases::const_iterator aliasIt = _fileLocationAliases.constFind(location);
 		if (aliasIt != _fileLocationAliases.cend()) {
@@ -3268,6 +3684,8 @@ void writeFileLocation(MediaKey location, const FileLocation &local) {
 }
 
 void removeFileLocation(MediaKey location) {
+	_hydrateLocations();
+
 	FileLocations::iterator i = _fileLocations.find(location);
 	if (i == _fileLocations.end()) {
 		return;
@@ -3279,6 +3697,8 @@ void removeFileLocation(MediaKey location) {
 }
 
 FileLocation readFileLocation(MediaKey location) {
+	_hydrateLocations();
+
 	FileLocationAliases::const_iterator aliasIt = _fileLocationAliases.constFind(location);
 	if (aliasIt != _fileLocationAliases.cend()) {
 		location = aliasIt.value();
@@ -3381,6 +3801,11 @@ public:
 			if (!_waveform.isEmpty()) {
 				voice->waveform = _waveform;
 				voice->wavemax = _wavemax;
+				_doc->owner().cache().put(
+					_doc->voiceWaveformCacheKey(),
+					Storage::Cache::Database::TaggedValue(
+						documentWaveformEncode5bit(_waveform),
+						Data::kVoiceMessageCacheTag));
 			}
 			if (voice->waveform.isEmpty()) {
 				voice->waveform.resize(1);
@@ -3410,15 +3835,47 @@ protected:
 
 void countVoiceWaveform(not_null<Data::DocumentMedia*> media) {
 	const auto document = media->owner();
-	if (const auto voice = document->voice()) {
-		if (_localLoader) {
-			voice->waveform.resize(1 + sizeof(TaskId));
-			voice->waveform[0] = -1; // counting
-			TaskId taskId = _localLoader->addTask(
-				std::make_unique<CountWaveformTask>(media));
-			memcpy(voice->waveform.data() + 1, &taskId, sizeof(taskId));
-		}
+	const auto voice = document->voice();
+	if (!voice || !_localLoader) {
+		return;
 	}
+	voice->waveform.resize(1 + sizeof(TaskId));
+	voice->waveform[0] = -1; // counting
+	auto taskId = TaskId();
+	memcpy(voice->waveform.data() + 1, &taskId, sizeof(taskId));
+
+	// Look the waveform up in the cache before decoding the whole file.
+	const auto guard = base::make_weak(&document->session());
+	document->owner().cache().get(document->voiceWaveformCacheKey(), [=](
+			QByteArray value) {
+		crl::on_main(guard, [=] {
+			const auto voice = document->voice();
+			if (!voice
+				|| voice->waveform.isEmpty()
+				|| voice->waveform[0] != -1) {
+				return;
+			} else if (!value.isEmpty()) {
+				voice->waveform = documentWaveformDecode(value);
+				voice->wavemax = voice->waveform.isEmpty()
+					? char(0)
+					: *ranges::max_element(voice->waveform);
+				if (voice->waveform.isEmpty()) {
+					voice->waveform.resize(1);
+					voice->waveform[0] = -2;
+				}
+				document->owner().requestDocumentViewRepaint(document);
+			} else if (const auto active = document->activeMediaView()) {
+				if (_localLoader) {
+					TaskId taskId = _localLoader->addTask(
+						std::make_unique<CountWaveformTask>(active.get()));
+					memcpy(
+						voice->waveform.data() + 1,
+						&taskId,
+						sizeof(taskId));
+				}
+			}
+		});
+	});
 }
 
 void cancelTask(TaskId id) {
@@ -3427,6 +3884,67 @@ void cancelTask(TaskId id) {
 	}
 }
 
+// A fingerprint of the set contents, to skip rewriting the contents file
+// of a set that didn't change since it was written the last time.
+int32 _countStickerSetContentsHash(const Stickers::Set &set) {
+	auto result = Api::HashInit();
+	Api::HashUpdate(result, set.hash);
+	for (const auto sticker : set.stickers) {
+		Api::HashUpdate(result, sticker->id);
+	}
+	for (const auto date : set.dates) {
+		Api::HashUpdate(result, date);
+	}
+	Api::HashUpdate(result, int32(set.emoji.size()));
+	return Api::HashFinalize(result);
+}
+
+void _writeStickerSetContents(const Stickers::Set &set, FileKey contentsKey) {
+	// versionTag + version + setId + stickersCount
+	quint32 size = sizeof(quint32)
+		+ sizeof(qint32)
+		+ sizeof(quint64)
+		+ sizeof(qint32);
+	for (const auto sticker : set.stickers) {
+		size += Serialize::Document::sizeInStream(sticker);
+	}
+	size += sizeof(qint32); // datesCount
+	if (!set.dates.empty()) {
+		Assert(set.dates.size() == set.stickers.size());
+		size += set.dates.size() * sizeof(qint32);
+	}
+	size += sizeof(qint32); // emojiCount
+	for (auto j = set.emoji.cbegin(), e = set.emoji.cend(); j != e; ++j) {
+		size += Serialize::stringSize(j.key()->id()) + sizeof(qint32) + (j->size() * sizeof(quint64));
+	}
+
+	EncryptedDescriptor data(size);
+	data.stream
+		<< quint32(kStickersVersionTag)
+		<< qint32(kStickersSerializeVersion)
+		<< quint64(set.id)
+		<< qint32(set.stickers.size());
+	for (const auto &sticker : set.stickers) {
+		Serialize::Document::writeToStream(data.stream, sticker);
+	}
+	data.stream << qint32(set.dates.size());
+	if (!set.dates.empty()) {
+		for (const auto date : set.dates) {
+			data.stream << qint32(date);
+		}
+	}
+	data.stream << qint32(set.emoji.size());
+	for (auto j = set.emoji.cbegin(), e = set.emoji.cend(); j != e; ++j) {
+		data.stream << j.key()->id() << qint32(j->size());
+		for (const auto sticker : *j) {
+			data.stream << quint64(sticker->id);
+		}
+	}
+
+	FileWriteDescriptor file(contentsKey);
+	file.writeEncrypted(data);
+}
+
 void _writeStickerSet(QDataStream &stream, const Stickers::Set &set) {
 	const auto writeInfo = [&](int count) {
 		stream
@@ -3442,29 +3960,32 @@ void _writeStickerSet(QDataStream &stream, const Stickers::Set &set) {
 	};
 	if (set.flags & MTPDstickerSet_ClientFlag::f_not_loaded) {
 		writeInfo(-set.count);
-		return;
-	} else if (set.stickers.isEmpty()) {
+		stream << quint64(0) << qint32(0);
 		return;
 	}
 
 	writeInfo(set.stickers.size());
-	for (const auto &sticker : set.stickers) {
-		Serialize::Document::writeToStream(stream, sticker);
-	}
-	stream << qint32(set.dates.size());
-	if (!set.dates.empty()) {
-		Assert(set.dates.size() == set.stickers.size());
-		for (const auto date : set.dates) {
-			stream << qint32(date);
-		}
-	}
-	stream << qint32(set.emoji.size());
-	for (auto j = set.emoji.cbegin(), e = set.emoji.cend(); j != e; ++j) {
-		stream << j.key()->id() << qint32(j->size());
-		for (const auto sticker : *j) {
-			stream << quint64(sticker->id);
+	auto contentsKey = FileKey(0);
+	auto contentsHash = qint32(0);
+	if (!set.stickers.isEmpty()) {
+		const auto i = _stickerSetKeys.find(quint64(set.id));
+		contentsKey = (i != end(_stickerSetKeys)) ? i->second : FileKey(0);
+		contentsHash = _countStickerSetContentsHash(set);
+		const auto written = _stickerSetWrittenHashes.find(quint64(set.id));
+		if (!contentsKey
+			|| written == end(_stickerSetWrittenHashes)
+			|| written->second != contentsHash) {
+			if (!contentsKey) {
+				contentsKey = GenerateKey();
+				_stickerSetKeys.emplace_or_assign(quint64(set.id), contentsKey);
+			}
+			_writeStickerSetContents(set, contentsKey);
+			_stickerSetWrittenHashes.emplace_or_assign(
+				quint64(set.id),
+				contentsHash);
 		}
 	}
+	stream << quint64(contentsKey) << qint32(contentsHash);
 }
 
 // In generic method _writeStickerSets() we look through all the sets and call a
@@ -3480,7 +4001,21 @@ template <typename CheckSet>
 void _writeStickerSets(FileKey &stickersKey, CheckSet checkSet, const Stickers::Order &order) {
 	if (!_working()) return;
 
+	_stickersCountedHash = std::nullopt;
+
 	const auto &sets = Auth().data().stickerSets();
+
+	// Drop the contents files of sets that are gone from the repository.
+	for (auto i = _stickerSetKeys.begin(); i != _stickerSetKeys.end();) {
+		if (sets.find(i->first) != end(sets)) {
+			++i;
+		} else {
+			ClearKey(i->second);
+			_stickerSetWrittenHashes.remove(i->first);
+			i = _stickerSetKeys.erase(i);
+		}
+	}
+
 	if (sets.empty()) {
 		if (stickersKey) {
 			ClearKey(stickersKey);
@@ -3504,30 +4039,15 @@ void _writeStickerSets(FileKey &stickersKey, CheckSet checkSet, const Stickers::
 			continue;
 		}
 
-		// id + access + title + shortName + stickersCount + hash + flags + installDate
+		// id + access + title + shortName + stickersCount + hash + flags
+		// + installDate + thumbnail + contentsKey + contentsHash
 		size += sizeof(quint64) * 2
 			+ Serialize::stringSize(raw->title)
 			+ Serialize::stringSize(raw->shortName)
 			+ sizeof(qint32) * 4
-			+ Serialize::imageLocationSize(raw->thumbnailLocation());
-		if (raw->flags & MTPDstickerSet_ClientFlag::f_not_loaded) {
-			continue;
-		}
-
-		for (const auto sticker : raw->stickers) {
-			size += Serialize::Document::sizeInStream(sticker);
-		}
-
-		size += sizeof(qint32); // datesCount
-		if (!raw->dates.empty()) {
-			Assert(raw->stickers.size() == raw->dates.size());
-			size += raw->dates.size() * sizeof(qint32);
-		}
-
-		size += sizeof(qint32); // emojiCount
-		for (auto j = raw->emoji.cbegin(), e = raw->emoji.cend(); j != e; ++j) {
-			size += Serialize::stringSize(j.key()->id()) + sizeof(qint32) + (j->size() * sizeof(quint64));
-		}
+			+ Serialize::imageLocationSize(raw->thumbnailLocation())
+			+ sizeof(quint64)
+			+ sizeof(qint32);
 
 		++setsCount;
 	}
@@ -3567,7 +4087,108 @@ void _writeStickerSets(FileKey &stickersKey, CheckSet checkSet, const Stickers::
 	file.writeEncrypted(data);
 }
 
+bool _readStickerSetContents(Stickers::Set *set, FileKey contentsKey) {
+	FileReadDescriptor contents;
+	if (!ReadEncryptedFile(contents, contentsKey)) {
+		return false;
+	}
+
+	quint32 versionTag = 0;
+	qint32 version = 0;
+	quint64 setId = 0;
+	qint32 scnt = 0;
+	contents.stream >> versionTag >> version >> setId >> scnt;
+	if (!_checkStreamStatus(contents.stream)
+		|| versionTag != kStickersVersionTag
+		|| version != kStickersSerializeVersion
+		|| setId != set->id
+		|| scnt < 0) {
+		return false;
+	}
+
+	const auto fillStickers = set->stickers.isEmpty();
+	if (fillStickers) {
+		set->stickers.reserve(scnt);
+		set->count = 0;
+	}
+
+	auto inputSet = MTP_inputStickerSetID(MTP_long(set->id), MTP_long(set->access));
+	Serialize::Document::StickerSetInfo info(set->id, set->access, set->shortName);
+	base::flat_set<DocumentId> read;
+	for (int32 j = 0; j < scnt; ++j) {
+		auto document = Serialize::Document::readStickerFromStream(contents.version, contents.stream, info);
+		if (!_checkStreamStatus(contents.stream)) {
+			return false;
+		} else if (!document
+			|| !document->sticker()
+			|| read.contains(document->id)) {
+			continue;
+		}
+		read.emplace(document->id);
+		if (fillStickers) {
+			set->stickers.push_back(document);
+			if (!(set->flags & MTPDstickerSet_ClientFlag::f_special)) {
+				if (document->sticker()->set.type() != mtpc_inputStickerSetID) {
+					document->sticker()->set = inputSet;
+				}
+			}
+			++set->count;
+		}
+	}
+
+	qint32 datesCount = 0;
+	contents.stream >> datesCount;
+	if (datesCount > 0) {
+		if (datesCount != scnt) {
+			return false;
+		}
+		const auto fillDates = (set->id == Stickers::CloudRecentSetId)
+			&& (set->stickers.size() == datesCount);
+		if (fillDates) {
+			set->dates.clear();
+			set->dates.reserve(datesCount);
+		}
+		for (auto i = 0; i != datesCount; ++i) {
+			qint32 date = 0;
+			contents.stream >> date;
+			if (fillDates) {
+				set->dates.push_back(TimeId(date));
+			}
+		}
+	}
+
+	qint32 emojiCount = 0;
+	contents.stream >> emojiCount;
+	if (!_checkStreamStatus(contents.stream) || emojiCount < 0) {
+		return false;
+	}
+	for (int32 j = 0; j < emojiCount; ++j) {
+		QString emojiString;
+		qint32 stickersCount;
+		contents.stream >> emojiString >> stickersCount;
+		Stickers::Pack pack;
+		pack.reserve(stickersCount);
+		for (int32 k = 0; k < stickersCount; ++k) {
+			quint64 id;
+			contents.stream >> id;
+			const auto doc = Auth().data().document(id);
+			if (!doc->sticker()) continue;
+
+			pack.push_back(doc);
+		}
+		if (fillStickers) {
+			if (auto emoji = Ui::Emoji::Find(emojiString)) {
+				emoji = emoji->original();
+				set->emoji.insert(emoji, pack);
+			}
+		}
+	}
+	return _checkStreamStatus(contents.stream);
+}
+
 void _readStickerSets(FileKey &stickersKey, Stickers::Order *outOrder = nullptr, MTPDstickerSet::Flags readingFlags = 0) {
+	_stickersCountedHash = std::nullopt;
+
 	FileReadDescriptor stickers;
 	if (!ReadEncryptedFile(stickers, stickersKey)) {
 		ClearKey(stickersKey);
@@ -3620,6 +4241,9 @@ void _readStickerSets(FileKey &stickersKey, Stickers::Order *outOrder = nullptr,
 			>> setHash
 			>> setFlagsValue
 			>> setInstallDate;
+		quint64 contentsKey = 0;
+		qint32 contentsHash = 0;
+
 		const auto thumbnail = Serialize::readImageLocation(
 			stickers.version,
 			stickers.stream);
@@ -3633,6 +4257,10 @@ void _readStickerSets(FileKey &stickersKey, Stickers::Order *outOrder = nullptr,
 		} else {
 			setThumbnail = *thumbnail;
 		}
+		stickers.stream >> contentsKey >> contentsHash;
+		if (!_checkStreamStatus(stickers.stream)) {
+			return failed();
+		}
 
 		setFlags = MTPDstickerSet::Flags::from_raw(setFlagsValue);
 		if (setId == Stickers::DefaultSetId) {
@@ -3669,90 +4297,25 @@ void _readStickerSets(FileKey &stickersKey, Stickers::Order *outOrder = nullptr,
 				ImageWithLocation{ .location = setThumbnail });
 		}
 		const auto set = it->second.get();
-		auto inputSet = MTP_inputStickerSetID(MTP_long(set->id), MTP_long(set->access));
-		const auto fillStickers = set->stickers.isEmpty();
 
 		if (scnt < 0) { // disabled not loaded set
-			if (!set->count || fillStickers) {
+			if (!set->count || set->stickers.isEmpty()) {
 				set->count = -scnt;
 			}
 			continue;
+		} else if (!contentsKey) {
+			continue;
 		}
 
-		if (fillStickers) {
-			set->stickers.reserve(scnt);
-			set->count = 0;
-		}
-
-		Serialize::Document::StickerSetInfo info(setId, setAccess, setShortName);
-		base::flat_set<DocumentId> read;
-		for (int32 j = 0; j < scnt; ++j) {
-			auto document = Serialize::Document::readStickerFromStream(stickers.version, stickers.stream, info);
-			if (!_checkStreamStatus(stickers.stream)) {
-				return failed();
-			} else if (!document
-				|| !document->sticker()
-				|| read.contains(document->id)) {
-				continue;
-			}
-			read.emplace(document->id);
-			if (fillStickers) {
-				set->stickers.push_back(document);
-				if (!(set->flags & MTPDstickerSet_ClientFlag::f_special)) {
-					if (document->sticker()->set.type() != mtpc_inputStickerSetID) {
-						document->sticker()->set = inputSet;
-					}
-				}
-				++set->count;
-			}
-		}
-
-		qint32 datesCount = 0;
-		stickers.stream >> datesCount;
-		if (datesCount > 0) {
-			if (datesCount != scnt) {
-				return failed();
-			}
-			const auto fillDates = (set->id == Stickers::CloudRecentSetId)
-				&& (set->stickers.size() == datesCount);
-			if (fillDates) {
-				set->dates.clear();
-				set->dates.reserve(datesCount);
-			}
-			for (auto i = 0; i != datesCount; ++i) {
-				qint32 date = 0;
-				stickers.stream >> date;
-				if (fillDates) {
-					set->dates.push_back(TimeId(date));
-				}
-			}
-		}
-
-		qint32 emojiCount = 0;
-		stickers.stream >> emojiCount;
-		if (!_checkStreamStatus(stickers.stream) || emojiCount < 0) {
-			return failed();
-		}
-		for (int32 j = 0; j < emojiCount; ++j) {
-			QString emojiString;
-			qint32 stickersCount;
-			stickers.stream >> emojiString >> stickersCount;
-			Stickers::Pack pack;
-			pack.reserve(stickersCount);
-			for (int32 k = 0; k < stickersCount; ++k) {
-				quint64 id;
-				stickers.stream >> id;
-				const auto doc = Auth().data().document(id);
-				if (!doc->sticker()) continue;
-
-				pack.push_back(doc);
-			}
-			if (fillStickers) {
-				if (auto emoji = Ui::Emoji::Find(emojiString)) {
-					emoji = emoji->original();
-					set->emoji.insert(emoji, pack);
-				}
-			}
+		_stickerSetKeys.emplace_or_assign(setId, FileKey(contentsKey));
+		_stickerSetWrittenHashes.emplace_or_assign(setId, contentsHash);
+		if (!_readStickerSetContents(set, FileKey(contentsKey))) {
+			// The contents file is broken, drop it and mark the set to be
+			// requested from the server again.
+			ClearKey(FileKey(contentsKey));
+			_stickerSetKeys.remove(setId);
+			_stickerSetWrittenHashes.remove(setId);
+			set->flags |= MTPDstickerSet_ClientFlag::f_not_loaded;
 		}
 	}
 
@@ -4030,12 +4593,10 @@ void readArchivedStickers() {
 	}
 }
 
-int32 countDocumentVectorHash(const QVector<DocumentData*> vector) {
-	auto result = Api::HashInit();
-	for (const auto document : vector) {
-		Api::HashUpdate(result, document->id);
-	}
-	return Api::HashFinalize(result);
+int32 countDocumentVectorHash(const QVector<DocumentData*> &vector) {
+	return Api::CountHash(vector, [](DocumentData *document) {
+		return document->id;
+	});
 }
 
 int32 countSpecialStickerSetHash(uint64 setId) {
@@ -4048,24 +4609,28 @@ int32 countSpecialStickerSetHash(uint64 setId) {
 }
 
 int32 countStickersHash(bool checkOutdatedInfo) {
-	auto result = Api::HashInit();
-	bool foundOutdated = false;
-	const auto &sets = Auth().data().stickerSets();
-	const auto &order = Auth().data().stickerSetsOrder();
-	for (auto i = order.cbegin(), e = order.cend(); i != e; ++i) {
-		auto it = sets.find(*i);
-		if (it != sets.cend()) {
-			const auto set = it->second.get();
-			if (set->id == Stickers::DefaultSetId) {
-				foundOutdated = true;
-			} else if (!(set->flags & MTPDstickerSet_ClientFlag::f_special)
-				&& !(set->flags & MTPDstickerSet::Flag::f_archived)) {
-				Api::HashUpdate(result, set->hash);
+	if (!_stickersCountedHash) {
+		auto result = Api::HashInit();
+		bool foundOutdated = false;
+		const auto &sets = Auth().data().stickerSets();
+		const auto &order = Auth().data().stickerSetsOrder();
+		for (auto i = order.cbegin(), e = order.cend(); i != e; ++i) {
+			auto it = sets.find(*i);
+			if (it != sets.cend()) {
+				const auto set = it->second.get();
+				if (set->id == Stickers::DefaultSetId) {
+					foundOutdated = true;
+				} else if (!(set->flags & MTPDstickerSet_ClientFlag::f_special)
+					&& !(set->flags & MTPDstickerSet::Flag::f_archived)) {
+					Api::HashUpdate(result, set->hash);
+				}
 			}
 		}
+		_stickersCountedHash = Api::HashFinalize(result);
+		_stickersCountedHashOutdated = foundOutdated;
 	}
-	return (!checkOutdatedInfo || !foundOutdated)
-		? Api::HashFinalize(result)
+	return (!checkOutdatedInfo || !_stickersCountedHashOutdated)
+		? *_stickersCountedHash
 		: 0;
 }
 
@@ -4094,12 +4659,18 @@ int32 countFeaturedStickersHash() {
 }
 
 int32 countSavedGifsHash() {
-	return countDocumentVectorHash(Auth().data().savedGifs());
+	if (!_savedGifsCountedHash) {
+		_savedGifsCountedHash = countDocumentVectorHash(
+			Auth().data().savedGifs());
+	}
+	return *_savedGifsCountedHash;
 }
 
 void writeSavedGifs() {
 	if (!_working()) return;
 
+	_savedGifsCountedHash = std::nullopt;
+
 	auto &saved = Auth().data().savedGifs();
 	if (saved.isEmpty()) {
 		if (_savedGifsKey) {
@@ -4132,6 +4703,8 @@ void writeSavedGifs() {
 void readSavedGifs() {
 	if (!_savedGifsKey) return;
 
+	_savedGifsCountedHash = std::nullopt;
+
 	FileReadDescriptor gifs;
 	if (!ReadEncryptedFile(gifs, _savedGifsKey)) {
 		ClearKey(_savedGifsKey);
@@ -4167,6 +4740,312 @@ void readSavedGifs() {
 	}
 }
 
+void writeSharedMediaCounts() {
+	if (!_working()) return;
+
+	const auto serialized = Auth().storage().serializeSharedMediaCounts();
+	if (serialized.isEmpty()) {
+		if (_sharedMediaCountsKey) {
+			ClearKey(_sharedMediaCountsKey);
+			_sharedMediaCountsKey = 0;
+			_mapChanged = true;
+		}
+		_writeMap();
+	} else {
+		if (!_sharedMediaCountsKey) {
+			_sharedMediaCountsKey = GenerateKey();
+			_mapChanged = true;
+			_writeMap(WriteMapWhen::Fast);
+		}
+		quint32 size = Serialize::bytearraySize(serialized);
+		EncryptedDescriptor data(size);
+		data.stream << serialized;
+		FileWriteDescriptor file(_sharedMediaCountsKey);
+		file.writeEncrypted(data);
+	}
+}
+
+void readSharedMediaCounts() {
+	if (!_sharedMediaCountsKey) return;
+
+	FileReadDescriptor counts;
+	if (!ReadEncryptedFile(counts, _sharedMediaCountsKey)) {
+		ClearKey(_sharedMediaCountsKey);
+		_sharedMediaCountsKey = 0;
+		_writeMap();
+		return;
+	}
+
+	QByteArray serialized;
+	counts.stream >> serialized;
+	if (!_checkStreamStatus(counts.stream)) {
+		return;
+	}
+	Auth().storage().applySharedMediaCounts(serialized);
+}
+
+void writeSearchIndex() {
+	if (!_working()) return;
+
+	const auto serialized = Auth().storage().serializeSearchIndex();
+	if (serialized.isEmpty()) {
+		if (_searchIndexKey) {
+			ClearKey(_searchIndexKey);
+			_searchIndexKey = 0;
+			_mapChanged = true;
+		}
+		_writeMap();
+	} else {
+		if (!_searchIndexKey) {
+			_searchIndexKey = GenerateKey();
+			_mapChanged = true;
+			_writeMap(WriteMapWhen::Fast);
+		}
+		quint32 size = Serialize::bytearraySize(serialized);
+		EncryptedDescriptor data(size);
+		data.stream << serialized;
+		FileWriteDescriptor file(_searchIndexKey);
+		file.writeEncrypted(data);
+	}
+}
+
+void readSearchIndex() {
+	if (!_searchIndexKey) return;
+
+	FileReadDescriptor index;
+	if (!ReadEncryptedFile(index, _searchIndexKey)) {
+		ClearKey(_searchIndexKey);
+		_searchIndexKey = 0;
+		_writeMap();
+		return;
+	}
+
+	QByteArray serialized;
+	index.stream >> serialized;
+	if (!_checkStreamStatus(index.stream)) {
+		return;
+	}
+	Auth().storage().applySearchIndex(serialized);
+}
+
+namespace {
+
+void WriteSendOutbox() {
+	if (_sendOutbox.empty()) {
+		if (_sendOutboxKey) {
+			ClearKey(_sendOutboxKey);
+			_sendOutboxKey = 0;
+			_mapChanged = true;
+		}
+		_writeMap();
+		return;
+	}
+	if (!_sendOutboxKey) {
+		_sendOutboxKey = GenerateKey();
+		_mapChanged = true;
+		_writeMap(WriteMapWhen::Fast);
+	}
+	quint32 size = sizeof(quint32);
+	for (const auto &entry : _sendOutbox) {
+		size += sizeof(quint64) * 2
+			+ sizeof(qint32) * 2
+			+ Serialize::stringSize(entry.text);
+	}
+	EncryptedDescriptor data(size);
+	data.stream << quint32(_sendOutbox.size());
+	for (const auto &entry : _sendOutbox) {
+		data.stream
+			<< quint64(entry.randomId)
+			<< quint64(entry.peerId)
+			<< qint32(entry.replyTo)
+			<< qint32(entry.silent ? 1 : 0)
+			<< entry.text;
+	}
+	FileWriteDescriptor file(_sendOutboxKey);
+	file.writeEncrypted(data);
+}
+
+void ReadSendOutbox() {
+	if (_sendOutboxRead) {
+		return;
+	}
+	_sendOutboxRead = true;
+	if (!_sendOutboxKey) {
+		return;
+	}
+
+	FileReadDescriptor outbox;
+	if (!ReadEncryptedFile(outbox, _sendOutboxKey)) {
+		ClearKey(_sendOutboxKey);
+		_sendOutboxKey = 0;
+		_writeMap();
+		return;
+	}
+	quint32 count = 0;
+	outbox.stream >> count;
+	if (!_checkStreamStatus(outbox.stream)) {
+		return;
+	}
+	auto result = std::vector<SendOutboxEntry>();
+	for (auto i = quint32(0); i != count; ++i) {
+		auto entry = SendOutboxEntry();
+		qint32 silent = 0;
+		outbox.stream
+			>> entry.randomId
+			>> entry.peerId
+			>> entry.replyTo
+			>> silent
+			>> entry.text;
+		if (!_checkStreamStatus(outbox.stream)) {
+			return;
+		}
+		entry.silent = (silent == 1);
+		result.push_back(std::move(entry));
+	}
+	_sendOutbox = std::move(result);
+}
+
+} // namespace
+
+void addToSendOutbox(const SendOutboxEntry &entry) {
+	if (!_working()) return;
+
+	ReadSendOutbox();
+	_sendOutbox.push_back(entry);
+	WriteSendOutbox();
+}
+
+void removeFromSendOutbox(quint64 randomId) {
+	if (!_working()) return;
+
+	ReadSendOutbox();
+	const auto i = ranges::find(
+		_sendOutbox,
+		randomId,
+		&SendOutboxEntry::randomId);
+	if (i == end(_sendOutbox)) {
+		return;
+	}
+	_sendOutbox.erase(i);
+	WriteSendOutbox();
+}
+
+std::vector<SendOutboxEntry> readSendOutbox() {
+	ReadSendOutbox();
+
+	// The entries stay journaled until each replayed request finishes,
+	// so a crash during the replay doesn't lose them either.
+	return _sendOutbox;
+}
+
+void writeDialogsSnapshot() {
+	if (!_working()) return;
+
+	auto &owner = Auth().data();
+	auto histories = std::vector<not_null<History*>>();
+	histories.reserve(kDialogsSnapshotLimit);
+	for (const auto &row : *owner.chatsList()->indexed()) {
+		const auto history = row->history();
+		if (!history
+			|| history->peer->loadedStatus != PeerData::FullLoaded) {
+			continue;
+		}
+		histories.push_back(history);
+		if (histories.size() == kDialogsSnapshotLimit) {
+			break;
+		}
+	}
+	if (histories.empty()) {
+		if (_dialogsSnapshotKey) {
+			ClearKey(_dialogsSnapshotKey);
+			_dialogsSnapshotKey = 0;
+			_mapChanged = true;
+		}
+		_writeMap();
+	} else {
+		quint32 size = sizeof(quint32);
+		for (const auto history : histories) {
+			size += Serialize::peerSize(history->peer)
+				+ 3 * sizeof(qint32);
+		}
+		if (!_dialogsSnapshotKey) {
+			_dialogsSnapshotKey = GenerateKey();
+			_mapChanged = true;
+			_writeMap(WriteMapWhen::Fast);
+		}
+		EncryptedDescriptor data(size);
+		data.stream << quint32(histories.size());
+		for (const auto history : histories) {
+			Serialize::writePeer(data.stream, history->peer);
+			const auto flags = 0
+				| (history->unreadMark()
+					? kDialogsSnapshotUnreadMarkFlag
+					: 0)
+				| (history->isPinnedDialog(FilterId())
+					? kDialogsSnapshotPinnedFlag
+					: 0)
+				| (history->mute() ? kDialogsSnapshotMutedFlag : 0);
+			data.stream
+				<< qint32(history->unreadCount())
+				<< qint32(flags)
+				<< qint32(history->chatListTimeId());
+		}
+		FileWriteDescriptor file(_dialogsSnapshotKey);
+		file.writeEncrypted(data);
+	}
+}
+
+void readDialogsSnapshot() {
+	if (!_dialogsSnapshotKey) return;
+
+	FileReadDescriptor snapshot;
+	if (!ReadEncryptedFile(snapshot, _dialogsSnapshotKey)) {
+		ClearKey(_dialogsSnapshotKey);
+		_dialogsSnapshotKey = 0;
+		_writeMap();
+		return;
+	}
+
+	auto &owner = Auth().data();
+	quint32 count = 0;
+	snapshot.stream >> count;
+	if (!_checkStreamStatus(snapshot.stream)
+		|| count > kDialogsSnapshotLimit) {
+		return;
+	}
+	for (auto i = quint32(0); i != count; ++i) {
+		const auto peer = Serialize::readPeer(
+			snapshot.version,
+			snapshot.stream);
+		qint32 unreadCount = 0, flags = 0, timeId = 0;
+		snapshot.stream >> unreadCount >> flags >> timeId;
+		if (!_checkStreamStatus(snapshot.stream) || !peer) {
+			return;
+		}
+		const auto history = owner.history(peer).get();
+		if (history->folderKnown() || history->lastMessageKnown()) {
+			// The real dialog data was already received.
+			continue;
+		}
+		// The snapshot holds only main list dialogs, so the folder is
+		// known to be none and the entry may enter the chats list with
+		// a not yet known last message - the dialogs request then
+		// updates the same rows in place.
+		history->clearFolder();
+		if (flags & kDialogsSnapshotMutedFlag) {
+			history->changeMute(true);
+		}
+		history->setUnreadCount(unreadCount);
+		history->setUnreadMark(flags & kDialogsSnapshotUnreadMarkFlag);
+		history->setChatListTimeId(timeId);
+		history->updateChatListExistence();
+		if (flags & kDialogsSnapshotPinnedFlag) {
+			owner.setChatPinned(history, FilterId(), true);
+		}
+	}
+	owner.chatsListChanged(FolderId(0));
+}
+
 void writeBackground(const Data::WallPaper &paper, const QImage &image) {
 	if (!_working() || !_backgroundCanWrite) {
 		return;
@@ -4888,6 +5767,8 @@ void WriteExportSettings(const Export::Settings &settings) {
 		&& settings.fullChats == check.fullChats
 		&& settings.media.types == check.media.types
 		&& settings.media.sizeLimit == check.media.sizeLimit
+		&& (settings.media.contentAddressedStore
+			== check.media.contentAddressedStore)
 		&& settings.path == check.path
 		&& settings.format == check.format
 		&& settings.availableAt == check.availableAt
@@ -4906,7 +5787,8 @@ void WriteExportSettings(const Export::Settings &settings) {
 		}
 		quint32 size = sizeof(quint32) * 6
 			+ Serialize::stringSize(settings.path)
-			+ sizeof(qint32) * 2 + sizeof(quint64);
+			+ sizeof(qint32) * 2 + sizeof(quint64)
+			+ sizeof(qint32);
 		EncryptedDescriptor data(size);
 		data.stream
 			<< quint32(settings.types)
@@ -4939,6 +5821,7 @@ void WriteExportSettings(const Export::Settings &settings) {
 		});
 		data.stream << qint32(settings.singlePeerFrom);
 		data.stream << qint32(settings.singlePeerTill);
+		data.stream << qint32(settings.media.contentAddressedStore ? 1 : 0);
 
 		FileWriteDescriptor file(_exportSettingsKey);
 		file.writeEncrypted(data);
@@ -4985,11 +5868,16 @@ Export::Settings ReadExportSettings() {
 	if (!file.stream.atEnd()) {
 		file.stream >> singlePeerFrom >> singlePeerTill;
 	}
+	qint32 contentAddressedStore = 0;
+	if (!file.stream.atEnd()) {
+		file.stream >> contentAddressedStore;
+	}
 	auto result = Export::Settings();
 	result.types = Export::Settings::Types::from_raw(types);
 	result.fullChats = Export::Settings::Types::from_raw(fullChats);
 	result.media.types = Export::MediaSettings::Types::from_raw(mediaTypes);
 	result.media.sizeLimit = mediaSizeLimit;
+	result.media.contentAddressedStore = (contentAddressedStore == 1);
 	result.format = Export::Output::Format(format);
 	result.path = path;
 	result.availableAt = availableAt;
@@ -5165,6 +6053,8 @@ bool ClearManager::addTask(int task) {
 			_installedStickersKey = _featuredStickersKey = _recentStickersKey = _archivedStickersKey = 0;
 			_mapChanged = true;
 		}
+		_stickerSetKeys.clear();
+		_stickerSetWrittenHashes.clear();
 		if (_recentHashtagsAndBotsKey) {
 			_recentHashtagsAndBotsKey = 0;
 			_mapChanged = true;
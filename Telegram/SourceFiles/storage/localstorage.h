@@ -58,6 +58,12 @@ void reset();
 bool checkPasscode(const QByteArray &passcode);
 void setPasscode(const QByteArray &passcode);
 
+// The key derivation runs on a background thread, the done callback
+// is invoked on the main thread. Setting a non-empty passcode also
+// calibrates the iteration count to the measured machine speed.
+void checkPasscodeAsync(const QByteArray &passcode, Fn<void(bool)> done);
+void setPasscodeAsync(const QByteArray &passcode, Fn<void()> done);
+
 enum ClearManagerTask {
 	ClearManagerAll = 0xFFFF,
 	ClearManagerDownloads = 0x01,
@@ -153,6 +159,26 @@ void writeSavedGifs();
 void readSavedGifs();
 int32 countSavedGifsHash();
 
+void writeSharedMediaCounts();
+void readSharedMediaCounts();
+
+void writeDialogsSnapshot();
+void readDialogsSnapshot();
+
+void writeSearchIndex();
+void readSearchIndex();
+
+struct SendOutboxEntry {
+	quint64 randomId = 0;
+	quint64 peerId = 0;
+	qint32 replyTo = 0;
+	bool silent = false;
+	QString text;
+};
+void addToSendOutbox(const SendOutboxEntry &entry);
+void removeFromSendOutbox(quint64 randomId);
+[[nodiscard]] std::vector<SendOutboxEntry> readSendOutbox();
+
 void writeBackground(const Data::WallPaper &paper, const QImage &image);
 bool readBackground();
 
@@ -180,10 +180,14 @@ DocumentData *Document::readFromStream(int streamAppVersion, QDataStream &stream
 }
 
 int Document::sizeInStream(DocumentData *document) {
+	// Must match writeToStream exactly, the result is used to allocate
+	// the whole serialization buffer up front.
 	int result = 0;
 
-	// id + access + date + version
-	result += sizeof(quint64) + sizeof(quint64) + sizeof(qint32) + sizeof(qint32);
+	// id + access + date
+	result += sizeof(quint64) + sizeof(quint64) + sizeof(qint32);
+	// + fileReference + versionTag + version
+	result += bytearraySize(document->_fileReference) + sizeof(qint32) + sizeof(qint32);
 	// + namelen + name + mimelen + mime + dc + size
 	result += stringSize(document->filename()) + stringSize(document->mimeString()) + sizeof(qint32) + sizeof(qint32);
 	// + width + height
@@ -198,8 +202,10 @@ int Document::sizeInStream(DocumentData *document) {
 		// + duration
 		result += sizeof(qint32);
 	}
-	// + thumb loc
-	result += Serialize::imageLocationSize(document->thumbnailLocation());
+	// + thumb loc + thumb byte size
+	result += Serialize::imageLocationSize(document->thumbnailLocation()) + sizeof(qint32);
+	// + video thumb loc + video thumb byte size
+	result += Serialize::imageLocationSize(document->videoThumbnailLocation()) + sizeof(qint32);
 
 	return result;
 }
@@ -9,6 +9,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 #include "storage/storage_shared_media.h"
 #include "storage/storage_user_photos.h"
+#include "storage/storage_search_index.h"
 //#include "storage/storage_feed_messages.h" // #feed
 
 namespace Storage {
@@ -21,6 +22,8 @@ public:
 	void remove(SharedMediaRemoveOne &&query);
 	void remove(SharedMediaRemoveAll &&query);
 	void invalidate(SharedMediaInvalidateBottom &&query);
+	QByteArray serializeSharedMediaCounts() const;
+	void applySharedMediaCounts(const QByteArray &serialized);
 	rpl::producer<SharedMediaResult> query(SharedMediaQuery &&query) const;
 	rpl::producer<SharedMediaSliceUpdate> sharedMediaSliceUpdated() const;
 	rpl::producer<SharedMediaRemoveOne> sharedMediaOneRemoved() const;
@@ -34,6 +37,14 @@ public:
 	rpl::producer<UserPhotosResult> query(UserPhotosQuery &&query) const;
 	rpl::producer<UserPhotosSliceUpdate> userPhotosSliceUpdated() const;
 
+	void searchIndexAdd(PeerId peerId, MsgId messageId, const QString &text);
+	void searchIndexRemove(PeerId peerId, MsgId messageId);
+	std::vector<MsgId> searchIndexQuery(
+		PeerId peerId,
+		const QString &query) const;
+	QByteArray serializeSearchIndex() const;
+	void applySearchIndex(const QByteArray &serialized);
+
 	//void add(FeedMessagesAddNew &&query); // #feed
 	//void add(FeedMessagesAddSlice &&query);
 	//void remove(FeedMessagesRemoveOne &&query);
@@ -51,6 +62,7 @@ public:
 private:
 	SharedMedia _sharedMedia;
 	UserPhotos _userPhotos;
+	SearchIndex _searchIndex;
 	//FeedMessages _feedMessages; // #feed
 
 };
@@ -79,6 +91,14 @@ void Facade::Impl::invalidate(SharedMediaInvalidateBottom &&query) {
 	_sharedMedia.invalidate(std::move(query));
 }
 
+QByteArray Facade::Impl::serializeSharedMediaCounts() const {
+	return _sharedMedia.serializeCounts();
+}
+
+void Facade::Impl::applySharedMediaCounts(const QByteArray &serialized) {
+	_sharedMedia.applySerializedCounts(serialized);
+}
+
 rpl::producer<SharedMediaResult> Facade::Impl::query(SharedMediaQuery &&query) const {
 	return _sharedMedia.query(std::move(query));
 }
@@ -122,6 +142,31 @@ rpl::producer<UserPhotosResult> Facade::Impl::query(UserPhotosQuery &&query) con
 rpl::producer<UserPhotosSliceUpdate> Facade::Impl::userPhotosSliceUpdated() const {
 	return _userPhotos.sliceUpdated();
 }
+
+void Facade::Impl::searchIndexAdd(
+		PeerId peerId,
+		MsgId messageId,
+		const QString &text) {
+	_searchIndex.add(peerId, messageId, text);
+}
+
+void Facade::Impl::searchIndexRemove(PeerId peerId, MsgId messageId) {
+	_searchIndex.remove(peerId, messageId);
+}
+
+std::vector<MsgId> Facade::Impl::searchIndexQuery(
+		PeerId peerId,
+		const QString &query) const {
+	return _searchIndex.query(peerId, query);
+}
+
+QByteArray Facade::Impl::serializeSearchIndex() const {
+	return _searchIndex.serialize();
+}
+
+void Facade::Impl::applySearchIndex(const QByteArray &serialized) {
+	_searchIndex.applySerialized(serialized);
+}
 // // #feed
 //void Facade::Impl::add(FeedMessagesAddNew &&query) {
 //	return _feedMessages.add(std::move(query));
@@ -199,6 +244,14 @@ void Facade::invalidate(SharedMediaInvalidateBottom &&query) {
 	_impl->invalidate(std::move(query));
 }
 
+QByteArray Facade::serializeSharedMediaCounts() const {
+	return _impl->serializeSharedMediaCounts();
+}
+
+void Facade::applySharedMediaCounts(const QByteArray &serialized) {
+	_impl->applySharedMediaCounts(serialized);
+}
+
 rpl::producer<SharedMediaResult> Facade::query(SharedMediaQuery &&query) const {
 	return _impl->query(std::move(query));
 }
@@ -242,6 +295,31 @@ rpl::producer<UserPhotosResult> Facade::query(UserPhotosQuery &&query) const {
 rpl::producer<UserPhotosSliceUpdate> Facade::userPhotosSliceUpdated() const {
 	return _impl->userPhotosSliceUpdated();
 }
+
+void Facade::searchIndexAdd(
+		PeerId peerId,
+		MsgId messageId,
+		const QString &text) {
+	_impl->searchIndexAdd(peerId, messageId, text);
+}
+
+void Facade::searchIndexRemove(PeerId peerId, MsgId messageId) {
+	_impl->searchIndexRemove(peerId, messageId);
+}
+
+std::vector<MsgId> Facade::searchIndexQuery(
+		PeerId peerId,
+		const QString &query) const {
+	return _impl->searchIndexQuery(peerId, query);
+}
+
+QByteArray Facade::serializeSearchIndex() const {
+	return _impl->serializeSearchIndex();
+}
+
+void Facade::applySearchIndex(const QByteArray &serialized) {
+	_impl->applySearchIndex(serialized);
+}
 // // #feed
 //void Facade::add(FeedMessagesAddNew &&query) {
 //	return _impl->add(std::move(query));
@@ -57,6 +57,9 @@ public:
 	void remove(SharedMediaRemoveAll &&query);
 	void invalidate(SharedMediaInvalidateBottom &&query);
 
+	[[nodiscard]] QByteArray serializeSharedMediaCounts() const;
+	void applySharedMediaCounts(const QByteArray &serialized);
+
 	rpl::producer<SharedMediaResult> query(SharedMediaQuery &&query) const;
 	rpl::producer<SharedMediaSliceUpdate> sharedMediaSliceUpdated() const;
 	rpl::producer<SharedMediaRemoveOne> sharedMediaOneRemoved() const;
@@ -71,6 +74,14 @@ public:
 	rpl::producer<UserPhotosResult> query(UserPhotosQuery &&query) const;
 	rpl::producer<UserPhotosSliceUpdate> userPhotosSliceUpdated() const;
 
+	void searchIndexAdd(PeerId peerId, MsgId messageId, const QString &text);
+	void searchIndexRemove(PeerId peerId, MsgId messageId);
+	[[nodiscard]] std::vector<MsgId> searchIndexQuery(
+		PeerId peerId,
+		const QString &query) const;
+	[[nodiscard]] QByteArray serializeSearchIndex() const;
+	void applySearchIndex(const QByteArray &serialized);
+
 	//void add(FeedMessagesAddNew &&query); // #feed
 	//void add(FeedMessagesAddSlice &&query);
 	//void remove(FeedMessagesRemoveOne &&query);
@@ -10,11 +10,13 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "platform/platform_file_utilities.h"
 #include "storage/localimageloader.h"
 #include "core/mime_type.h"
+#include "core/dispatch_tracer.h"
 #include "ui/image/image_prepare.h"
 #include "app.h"
 
 #include <QtCore/QSemaphore>
 #include <QtCore/QMimeData>
+#include <QtGui/QImageReader>
 
 namespace Storage {
 namespace {
@@ -48,25 +50,74 @@ bool ValidVideoForAlbum(const FileMediaInformation::Video &video) {
 	return ValidateThumbDimensions(width, height);
 }
 
-QSize PrepareShownDimensions(const QImage &preview) {
+QSize PrepareShownDimensions(QSize full) {
 	constexpr auto kMaxWidth = 1280;
 	constexpr auto kMaxHeight = 1280;
 
-	const auto result = preview.size();
-	return (result.width() > kMaxWidth || result.height() > kMaxHeight)
-		? result.scaled(kMaxWidth, kMaxHeight, Qt::KeepAspectRatio)
-		: result;
+	return (full.width() > kMaxWidth || full.height() > kMaxHeight)
+		? full.scaled(kMaxWidth, kMaxHeight, Qt::KeepAspectRatio)
+		: full;
+}
+
+// Decodes the image right at the preview size, so the decoder can skip
+// most of the work (for JPEG the downscale happens in the DCT domain).
+// The full resolution decode is deferred to the sending thread -
+// FileLoadTask reads the media information itself when it wasn't
+// prepared in advance.
+bool PrepareFastImagePreview(PreparedFile &file, int previewWidth) {
+	if (Core::IsMimeSticker(file.mime)) {
+		return false;
+	}
+	auto reader = QImageReader(file.path);
+	reader.setAutoTransform(true);
+	if (!reader.canRead() || reader.supportsAnimation()) {
+		return false;
+	}
+	const auto raw = reader.size();
+	if (raw.isEmpty()) {
+		// The format can't report dimensions without a full decode.
+		return false;
+	}
+
+	// The size is reported before the EXIF orientation is applied.
+	const auto transposed = (reader.transformation()
+		& QImageIOHandler::TransformationRotate90);
+	const auto shown = transposed ? raw.transposed() : raw;
+	if (!ValidateThumbDimensions(shown.width(), shown.height())) {
+		return false;
+	}
+	const auto wanted = std::min(
+		previewWidth,
+		style::ConvertScale(shown.width())) * cIntRetinaFactor();
+	reader.setScaledSize(QSize(
+		std::max(1, raw.width() * wanted / shown.width()),
+		std::max(1, raw.height() * wanted / shown.width())));
+	auto image = reader.read();
+	if (image.isNull()) {
+		return false;
+	}
+	file.shownDimensions = PrepareShownDimensions(shown);
+	file.preview = Images::prepareOpaque(std::move(image));
+	Assert(!file.preview.isNull());
+	file.preview.setDevicePixelRatio(cRetinaFactor());
+	file.type = PreparedFile::AlbumType::Photo;
+	return true;
 }
 
 bool PrepareAlbumMediaIsWaiting(
 		QSemaphore &semaphore,
 		PreparedFile &file,
-		int previewWidth) {
+		int previewWidth,
+		bool fastPreviewAllowed) {
 	// TODO: Use some special thread queue, like a separate QThreadPool.
-	crl::async([=, &semaphore, &file] {
+	Core::DispatchTracer::Async("media prepare", [=, &semaphore, &file] {
 		const auto guard = gsl::finally([&] { semaphore.release(); });
 		if (!file.path.isEmpty()) {
 			file.mime = Core::MimeTypeForFile(QFileInfo(file.path)).name();
+			if (fastPreviewAllowed
+				&& PrepareFastImagePreview(file, previewWidth)) {
+				return;
+			}
 			file.information = FileLoadTask::ReadMediaInformation(
 				file.path,
 				QByteArray(),
@@ -86,7 +137,8 @@ bool PrepareAlbumMediaIsWaiting(
 		if (const auto image = base::get_if<Image>(
 				&file.information->media)) {
 			if (ValidPhotoForAlbum(*image, file.mime)) {
-				file.shownDimensions = PrepareShownDimensions(image->data);
+				file.shownDimensions = PrepareShownDimensions(
+					image->data.size());
 				file.preview = Images::prepareOpaque(image->data.scaledToWidth(
 					std::min(previewWidth, style::ConvertScale(image->data.width()))
 						* cIntRetinaFactor(),
@@ -98,11 +150,16 @@ bool PrepareAlbumMediaIsWaiting(
 		} else if (const auto video = base::get_if<Video>(
 				&file.information->media)) {
 			if (ValidVideoForAlbum(*video)) {
-				auto blurred = Images::prepareBlur(Images::prepareOpaque(video->thumbnail));
-				file.shownDimensions = PrepareShownDimensions(video->thumbnail);
-				file.preview = std::move(blurred).scaledToWidth(
-					previewWidth * cIntRetinaFactor(),
-					Qt::SmoothTransformation);
+				file.shownDimensions = PrepareShownDimensions(
+					video->thumbnail.size());
+
+				// Blur after the downscale to the preview width, the
+				// kernel cost is proportional to the area and the frame
+				// is much larger than the preview.
+				file.preview = Images::prepareBlur(Images::prepareOpaque(
+					video->thumbnail.scaledToWidth(
+						previewWidth * cIntRetinaFactor(),
+						Qt::SmoothTransformation)));
 				Assert(!file.preview.isNull());
 				file.preview.setDevicePixelRatio(cRetinaFactor());
 				file.type = PreparedFile::AlbumType::Video;
@@ -119,10 +176,20 @@ void PrepareAlbum(PreparedList &result, int previewWidth) {
 	}
 
 	result.albumIsPossible = (count > 1);
+
+	// A single file shows a large preview and needs the full decode
+	// right here, while the album thumbnails are fine with a fast
+	// preview-sized decode. The jobs are dispatched in list order, so
+	// the top rows are ready first.
+	const auto fastPreviewAllowed = (count > 1);
 	auto waiting = 0;
 	QSemaphore semaphore;
 	for (auto &file : result.files) {
-		if (PrepareAlbumMediaIsWaiting(semaphore, file, previewWidth)) {
+		if (PrepareAlbumMediaIsWaiting(
+				semaphore,
+				file,
+				previewWidth,
+				fastPreviewAllowed)) {
 			++waiting;
 		}
 	}
@@ -334,6 +401,11 @@ std::optional<PreparedList> PreparedList::PreparedFileFromFilesDialog(
 			}
 			using Info = FileMediaInformation;
 
+			if (!file.information) {
+				// A fast preview was made instead, the full media
+				// information is read at sending time.
+				return (file.type == Storage::PreparedFile::AlbumType::Photo);
+			}
 			const auto media = &file.information->media;
 			const auto valid = media->match([](const Info::Image &data) {
 				return Storage::ValidateThumbDimensions(
@@ -0,0 +1,180 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "storage/storage_search_index.h"
+
+#include "ui/text/text_entity.h"
+
+#include <QtCore/QDataStream>
+
+namespace Storage {
+namespace {
+
+// Longer words are truncated before indexing, a prefix match on the
+// truncated word can only add false positives, never lose results.
+constexpr auto kMaxWordLength = 16;
+
+// Older messages are evicted from the index, both to bound the memory
+// usage and the size of the serialized data written to disk.
+constexpr auto kMaxMessagesPerPeer = 1024;
+
+} // namespace
+
+void SearchIndex::add(PeerId peerId, MsgId messageId, const QString &text) {
+	const auto words = TextUtilities::PrepareSearchWords(text);
+	if (words.isEmpty()) {
+		return;
+	}
+	auto &index = _peers[peerId];
+	if (!index.messages.emplace(messageId).second) {
+		return;
+	}
+	for (const auto &word : words) {
+		addWord(index, word.left(kMaxWordLength), messageId);
+	}
+	while (index.messages.size() > kMaxMessagesPerPeer) {
+		removeMessage(index, *index.messages.begin());
+	}
+}
+
+void SearchIndex::remove(PeerId peerId, MsgId messageId) {
+	const auto i = _peers.find(peerId);
+	if (i == _peers.end()) {
+		return;
+	}
+	removeMessage(i->second, messageId);
+	if (i->second.messages.empty()) {
+		_peers.erase(i);
+	}
+}
+
+std::vector<MsgId> SearchIndex::query(
+		PeerId peerId,
+		const QString &query) const {
+	auto result = std::vector<MsgId>();
+	const auto words = TextUtilities::PrepareSearchWords(query);
+	if (words.isEmpty()) {
+		return result;
+	}
+	const auto i = _peers.find(peerId);
+	if (i == _peers.end()) {
+		return result;
+	}
+	const auto &index = i->second;
+	auto matched = base::flat_set<MsgId>();
+	auto first = true;
+	for (const auto &word : words) {
+		const auto prefix = word.left(kMaxWordLength);
+		auto found = base::flat_set<MsgId>();
+		for (auto j = index.words.lower_bound(prefix)
+			; (j != index.words.end()) && j->first.startsWith(prefix)
+			; ++j) {
+			for (const auto messageId : j->second) {
+				found.emplace(messageId);
+			}
+		}
+		if (first) {
+			matched = std::move(found);
+			first = false;
+		} else {
+			for (auto k = matched.begin(); k != matched.end();) {
+				if (found.contains(*k)) {
+					++k;
+				} else {
+					k = matched.erase(k);
+				}
+			}
+		}
+		if (matched.empty()) {
+			return result;
+		}
+	}
+	result.reserve(matched.size());
+	for (const auto messageId : matched) {
+		result.push_back(messageId);
+	}
+	ranges::reverse(result);
+	return result;
+}
+
+QByteArray SearchIndex::serialize() const {
+	auto result = QByteArray();
+	{
+		QDataStream stream(&result, QIODevice::WriteOnly);
+		stream.setVersion(QDataStream::Qt_5_1);
+		stream << qint32(_peers.size());
+		for (const auto &[peerId, index] : _peers) {
+			stream << quint64(peerId) << qint32(index.words.size());
+			for (const auto &[word, messageIds] : index.words) {
+				stream << word << qint32(messageIds.size());
+				for (const auto messageId : messageIds) {
+					stream << qint32(messageId);
+				}
+			}
+		}
+	}
+	return result;
+}
+
+void SearchIndex::applySerialized(const QByteArray &serialized) {
+	QDataStream stream(serialized);
+	stream.setVersion(QDataStream::Qt_5_1);
+	auto peersCount = qint32(0);
+	stream >> peersCount;
+	if (stream.status() != QDataStream::Ok || peersCount < 0) {
+		return;
+	}
+	for (auto i = 0; i != peersCount; ++i) {
+		auto peerId = quint64(0);
+		auto wordsCount = qint32(0);
+		stream >> peerId >> wordsCount;
+		if (stream.status() != QDataStream::Ok || wordsCount < 0) {
+			return;
+		}
+		auto &index = _peers[PeerId(peerId)];
+		for (auto j = 0; j != wordsCount; ++j) {
+			auto word = QString();
+			auto idsCount = qint32(0);
+			stream >> word >> idsCount;
+			if (stream.status() != QDataStream::Ok || idsCount < 0) {
+				return;
+			}
+			for (auto k = 0; k != idsCount; ++k) {
+				auto messageId = qint32(0);
+				stream >> messageId;
+				if (stream.status() != QDataStream::Ok) {
+					return;
+				}
+				addWord(index, word, messageId);
+				index.messages.emplace(messageId);
+			}
+		}
+	}
+}
+
+void SearchIndex::addWord(
+		PeerIndex &index,
+		const QString &word,
+		MsgId messageId) {
+	index.words[word].emplace(messageId);
+}
+
+void SearchIndex::removeMessage(PeerIndex &index, MsgId messageId) {
+	if (!index.messages.remove(messageId)) {
+		return;
+	}
+	for (auto i = index.words.begin(); i != index.words.end();) {
+		i->second.remove(messageId);
+		if (i->second.empty()) {
+			i = index.words.erase(i);
+		} else {
+			++i;
+		}
+	}
+}
+
+} // namespace Storage
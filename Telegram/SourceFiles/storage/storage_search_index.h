@@ -0,0 +1,43 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+namespace Storage {
+
+// An inverted index over the text of locally cached messages, so that
+// search inside a chat can serve instant results for the messages we
+// already hold, while the server results are on their way.
+class SearchIndex {
+public:
+	void add(PeerId peerId, MsgId messageId, const QString &text);
+	void remove(PeerId peerId, MsgId messageId);
+
+	// Returns the matching message ids, newest first. The ids are only
+	// hints - a message could've been deleted since it was indexed, so
+	// the caller must check each one against the loaded messages.
+	[[nodiscard]] std::vector<MsgId> query(
+		PeerId peerId,
+		const QString &query) const;
+
+	[[nodiscard]] QByteArray serialize() const;
+	void applySerialized(const QByteArray &serialized);
+
+private:
+	struct PeerIndex {
+		base::flat_map<QString, base::flat_set<MsgId>> words;
+		base::flat_set<MsgId> messages;
+	};
+
+	void addWord(PeerIndex &index, const QString &word, MsgId messageId);
+	void removeMessage(PeerIndex &index, MsgId messageId);
+
+	base::flat_map<PeerId, PeerIndex> _peers;
+
+};
+
+} // namespace Storage
@@ -8,6 +8,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "storage/storage_shared_media.h"
 
 #include <rpl/map.h>
+#include <QtCore/QDataStream>
 
 namespace Storage {
 
@@ -98,6 +99,64 @@ void SharedMedia::invalidate(SharedMediaInvalidateBottom &&query) {
 	}
 }
 
+QByteArray SharedMedia::serializeCounts() const {
+	const auto hasKnownCount = [](const Lists &lists) {
+		for (auto index = 0; index != kSharedMediaTypeCount; ++index) {
+			if (lists[index].count()) {
+				return true;
+			}
+		}
+		return false;
+	};
+	auto peersCount = qint32(0);
+	for (const auto &[peerId, lists] : _lists) {
+		if (hasKnownCount(lists)) {
+			++peersCount;
+		}
+	}
+	auto result = QByteArray();
+	auto stream = QDataStream(&result, QIODevice::WriteOnly);
+	stream.setVersion(QDataStream::Qt_5_1);
+	stream << peersCount;
+	for (const auto &[peerId, lists] : _lists) {
+		if (!hasKnownCount(lists)) {
+			continue;
+		}
+		stream << quint64(peerId);
+		for (auto index = 0; index != kSharedMediaTypeCount; ++index) {
+			stream << qint32(lists[index].count().value_or(-1));
+		}
+	}
+	return result;
+}
+
+void SharedMedia::applySerializedCounts(const QByteArray &serialized) {
+	auto stream = QDataStream(serialized);
+	stream.setVersion(QDataStream::Qt_5_1);
+	auto peersCount = qint32(0);
+	stream >> peersCount;
+	if (stream.status() != QDataStream::Ok || peersCount < 0) {
+		return;
+	}
+	for (auto i = 0; i != peersCount; ++i) {
+		auto peerId = quint64(0);
+		auto counts = std::array<qint32, kSharedMediaTypeCount>{};
+		stream >> peerId;
+		for (auto index = 0; index != kSharedMediaTypeCount; ++index) {
+			stream >> counts[index];
+		}
+		if (stream.status() != QDataStream::Ok || !peerId) {
+			return;
+		}
+		auto peerIt = enforceLists(peerId);
+		for (auto index = 0; index != kSharedMediaTypeCount; ++index) {
+			if (counts[index] >= 0) {
+				peerIt->second[index].setCount(counts[index]);
+			}
+		}
+	}
+}
+
 rpl::producer<SharedMediaResult> SharedMedia::query(SharedMediaQuery &&query) const {
 	Expects(IsValidSharedMediaType(query.key.type));
 	auto peerIt = _lists.find(query.key.peerId);
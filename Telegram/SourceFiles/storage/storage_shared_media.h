@@ -190,6 +190,11 @@ public:
 	void remove(SharedMediaRemoveAll &&query);
 	void invalidate(SharedMediaInvalidateBottom &&query);
 
+	// The known counts are cached locally, so that the shared media
+	// tabs can show them right away, without waiting for the server.
+	[[nodiscard]] QByteArray serializeCounts() const;
+	void applySerializedCounts(const QByteArray &serialized);
+
 	rpl::producer<SharedMediaResult> query(SharedMediaQuery &&query) const;
 	rpl::producer<SharedMediaSliceUpdate> sliceUpdated() const;
 	rpl::producer<SharedMediaRemoveOne> oneRemoved() const;
@@ -163,6 +163,13 @@ void SparseIdsList::removeAll() {
 	_count = 0;
 }
 
+void SparseIdsList::setCount(int count) {
+	// Only seed an unknown count, the server knows better than a cache.
+	if (!_count) {
+		_count = count;
+	}
+}
+
 void SparseIdsList::invalidateBottom() {
 	if (!_slices.empty()) {
 		const auto &last = _slices.back();
@@ -213,8 +220,11 @@ SparseIdsListResult SparseIdsList::queryFromSlice(
 	auto haveEqualOrAfter = int(slice.messages.end() - position);
 	auto before = qMin(haveBefore, query.limitBefore);
 	auto equalOrAfter = qMin(haveEqualOrAfter, query.limitAfter + 1);
-	auto ids = std::vector<MsgId>(position - before, position + equalOrAfter);
-	result.messageIds.merge(ids.begin(), ids.end());
+	// The slice storage is sorted and unique already, so the result
+	// can be filled right away, without a temporary vector and merge.
+	result.messageIds = base::flat_set<MsgId>(
+		position - before,
+		position + equalOrAfter);
 	if (slice.range.from == 0) {
 		result.skippedBefore = haveBefore - before;
 	}
@@ -49,6 +49,10 @@ public:
 	void removeOne(MsgId messageId);
 	void removeAll();
 	void invalidateBottom();
+	[[nodiscard]] std::optional<int> count() const {
+		return _count;
+	}
+	void setCount(int count);
 	rpl::producer<SparseIdsListResult> query(SparseIdsListQuery &&query) const;
 	rpl::producer<SparseIdsSliceUpdate> sliceUpdated() const;
 
@@ -79,9 +79,14 @@ Data::FileOrigin StreamedFileDownloader::fileOrigin() const {
 }
 
 void StreamedFileDownloader::requestParts() {
+	// Request less parts ahead while playback-critical loads are in
+	// flight, so the sequential fill uses only the spare request slots.
+	const auto limit = std::max(
+		kRequestPartsCount - _reader->playbackLoadingCount(),
+		1);
 	while (!_finished
 		&& _nextPartIndex < _partsCount
-		&& _partsRequested < kRequestPartsCount) {
+		&& _partsRequested < limit) {
 		requestPart();
 	}
 }
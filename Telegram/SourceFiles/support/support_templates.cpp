@@ -13,6 +13,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "main/main_session.h"
 
 #include <QtNetwork/QNetworkAccessManager>
+#include <QtCore/QDataStream>
+#include <QtCore/QDateTime>
 
 namespace Support {
 namespace details {
@@ -20,6 +22,7 @@ namespace {
 
 constexpr auto kQueryLimit = 10;
 constexpr auto kWeightStep = 1000;
+constexpr auto kCompiledCacheVersion = 1;
 
 struct Delta {
 	std::vector<const TemplatesQuestion*> added;
@@ -254,8 +257,107 @@ struct FilesResult {
 	QStringList errors;
 };
 
+QString CompiledCachePath(const QString &folder) {
+	return folder + qsl("/compiled.cache");
+}
+
+// File names with modification times, so any added / removed / edited
+// template file invalidates the compiled cache.
+QByteArray CollectFingerprint(const QString &folder) {
+	auto result = QString();
+	const auto files = QDir(folder).entryInfoList(QDir::Files);
+	for (const auto &info : files) {
+		if (!IsTemplatesFile(info.fileName())) {
+			continue;
+		}
+		result += info.fileName()
+			+ ':'
+			+ QString::number(info.lastModified().toMSecsSinceEpoch())
+			+ ';';
+	}
+	return result.toUtf8();
+}
+
+bool ReadCompiledCache(
+		const QString &folder,
+		const QByteArray &fingerprint,
+		TemplatesData &data) {
+	QFile f(CompiledCachePath(folder));
+	if (!f.open(QIODevice::ReadOnly)) {
+		return false;
+	}
+	QDataStream stream(&f);
+	stream.setVersion(QDataStream::Qt_5_1);
+
+	auto version = qint32(0);
+	auto cachedFingerprint = QByteArray();
+	stream >> version >> cachedFingerprint;
+	if (stream.status() != QDataStream::Ok
+		|| version != kCompiledCacheVersion
+		|| cachedFingerprint != fingerprint) {
+		return false;
+	}
+	auto filesCount = qint32(0);
+	stream >> filesCount;
+	for (auto i = qint32(0); i != filesCount; ++i) {
+		auto path = QString();
+		auto file = TemplatesFile();
+		auto questionsCount = qint32(0);
+		stream >> path >> file.url >> questionsCount;
+		for (auto j = qint32(0); j != questionsCount; ++j) {
+			auto normalized = QString();
+			auto question = TemplatesQuestion();
+			stream >> normalized
+				>> question.question
+				>> question.originalKeys
+				>> question.normalizedKeys
+				>> question.value;
+			if (stream.status() != QDataStream::Ok) {
+				data = TemplatesData();
+				return false;
+			}
+			file.questions.emplace(normalized, std::move(question));
+		}
+		data.files.emplace(path, std::move(file));
+	}
+	if (stream.status() != QDataStream::Ok) {
+		data = TemplatesData();
+		return false;
+	}
+	return true;
+}
+
+void WriteCompiledCache(
+		const QString &folder,
+		const QByteArray &fingerprint,
+		const TemplatesData &data) {
+	QFile f(CompiledCachePath(folder));
+	if (!f.open(QIODevice::WriteOnly)) {
+		return;
+	}
+	QDataStream stream(&f);
+	stream.setVersion(QDataStream::Qt_5_1);
+
+	stream << qint32(kCompiledCacheVersion) << fingerprint;
+	stream << qint32(data.files.size());
+	for (const auto &[path, file] : data.files) {
+		stream << path << file.url << qint32(file.questions.size());
+		for (const auto &[normalized, question] : file.questions) {
+			stream << normalized
+				<< question.question
+				<< question.originalKeys
+				<< question.normalizedKeys
+				<< question.value;
+		}
+	}
+}
+
 FilesResult ReadFiles(const QString &folder) {
 	auto result = FilesResult();
+	const auto fingerprint = CollectFingerprint(folder);
+	if (ReadCompiledCache(folder, fingerprint, result.result)) {
+		return result;
+	}
 	const auto files = QDir(folder).entryList(QDir::Files);
 	for (const auto &path : files) {
 		if (!IsTemplatesFile(path)) {
@@ -267,6 +369,9 @@ FilesResult ReadFiles(const QString &folder) {
 		}
 		result.errors.append(std::move(file.errors));
 	}
+	if (result.errors.isEmpty()) {
+		WriteCompiledCache(folder, fingerprint, result.result);
+	}
 	return result;
 }
 
@@ -507,6 +612,8 @@ void Templates::load() {
 void Templates::setData(TemplatesData &&data) {
 	_data = std::move(data);
 	_maxKeyLength = CountMaxKeyLength(_data);
+	_lastQueryWords = QStringList();
+	_lastQueryIds.clear();
 }
 
 void Templates::ensureUpdatesCreated() {
@@ -581,6 +688,8 @@ void Templates::updateRequestFinished(QNetworkReply *reply) {
 			auto &parsed = one.files.at(path);
 			MoveKeys(parsed, existing);
 			ReplaceFileIndex(_index, ComputeIndex(one), path);
+			_lastQueryWords = QStringList();
+			_lastQueryIds.clear();
 			if (!errors.isEmpty()) {
 				_errors.fire(std::move(errors));
 			}
@@ -666,16 +775,37 @@ Templates::~Templates() = default;
 
 auto Templates::query(const QString &text) const -> std::vector<Question> {
 	const auto words = TextUtilities::PrepareSearchWords(text);
+
+	// Every word of the previous query must still constrain the new
+	// one, then the new results are a subset of the previous ones and
+	// we can refine them instead of rescanning the index bucket.
+	const auto refining = [&] {
+		const auto was = _lastQueryWords.size();
+		if (!was || words.size() < was) {
+			return false;
+		}
+		for (auto i = 0; i + 1 != was; ++i) {
+			if (words[i] != _lastQueryWords[i]) {
+				return false;
+			}
+		}
+		return words[was - 1].startsWith(_lastQueryWords[was - 1]);
+	}();
+
 	const auto questions = [&](const QString &word) {
 		const auto i = _index.first.find(word[0]);
 		return (i == end(_index.first)) ? 0 : i->second.size();
 	};
 	const auto best = ranges::min_element(words, std::less<>(), questions);
 	if (best == std::end(words)) {
+		_lastQueryWords = QStringList();
+		_lastQueryIds.clear();
 		return {};
 	}
 	const auto narrowed = _index.first.find((*best)[0]);
 	if (narrowed == end(_index.first)) {
+		_lastQueryWords = QStringList();
+		_lastQueryIds.clear();
 		return {};
 	}
 	using Id = TemplatesIndex::Id;
@@ -687,6 +817,9 @@ auto Templates::query(const QString &text) const -> std::vector<Question> {
 	const auto computeWeight = [&](const Id &id) {
 		auto result = 0;
 		const auto full = _index.full.find(id);
+		if (full == end(_index.full)) {
+			return 0;
+		}
 		for (const auto &word : words) {
 			const auto from = ranges::lower_bound(
 				full->second,
@@ -730,11 +863,16 @@ auto Templates::query(const QString &text) const -> std::vector<Question> {
 			return (a.first.second < b.first.second);
 		}
 	};
-	const auto good = narrowed->second | ranges::view::transform(
+	const auto &candidates = refining ? _lastQueryIds : narrowed->second;
+	const auto good = candidates | ranges::view::transform(
 		pairById
 	) | ranges::view::filter([](const Pair &pair) {
 		return pair.second > 0;
 	}) | ranges::to_vector | ranges::action::stable_sort(sorter);
+	_lastQueryWords = words;
+	_lastQueryIds = good | ranges::view::transform([](const Pair &pair) {
+		return pair.first;
+	}) | ranges::to_vector;
 	return good | ranges::view::transform([&](const Pair &pair) {
 		return questionById(pair.first);
 	}) | ranges::view::take(kQueryLimit) | ranges::to_vector;
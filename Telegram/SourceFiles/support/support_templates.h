@@ -83,6 +83,12 @@ private:
 
 	details::TemplatesData _data;
 	details::TemplatesIndex _index;
+
+	// The last query results, for refining instead of a full lookup
+	// when the query is extended by the next keystroke.
+	mutable QStringList _lastQueryWords;
+	mutable std::vector<details::TemplatesIndex::Id> _lastQueryIds;
+
 	rpl::event_stream<QStringList> _errors;
 	base::binary_guard _reading;
 	bool _reloadAfterRead = false;
@@ -565,6 +565,37 @@ std::vector<GroupMediaLayout> ComplexLayouter::layout() const {
 	return result;
 }
 
+struct LayoutCacheKey {
+	std::vector<QSize> sizes;
+	int maxWidth = 0;
+	int minWidth = 0;
+	int spacing = 0;
+
+	friend inline bool operator<(
+			const LayoutCacheKey &a,
+			const LayoutCacheKey &b) {
+		if (a.maxWidth != b.maxWidth) {
+			return a.maxWidth < b.maxWidth;
+		} else if (a.minWidth != b.minWidth) {
+			return a.minWidth < b.minWidth;
+		} else if (a.spacing != b.spacing) {
+			return a.spacing < b.spacing;
+		}
+		return std::lexicographical_compare(
+			begin(a.sizes),
+			end(a.sizes),
+			begin(b.sizes),
+			end(b.sizes),
+			[](QSize a, QSize b) {
+				return (a.width() != b.width())
+					? (a.width() < b.width())
+					: (a.height() < b.height());
+			});
+	}
+};
+
+constexpr auto kLayoutCacheLimit = 128;
+
 } // namespace
 
 std::vector<GroupMediaLayout> LayoutMediaGroup(
@@ -572,7 +603,25 @@ std::vector<GroupMediaLayout> LayoutMediaGroup(
 		int maxWidth,
 		int minWidth,
 		int spacing) {
-	return Layouter(sizes, maxWidth, minWidth, spacing).layout();
+	// Albums re-init their layout each time a thumbnail arrives with the
+	// real dimensions and many albums share the same shapes, so the
+	// attempt search in ComplexLayouter runs over and over with the same
+	// inputs. Memoize the result, it depends only on the arguments.
+	static auto Cache = std::map<
+		LayoutCacheKey,
+		std::vector<GroupMediaLayout>>();
+
+	auto key = LayoutCacheKey{ sizes, maxWidth, minWidth, spacing };
+	const auto i = Cache.find(key);
+	if (i != end(Cache)) {
+		return i->second;
+	}
+	auto result = Layouter(sizes, maxWidth, minWidth, spacing).layout();
+	if (Cache.size() >= kLayoutCacheLimit) {
+		Cache.clear();
+	}
+	Cache.emplace(std::move(key), result);
+	return result;
 }
 
 RectParts GetCornersFromSides(RectParts sides) {
@@ -8,6 +8,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "ui/image/image.h"
 
 #include "storage/cache/storage_cache_database.h"
+#include "core/alloc_stats.h"
 #include "data/data_session.h"
 #include "chat_helpers/stickers.h"
 #include "main/main_session.h"
@@ -28,6 +29,25 @@ namespace {
 	return PixKey(0, 0, options);
 }
 
+// All the cached pixmap variants of all the images are kept under this
+// budget together, the least recently used images lose their whole
+// caches when it overflows. The variants are cheap to render back from
+// the original data, so an eviction never loses anything.
+constexpr auto kCacheBudget = 64 * int64(1024 * 1024);
+
+auto CacheRegistry = base::flat_set<const Image*>();
+auto CacheBytes = int64(0);
+auto CacheTick = uint64(0);
+
+[[nodiscard]] Core::AllocStats::Counter &CacheAllocations() {
+	static auto result = Core::AllocStats::Counter("image_cache");
+	return result;
+}
+
+[[nodiscard]] int64 PixmapBytes(const QPixmap &pixmap) {
+	return int64(pixmap.width()) * pixmap.height() * (pixmap.depth() / 8);
+}
+
 [[nodiscard]] QByteArray ReadContent(const QString &path) {
 	auto file = QFile(path);
 	const auto good = (file.size() <= App::kImageSizeLimit)
@@ -104,6 +124,29 @@ QSize GetSizeForDocument(const QVector<MTPDocumentAttribute> &attributes) {
 	return QSize();
 }
 
+CacheState CurrentCacheState() {
+	return { CacheBytes, kCacheBudget, int(CacheRegistry.size()) };
+}
+
+int64 TrimCacheForIdle() {
+	const auto was = CacheBytes;
+	// Halving the budget keeps the most recently shown images cached
+	// while the long tail is given back until the user returns.
+	while (CacheBytes > kCacheBudget / 2) {
+		auto lru = (const Image*)nullptr;
+		for (const auto image : CacheRegistry) {
+			if (!lru || image->_cacheTick < lru->_cacheTick) {
+				lru = image;
+			}
+		}
+		if (!lru) {
+			break;
+		}
+		lru->cacheUnregister();
+	}
+	return was - CacheBytes;
+}
+
 } // namespace Images
 
 Image::Image(const QString &path) : Image(ReadContent(path)) {
@@ -149,6 +192,66 @@ QImage Image::original() const {
 	return _data;
 }
 
+Image::~Image() {
+	cacheUnregister();
+}
+
+const QPixmap *Image::cacheFind(uint64 key) const {
+	const auto i = _cache.find(key);
+	if (i == _cache.cend()) {
+		return nullptr;
+	}
+	_cacheTick = ++CacheTick;
+	return &i->second;
+}
+
+const QPixmap &Image::cachePut(uint64 key, QPixmap &&pixmap) const {
+	auto i = _cache.find(key);
+	if (i != _cache.cend()) {
+		CacheBytes -= PixmapBytes(i->second);
+		_cacheBytes -= PixmapBytes(i->second);
+		CacheAllocations().freed(PixmapBytes(i->second));
+		i->second = std::move(pixmap);
+	} else {
+		i = _cache.emplace(key, std::move(pixmap)).first;
+	}
+	CacheBytes += PixmapBytes(i->second);
+	_cacheBytes += PixmapBytes(i->second);
+	CacheAllocations().allocated(PixmapBytes(i->second));
+	_cacheTick = ++CacheTick;
+	CacheRegistry.emplace(this);
+	EnforceCacheBudget(this);
+	return i->second;
+}
+
+void Image::cacheUnregister() const {
+	if (CacheRegistry.remove(this)) {
+		CacheBytes -= _cacheBytes;
+		CacheAllocations().freed(_cacheBytes);
+	}
+	_cacheBytes = 0;
+	_cache.clear();
+}
+
+void Image::EnforceCacheBudget(not_null<const Image*> keep) {
+	while (CacheBytes > kCacheBudget) {
+		// Evict the whole cache of the least recently used image, the
+		// visible ones were just touched so their variants are newest.
+		// The image that is being cached right now is never evicted.
+		auto lru = (const Image*)nullptr;
+		for (const auto image : CacheRegistry) {
+			if (image != keep
+				&& (!lru || image->_cacheTick < lru->_cacheTick)) {
+				lru = image;
+			}
+		}
+		if (!lru) {
+			break;
+		}
+		lru->cacheUnregister();
+	}
+}
+
 const QPixmap &Image::pix(int w, int h) const {
 	if (w <= 0 || !width() || !height()) {
 		w = width();
@@ -158,13 +261,12 @@ const QPixmap &Image::pix(int w, int h) const {
 	}
 	auto options = Option::Smooth | Option::None;
 	auto k = PixKey(w, h, options);
-	auto i = _cache.find(k);
-	if (i == _cache.cend()) {
-		auto p = pixNoCache(w, h, options);
-		p.setDevicePixelRatio(cRetinaFactor());
-		i = _cache.emplace_or_assign(k, p).first;
+	if (const auto cached = cacheFind(k)) {
+		return *cached;
 	}
-	return i->second;
+	auto p = pixNoCache(w, h, options);
+	p.setDevicePixelRatio(cRetinaFactor());
+	return cachePut(k, std::move(p));
 }
 
 const QPixmap &Image::pixRounded(
@@ -193,13 +295,12 @@ const QPixmap &Image::pixRounded(
 		options |= Option::Circled | cornerOptions(corners);
 	}
 	auto k = PixKey(w, h, options);
-	auto i = _cache.find(k);
-	if (i == _cache.cend()) {
-		auto p = pixNoCache(w, h, options);
-		p.setDevicePixelRatio(cRetinaFactor());
-		i = _cache.emplace_or_assign(k, p).first;
+	if (const auto cached = cacheFind(k)) {
+		return *cached;
 	}
-	return i->second;
+	auto p = pixNoCache(w, h, options);
+	p.setDevicePixelRatio(cRetinaFactor());
+	return cachePut(k, std::move(p));
 }
 
 const QPixmap &Image::pixCircled(int w, int h) const {
@@ -211,13 +312,12 @@ const QPixmap &Image::pixCircled(int w, int h) const {
 	}
 	auto options = Option::Smooth | Option::Circled;
 	auto k = PixKey(w, h, options);
-	auto i = _cache.find(k);
-	if (i == _cache.cend()) {
-		auto p = pixNoCache(w, h, options);
-		p.setDevicePixelRatio(cRetinaFactor());
-		i = _cache.emplace_or_assign(k, p).first;
+	if (const auto cached = cacheFind(k)) {
+		return *cached;
 	}
-	return i->second;
+	auto p = pixNoCache(w, h, options);
+	p.setDevicePixelRatio(cRetinaFactor());
+	return cachePut(k, std::move(p));
 }
 
 const QPixmap &Image::pixBlurredCircled(int w, int h) const {
@@ -229,13 +329,12 @@ const QPixmap &Image::pixBlurredCircled(int w, int h) const {
 	}
 	auto options = Option::Smooth | Option::Circled | Option::Blurred;
 	auto k = PixKey(w, h, options);
-	auto i = _cache.find(k);
-	if (i == _cache.cend()) {
-		auto p = pixNoCache(w, h, options);
-		p.setDevicePixelRatio(cRetinaFactor());
-		i = _cache.emplace_or_assign(k, p).first;
+	if (const auto cached = cacheFind(k)) {
+		return *cached;
 	}
-	return i->second;
+	auto p = pixNoCache(w, h, options);
+	p.setDevicePixelRatio(cRetinaFactor());
+	return cachePut(k, std::move(p));
 }
 
 const QPixmap &Image::pixBlurred(int w, int h) const {
@@ -247,13 +346,12 @@ const QPixmap &Image::pixBlurred(int w, int h) const {
 	}
 	auto options = Option::Smooth | Option::Blurred;
 	auto k = PixKey(w, h, options);
-	auto i = _cache.find(k);
-	if (i == _cache.cend()) {
-		auto p = pixNoCache(w, h, options);
-		p.setDevicePixelRatio(cRetinaFactor());
-		i = _cache.emplace_or_assign(k, p).first;
+	if (const auto cached = cacheFind(k)) {
+		return *cached;
 	}
-	return i->second;
+	auto p = pixNoCache(w, h, options);
+	p.setDevicePixelRatio(cRetinaFactor());
+	return cachePut(k, std::move(p));
 }
 
 const QPixmap &Image::pixColored(style::color add, int w, int h) const {
@@ -265,13 +363,12 @@ const QPixmap &Image::pixColored(style::color add, int w, int h) const {
 	}
 	auto options = Option::Smooth | Option::Colored;
 	auto k = PixKey(w, h, options);
-	auto i = _cache.find(k);
-	if (i == _cache.cend()) {
-		auto p = pixColoredNoCache(add, w, h, true);
-		p.setDevicePixelRatio(cRetinaFactor());
-		i = _cache.emplace_or_assign(k, p).first;
+	if (const auto cached = cacheFind(k)) {
+		return *cached;
 	}
-	return i->second;
+	auto p = pixColoredNoCache(add, w, h, true);
+	p.setDevicePixelRatio(cRetinaFactor());
+	return cachePut(k, std::move(p));
 }
 
 const QPixmap &Image::pixBlurredColored(
@@ -286,13 +383,12 @@ const QPixmap &Image::pixBlurredColored(
 	}
 	auto options = Option::Blurred | Option::Smooth | Option::Colored;
 	auto k = PixKey(w, h, options);
-	auto i = _cache.find(k);
-	if (i == _cache.cend()) {
-		auto p = pixBlurredColoredNoCache(add, w, h);
-		p.setDevicePixelRatio(cRetinaFactor());
-		i = _cache.emplace_or_assign(k, p).first;
+	if (const auto cached = cacheFind(k)) {
+		return *cached;
 	}
-	return i->second;
+	auto p = pixBlurredColoredNoCache(add, w, h);
+	p.setDevicePixelRatio(cRetinaFactor());
+	return cachePut(k, std::move(p));
 }
 
 const QPixmap &Image::pixSingle(
@@ -329,13 +425,15 @@ const QPixmap &Image::pixSingle(
 	}
 
 	auto k = SinglePixKey(options);
-	auto i = _cache.find(k);
-	if (i == _cache.cend() || i->second.width() != (outerw * cIntRetinaFactor()) || i->second.height() != (outerh * cIntRetinaFactor())) {
-		auto p = pixNoCache(w, h, options, outerw, outerh, colored);
-		p.setDevicePixelRatio(cRetinaFactor());
-		i = _cache.emplace_or_assign(k, p).first;
+	const auto cached = cacheFind(k);
+	if (cached
+		&& cached->width() == (outerw * cIntRetinaFactor())
+		&& cached->height() == (outerh * cIntRetinaFactor())) {
+		return *cached;
 	}
-	return i->second;
+	auto p = pixNoCache(w, h, options, outerw, outerh, colored);
+	p.setDevicePixelRatio(cRetinaFactor());
+	return cachePut(k, std::move(p));
 }
 
 const QPixmap &Image::pixBlurredSingle(
@@ -368,13 +466,15 @@ const QPixmap &Image::pixBlurredSingle(
 	}
 
 	auto k = SinglePixKey(options);
-	auto i = _cache.find(k);
-	if (i == _cache.cend() || i->second.width() != (outerw * cIntRetinaFactor()) || i->second.height() != (outerh * cIntRetinaFactor())) {
-		auto p = pixNoCache(w, h, options, outerw, outerh);
-		p.setDevicePixelRatio(cRetinaFactor());
-		i = _cache.emplace_or_assign(k, p).first;
+	const auto cached = cacheFind(k);
+	if (cached
+		&& cached->width() == (outerw * cIntRetinaFactor())
+		&& cached->height() == (outerh * cIntRetinaFactor())) {
+		return *cached;
 	}
-	return i->second;
+	auto p = pixNoCache(w, h, options, outerw, outerh);
+	p.setDevicePixelRatio(cRetinaFactor());
+	return cachePut(k, std::move(p));
 }
 
 QPixmap Image::pixNoCache(
@@ -461,6 +561,16 @@ QPixmap Image::pixBlurredColoredNoCache(
 		return Empty()->pix();
 	}
 
+	// Scale down before blurring when the target is smaller, the blur
+	// cost is proportional to the area and the blurred look of a small
+	// result is the same.
+	if (w > 0 && w < _data.width()) {
+		auto img = (h <= 0)
+			? _data.scaledToWidth(w, Qt::SmoothTransformation)
+			: _data.scaled(w, h, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+		return App::pixmapFromImageInPlace(
+			prepareColored(add, prepareBlur(std::move(img))));
+	}
 	auto img = prepareBlur(_data);
 	if (h <= 0) {
 		img = img.scaledToWidth(w, Qt::SmoothTransformation);
@@ -17,6 +17,19 @@ namespace Images {
 [[nodiscard]] QSize GetSizeForDocument(
 	const QVector<MTPDocumentAttribute> &attributes);
 
+// Process-wide accounting of the cached pixmap variants, for diagnostics.
+struct CacheState {
+	int64 bytes = 0;
+	int64 limit = 0;
+	int images = 0;
+};
+[[nodiscard]] CacheState CurrentCacheState();
+
+// Shrinks the pixmap variants cache below its budget while the user is
+// idle, returns the number of bytes reclaimed. The evicted variants are
+// re-rendered from the original data when they are needed again.
+int64 TrimCacheForIdle();
+
 } // namespace Images
 
 class Image final {
@@ -90,8 +103,19 @@ public:
 		int w,
 		int h = 0) const;
 
+	~Image();
+
 private:
+	friend int64 Images::TrimCacheForIdle();
+
+	[[nodiscard]] const QPixmap *cacheFind(uint64 key) const;
+	const QPixmap &cachePut(uint64 key, QPixmap &&pixmap) const;
+	void cacheUnregister() const;
+	static void EnforceCacheBudget(not_null<const Image*> keep);
+
 	const QImage _data;
 	mutable base::flat_map<uint64, QPixmap> _cache;
+	mutable int64 _cacheBytes = 0;
+	mutable uint64 _cacheTick = 0;
 
 };
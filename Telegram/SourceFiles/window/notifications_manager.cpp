@@ -17,6 +17,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "lang/lang_keys.h"
 #include "data/data_session.h"
 #include "data/data_channel.h"
+#include "base/flat_set.h"
 #include "base/unixtime.h"
 #include "window/window_session_controller.h"
 #include "core/application.h"
@@ -37,6 +38,16 @@ namespace {
 constexpr auto kMinimalAlertDelay = crl::time(500);
 constexpr auto kWaitingForAllGroupedDelay = crl::time(1000);
 
+// Toasts collected within this interval are shown as one batch.
+constexpr auto kBatchFlushDelay = crl::time(300);
+
+// Group chat toasts above this count per flush are dropped, the unread
+// badge still counts them. PMs and mentions are never dropped.
+constexpr auto kMaxNotificationsPerFlush = 8;
+
+// One alert sound per this interval, whatever lands in between.
+constexpr auto kMinimalSoundDelay = 2 * crl::time(1000);
+
 #ifdef Q_OS_MAC
 constexpr auto kSystemAlertDuration = crl::time(1000);
 #else // !Q_OS_MAC
@@ -48,7 +59,8 @@ constexpr auto kSystemAlertDuration = crl::time(0);
 System::System(not_null<Main::Session*> session)
 : _session(session)
 , _waitTimer([=] { showNext(); })
-, _waitForAllGroupedTimer([=] { showGrouped(); }) {
+, _waitForAllGroupedTimer([=] { showGrouped(); })
+, _batchTimer([=] { flushBatch(); }) {
 	createManager();
 
 	subscribe(settingsChanged(), [=](ChangeType type) {
@@ -162,6 +174,8 @@ void System::clearAll() {
 	_whenAlerts.clear();
 	_waiters.clear();
 	_settingWaiters.clear();
+	_batch.clear();
+	_batchTimer.cancel();
 }
 
 void System::clearFromHistory(not_null<History*> history) {
@@ -172,6 +186,9 @@ void System::clearFromHistory(not_null<History*> history) {
 	_whenAlerts.remove(history);
 	_waiters.remove(history);
 	_settingWaiters.remove(history);
+	_batch.erase(
+		ranges::remove(_batch, history, &BatchItem::history),
+		end(_batch));
 
 	_waitTimer.cancel();
 	showNext();
@@ -194,6 +211,8 @@ void System::clearAllFast() {
 	_whenAlerts.clear();
 	_waiters.clear();
 	_settingWaiters.clear();
+	_batch.clear();
+	_batchTimer.cancel();
 }
 
 void System::checkDelayed() {
@@ -245,12 +264,60 @@ void System::checkDelayed() {
 void System::showGrouped() {
 	if (const auto lastItem = session().data().message(_lastHistoryItemId)) {
 		_waitForAllGroupedTimer.cancel();
-		_manager->showNotification(lastItem, _lastForwardedCount);
+		pushToBatch(lastItem, _lastForwardedCount);
 		_lastForwardedCount = 0;
 		_lastHistoryItemId = FullMsgId();
 	}
 }
 
+void System::pushToBatch(not_null<HistoryItem*> item, int forwardedCount) {
+	const auto priority = item->history()->peer->isUser()
+		|| item->mentionsMe();
+	_batch.push_back({
+		item->fullId(),
+		item->history(),
+		forwardedCount,
+		priority });
+	if (!_batchTimer.isActive()) {
+		_batchTimer.callOnce(kBatchFlushDelay);
+	}
+}
+
+void System::flushBatch() {
+	const auto batch = base::take(_batch);
+
+	// A run of messages from one chat collapses into the toast for the
+	// latest of them, the unread badge counts the rest.
+	auto seen = base::flat_set<not_null<History*>>();
+	auto collapsed = std::vector<BatchItem>();
+	collapsed.reserve(batch.size());
+	for (auto i = batch.rbegin(); i != batch.rend(); ++i) {
+		if (seen.emplace(i->history).second) {
+			collapsed.push_back(*i);
+		}
+	}
+	ranges::reverse(collapsed);
+	ranges::stable_partition(collapsed, &BatchItem::priority);
+
+	auto shown = 0;
+	auto dropped = 0;
+	for (const auto &entry : collapsed) {
+		const auto item = session().data().message(entry.id);
+		if (!item) {
+			continue;
+		} else if (shown >= kMaxNotificationsPerFlush && !entry.priority) {
+			++dropped;
+			continue;
+		}
+		_manager->showNotification(item, entry.forwardedCount);
+		++shown;
+	}
+	if (dropped > 0) {
+		DEBUG_LOG(("Notifications: dropped %1 group toasts in a batch."
+			).arg(dropped));
+	}
+}
+
 void System::showNext() {
 	if (App::quitting()) return;
 
@@ -306,7 +373,10 @@ void System::showNext() {
 				}
 			}
 		}
-		if (Global::SoundNotify() && !Platform::Notifications::SkipAudio()) {
+		if (Global::SoundNotify()
+			&& !Platform::Notifications::SkipAudio()
+			&& (ms >= _lastSoundPlayed + kMinimalSoundDelay)) {
+			_lastSoundPlayed = ms;
 			ensureSoundCreated();
 			_soundTrack->playOnce();
 			emit Media::Player::mixer()->suppressAll(_soundTrack->getLengthMs());
@@ -444,7 +514,7 @@ void System::showNext() {
 					// then there is no reason to wait for the timer
 					// to show the previous notification.
 					showGrouped();
-					_manager->showNotification(notifyItem, forwardedCount);
+					pushToBatch(notifyItem, forwardedCount);
 				}
 
 				if (!history->hasNotification()) {
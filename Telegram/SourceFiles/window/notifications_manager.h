@@ -102,6 +102,8 @@ private:
 
 	void showNext();
 	void showGrouped();
+	void pushToBatch(not_null<HistoryItem*> item, int forwardedCount);
+	void flushBatch();
 	void ensureSoundCreated();
 
 	not_null<Main::Session*> _session;
@@ -126,6 +128,18 @@ private:
 
 	QMap<History*, QMap<crl::time, PeerData*>> _whenAlerts;
 
+	// Toasts are collected here and passed to the platform manager in
+	// batches, so an unmute or a catch-up does not show them in a storm.
+	struct BatchItem {
+		FullMsgId id;
+		not_null<History*> history;
+		int forwardedCount = 0;
+		bool priority = false;
+	};
+	std::vector<BatchItem> _batch;
+	base::Timer _batchTimer;
+	crl::time _lastSoundPlayed = 0;
+
 	std::unique_ptr<Manager> _manager;
 
 	base::Observable<ChangeType> _settingsChanged;
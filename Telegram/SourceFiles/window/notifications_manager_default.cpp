@@ -74,6 +74,14 @@ Manager::Manager(System *system)
 	subscribe(system->settingsChanged(), [this](ChangeType change) {
 		settingsChanged(change);
 	});
+	subscribe(Window::Theme::Background(), [this](
+			const Window::Theme::BackgroundUpdate &data) {
+		if (data.paletteChanged()) {
+			// Rebuilt lazily by the first toast that needs it, the
+			// notifications refresh their copies right after this.
+			_sharedButtonsCache = QPixmap();
+		}
+	});
 }
 
 Manager::QueuedNotification::QueuedNotification(
@@ -545,7 +553,8 @@ Notification::Notification(
 , _forwardedCount(forwardedCount)
 , _fromScheduled(fromScheduled)
 , _close(this, st::notifyClose)
-, _reply(this, tr::lng_notification_reply(), st::defaultBoxButton) {
+, _reply(this, tr::lng_notification_reply(), st::defaultBoxButton)
+, _hideTimer([=] { startHiding(); }) {
 	subscribe(Lang::Current().updated(), [this] { refreshLang(); });
 
 	auto position = computePosition(st::notifyMinHeight);
@@ -554,9 +563,6 @@ Notification::Notification(
 	_userpicLoaded = !_userpicView || (_userpicView->image() != nullptr);
 	updateNotifyDisplay();
 
-	_hideTimer.setSingleShot(true);
-	connect(&_hideTimer, &QTimer::timeout, [=] { startHiding(); });
-
 	_close->setClickedCallback([this] {
 		unlinkHistoryInManager();
 	});
@@ -598,22 +604,35 @@ void Notification::refreshLang() {
 }
 
 void Notification::prepareActionsCache() {
-	auto replyCache = Ui::GrabWidget(_reply);
-	auto fadeWidth = st::notifyFadeRight.width();
-	auto actionsTop = st::notifyTextTop + st::msgNameFont->height;
-	auto replyRight = _replyPadding - st::notifyBorderWidth;
-	auto actionsCacheWidth = _reply->width() + replyRight + fadeWidth;
-	auto actionsCacheHeight = height() - actionsTop - st::notifyBorderWidth;
-	auto actionsCacheImg = QImage(QSize(actionsCacheWidth, actionsCacheHeight) * cIntRetinaFactor(), QImage::Format_ARGB32_Premultiplied);
-	actionsCacheImg.setDevicePixelRatio(cRetinaFactor());
-	actionsCacheImg.fill(Qt::transparent);
-	{
-		Painter p(&actionsCacheImg);
-		st::notifyFadeRight.fill(p, style::rtlrect(0, 0, fadeWidth, actionsCacheHeight, actionsCacheWidth));
-		p.fillRect(style::rtlrect(fadeWidth, 0, actionsCacheWidth - fadeWidth, actionsCacheHeight, actionsCacheWidth), st::notificationBg);
-		p.drawPixmapRight(replyRight, _reply->y() - actionsTop, actionsCacheWidth, replyCache);
+	// Every toast shows an identical actions strip, so it is rendered
+	// once and shared through the manager till the palette changes.
+	// All the positions are computed from the minimal height metrics,
+	// making the pixmap independent of this toast's current geometry.
+	auto &shared = manager()->_sharedButtonsCache;
+	if (shared.isNull()) {
+		auto replyCache = Ui::GrabWidget(_reply);
+		auto fadeWidth = st::notifyFadeRight.width();
+		auto actionsTop = st::notifyTextTop + st::msgNameFont->height;
+		auto replyTop = st::notifyMinHeight
+			- _reply->height()
+			- _replyPadding;
+		auto replyRight = _replyPadding - st::notifyBorderWidth;
+		auto actionsCacheWidth = _reply->width() + replyRight + fadeWidth;
+		auto actionsCacheHeight = st::notifyMinHeight
+			- actionsTop
+			- st::notifyBorderWidth;
+		auto actionsCacheImg = QImage(QSize(actionsCacheWidth, actionsCacheHeight) * cIntRetinaFactor(), QImage::Format_ARGB32_Premultiplied);
+		actionsCacheImg.setDevicePixelRatio(cRetinaFactor());
+		actionsCacheImg.fill(Qt::transparent);
+		{
+			Painter p(&actionsCacheImg);
+			st::notifyFadeRight.fill(p, style::rtlrect(0, 0, fadeWidth, actionsCacheHeight, actionsCacheWidth));
+			p.fillRect(style::rtlrect(fadeWidth, 0, actionsCacheWidth - fadeWidth, actionsCacheHeight, actionsCacheWidth), st::notificationBg);
+			p.drawPixmapRight(replyRight, replyTop - actionsTop, actionsCacheWidth, replyCache);
+		}
+		shared = App::pixmapFromImageInPlace(std::move(actionsCacheImg));
 	}
-	_buttonsCache = App::pixmapFromImageInPlace(std::move(actionsCacheImg));
+	_buttonsCache = shared;
 }
 
 bool Notification::checkLastInput(bool hasReplyingNotifications) {
@@ -625,7 +644,7 @@ bool Notification::checkLastInput(bool hasReplyingNotifications) {
 	if (!waitForUserInput) {
 		_waitingForInput = false;
 		if (!hasReplyingNotifications) {
-			_hideTimer.start(st::notifyWaitLongHide);
+			_hideTimer.callOnce(st::notifyWaitLongHide);
 		}
 		return true;
 	}
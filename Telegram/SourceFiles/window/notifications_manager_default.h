@@ -14,8 +14,6 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "base/binary_guard.h"
 #include "base/object_ptr.h"
 
-#include <QtCore/QTimer>
-
 namespace Data {
 class CloudImageView;
 } // namespace Data
@@ -109,6 +107,10 @@ private:
 
 	mutable QPixmap _hiddenUserpicPlaceholder;
 
+	// The actions strip is identical for all toasts, rendered by the
+	// first one that needs it and dropped when the palette changes.
+	QPixmap _sharedButtonsCache;
+
 };
 
 namespace internal {
@@ -260,7 +262,7 @@ private:
 	object_ptr<Ui::IconButton> _replySend = { nullptr };
 	bool _waitingForInput = true;
 
-	QTimer _hideTimer;
+	base::Timer _hideTimer;
 
 	int _replyPadding = 0;
 
@@ -40,10 +40,29 @@ CachedUserpics::~CachedUserpics() {
 	}
 }
 
-QString CachedUserpics::get(
+QImage CachedUserpics::renderImage(
 		const InMemoryKey &key,
 		not_null<PeerData*> peer,
-		std::shared_ptr<Data::CloudImageView> &view) {
+		std::shared_ptr<Data::CloudImageView> &view) const {
+	if (!key.first && !key.second) {
+		return Core::App().logoNoMargin();
+	} else if (peer->isSelf()) {
+		const auto method = (_type == Type::Rounded)
+			? Ui::EmptyUserpic::GenerateSavedMessagesRounded
+			: Ui::EmptyUserpic::GenerateSavedMessages;
+		return method(st::notifyMacPhotoSize).toImage();
+	} else if (_type == Type::Rounded) {
+		return peer->genUserpicRounded(view, st::notifyMacPhotoSize).toImage();
+	} else {
+		return peer->genUserpic(view, st::notifyMacPhotoSize).toImage();
+	}
+}
+
+void CachedUserpics::getAsync(
+		const InMemoryKey &key,
+		not_null<PeerData*> peer,
+		std::shared_ptr<Data::CloudImageView> &view,
+		Fn<void(const QString &path)> done) {
 	auto ms = crl::now();
 	auto i = _images.find(key);
 	if (i != _images.cend()) {
@@ -51,33 +70,45 @@ QString CachedUserpics::get(
 			i->until = ms + kNotifyDeletePhotoAfterMs;
 			clearInMs(-kNotifyDeletePhotoAfterMs);
 		}
-	} else {
-		Image v;
-		if (key.first) {
-			v.until = ms + kNotifyDeletePhotoAfterMs;
-			clearInMs(-kNotifyDeletePhotoAfterMs);
-		} else {
-			v.until = 0;
-		}
-		v.path = cWorkingDir() + qsl("tdata/temp/") + QString::number(rand_value<uint64>(), 16) + qsl(".png");
-		if (key.first || key.second) {
-			if (peer->isSelf()) {
-				const auto method = (_type == Type::Rounded)
-					? Ui::EmptyUserpic::GenerateSavedMessagesRounded
-					: Ui::EmptyUserpic::GenerateSavedMessages;
-				method(st::notifyMacPhotoSize).save(v.path, "PNG");
-			} else if (_type == Type::Rounded) {
-				peer->saveUserpicRounded(view, v.path, st::notifyMacPhotoSize);
-			} else {
-				peer->saveUserpic(view, v.path, st::notifyMacPhotoSize);
-			}
+		if (i->writing) {
+			_waiting[key].push_back(std::move(done));
 		} else {
-			Core::App().logoNoMargin().save(v.path, "PNG");
+			done(i->path);
 		}
-		i = _images.insert(key, v);
-		_someSavedFlag = true;
+		return;
+	}
+	Image v;
+	if (key.first) {
+		v.until = ms + kNotifyDeletePhotoAfterMs;
+		clearInMs(-kNotifyDeletePhotoAfterMs);
+	} else {
+		v.until = 0;
+	}
+	v.path = cWorkingDir() + qsl("tdata/temp/") + QString::number(rand_value<uint64>(), 16) + qsl(".png");
+	v.writing = true;
+	_images.insert(key, v);
+	_someSavedFlag = true;
+	_waiting[key].push_back(std::move(done));
+
+	// The userpic is rendered from the data right here, only the PNG
+	// encoding and the disk write happen on the worker thread.
+	const auto path = v.path;
+	const auto ready = crl::guard(this, [=] { written(key); });
+	crl::async([path, ready, image = renderImage(key, peer, view)] {
+		image.save(path, "PNG");
+		crl::on_main(ready);
+	});
+}
+
+void CachedUserpics::written(const InMemoryKey &key) {
+	const auto i = _images.find(key);
+	if (i != _images.cend()) {
+		i->writing = false;
+	}
+	const auto path = (i != _images.cend()) ? i->path : QString();
+	for (const auto &callback : _waiting.take(key)) {
+		callback(path);
 	}
-	return i->path;
 }
 
 crl::time CachedUserpics::clear(crl::time ms) {
@@ -9,6 +9,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 #include "window/notifications_manager.h"
 #include "base/timer.h"
+#include "base/weak_ptr.h"
 
 namespace Data {
 class CloudImageView;
@@ -17,7 +18,7 @@ class CloudImageView;
 namespace Window {
 namespace Notifications {
 
-class CachedUserpics : public QObject {
+class CachedUserpics : public QObject, public base::has_weak_ptr {
 public:
 	enum class Type {
 		Rounded,
@@ -27,23 +28,34 @@ public:
 	CachedUserpics(Type type);
 	~CachedUserpics();
 
-	[[nodiscard]] QString get(
+	// Renders the userpic right away, encodes and writes the file on a
+	// worker thread and calls back on the main thread with the path.
+	// The callback is dropped if the cache is destroyed in between.
+	void getAsync(
 		const InMemoryKey &key,
 		not_null<PeerData*> peer,
-		std::shared_ptr<Data::CloudImageView> &view);
+		std::shared_ptr<Data::CloudImageView> &view,
+		Fn<void(const QString &path)> done);
 
 private:
 	void clear();
 	void clearInMs(int ms);
 	crl::time clear(crl::time ms);
+	[[nodiscard]] QImage renderImage(
+		const InMemoryKey &key,
+		not_null<PeerData*> peer,
+		std::shared_ptr<Data::CloudImageView> &view) const;
+	void written(const InMemoryKey &key);
 
 	Type _type = Type::Rounded;
 	struct Image {
 		crl::time until = 0;
+		bool writing = false;
 		QString path;
 	};
 	using Images = QMap<InMemoryKey, Image>;
 	Images _images;
+	QMap<InMemoryKey, std::vector<Fn<void(const QString&)>>> _waiting;
 	bool _someSavedFlag = false;
 	base::Timer _clearTimer;
 
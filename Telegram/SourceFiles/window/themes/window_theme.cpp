@@ -16,6 +16,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "storage/localstorage.h"
 #include "storage/localimageloader.h"
 #include "storage/file_upload.h"
+#include "base/call_delayed.h"
 #include "base/parse_helper.h"
 #include "base/zlib_help.h"
 #include "base/unixtime.h"
@@ -272,6 +273,48 @@ bool LoadTheme(
 		return false;
 	}
 
+	// When the cache already holds the prepared artifacts of this very
+	// content - the resolved palette as a flat blob and the decoded
+	// background - applying does no parsing or image preparation work.
+	const auto loadedFromCache = [&] {
+		if (!cache || editedPalette) {
+			return false;
+		} else if (cache->paletteChecksum != style::palette::Checksum()) {
+			return false;
+		} else if (cache->contentChecksum
+			!= base::crc32(content.constData(), content.size())) {
+			return false;
+		}
+		auto background = QImage();
+		if (!cache->background.isEmpty()) {
+			QDataStream stream(cache->background);
+			QImageReader reader(stream.device());
+#ifndef OS_MAC_OLD
+			reader.setAutoTransform(true);
+#endif // OS_MAC_OLD
+			if (!reader.read(&background) || background.isNull()) {
+				return false;
+			}
+		}
+		if (out) {
+			if (!out->palette.load(cache->colors)) {
+				return false;
+			}
+		} else {
+			if (!style::main_palette::load(cache->colors)) {
+				return false;
+			}
+			Background()->saveAdjustableColors();
+		}
+		if (!background.isNull()) {
+			applyBackground(std::move(background), cache->tiled, out);
+		}
+		return true;
+	}();
+	if (loadedFromCache) {
+		return true;
+	}
+
 	if (cache) {
 		*cache = Cached();
 	}
@@ -505,6 +548,70 @@ void ClearEditingPalette() {
 	QFile(EditingPalettePath()).remove();
 }
 
+// Loading a theme parses the scheme and decodes the background image,
+// which freezes the window for hundreds of milliseconds when done right
+// in the night mode toggle. So after a theme is applied the theme we
+// would switch to on the next toggle is loaded ahead of time on a
+// background thread and the toggle just applies the ready instance.
+std::unique_ptr<Preview> GlobalSwitchPrepared;
+bool GlobalSwitchPreparedNightMode = false;
+
+constexpr auto kPrepareSwitchAfterApply = 10 * crl::time(1000);
+
+void PrepareOppositeNightModeSwitch() {
+	const auto background = Background();
+	const auto nightMode = background->nightMode();
+	background->setNightModeValue(!nightMode);
+	auto read = Local::readThemeAfterSwitch();
+	background->setNightModeValue(nightMode);
+
+	GlobalSwitchPrepared = nullptr;
+	if (read.object.content.isEmpty()) {
+		return;
+	}
+	const auto targetNightMode = !nightMode;
+	const auto colorizer = ColorizerForTheme(read.object.pathAbsolute);
+	crl::async([=, read = std::move(read)]() mutable {
+		auto preview = std::make_unique<Preview>();
+		preview->object = std::move(read.object);
+		preview->instance.cached = std::move(read.cache);
+		const auto loaded = LoadTheme(
+			preview->object.content,
+			colorizer,
+			std::nullopt,
+			&preview->instance.cached,
+			&preview->instance);
+		if (!loaded) {
+			return;
+		}
+		crl::on_main([=, preview = std::move(preview)]() mutable {
+			if (GlobalBackground
+				&& !AreTestingTheme()
+				&& Background()->nightMode() != targetNightMode) {
+				GlobalSwitchPrepared = std::move(preview);
+				GlobalSwitchPreparedNightMode = targetNightMode;
+			}
+		});
+	});
+}
+
+void SchedulePrepareOppositeNightModeSwitch() {
+	base::call_delayed(kPrepareSwitchAfterApply, [] {
+		if (GlobalBackground && !AreTestingTheme()) {
+			PrepareOppositeNightModeSwitch();
+		}
+	});
+}
+
+[[nodiscard]] std::unique_ptr<Preview> TakePreparedNightModeSwitch(
+		bool newNightMode) {
+	if (!GlobalSwitchPrepared
+		|| (GlobalSwitchPreparedNightMode != newNightMode)) {
+		return nullptr;
+	}
+	return base::take(GlobalSwitchPrepared);
+}
+
 } // namespace
 
 ChatBackground::AdjustableColor::AdjustableColor(style::color data)
@@ -1004,6 +1111,7 @@ void ChatBackground::keepApplied(const Object &object, bool write) {
 		}
 	}
 	notify(BackgroundUpdate(BackgroundUpdate::Type::ApplyingTheme, tile()), true);
+	SchedulePrepareOppositeNightModeSwitch();
 }
 
 bool ChatBackground::isNonDefaultThemeOrBackground() {
@@ -1061,13 +1169,26 @@ void ChatBackground::reapplyWithNightMode(
 	const auto settingExactTheme = themePath.has_value();
 	const auto nightModeChanged = (newNightMode != _nightMode);
 	const auto oldNightMode = _nightMode;
+	auto prepared = (settingExactTheme || !nightModeChanged)
+		? nullptr
+		: TakePreparedNightModeSwitch(newNightMode);
 	_nightMode = newNightMode;
-	auto read = settingExactTheme ? Saved() : Local::readThemeAfterSwitch();
-	auto path = read.object.pathAbsolute;
+	auto read = (settingExactTheme || prepared)
+		? Saved()
+		: Local::readThemeAfterSwitch();
+	auto path = prepared
+		? prepared->object.pathAbsolute
+		: read.object.pathAbsolute;
 
 	_nightMode = oldNightMode;
 	auto oldTileValue = (_nightMode ? _tileNightValue : _tileDayValue);
 	const auto alreadyOnDisk = [&] {
+		if (prepared) {
+			// The theme was loaded ahead of time in the background,
+			// apply the ready palette and background right away.
+			Apply(std::move(prepared));
+			return true;
+		}
 		if (read.object.content.isEmpty()) {
 			return false;
 		}
@@ -1139,6 +1260,7 @@ bool IsEmbeddedTheme(const QString &path) {
 bool Initialize(Saved &&saved) {
 	if (InitializeFromSaved(std::move(saved))) {
 		Background()->setThemeObject(saved.object);
+		SchedulePrepareOppositeNightModeSwitch();
 		return true;
 	}
 	return false;
@@ -246,6 +246,7 @@ void SessionController::openFolder(not_null<Data::Folder*> folder) {
 		resetFakeUnreadWhileOpened();
 	}
 	setActiveChatsFilter(0);
+	folder->requestChatsList();
 	_openedFolder = folder.get();
 }
 
@@ -27,6 +27,8 @@ PRIVATE
     mtproto/details/mtproto_dump_to_text.h
     mtproto/details/mtproto_received_ids_manager.cpp
     mtproto/details/mtproto_received_ids_manager.h
+    mtproto/details/mtproto_request_metrics.cpp
+    mtproto/details/mtproto_request_metrics.h
     mtproto/details/mtproto_rsa_public_key.cpp
     mtproto/details/mtproto_rsa_public_key.h
     mtproto/details/mtproto_serialized_request.cpp
@@ -39,6 +41,7 @@ PRIVATE
     mtproto/mtproto_auth_key.h
     mtproto/mtproto_concurrent_sender.cpp
     mtproto/mtproto_concurrent_sender.h
+    mtproto/mtproto_concurrent_sender_coroutine.h
     mtproto/mtproto_dh_utils.cpp
     mtproto/mtproto_dh_utils.h
     mtproto/mtproto_proxy_data.cpp